@@ -35,20 +35,19 @@
 /*===========================================================================*/
 
 az_paused_action_t az_paused_event_loop(
-    const az_planet_t *planet, az_preferences_t *prefs,
-    az_ship_t *ship) {
-  static az_paused_state_t state;
-  az_init_paused_state(&state, planet, prefs, ship);
+    az_paused_state_t *state, const az_planet_t *planet,
+    az_preferences_t *prefs, az_ship_t *ship) {
+  az_init_paused_state(state, planet, prefs, ship);
   az_player_t *player = &ship->player;
 
   bool prefs_changed = false;
 
   while (true) {
     // Tick the state and redraw the screen.
-    az_tick_paused_state(&state, AZ_FRAME_TIME_SECONDS);
-    az_tick_audio(&state.soundboard);
+    az_tick_paused_state(state, AZ_FRAME_TIME_SECONDS);
+    az_tick_audio(&state->soundboard);
     az_start_screen_redraw(); {
-      az_paused_draw_screen(&state);
+      az_paused_draw_screen(state);
     } az_finish_screen_redraw();
 
     // Get and process GUI events.
@@ -56,10 +55,10 @@ az_paused_action_t az_paused_event_loop(
     while (az_poll_event(&event)) {
       switch (event.kind) {
         case AZ_EVENT_KEY_DOWN: {
-          if (state.do_quit) break;
-          if (state.prefs_pane.selected_key_picker_index >= 0) {
-            az_prefs_try_pick_key(&state.prefs_pane, event.key.id,
-                                  &state.soundboard);
+          if (state->do_quit) break;
+          if (state->prefs_pane.selected_key_picker_index >= 0) {
+            az_prefs_try_pick_key(&state->prefs_pane, event.key.id,
+                                  &state->soundboard);
             break;
           }
           if (event.key.id == AZ_KEY_RETURN) return AZ_PA_RESUME;
@@ -99,13 +98,13 @@ az_paused_action_t az_paused_event_loop(
             case AZ_CONTROL_PAUSE:
               return AZ_PA_RESUME;
             case AZ_CONTROL_FIRE:
-              state.current_drawer = AZ_PAUSE_DRAWER_UPGRADES;
+              state->current_drawer = AZ_PAUSE_DRAWER_UPGRADES;
               break;
             case AZ_CONTROL_ORDN:
-              state.current_drawer = AZ_PAUSE_DRAWER_MAP;
+              state->current_drawer = AZ_PAUSE_DRAWER_MAP;
               break;
             case AZ_CONTROL_UTIL:
-              state.current_drawer = AZ_PAUSE_DRAWER_OPTIONS;
+              state->current_drawer = AZ_PAUSE_DRAWER_OPTIONS;
               break;
             default:
               break;
@@ -113,19 +112,19 @@ az_paused_action_t az_paused_event_loop(
           break;
         }
         case AZ_EVENT_MOUSE_DOWN:
-          az_paused_on_click(&state, event.mouse.x, event.mouse.y);
+          az_paused_on_click(state, event.mouse.x, event.mouse.y);
           break;
         case AZ_EVENT_MOUSE_MOVE:
-          az_paused_on_hover(&state, event.mouse.x, event.mouse.y);
+          az_paused_on_hover(state, event.mouse.x, event.mouse.y);
           break;
         default: break;
       }
     }
 
-    az_update_preferences(&state.prefs_pane, prefs, &prefs_changed);
+    az_update_preferences(&state->prefs_pane, prefs, &prefs_changed);
 
-    if (state.quitting_fade_alpha >= 1.0) {
-      assert(state.do_quit);
+    if (state->quitting_fade_alpha >= 1.0) {
+      assert(state->do_quit);
       return AZ_PA_EXIT_TO_TITLE;
     }
   }
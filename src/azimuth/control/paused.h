@@ -24,6 +24,7 @@
 #include "azimuth/state/planet.h"
 #include "azimuth/state/ship.h"
 #include "azimuth/util/prefs.h"
+#include "azimuth/view/paused.h"
 
 /*===========================================================================*/
 
@@ -32,8 +33,11 @@ typedef enum {
   AZ_PA_EXIT_TO_TITLE
 } az_paused_action_t;
 
+// Run the paused screen, using the given (caller-allocated) state, which gets
+// reinitialized each time.
 az_paused_action_t az_paused_event_loop(
-    const az_planet_t *planet, az_preferences_t *prefs, az_ship_t *ship);
+    az_paused_state_t *state, const az_planet_t *planet,
+    az_preferences_t *prefs, az_ship_t *ship);
 
 /*===========================================================================*/
 
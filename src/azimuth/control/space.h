@@ -22,8 +22,12 @@
 #define AZIMUTH_CONTROL_SPACE_H_
 
 #include "azimuth/state/planet.h"
+#include "azimuth/state/profile.h"
+#include "azimuth/state/replay.h"
 #include "azimuth/state/save.h"
+#include "azimuth/state/space.h"
 #include "azimuth/util/prefs.h"
+#include "azimuth/view/paused.h"
 
 /*===========================================================================*/
 
@@ -33,9 +37,34 @@ typedef enum {
   AZ_SA_VICTORY
 } az_space_action_t;
 
+// Everything belonging to one session of space mode.  The caller allocates
+// this (it's large, so statically or on the heap rather than on the stack),
+// so a single process may run several independent sessions, all sharing the
+// same planet data.
+typedef struct {
+  az_space_state_t state;
+  az_paused_state_t paused;
+  // The recording of the current run of the event loop.  This gets saved (in
+  // place of the previous one) whenever the loop exits, so that it can be
+  // played back later with az_replay_event_loop.
+  az_replay_t replay;
+  // Tick timings, for the debug overlay (toggled with the backtick key).
+  az_tick_profile_t profile;
+} az_space_session_t;
+
 az_space_action_t az_space_event_loop(
-    const az_planet_t *planet, az_saved_games_t *saved_games,
-    az_preferences_t *prefs, int saved_game_index);
+    az_space_session_t *session, const az_planet_t *planet,
+    az_saved_games_t *saved_games, az_preferences_t *prefs,
+    int saved_game_index);
+
+// Play back a replay recorded by az_space_event_loop, redrawing the screen
+// only once every frames_per_draw frames (so that values above 1 play back
+// faster than real time).  The left and right arrow keys seek backwards and
+// forwards, and the escape key stops playback.  The backtick key toggles the
+// tick profile overlay, just as in az_space_event_loop.
+void az_replay_event_loop(az_space_session_t *session,
+                          const az_planet_t *planet,
+                          const az_replay_t *replay, int frames_per_draw);
 
 /*===========================================================================*/
 
@@ -32,6 +32,7 @@
 #endif
 
 #include "azimuth/gui/audio.h"
+#include "azimuth/state/replay.h"
 #include "azimuth/state/save.h"
 #include "azimuth/system/resource.h"
 #include "azimuth/util/prefs.h"
@@ -155,4 +156,15 @@ bool az_save_saved_games(const az_saved_games_t *saved_games) {
   return success;
 }
 
+bool az_save_replay(const az_replay_t *replay) {
+  assert(replay != NULL);
+  char *data_dir = az_get_app_data_directory();
+  if (data_dir == NULL) return false;
+  char *replay_path = az_strprintf("%s/replay.txt", data_dir);
+  SDL_free(data_dir);
+  const bool success = az_save_replay_to_path(replay, replay_path);
+  free(replay_path);
+  return success;
+}
+
 /*===========================================================================*/
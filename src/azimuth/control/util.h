@@ -24,6 +24,7 @@
 #include <stdbool.h>
 
 #include "azimuth/state/planet.h"
+#include "azimuth/state/replay.h"
 #include "azimuth/state/save.h"
 #include "azimuth/util/prefs.h"
 #include "azimuth/view/prefs.h"
@@ -40,6 +41,10 @@ void az_load_saved_games(const az_planet_t *planet,
                          az_saved_games_t *saved_games);
 bool az_save_saved_games(const az_saved_games_t *saved_games);
 
+// Save the replay of the most recent space session, replacing the previous
+// one.  Returns true on success, or false on failure.
+bool az_save_replay(const az_replay_t *replay);
+
 /*===========================================================================*/
 
 #endif // AZIMUTH_CONTROL_UTIL_H_
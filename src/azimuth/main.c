@@ -18,7 +18,9 @@
 =============================================================================*/
 
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "azimuth/control/gameover.h"
 #include "azimuth/control/space.h"
@@ -29,8 +31,10 @@
 #include "azimuth/state/baddie.h" // for az_init_baddie_datas
 #include "azimuth/state/music.h" // for az_init_music_datas
 #include "azimuth/state/planet.h"
+#include "azimuth/state/replay.h"
 #include "azimuth/state/save.h"
 #include "azimuth/state/sound.h" // for az_init_sound_datas
+#include "azimuth/state/space.h" // for az_prebuild_rooms
 #include "azimuth/state/wall.h" // for az_init_wall_datas
 #include "azimuth/system/resource.h"
 #include "azimuth/util/misc.h" // for AZ_ASSERT_UNREACHABLE
@@ -43,10 +47,12 @@
 static az_planet_t planet;
 static az_saved_games_t saved_games;
 static az_preferences_t preferences;
+static az_space_session_t space_session;
 
 static bool load_scenario(void) {
   if (!az_init_music_datas(&az_system_resource_reader)) return false;
   if (!az_read_planet(&az_system_resource_reader, &planet)) return false;
+  az_prebuild_rooms(&planet);
   return true;
 }
 
@@ -56,7 +62,37 @@ typedef enum {
   AZ_CONTROLLER_GAME_OVER
 } az_controller_t;
 
+// Play back a replay file (as saved by the space controller) in the window
+// rather than running the game normally.  Returns the program's exit status.
+static int play_replay(const char *replay_path, int frames_per_draw) {
+  az_replay_t replay;
+  if (!az_load_replay_from_path(replay_path, &replay)) {
+    printf("Failed to load replay from %s.\n", replay_path);
+    return EXIT_FAILURE;
+  }
+  az_init_gui(false, true);
+  az_set_global_music_volume(preferences.music_volume);
+  az_set_global_sound_volume(preferences.sound_volume);
+  az_replay_event_loop(&space_session, &planet, &replay, frames_per_draw);
+  az_destroy_replay(&replay);
+  az_deinit_gui();
+  return EXIT_SUCCESS;
+}
+
 int main(int argc, char **argv) {
+  // Usage: azimuth [--replay <replay_file> [<frames_per_draw>]]
+  const char *replay_path = NULL;
+  int frames_per_draw = 1;
+  if (argc >= 3 && strcmp(argv[1], "--replay") == 0) {
+    replay_path = argv[2];
+    if (argc >= 4 &&
+        (sscanf(argv[3], "%d", &frames_per_draw) < 1 ||
+         frames_per_draw < 1)) {
+      printf("Invalid frames-per-draw: %s\n", argv[3]);
+      return EXIT_FAILURE;
+    }
+  }
+
   az_init_sound_datas();
   az_init_baddie_datas();
   az_init_wall_datas();
@@ -68,6 +104,7 @@ int main(int argc, char **argv) {
     return EXIT_FAILURE;
   }
   az_load_preferences(&preferences);
+  if (replay_path != NULL) return play_replay(replay_path, frames_per_draw);
   az_load_saved_games(&planet, &saved_games);
   az_init_gui(preferences.fullscreen_on_startup, true);
   az_set_global_music_volume(preferences.music_volume);
@@ -95,8 +132,8 @@ int main(int argc, char **argv) {
         }
         break;
       case AZ_CONTROLLER_SPACE:
-        switch (az_space_event_loop(&planet, &saved_games, &preferences,
-                                    saved_game_slot_index)) {
+        switch (az_space_event_loop(&space_session, &planet, &saved_games,
+                                    &preferences, saved_game_slot_index)) {
           case AZ_SA_EXIT_TO_TITLE:
             controller = AZ_CONTROLLER_TITLE;
             title_intro = AZ_TI_SKIP_INTRO;
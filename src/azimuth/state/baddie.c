@@ -22,7 +22,7 @@
 #include <assert.h>
 #include <math.h>
 #include <stdbool.h>
-#include <stddef.h> // for NULL
+#include <stddef.h> // for NULL and offsetof
 
 #include "azimuth/state/pickup.h" // for AZ_PUPF_* macros
 #include "azimuth/util/misc.h"
@@ -2093,6 +2093,130 @@ const az_baddie_data_t *az_get_baddie_data(az_baddie_kind_t kind) {
   return &baddie_datas[data_index];
 }
 
+const char *az_baddie_kind_name(az_baddie_kind_t kind) {
+  switch (kind) {
+    case AZ_BAD_NOTHING: break;
+    case AZ_BAD_MARKER: return "marker";
+    case AZ_BAD_NORMAL_TURRET: return "normal_turret";
+    case AZ_BAD_ZIPPER: return "zipper";
+    case AZ_BAD_BOUNCER: return "bouncer";
+    case AZ_BAD_ATOM: return "atom";
+    case AZ_BAD_SPINER: return "spiner";
+    case AZ_BAD_BOX: return "box";
+    case AZ_BAD_ARMORED_BOX: return "armored_box";
+    case AZ_BAD_CLAM: return "clam";
+    case AZ_BAD_NIGHTBUG: return "nightbug";
+    case AZ_BAD_SPINE_MINE: return "spine_mine";
+    case AZ_BAD_BROKEN_TURRET: return "broken_turret";
+    case AZ_BAD_ZENITH_CORE: return "zenith_core";
+    case AZ_BAD_ARMORED_TURRET: return "armored_turret";
+    case AZ_BAD_DRAGONFLY: return "dragonfly";
+    case AZ_BAD_CAVE_CRAWLER: return "cave_crawler";
+    case AZ_BAD_CRAWLING_TURRET: return "crawling_turret";
+    case AZ_BAD_HORNET: return "hornet";
+    case AZ_BAD_BEAM_SENSOR: return "beam_sensor";
+    case AZ_BAD_ROCKWYRM: return "rockwyrm";
+    case AZ_BAD_WYRM_EGG: return "wyrm_egg";
+    case AZ_BAD_WYRMLING: return "wyrmling";
+    case AZ_BAD_TRAPDOOR: return "trapdoor";
+    case AZ_BAD_CAVE_SWOOPER: return "cave_swooper";
+    case AZ_BAD_ICE_CRAWLER: return "ice_crawler";
+    case AZ_BAD_BEAM_TURRET: return "beam_turret";
+    case AZ_BAD_OTH_CRAB_1: return "oth_crab_1";
+    case AZ_BAD_OTH_ORB_1: return "oth_orb_1";
+    case AZ_BAD_OTH_SNAPDRAGON: return "oth_snapdragon";
+    case AZ_BAD_OTH_RAZOR_1: return "oth_razor_1";
+    case AZ_BAD_GUN_SENSOR: return "gun_sensor";
+    case AZ_BAD_SECURITY_DRONE: return "security_drone";
+    case AZ_BAD_SMALL_TRUCK: return "small_truck";
+    case AZ_BAD_HEAT_RAY: return "heat_ray";
+    case AZ_BAD_NUCLEAR_MINE: return "nuclear_mine";
+    case AZ_BAD_BEAM_WALL: return "beam_wall";
+    case AZ_BAD_SPARK: return "spark";
+    case AZ_BAD_MOSQUITO: return "mosquito";
+    case AZ_BAD_ARMORED_ZIPPER: return "armored_zipper";
+    case AZ_BAD_FORCEFIEND: return "forcefiend";
+    case AZ_BAD_CHOMPER_PLANT: return "chomper_plant";
+    case AZ_BAD_COPTER_HORZ: return "copter_horz";
+    case AZ_BAD_URCHIN: return "urchin";
+    case AZ_BAD_BOSS_DOOR: return "boss_door";
+    case AZ_BAD_ROCKET_TURRET: return "rocket_turret";
+    case AZ_BAD_MINI_ARMORED_ZIPPER: return "mini_armored_zipper";
+    case AZ_BAD_OTH_CRAB_2: return "oth_crab_2";
+    case AZ_BAD_SPINED_CRAWLER: return "spined_crawler";
+    case AZ_BAD_DEATH_RAY: return "death_ray";
+    case AZ_BAD_OTH_GUNSHIP: return "oth_gunship";
+    case AZ_BAD_FIREBALL_MINE: return "fireball_mine";
+    case AZ_BAD_LEAPER: return "leaper";
+    case AZ_BAD_BOUNCER_90: return "bouncer_90";
+    case AZ_BAD_PISTON: return "piston";
+    case AZ_BAD_ARMORED_PISTON: return "armored_piston";
+    case AZ_BAD_ARMORED_PISTON_EXT: return "armored_piston_ext";
+    case AZ_BAD_INCORPOREAL_PISTON: return "incorporeal_piston";
+    case AZ_BAD_INCORPOREAL_PISTON_EXT: return "incorporeal_piston_ext";
+    case AZ_BAD_COPTER_VERT: return "copter_vert";
+    case AZ_BAD_CRAWLING_MORTAR: return "crawling_mortar";
+    case AZ_BAD_OTH_ORB_2: return "oth_orb_2";
+    case AZ_BAD_FIRE_ZIPPER: return "fire_zipper";
+    case AZ_BAD_SUPER_SPINER: return "super_spiner";
+    case AZ_BAD_HEAVY_TURRET: return "heavy_turret";
+    case AZ_BAD_ECHO_SWOOPER: return "echo_swooper";
+    case AZ_BAD_SUPER_HORNET: return "super_hornet";
+    case AZ_BAD_KILOFUGE: return "kilofuge";
+    case AZ_BAD_ICE_CRYSTAL: return "ice_crystal";
+    case AZ_BAD_SWITCHER: return "switcher";
+    case AZ_BAD_FAST_BOUNCER: return "fast_bouncer";
+    case AZ_BAD_PROXY_MINE: return "proxy_mine";
+    case AZ_BAD_NIGHTSHADE: return "nightshade";
+    case AZ_BAD_AQUATIC_CHOMPER: return "aquatic_chomper";
+    case AZ_BAD_SMALL_FISH: return "small_fish";
+    case AZ_BAD_NOCTURNE: return "nocturne";
+    case AZ_BAD_MYCOFLAKKER: return "mycoflakker";
+    case AZ_BAD_MYCOSTALKER: return "mycostalker";
+    case AZ_BAD_OTH_CRAWLER: return "oth_crawler";
+    case AZ_BAD_FIRE_CRAWLER: return "fire_crawler";
+    case AZ_BAD_JUNGLE_CRAWLER: return "jungle_crawler";
+    case AZ_BAD_FORCE_EGG: return "force_egg";
+    case AZ_BAD_FORCELING: return "forceling";
+    case AZ_BAD_JUNGLE_CHOMPER: return "jungle_chomper";
+    case AZ_BAD_SMALL_AUV: return "small_auv";
+    case AZ_BAD_SENSOR_LASER: return "sensor_laser";
+    case AZ_BAD_BEAM_SENSOR_INV: return "beam_sensor_inv";
+    case AZ_BAD_ERUPTION: return "eruption";
+    case AZ_BAD_PYROFLAKKER: return "pyroflakker";
+    case AZ_BAD_PYROSTALKER: return "pyrostalker";
+    case AZ_BAD_DEMON_SWOOPER: return "demon_swooper";
+    case AZ_BAD_FIRE_CHOMPER: return "fire_chomper";
+    case AZ_BAD_GRABBER_PLANT: return "grabber_plant";
+    case AZ_BAD_POP_OPEN_TURRET: return "pop_open_turret";
+    case AZ_BAD_GNAT: return "gnat";
+    case AZ_BAD_CREEPY_EYE: return "creepy_eye";
+    case AZ_BAD_BOMB_SENSOR: return "bomb_sensor";
+    case AZ_BAD_ROCKET_SENSOR: return "rocket_sensor";
+    case AZ_BAD_SPIKED_VINE: return "spiked_vine";
+    case AZ_BAD_MAGBEEST_HEAD: return "magbeest_head";
+    case AZ_BAD_MAGBEEST_LEGS_L: return "magbeest_legs_l";
+    case AZ_BAD_MAGBEEST_LEGS_R: return "magbeest_legs_r";
+    case AZ_BAD_MAGMA_BOMB: return "magma_bomb";
+    case AZ_BAD_OTH_BRAWLER: return "oth_brawler";
+    case AZ_BAD_LARGE_FISH: return "large_fish";
+    case AZ_BAD_CRAB_CRAWLER: return "crab_crawler";
+    case AZ_BAD_SCRAP_METAL: return "scrap_metal";
+    case AZ_BAD_RED_ATOM: return "red_atom";
+    case AZ_BAD_REFLECTION: return "reflection";
+    case AZ_BAD_OTH_MINICRAB: return "oth_minicrab";
+    case AZ_BAD_OTH_RAZOR_2: return "oth_razor_2";
+    case AZ_BAD_OTH_SUPERGUNSHIP: return "oth_supergunship";
+    case AZ_BAD_OTH_DECOY: return "oth_decoy";
+    case AZ_BAD_CENTRAL_NETWORK_NODE: return "central_network_node";
+    case AZ_BAD_OTH_TENTACLE: return "oth_tentacle";
+  }
+  AZ_ASSERT_UNREACHABLE();
+}
+
+// The hot fields of az_baddie_t (see baddie.h) should fit in one cache line.
+AZ_STATIC_ASSERT(offsetof(az_baddie_t, velocity) <= 64);
+
 void az_init_baddie(az_baddie_t *baddie, az_baddie_kind_t kind,
                     az_vector_t position, double angle) {
   assert(kind != AZ_BAD_NOTHING);
@@ -2112,6 +2236,61 @@ void az_init_baddie(az_baddie_t *baddie, az_baddie_kind_t kind,
   }
 }
 
+// How much to pad baddie bounds by, so that rounding error can never make
+// them rule out a hit that the exact tests would find.
+#define BADDIE_BOUNDS_MARGIN 0.001
+
+// Find a (not necessarily smallest) circle enclosing all of the given
+// circles, by centering it on their bounding box.
+static double enclosing_circle(int num_circles, const az_vector_t *centers,
+                               const double *radii, az_vector_t *center_out) {
+  assert(num_circles > 0);
+  az_vector_t min = {INFINITY, INFINITY}, max = {-INFINITY, -INFINITY};
+  for (int i = 0; i < num_circles; ++i) {
+    min.x = fmin(min.x, centers[i].x - radii[i]);
+    min.y = fmin(min.y, centers[i].y - radii[i]);
+    max.x = fmax(max.x, centers[i].x + radii[i]);
+    max.y = fmax(max.y, centers[i].y + radii[i]);
+  }
+  const az_vector_t center = az_vmul(az_vadd(min, max), 0.5);
+  double radius = 0.0;
+  for (int i = 0; i < num_circles; ++i) {
+    radius = fmax(radius, az_vdist(center, centers[i]) + radii[i]);
+  }
+  *center_out = center;
+  return radius + BADDIE_BOUNDS_MARGIN;
+}
+
+void az_get_baddie_bounds(const az_baddie_t *baddie,
+                          az_baddie_bounds_t *bounds_out) {
+  assert(baddie->kind != AZ_BAD_NOTHING);
+  const az_baddie_data_t *data = baddie->data;
+  const int num_components = data->num_components;
+  assert(num_components <= AZ_ARRAY_SIZE(baddie->components));
+  // The last entry is for the main body.
+  az_vector_t centers[AZ_MAX_BADDIE_COMPONENTS + 1];
+  double radii[AZ_MAX_BADDIE_COMPONENTS + 1];
+  for (int i = 0; i < num_components; ++i) {
+    centers[i] = baddie->components[i].position;
+    radii[i] = data->components[i].bounding_radius;
+  }
+  centers[num_components] = AZ_VZERO;
+  radii[num_components] = data->main_body.bounding_radius;
+  if (num_components > 0) {
+    bounds_out->components_radius =
+      enclosing_circle(num_components, centers, radii,
+                       &bounds_out->components_center);
+  } else {
+    bounds_out->components_center = AZ_VZERO;
+    bounds_out->components_radius = 0.0;
+  }
+  az_vector_t center;
+  bounds_out->radius =
+    enclosing_circle(num_components + 1, centers, radii, &center);
+  bounds_out->center =
+    az_vadd(baddie->position, az_vrotate(center, baddie->angle));
+}
+
 /*===========================================================================*/
 
 bool az_baddie_has_flag(const az_baddie_t *baddie, az_baddie_flags_t flag) {
@@ -2197,7 +2376,7 @@ bool az_circle_touches_baddie(
   // Semi-common case: cast a ray towards the baddie center, returning the
   // first component hit.
   if (az_ray_hits_baddie(
-          baddie, center,
+          baddie, NULL, center,
           az_vwithlen(az_vsub(baddie->position, center), radius),
           NULL, NULL, component_out)) return true;
 
@@ -2245,13 +2424,17 @@ static bool ray_hits_component(
 }
 
 bool az_ray_hits_baddie(
-    const az_baddie_t *baddie, az_vector_t start, az_vector_t delta,
+    const az_baddie_t *baddie, const az_baddie_bounds_t *bounds,
+    az_vector_t start, az_vector_t delta,
     az_vector_t *point_out, az_vector_t *normal_out,
     const az_component_data_t **component_out) {
   assert(baddie->kind != AZ_BAD_NOTHING);
   const az_baddie_data_t *data = baddie->data;
 
   // Common case: if ray definitely misses baddie, return early.
+  if (bounds != NULL &&
+      !az_ray_hits_bounding_circle(start, delta, bounds->center,
+                                   bounds->radius)) return false;
   if (!az_ray_hits_bounding_circle(start, delta, baddie->position,
                                    data->overall_bounding_radius)) {
     return false;
@@ -2263,21 +2446,35 @@ bool az_ray_hits_baddie(
   az_vector_t rel_delta = az_vrotate(delta, -baddie->angle);
   const az_component_data_t *hit_component = NULL;
   az_vector_t point = AZ_VZERO;
+  // If the caller only wants to know whether there's a hit, the first one
+  // that we find will do.
+  const bool any_hit =
+    (point_out == NULL && normal_out == NULL && component_out == NULL);
 
   // Check if we hit the main body of the baddie.
   if (ray_hits_component(&data->main_body, AZ_VZERO, 0.0, rel_start,
                          rel_delta, &point, normal_out)) {
+    if (any_hit) return true;
     hit_component = &data->main_body;
     rel_delta = az_vsub(point, rel_start);
   }
 
-  // Now check if we hit any of the baddie's components.
-  for (int i = 0; i < data->num_components; ++i) {
+  // Now check if we hit any of the baddie's components (unless we can tell
+  // that we'll miss all of them at once).
+  int num_components = data->num_components;
+  if (bounds != NULL && num_components > 0 &&
+      !az_ray_hits_bounding_circle(rel_start, rel_delta,
+                                   bounds->components_center,
+                                   bounds->components_radius)) {
+    num_components = 0;
+  }
+  for (int i = 0; i < num_components; ++i) {
     assert(i < AZ_ARRAY_SIZE(baddie->components));
     const az_component_data_t *component = &data->components[i];
     if (ray_hits_component(component, baddie->components[i].position,
                            baddie->components[i].angle, rel_start, rel_delta,
                            &point, normal_out)) {
+      if (any_hit) return true;
       hit_component = component;
       rel_delta = az_vsub(point, rel_start);
     }
@@ -2316,13 +2513,17 @@ static bool circle_hits_component(
 }
 
 bool az_circle_hits_baddie(
-    const az_baddie_t *baddie, double radius, az_vector_t start,
+    const az_baddie_t *baddie, const az_baddie_bounds_t *bounds,
+    double radius, az_vector_t start,
     az_vector_t delta, az_vector_t *pos_out, az_vector_t *normal_out,
     const az_component_data_t **component_out) {
   assert(baddie->kind != AZ_BAD_NOTHING);
   const az_baddie_data_t *data = baddie->data;
 
   // Common case: if circle definitely misses baddie, return early.
+  if (bounds != NULL &&
+      !az_ray_hits_bounding_circle(start, delta, bounds->center,
+                                   bounds->radius + radius)) return false;
   if (!az_ray_hits_bounding_circle(start, delta, baddie->position,
                                    data->overall_bounding_radius + radius)) {
     return false;
@@ -2334,21 +2535,33 @@ bool az_circle_hits_baddie(
   az_vector_t rel_delta = az_vrotate(delta, -baddie->angle);
   const az_component_data_t *hit_component = NULL;
   az_vector_t pos = AZ_VZERO;
+  const bool any_hit =
+    (pos_out == NULL && normal_out == NULL && component_out == NULL);
 
   // Check if we hit the main body of the baddie.
   if (circle_hits_component(&data->main_body, AZ_VZERO, 0.0, radius, rel_start,
                             rel_delta, &pos, normal_out)) {
+    if (any_hit) return true;
     hit_component = &data->main_body;
     rel_delta = az_vsub(pos, rel_start);
   }
 
-  // Now check if we hit any of the baddie's components.
-  for (int i = 0; i < data->num_components; ++i) {
+  // Now check if we hit any of the baddie's components (unless we can tell
+  // that we'll miss all of them at once).
+  int num_components = data->num_components;
+  if (bounds != NULL && num_components > 0 &&
+      !az_ray_hits_bounding_circle(rel_start, rel_delta,
+                                   bounds->components_center,
+                                   bounds->components_radius + radius)) {
+    num_components = 0;
+  }
+  for (int i = 0; i < num_components; ++i) {
     assert(i < AZ_ARRAY_SIZE(baddie->components));
     const az_component_data_t *component = &data->components[i];
     if (circle_hits_component(component, baddie->components[i].position,
                               baddie->components[i].angle, radius, rel_start,
                               rel_delta, &pos, normal_out)) {
+      if (any_hit) return true;
       hit_component = component;
       rel_delta = az_vsub(pos, rel_start);
     }
@@ -2391,7 +2604,8 @@ static bool arc_circle_hits_component(
 }
 
 bool az_arc_circle_hits_baddie(
-    const az_baddie_t *baddie, double circle_radius,
+    const az_baddie_t *baddie, const az_baddie_bounds_t *bounds,
+    double circle_radius,
     az_vector_t start, az_vector_t spin_center, double spin_angle,
     double *angle_out, az_vector_t *pos_out, az_vector_t *normal_out,
     const az_component_data_t **component_out) {
@@ -2399,6 +2613,10 @@ bool az_arc_circle_hits_baddie(
   const az_baddie_data_t *data = baddie->data;
 
   // Common case: if circle definitely misses baddie, return early.
+  if (bounds != NULL &&
+      !az_arc_ray_might_hit_bounding_circle(
+          start, spin_center, spin_angle, bounds->center,
+          bounds->radius + circle_radius)) return false;
   if (!az_arc_ray_might_hit_bounding_circle(
           start, spin_center, spin_angle, baddie->position,
           data->overall_bounding_radius + circle_radius)) {
@@ -2419,8 +2637,16 @@ bool az_arc_circle_hits_baddie(
     hit_component = &data->main_body;
   }
 
-  // Now check if we hit any of the baddie's components.
-  for (int i = 0; i < data->num_components; ++i) {
+  // Now check if we hit any of the baddie's components (unless we can tell
+  // that we'll miss all of them at once).
+  int num_components = data->num_components;
+  if (bounds != NULL && num_components > 0 &&
+      !az_arc_ray_might_hit_bounding_circle(
+          rel_start, rel_spin_center, spin_angle, bounds->components_center,
+          bounds->components_radius + circle_radius)) {
+    num_components = 0;
+  }
+  for (int i = 0; i < num_components; ++i) {
     assert(i < AZ_ARRAY_SIZE(baddie->components));
     const az_component_data_t *component = &data->components[i];
     if (arc_circle_hits_component(
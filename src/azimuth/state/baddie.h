@@ -227,26 +227,48 @@ typedef struct {
   double angle;
 } az_component_t;
 
+// The fields of a baddie are ordered so that the ones that loops over all the
+// baddies (such as the impact functions in space.h) check first come first,
+// and fit within 64 bytes; that way, skipping a baddie that's absent or not
+// of interest usually touches only one or two cache lines, rather than all of
+// the (much bulkier) components and cargo.
 typedef struct {
+  // Hot fields:
   az_baddie_kind_t kind; // if AZ_BAD_NOTHING, this baddie is not present
   const az_baddie_data_t *data;
   az_uid_t uid;
-  const az_script_t *on_kill; // not owned; NULL if no script
+  az_baddie_flags_t temp_properties;
   az_vector_t position;
-  az_vector_t velocity;
   double angle;
   double health;
+  // Cold fields:
+  az_vector_t velocity;
   double armor_flare; // from 0.0 (nothing) to 1.0 (was just now hit)
   double frozen; // from 0.0 (unfrozen) to 1.0 (was just now frozen)
   double cooldown; // time until baddie can attack again, in seconds
   double param; // the meaning of this is baddie-kind-specific
   double param2; // the meaning of this is baddie-kind-specific
   int state; // the meaning of this is baddie-kind-specific
-  az_baddie_flags_t temp_properties;
+  const az_script_t *on_kill; // not owned; NULL if no script
   az_component_t components[AZ_MAX_BADDIE_COMPONENTS];
   az_uuid_t cargo_uuids[AZ_MAX_BADDIE_CARGO_UUIDS];
 } az_baddie_t;
 
+// Bounding circles for a baddie in a particular pose (that is, with its
+// components in particular positions), which are usually much tighter than
+// the overall_bounding_radius of the baddie's data, since that has to cover
+// every pose that the baddie can take.
+typedef struct {
+  // A circle around the main body and all components, in absolute
+  // coordinates:
+  az_vector_t center;
+  double radius;
+  // A circle around just the components (not the main body), relative to the
+  // baddie's position and angle (unused if there are no components):
+  az_vector_t components_center;
+  double components_radius;
+} az_baddie_bounds_t;
+
 /*===========================================================================*/
 
 // Call this at program startup to initialize all baddie data.  In particular,
@@ -258,11 +280,20 @@ void az_init_baddie_datas(void);
 // must not be AZ_BAD_NOTHING.
 const az_baddie_data_t *az_get_baddie_data(az_baddie_kind_t kind);
 
+// Get a short, lowercase name for a baddie kind (with no spaces), for
+// debugging output.  The kind must not be AZ_BAD_NOTHING.
+const char *az_baddie_kind_name(az_baddie_kind_t kind);
+
 // Set reasonable initial field values for a baddie of the given kind, at the
 // given position.  All fields except baddie->uid will be reset.
 void az_init_baddie(az_baddie_t *baddie, az_baddie_kind_t kind,
                     az_vector_t position, double angle);
 
+// Compute bounding circles for the baddie in its current pose.  These remain
+// valid only until the baddie or any of its components moves.
+void az_get_baddie_bounds(const az_baddie_t *baddie,
+                          az_baddie_bounds_t *bounds_out);
+
 /*===========================================================================*/
 
 // True if the baddie has the given flag set (either temporarily for this
@@ -284,11 +315,17 @@ bool az_circle_touches_baddie(
     const az_baddie_t *baddie, double radius, az_vector_t center,
     const az_component_data_t **component_out);
 
+// The following functions each take an optional bounds argument, which, if
+// non-NULL, must be the baddie's bounds for its current pose (see
+// az_get_baddie_bounds); the functions use this to rule out misses more
+// quickly, but the results are the same either way.
+
 // Determine if a ray, travelling delta from start, will hit the baddie.  If it
 // does, stores the intersection point in *point_out (if point_out is non-NULL)
 // and the normal vector in *normal_out (if normal_out is non-NULL).
 bool az_ray_hits_baddie(
-    const az_baddie_t *baddie, az_vector_t start, az_vector_t delta,
+    const az_baddie_t *baddie, const az_baddie_bounds_t *bounds,
+    az_vector_t start, az_vector_t delta,
     az_vector_t *point_out, az_vector_t *normal_out,
     const az_component_data_t **component_out);
 
@@ -298,7 +335,8 @@ bool az_ray_hits_baddie(
 // is non-NULL) and the normal vector in *normal_out (if normal_out is
 // non-NULL).
 bool az_circle_hits_baddie(
-    const az_baddie_t *baddie, double radius, az_vector_t start,
+    const az_baddie_t *baddie, const az_baddie_bounds_t *bounds,
+    double radius, az_vector_t start,
     az_vector_t delta, az_vector_t *pos_out, az_vector_t *normal_out,
     const az_component_data_t **component_out);
 
@@ -310,7 +348,8 @@ bool az_circle_hits_baddie(
 // non-NULL), and a vector normal to the baddie at the impact point in
 // *normal_out (if normal_out is non-NULL).
 bool az_arc_circle_hits_baddie(
-    const az_baddie_t *baddie, double circle_radius,
+    const az_baddie_t *baddie, const az_baddie_bounds_t *bounds,
+    double circle_radius,
     az_vector_t start, az_vector_t spin_center, double spin_angle,
     double *angle_out, az_vector_t *pos_out, az_vector_t *normal_out,
     const az_component_data_t **component_out);
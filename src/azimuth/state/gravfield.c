@@ -127,6 +127,123 @@ bool az_point_within_gravfield(const az_gravfield_t *gravfield,
   }
 }
 
+// Return the direction (relative to the arc center) that comes first, going
+// counterclockwise, of the two ends of a line segment that doesn't pass
+// through the arc center, along with how far the segment's direction turns.
+static double first_direction(az_vector_t rel1, az_vector_t rel2,
+                              double *turn_out) {
+  const double theta1 = az_vtheta(rel1), theta2 = az_vtheta(rel2);
+  const double turn = az_mod2pi(theta2 - theta1);
+  *turn_out = fabs(turn);
+  return (turn >= 0.0 ? theta1 : theta2);
+}
+
+// Set the bounds to those of the annular sector around center whose radii
+// run from inner_radius to outer_radius, and whose angles run
+// counterclockwise from min_theta by theta_span.
+static void annular_sector_bounds(
+    az_vector_t center, double inner_radius, double outer_radius,
+    double min_theta, double theta_span, az_vector_t *min_out,
+    az_vector_t *max_out) {
+  // An annular sector is exactly the region swept out by a circle as thick as
+  // the annulus, travelling along the sector's middle arc.
+  const double mid_radius = 0.5 * (inner_radius + outer_radius);
+  az_arc_sweep_t sweep;
+  az_init_arc_sweep(0.5 * (outer_radius - inner_radius),
+                    az_vadd(center, az_vpolar(mid_radius, min_theta)),
+                    center, theta_span, &sweep);
+  *min_out = sweep.min;
+  *max_out = sweep.max;
+}
+
+// How much to pad gravfield bounds by, so that rounding error can never put a
+// point that az_point_within_gravfield accepts outside of them.
+#define GRAVFIELD_BOUNDS_MARGIN 0.01
+
+void az_gravfield_bounds(const az_gravfield_t *gravfield,
+                         az_vector_t *min_out, az_vector_t *max_out) {
+  assert(gravfield->kind != AZ_GRAV_NOTHING);
+  const az_gravfield_size_t *size = &gravfield->size;
+  az_vector_t min, max;
+  if (az_is_trapezoidal(gravfield->kind)) {
+    const double semilength = size->trapezoid.semilength;
+    const double front_offset = size->trapezoid.front_offset;
+    const double front_semiwidth = size->trapezoid.front_semiwidth;
+    const double rear_semiwidth = size->trapezoid.rear_semiwidth;
+    if (az_is_liquid(gravfield->kind)) {
+      // A liquid is the part of an annulus (centered on the arc center of its
+      // surface) lying between the two sides of the trapezoid; these are the
+      // same corners that az_point_within_gravfield uses.
+      const double position_norm = az_vnorm(gravfield->position);
+      const double outer_radius =
+        hypot(fmax(front_offset + front_semiwidth,
+                   front_offset - front_semiwidth),
+              position_norm + semilength);
+      const double inner_radius =
+        hypot(rear_semiwidth, position_norm - semilength);
+      const az_vector_t inner_start =
+        az_vwithlen((az_vector_t){position_norm - semilength, -rear_semiwidth},
+                    inner_radius);
+      const az_vector_t outer_start =
+        az_vwithlen((az_vector_t){position_norm + semilength,
+                                  front_offset - front_semiwidth},
+                    outer_radius);
+      const az_vector_t inner_end =
+        az_vwithlen((az_vector_t){position_norm - semilength, rear_semiwidth},
+                    inner_radius);
+      const az_vector_t outer_end =
+        az_vwithlen((az_vector_t){position_norm + semilength,
+                                  front_offset + front_semiwidth},
+                    outer_radius);
+      // Each side's direction varies between those of its two ends, so the
+      // liquid lies within the directions from the first end of the start
+      // side to the last end of the end side.  If the sides' ranges might
+      // overlap, fall back to the whole annulus.
+      double start_turn, end_turn;
+      const double first_theta =
+        first_direction(inner_start, outer_start, &start_turn);
+      const double last_theta =
+        first_direction(inner_end, outer_end, &end_turn) + end_turn;
+      double theta_span = az_mod2pi_nonneg(last_theta - first_theta);
+      if (start_turn + end_turn > theta_span) theta_span = AZ_TWO_PI;
+      const az_vector_t arc_center =
+        az_vsub(gravfield->position,
+                az_vpolar(position_norm, gravfield->angle));
+      annular_sector_bounds(arc_center, fmin(inner_radius, outer_radius),
+                            fmax(inner_radius, outer_radius),
+                            first_theta + gravfield->angle, theta_span,
+                            &min, &max);
+    } else {
+      const az_vector_t vertices[4] = {
+        {semilength, front_offset - front_semiwidth},
+        {semilength, front_offset + front_semiwidth},
+        {-semilength, rear_semiwidth},
+        {-semilength, -rear_semiwidth}
+      };
+      min = (az_vector_t){INFINITY, INFINITY};
+      max = (az_vector_t){-INFINITY, -INFINITY};
+      AZ_ARRAY_LOOP(vertex, vertices) {
+        const az_vector_t corner =
+          az_vadd(gravfield->position, az_vrotate(*vertex, gravfield->angle));
+        min.x = fmin(min.x, corner.x);
+        min.y = fmin(min.y, corner.y);
+        max.x = fmax(max.x, corner.x);
+        max.y = fmax(max.y, corner.y);
+      }
+    }
+  } else {
+    const double inner_radius = size->sector.inner_radius;
+    annular_sector_bounds(gravfield->position, inner_radius,
+                          inner_radius + size->sector.thickness,
+                          gravfield->angle, az_sector_interior_angle(size),
+                          &min, &max);
+  }
+  const az_vector_t margin =
+    {GRAVFIELD_BOUNDS_MARGIN, GRAVFIELD_BOUNDS_MARGIN};
+  *min_out = az_vsub(min, margin);
+  *max_out = az_vadd(max, margin);
+}
+
 static void get_liquid_surface_arc(
     const az_gravfield_t *gravfield, double *arc_radius_out,
     az_vector_t *arc_center_out, double *min_theta_out,
@@ -84,6 +84,13 @@ double az_sector_interior_angle(const az_gravfield_size_t *size);
 bool az_point_within_gravfield(const az_gravfield_t *gravfield,
                                az_vector_t point);
 
+// Compute an axis-aligned bounding box for the given gravfield.  The box may
+// be somewhat larger than it needs to be, but it is guaranteed to contain
+// every point for which az_point_within_gravfield returns true (as well as the
+// gravfield's liquid surface, if any).
+void az_gravfield_bounds(const az_gravfield_t *gravfield,
+                         az_vector_t *min_out, az_vector_t *max_out);
+
 bool az_ray_hits_liquid_surface(
     const az_gravfield_t *gravfield, az_vector_t start, az_vector_t delta,
     az_vector_t *point_out, az_vector_t *normal_out);
@@ -0,0 +1,428 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/state/hash.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "azimuth/state/baddie.h"
+#include "azimuth/state/player.h"
+#include "azimuth/state/script.h"
+#include "azimuth/state/space.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/vector.h"
+
+/*===========================================================================*/
+
+// We use 64-bit FNV-1a, which is simple and plenty good enough for telling
+// whether two states are the same.
+#define FNV_OFFSET_BASIS UINT64_C(0xcbf29ce484222325)
+#define FNV_PRIME UINT64_C(0x100000001b3)
+
+static void hash_u64(uint64_t *hash, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    *hash = (*hash ^ (value & 0xff)) * FNV_PRIME;
+    value >>= 8;
+  }
+}
+
+static void hash_int(uint64_t *hash, int64_t value) {
+  hash_u64(hash, (uint64_t)value);
+}
+
+static void hash_bool(uint64_t *hash, bool value) {
+  hash_u64(hash, (value ? 1 : 0));
+}
+
+// Doubles are hashed by their exact bit patterns; we want to catch even the
+// smallest rounding differences, since those can snowball.
+AZ_STATIC_ASSERT(sizeof(uint64_t) == sizeof(double));
+static void hash_double(uint64_t *hash, double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  hash_u64(hash, bits);
+}
+
+static void hash_vector(uint64_t *hash, az_vector_t value) {
+  hash_double(hash, value.x);
+  hash_double(hash, value.y);
+}
+
+// Scripts are owned by the planet, so their addresses vary from run to run;
+// all we hash is whether there is one, along with the VM's own state.
+static void hash_vm(uint64_t *hash, const az_script_vm_t *vm) {
+  hash_bool(hash, vm->script != NULL);
+  hash_int(hash, vm->pc);
+  hash_int(hash, vm->stack_size);
+  for (int i = 0; i < vm->stack_size; ++i) hash_double(hash, vm->stack[i]);
+}
+
+/*===========================================================================*/
+
+static uint64_t hash_mode(const az_space_state_t *state) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  hash_int(&hash, state->mode);
+  hash_u64(&hash, state->clock);
+  hash_u64(&hash, state->rng.z);
+  hash_u64(&hash, state->rng.w);
+  const az_camera_t *camera = &state->camera;
+  hash_vector(&hash, camera->center);
+  hash_double(&hash, camera->shake_horz);
+  hash_double(&hash, camera->shake_vert);
+  hash_double(&hash, camera->quake_vert);
+  hash_double(&hash, camera->wobble_intensity);
+  hash_double(&hash, camera->wobble_goal);
+  hash_double(&hash, camera->wobble_theta);
+  hash_double(&hash, camera->r_max_override);
+  hash_double(&hash, state->message.time_remaining);
+  hash_bool(&hash, state->countdown.is_active);
+  hash_double(&hash, state->countdown.active_for);
+  hash_double(&hash, state->countdown.time_remaining);
+  hash_vm(&hash, &state->countdown.vm);
+  // Mode-specific data:
+  hash_int(&hash, state->boss_death_mode.step);
+  hash_double(&hash, state->boss_death_mode.progress);
+  hash_int(&hash, state->console_mode.step);
+  hash_double(&hash, state->console_mode.progress);
+  hash_u64(&hash, state->console_mode.node_uid);
+  hash_int(&hash, state->cutscene.scene);
+  hash_int(&hash, state->cutscene.next);
+  hash_double(&hash, state->cutscene.time);
+  hash_int(&hash, state->cutscene.step);
+  hash_int(&hash, state->dialogue.step);
+  hash_double(&hash, state->dialogue.progress);
+  hash_int(&hash, state->dialogue.chars_to_print);
+  hash_int(&hash, state->doorway_mode.step);
+  hash_double(&hash, state->doorway_mode.progress);
+  hash_int(&hash, state->doorway_mode.destination);
+  hash_int(&hash, state->game_over_mode.step);
+  hash_double(&hash, state->game_over_mode.progress);
+  hash_int(&hash, state->global_fade.step);
+  hash_double(&hash, state->global_fade.fade_alpha);
+  hash_int(&hash, state->monologue.step);
+  hash_double(&hash, state->monologue.progress);
+  hash_int(&hash, state->monologue.chars_to_print);
+  hash_int(&hash, state->pausing_mode.step);
+  hash_double(&hash, state->pausing_mode.fade_alpha);
+  hash_bool(&hash, state->sync_timer.is_active);
+  hash_double(&hash, state->sync_timer.time_remaining);
+  hash_int(&hash, state->upgrade_mode.step);
+  hash_double(&hash, state->upgrade_mode.progress);
+  hash_int(&hash, state->upgrade_mode.upgrade);
+  hash_vm(&hash, &state->sync_vm);
+  hash_double(&hash, state->console_help_message_cooldown);
+  hash_double(&hash, state->skip.cooldown);
+  hash_bool(&hash, state->skip.allowed);
+  hash_bool(&hash, state->skip.active);
+  hash_bool(&hash, state->intro);
+  hash_bool(&hash, state->victory);
+  hash_bool(&hash, state->nuke.active);
+  hash_double(&hash, state->nuke.rho);
+  hash_double(&hash, state->darkness);
+  hash_double(&hash, state->dark_goal);
+  hash_u64(&hash, state->boss_uid);
+  AZ_ARRAY_LOOP(uuid, state->uuids) {
+    hash_int(&hash, uuid->type);
+    hash_u64(&hash, uuid->uid);
+  }
+  return hash;
+}
+
+static uint64_t hash_ship(const az_ship_t *ship) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  const az_controls_t *controls = &ship->controls;
+  hash_bool(&hash, controls->up_held);
+  hash_bool(&hash, controls->up_pressed);
+  hash_bool(&hash, controls->down_held);
+  hash_bool(&hash, controls->down_pressed);
+  hash_bool(&hash, controls->left_held);
+  hash_bool(&hash, controls->right_held);
+  hash_bool(&hash, controls->fire_held);
+  hash_bool(&hash, controls->fire_pressed);
+  hash_bool(&hash, controls->ordn_held);
+  hash_bool(&hash, controls->util_held);
+  hash_bool(&hash, controls->util_pressed);
+  hash_vector(&hash, ship->position);
+  hash_vector(&hash, ship->velocity);
+  hash_double(&hash, ship->angle);
+  hash_double(&hash, ship->recharge_cooldown);
+  hash_double(&hash, ship->gun_charge);
+  hash_double(&hash, ship->ordn_charge);
+  hash_double(&hash, ship->ordn_cooldown);
+  hash_bool(&hash, ship->ordn_held);
+  hash_double(&hash, ship->shield_flare);
+  hash_double(&hash, ship->reactive_flare);
+  hash_double(&hash, ship->temp_invincibility);
+  hash_int(&hash, ship->thrusters);
+  hash_int(&hash, ship->cplus.state);
+  hash_double(&hash, ship->cplus.charge);
+  hash_double(&hash, ship->cplus.tap_time);
+  hash_double(&hash, ship->orion.tap_time);
+  hash_double(&hash, ship->radar.active_time);
+  hash_double(&hash, ship->radar.angle);
+  hash_bool(&hash, ship->radar.locked_on);
+  hash_bool(&hash, ship->tractor_beam.active);
+  hash_u64(&hash, ship->tractor_beam.node_uid);
+  hash_double(&hash, ship->tractor_beam.distance);
+  hash_bool(&hash, ship->tractor_cloak.active);
+  hash_double(&hash, ship->tractor_cloak.charge);
+  hash_bool(&hash, ship->autopilot.enabled);
+  hash_int(&hash, ship->autopilot.thrust);
+  hash_bool(&hash, ship->autopilot.cplus);
+  hash_double(&hash, ship->autopilot.goal_angle);
+  return hash;
+}
+
+static uint64_t hash_player(const az_player_t *player) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  AZ_ARRAY_LOOP(word, player->upgrades.array) hash_u64(&hash, *word);
+  AZ_ARRAY_LOOP(word, player->rooms_visited) hash_u64(&hash, *word);
+  AZ_ARRAY_LOOP(word, player->zones_mapped) hash_u64(&hash, *word);
+  AZ_ARRAY_LOOP(word, player->flags) hash_u64(&hash, *word);
+  hash_double(&hash, player->total_time);
+  hash_int(&hash, player->current_room);
+  hash_double(&hash, player->shields);
+  hash_double(&hash, player->max_shields);
+  hash_double(&hash, player->energy);
+  hash_double(&hash, player->max_energy);
+  hash_int(&hash, player->rockets);
+  hash_int(&hash, player->max_rockets);
+  hash_int(&hash, player->bombs);
+  hash_int(&hash, player->max_bombs);
+  hash_int(&hash, player->gun1);
+  hash_int(&hash, player->gun2);
+  hash_bool(&hash, player->next_gun);
+  hash_int(&hash, player->ordnance);
+  return hash;
+}
+
+// Objects are hashed along with their index, so that (say) moving an object
+// from one slot to another counts as a difference.  Empty slots are skipped.
+static uint64_t hash_baddies(const az_space_state_t *state) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  AZ_ARRAY_LOOP(baddie, state->baddies) {
+    if (baddie->kind == AZ_BAD_NOTHING) continue;
+    hash_int(&hash, baddie - state->baddies);
+    hash_int(&hash, baddie->kind);
+    hash_u64(&hash, baddie->uid);
+    hash_bool(&hash, baddie->on_kill != NULL);
+    hash_vector(&hash, baddie->position);
+    hash_vector(&hash, baddie->velocity);
+    hash_double(&hash, baddie->angle);
+    hash_double(&hash, baddie->health);
+    hash_double(&hash, baddie->armor_flare);
+    hash_double(&hash, baddie->frozen);
+    hash_double(&hash, baddie->cooldown);
+    hash_double(&hash, baddie->param);
+    hash_double(&hash, baddie->param2);
+    hash_int(&hash, baddie->state);
+    hash_u64(&hash, baddie->temp_properties);
+    AZ_ARRAY_LOOP(component, baddie->components) {
+      hash_vector(&hash, component->position);
+      hash_double(&hash, component->angle);
+    }
+    AZ_ARRAY_LOOP(uuid, baddie->cargo_uuids) {
+      hash_int(&hash, uuid->type);
+      hash_u64(&hash, uuid->uid);
+    }
+  }
+  return hash;
+}
+
+static uint64_t hash_projectiles(const az_space_state_t *state) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  AZ_ARRAY_LOOP(proj, state->projectiles) {
+    if (proj->kind == AZ_PROJ_NOTHING) continue;
+    hash_int(&hash, proj - state->projectiles);
+    hash_int(&hash, proj->kind);
+    hash_vector(&hash, proj->position);
+    hash_vector(&hash, proj->velocity);
+    hash_double(&hash, proj->angle);
+    hash_double(&hash, proj->power);
+    hash_double(&hash, proj->age);
+    hash_int(&hash, proj->param);
+    hash_u64(&hash, proj->fired_by);
+    hash_u64(&hash, proj->last_hit_uid);
+  }
+  return hash;
+}
+
+static uint64_t hash_pickups(const az_space_state_t *state) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  AZ_ARRAY_LOOP(pickup, state->pickups) {
+    if (pickup->kind == AZ_PUP_NOTHING) continue;
+    hash_int(&hash, pickup - state->pickups);
+    hash_int(&hash, pickup->kind);
+    hash_vector(&hash, pickup->position);
+    hash_double(&hash, pickup->time_remaining);
+  }
+  return hash;
+}
+
+static uint64_t hash_walls(const az_space_state_t *state) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  AZ_ARRAY_LOOP(wall, state->walls) {
+    if (wall->kind == AZ_WALL_NOTHING) continue;
+    hash_int(&hash, wall - state->walls);
+    hash_int(&hash, wall->kind);
+    hash_u64(&hash, wall->uid);
+    hash_vector(&hash, wall->position);
+    hash_double(&hash, wall->angle);
+    hash_double(&hash, wall->flare);
+  }
+  return hash;
+}
+
+static uint64_t hash_doors(const az_space_state_t *state) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  AZ_ARRAY_LOOP(door, state->doors) {
+    if (door->kind == AZ_DOOR_NOTHING) continue;
+    hash_int(&hash, door - state->doors);
+    hash_int(&hash, door->kind);
+    hash_int(&hash, door->marker);
+    hash_u64(&hash, door->uid);
+    hash_vector(&hash, door->position);
+    hash_double(&hash, door->angle);
+    hash_int(&hash, door->destination);
+    hash_bool(&hash, door->is_open);
+    hash_double(&hash, door->openness);
+    hash_double(&hash, door->lockedness);
+  }
+  return hash;
+}
+
+static uint64_t hash_nodes(const az_space_state_t *state) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  AZ_ARRAY_LOOP(node, state->nodes) {
+    if (node->kind == AZ_NODE_NOTHING) continue;
+    hash_int(&hash, node - state->nodes);
+    hash_int(&hash, node->kind);
+    hash_u64(&hash, node->uid);
+    hash_vector(&hash, node->position);
+    hash_double(&hash, node->angle);
+    hash_int(&hash, node->status);
+  }
+  return hash;
+}
+
+static uint64_t hash_gravfields(const az_space_state_t *state) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  AZ_ARRAY_LOOP(gravfield, state->gravfields) {
+    if (gravfield->kind == AZ_GRAV_NOTHING) continue;
+    hash_int(&hash, gravfield - state->gravfields);
+    hash_int(&hash, gravfield->kind);
+    hash_u64(&hash, gravfield->uid);
+    hash_vector(&hash, gravfield->position);
+    hash_double(&hash, gravfield->angle);
+    hash_double(&hash, gravfield->strength);
+    hash_double(&hash, gravfield->age);
+    hash_bool(&hash, gravfield->script_fired);
+  }
+  return hash;
+}
+
+static uint64_t hash_timers(const az_space_state_t *state) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  AZ_ARRAY_LOOP(timer, state->timers) {
+    if (timer->vm.script == NULL) continue;
+    hash_int(&hash, timer - state->timers);
+    hash_double(&hash, timer->time_remaining);
+    hash_vm(&hash, &timer->vm);
+  }
+  return hash;
+}
+
+static uint64_t hash_particles(const az_space_state_t *state) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  for (int i = 0; i < AZ_MAX_NUM_PARTICLES; ++i) {
+    az_particle_t particle;
+    az_get_particle(state, i, &particle);
+    if (particle.kind == AZ_PAR_NOTHING) continue;
+    hash_int(&hash, i);
+    hash_int(&hash, particle.kind);
+    hash_vector(&hash, particle.position);
+    hash_vector(&hash, particle.velocity);
+    hash_double(&hash, particle.angle);
+    hash_double(&hash, particle.age);
+    hash_double(&hash, particle.lifetime);
+    hash_double(&hash, particle.param1);
+    hash_double(&hash, particle.param2);
+  }
+  return hash;
+}
+
+static uint64_t hash_specks(const az_space_state_t *state) {
+  uint64_t hash = FNV_OFFSET_BASIS;
+  for (int i = 0; i < AZ_MAX_NUM_SPECKS; ++i) {
+    az_speck_t speck;
+    az_get_speck(state, i, &speck);
+    if (speck.kind == AZ_SPECK_NOTHING) continue;
+    hash_int(&hash, i);
+    hash_vector(&hash, speck.position);
+    hash_vector(&hash, speck.velocity);
+    hash_double(&hash, speck.age);
+    hash_double(&hash, speck.lifetime);
+  }
+  return hash;
+}
+
+/*===========================================================================*/
+
+const char *az_hash_part_name(az_hash_part_t part) {
+  switch (part) {
+    case AZ_HASH_MODE: return "mode";
+    case AZ_HASH_SHIP: return "ship";
+    case AZ_HASH_PLAYER: return "player";
+    case AZ_HASH_BADDIES: return "baddies";
+    case AZ_HASH_PROJECTILES: return "projectiles";
+    case AZ_HASH_PICKUPS: return "pickups";
+    case AZ_HASH_WALLS: return "walls";
+    case AZ_HASH_DOORS: return "doors";
+    case AZ_HASH_NODES: return "nodes";
+    case AZ_HASH_GRAVFIELDS: return "gravfields";
+    case AZ_HASH_TIMERS: return "timers";
+    case AZ_HASH_PARTICLES: return "particles";
+    case AZ_HASH_SPECKS: return "specks";
+  }
+  AZ_ASSERT_UNREACHABLE();
+}
+
+void az_hash_space_state(const az_space_state_t *state,
+                         az_space_hash_t *hash_out) {
+  assert(state != NULL);
+  assert(hash_out != NULL);
+  hash_out->parts[AZ_HASH_MODE] = hash_mode(state);
+  hash_out->parts[AZ_HASH_SHIP] = hash_ship(&state->ship);
+  hash_out->parts[AZ_HASH_PLAYER] = hash_player(&state->ship.player);
+  hash_out->parts[AZ_HASH_BADDIES] = hash_baddies(state);
+  hash_out->parts[AZ_HASH_PROJECTILES] = hash_projectiles(state);
+  hash_out->parts[AZ_HASH_PICKUPS] = hash_pickups(state);
+  hash_out->parts[AZ_HASH_WALLS] = hash_walls(state);
+  hash_out->parts[AZ_HASH_DOORS] = hash_doors(state);
+  hash_out->parts[AZ_HASH_NODES] = hash_nodes(state);
+  hash_out->parts[AZ_HASH_GRAVFIELDS] = hash_gravfields(state);
+  hash_out->parts[AZ_HASH_TIMERS] = hash_timers(state);
+  hash_out->parts[AZ_HASH_PARTICLES] = hash_particles(state);
+  hash_out->parts[AZ_HASH_SPECKS] = hash_specks(state);
+}
+
+/*===========================================================================*/
@@ -0,0 +1,68 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_STATE_HASH_H_
+#define AZIMUTH_STATE_HASH_H_
+
+#include <stdint.h>
+
+#include "azimuth/state/space.h"
+
+/*===========================================================================*/
+
+// The parts of the space state that are hashed separately, so that when two
+// runs diverge we can tell which subsystem diverged first.
+typedef enum {
+  AZ_HASH_MODE = 0, // mode, clock, random seed, camera, scripts, etc.
+  AZ_HASH_SHIP,
+  AZ_HASH_PLAYER,
+  AZ_HASH_BADDIES,
+  AZ_HASH_PROJECTILES,
+  AZ_HASH_PICKUPS,
+  AZ_HASH_WALLS,
+  AZ_HASH_DOORS,
+  AZ_HASH_NODES,
+  AZ_HASH_GRAVFIELDS,
+  AZ_HASH_TIMERS,
+  // Purely cosmetic parts; these can't affect gameplay, but are still useful
+  // for catching changes to e.g. how particles are spawned.
+  AZ_HASH_PARTICLES,
+  AZ_HASH_SPECKS
+} az_hash_part_t;
+
+#define AZ_NUM_HASH_PARTS (AZ_HASH_SPECKS + 1)
+
+typedef struct {
+  uint64_t parts[AZ_NUM_HASH_PARTS];
+} az_space_hash_t;
+
+// Get a short, lowercase name for the given hash part (with no spaces).
+const char *az_hash_part_name(az_hash_part_t part);
+
+// Hash the simulation-relevant fields of the space state.  The hash depends
+// only on the values of those fields, not on padding bytes or on the addresses
+// of scripts and other planet data, so it is stable from one run (or one
+// build) to the next as long as the simulation itself behaves the same.
+void az_hash_space_state(const az_space_state_t *state,
+                         az_space_hash_t *hash_out);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_STATE_HASH_H_
@@ -29,7 +29,8 @@
 #define NOTHING_PROB 12
 
 az_pickup_kind_t az_choose_random_pickup_kind(
-    const az_player_t *player, az_pickup_flags_t potential_pickups) {
+    az_random_seed_t *seed, const az_player_t *player,
+    az_pickup_flags_t potential_pickups) {
   // Filter the permitted pickups; do not include pickups that the player
   // doesn't currently need.
   if (player->rockets >= player->max_rockets) {
@@ -80,7 +81,7 @@ az_pickup_kind_t az_choose_random_pickup_kind(
   if (limit == 0) return AZ_PUP_NOTHING;
 
   // Select the pickup kind:
-  int choice = az_randint(0, limit - 1);
+  int choice = az_rand_int(seed, 0, limit - 1);
   if (potential_pickups & AZ_PUPF_ROCKETS) {
     if (choice < rockets_prob) return AZ_PUP_ROCKETS;
     else choice -= rockets_prob;
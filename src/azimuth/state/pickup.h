@@ -24,6 +24,7 @@
 #include <stdint.h>
 
 #include "azimuth/state/player.h"
+#include "azimuth/util/random.h"
 #include "azimuth/util/vector.h"
 
 /*===========================================================================*/
@@ -76,9 +77,11 @@ typedef struct {
 // potential_pickups, which should be one or more AZ_PUPF_* flags bitwise-or'd
 // together.  If the AZ_PUPF_NOTHING flag is included, then there's a chance
 // that no pickup will be dropped.  Moreover, a pickup kind that the player
-// does not currently need will never be chosen.
+// does not currently need will never be chosen.  The choice is made using (and
+// updates) the given random seed.
 az_pickup_kind_t az_choose_random_pickup_kind(
-    const az_player_t *player, az_pickup_flags_t potential_pickups);
+    az_random_seed_t *seed, const az_player_t *player,
+    az_pickup_flags_t potential_pickups);
 
 /*===========================================================================*/
 
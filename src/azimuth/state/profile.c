@@ -0,0 +1,151 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/state/profile.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "azimuth/state/baddie.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/vector.h"
+
+/*===========================================================================*/
+
+const char *az_profile_section_name(az_profile_section_t section) {
+  switch (section) {
+    case AZ_PROF_SHIP: return "ship";
+    case AZ_PROF_BADDIES: return "baddies";
+    case AZ_PROF_PROJECTILES: return "projectiles";
+    case AZ_PROF_PARTICLES: return "particles";
+    case AZ_PROF_SPECKS: return "specks";
+    case AZ_PROF_WALLS: return "walls";
+    case AZ_PROF_GRAVFIELDS: return "gravfields";
+    case AZ_PROF_SCRIPTS: return "scripts";
+    case AZ_PROF_CAMERA: return "camera";
+    case AZ_PROF_OTHER: return "other";
+  }
+  AZ_ASSERT_UNREACHABLE();
+}
+
+const char *az_object_pool_name(az_object_pool_t pool) {
+  switch (pool) {
+    case AZ_POOL_BADDIES: return "baddies";
+    case AZ_POOL_PARTICLES: return "particles";
+    case AZ_POOL_PICKUPS: return "pickups";
+    case AZ_POOL_PROJECTILES: return "projectiles";
+    case AZ_POOL_SPECKS: return "specks";
+    case AZ_POOL_WALLS: return "walls";
+  }
+  AZ_ASSERT_UNREACHABLE();
+}
+
+void az_reset_tick_profile(az_tick_profile_t *profile,
+                           az_profile_clock_fn_t clock) {
+  assert(clock != NULL);
+  AZ_ZERO_OBJECT(profile);
+  profile->clock = clock;
+}
+
+void az_begin_profiled_tick(az_tick_profile_t *profile) {
+  profile->total_nanos = 0;
+  AZ_ZERO_ARRAY(profile->section_nanos);
+  AZ_ZERO_ARRAY(profile->baddie_nanos);
+  AZ_ZERO_ARRAY(profile->pool_dropped);
+}
+
+// Fold the latest value into a rolling average.  For the first few ticks,
+// this is just the mean so far, so that the average doesn't start out
+// dragged towards zero.
+static void update_average(double *average, uint64_t value, int num_ticks) {
+  const int weight = az_imin(num_ticks, AZ_PROFILE_WINDOW);
+  *average += ((double)value - *average) / weight;
+}
+
+void az_end_profiled_tick(az_tick_profile_t *profile, uint64_t total_nanos) {
+  profile->total_nanos = total_nanos;
+  uint64_t accounted = 0;
+  for (int i = 0; i < AZ_PROF_OTHER; ++i) {
+    accounted += profile->section_nanos[i];
+  }
+  profile->section_nanos[AZ_PROF_OTHER] =
+    (total_nanos > accounted ? total_nanos - accounted : 0);
+
+  ++profile->num_ticks;
+  update_average(&profile->average_total, total_nanos, profile->num_ticks);
+  for (int i = 0; i < AZ_NUM_PROFILE_SECTIONS; ++i) {
+    update_average(&profile->average_sections[i], profile->section_nanos[i],
+                   profile->num_ticks);
+  }
+  for (int i = 0; i <= AZ_NUM_BADDIE_KINDS; ++i) {
+    update_average(&profile->average_baddies[i], profile->baddie_nanos[i],
+                   profile->num_ticks);
+  }
+  profile->recent_totals[profile->num_ticks % AZ_PROFILE_WINDOW] =
+    total_nanos;
+  for (int i = 0; i < AZ_NUM_OBJECT_POOLS; ++i) {
+    profile->peak_pool_live[i] =
+      az_imax(profile->peak_pool_live[i], profile->pool_live[i]);
+    profile->total_pool_dropped[i] += profile->pool_dropped[i];
+  }
+}
+
+uint64_t az_peak_tick_nanos(const az_tick_profile_t *profile) {
+  uint64_t peak = 0;
+  AZ_ARRAY_LOOP(total, profile->recent_totals) {
+    if (*total > peak) peak = *total;
+  }
+  return peak;
+}
+
+/*===========================================================================*/
+
+void az_write_profile_csv_header(FILE *file) {
+  fprintf(file, "frame,total");
+  for (int i = 0; i < AZ_NUM_PROFILE_SECTIONS; ++i) {
+    fprintf(file, ",%s", az_profile_section_name((az_profile_section_t)i));
+  }
+  for (int kind = 1; kind <= AZ_NUM_BADDIE_KINDS; ++kind) {
+    fprintf(file, ",bad_%s", az_baddie_kind_name((az_baddie_kind_t)kind));
+  }
+  for (int i = 0; i < AZ_NUM_OBJECT_POOLS; ++i) {
+    const char *name = az_object_pool_name((az_object_pool_t)i);
+    fprintf(file, ",%s_live,%s_hw,%s_dropped", name, name, name);
+  }
+  fprintf(file, "\n");
+}
+
+void az_write_profile_csv_row(FILE *file, int frame,
+                              const az_tick_profile_t *profile) {
+  fprintf(file, "%d,%llu", frame, (unsigned long long)profile->total_nanos);
+  AZ_ARRAY_LOOP(nanos, profile->section_nanos) {
+    fprintf(file, ",%llu", (unsigned long long)*nanos);
+  }
+  for (int kind = 1; kind <= AZ_NUM_BADDIE_KINDS; ++kind) {
+    fprintf(file, ",%llu", (unsigned long long)profile->baddie_nanos[kind]);
+  }
+  for (int i = 0; i < AZ_NUM_OBJECT_POOLS; ++i) {
+    fprintf(file, ",%d,%d,%d", profile->pool_live[i],
+            profile->pool_high_water[i], profile->pool_dropped[i]);
+  }
+  fprintf(file, "\n");
+}
+
+/*===========================================================================*/
@@ -0,0 +1,136 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_STATE_PROFILE_H_
+#define AZIMUTH_STATE_PROFILE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "azimuth/state/baddie.h"
+
+/*===========================================================================*/
+
+// The parts of az_tick_space_state that are timed separately.  Each section
+// is timed at the top level of the tick only, so (for example) a script run
+// by a baddie being killed counts towards the baddie's time, not towards
+// AZ_PROF_SCRIPTS.
+typedef enum {
+  AZ_PROF_SHIP = 0,
+  AZ_PROF_BADDIES,
+  AZ_PROF_PROJECTILES,
+  AZ_PROF_PARTICLES,
+  AZ_PROF_SPECKS,
+  AZ_PROF_WALLS,
+  AZ_PROF_GRAVFIELDS,
+  AZ_PROF_SCRIPTS, // timers, sync timers, monologue, dialogue, and cutscenes
+  AZ_PROF_CAMERA,
+  AZ_PROF_OTHER // everything else (doors, nodes, pickups, modes, etc.)
+} az_profile_section_t;
+
+#define AZ_NUM_PROFILE_SECTIONS (AZ_PROF_OTHER + 1)
+
+// The fixed-size object arrays whose usage is tracked.  When one of these is
+// full, new objects of that type are dropped.
+typedef enum {
+  AZ_POOL_BADDIES = 0,
+  AZ_POOL_PARTICLES,
+  AZ_POOL_PICKUPS,
+  AZ_POOL_PROJECTILES,
+  AZ_POOL_SPECKS,
+  AZ_POOL_WALLS
+} az_object_pool_t;
+
+#define AZ_NUM_OBJECT_POOLS (AZ_POOL_WALLS + 1)
+
+// A clock for timing ticks, returning the current time in nanoseconds.
+typedef uint64_t (*az_profile_clock_fn_t)(void);
+
+// The number of ticks that the rolling averages (roughly) cover.
+#define AZ_PROFILE_WINDOW 60
+
+// Wall-clock timings of space state ticks.  These are kept outside of the
+// space state proper, since they differ from one run to the next.
+typedef struct {
+  // The clock to time ticks with.  This is supplied by whoever sets up the
+  // profile, so that the state and tick code don't depend on the system
+  // layer for it.
+  az_profile_clock_fn_t clock;
+  // Time spent during the most recent tick, in nanoseconds:
+  uint64_t total_nanos;
+  uint64_t section_nanos[AZ_NUM_PROFILE_SECTIONS];
+  uint64_t baddie_nanos[AZ_NUM_BADDIE_KINDS + 1]; // indexed by baddie kind
+  // Rolling averages over recent ticks, in nanoseconds:
+  double average_total;
+  double average_sections[AZ_NUM_PROFILE_SECTIONS];
+  double average_baddies[AZ_NUM_BADDIE_KINDS + 1];
+  // The totals for the last AZ_PROFILE_WINDOW ticks (a ring buffer), so that
+  // we can report the worst recent hitch:
+  uint64_t recent_totals[AZ_PROFILE_WINDOW];
+  int num_ticks;
+  // Usage of each object array (indexed by az_object_pool_t) during the most
+  // recent tick: the number of slots in use and the high water mark at the
+  // end of the tick, and the number of objects that were dropped during the
+  // tick because the array was full:
+  int pool_live[AZ_NUM_OBJECT_POOLS];
+  int pool_high_water[AZ_NUM_OBJECT_POOLS];
+  int pool_dropped[AZ_NUM_OBJECT_POOLS];
+  // The most slots ever in use at the end of a tick, and the total number of
+  // objects dropped, over all ticks so far:
+  int peak_pool_live[AZ_NUM_OBJECT_POOLS];
+  int total_pool_dropped[AZ_NUM_OBJECT_POOLS];
+} az_tick_profile_t;
+
+// Get a short, lowercase name for the given section (with no spaces).
+const char *az_profile_section_name(az_profile_section_t section);
+
+// Get a short, lowercase name for the given object pool (with no spaces).
+const char *az_object_pool_name(az_object_pool_t pool);
+
+// Forget all timings recorded so far, and set the clock to time future ticks
+// with (which must not be NULL).
+void az_reset_tick_profile(az_tick_profile_t *profile,
+                           az_profile_clock_fn_t clock);
+
+// Call this at the start of each profiled tick, to clear the timings for the
+// previous tick.
+void az_begin_profiled_tick(az_tick_profile_t *profile);
+
+// Call this at the end of each profiled tick, with the total time the tick
+// took (and after filling in pool_live and pool_high_water).  This works out
+// the time spent in AZ_PROF_OTHER, and updates the rolling averages and the
+// peak object array usage.
+void az_end_profiled_tick(az_tick_profile_t *profile, uint64_t total_nanos);
+
+// Get the longest total time of any of the last AZ_PROFILE_WINDOW ticks.
+uint64_t az_peak_tick_nanos(const az_tick_profile_t *profile);
+
+// Write the CSV header line, and a CSV line giving the most recent tick's
+// timings (in nanoseconds) for the given frame.  Baddie columns are named by
+// baddie kind (e.g. "bad_zipper").  These are followed by columns giving
+// the usage of each object array (e.g. "specks_live", "specks_hw", and
+// "specks_dropped").
+void az_write_profile_csv_header(FILE *file);
+void az_write_profile_csv_row(FILE *file, int frame,
+                              const az_tick_profile_t *profile);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_STATE_PROFILE_H_
@@ -0,0 +1,481 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/state/replay.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azimuth/state/player.h"
+#include "azimuth/state/save.h"
+#include "azimuth/state/ship.h"
+#include "azimuth/util/key.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/prefs.h"
+
+/*===========================================================================*/
+
+// Bump this whenever the file format (or anything that would make old
+// replays play back differently) changes.
+#define REPLAY_VERSION 1
+
+#define HELD_UP    0x01
+#define HELD_DOWN  0x02
+#define HELD_LEFT  0x04
+#define HELD_RIGHT 0x08
+#define HELD_FIRE  0x10
+#define HELD_ORDN  0x20
+#define HELD_UTIL  0x40
+#define HELD_ALL   0x7f
+
+uint8_t az_held_controls_bits(const az_controls_t *controls) {
+  return ((controls->up_held ? HELD_UP : 0) |
+          (controls->down_held ? HELD_DOWN : 0) |
+          (controls->left_held ? HELD_LEFT : 0) |
+          (controls->right_held ? HELD_RIGHT : 0) |
+          (controls->fire_held ? HELD_FIRE : 0) |
+          (controls->ordn_held ? HELD_ORDN : 0) |
+          (controls->util_held ? HELD_UTIL : 0));
+}
+
+void az_set_held_controls(az_controls_t *controls, uint8_t bits) {
+  controls->up_held = (bits & HELD_UP) != 0;
+  controls->down_held = (bits & HELD_DOWN) != 0;
+  controls->left_held = (bits & HELD_LEFT) != 0;
+  controls->right_held = (bits & HELD_RIGHT) != 0;
+  controls->fire_held = (bits & HELD_FIRE) != 0;
+  controls->ordn_held = (bits & HELD_ORDN) != 0;
+  controls->util_held = (bits & HELD_UTIL) != 0;
+}
+
+/*===========================================================================*/
+
+static void reset_replay(az_replay_t *replay) {
+  AZ_ZERO_OBJECT(replay);
+  az_reset_prefs_to_defaults(&replay->prefs);
+}
+
+void az_init_replay(az_replay_t *replay, const az_saved_games_t *saved_games,
+                    const az_preferences_t *prefs, int saved_game_index) {
+  assert(saved_game_index >= 0);
+  assert(saved_game_index < AZ_ARRAY_SIZE(saved_games->games));
+  reset_replay(replay);
+  replay->saved_game_index = saved_game_index;
+  replay->saved_game = saved_games->games[saved_game_index];
+  memcpy(replay->prefs.key_for_control, prefs->key_for_control,
+         sizeof(replay->prefs.key_for_control));
+}
+
+void az_destroy_replay(az_replay_t *replay) {
+  free(replay->records);
+  AZ_ZERO_OBJECT(replay);
+}
+
+static az_replay_record_t *append_record(az_replay_t *replay,
+                                         az_replay_record_kind_t kind) {
+  if (replay->num_records >= replay->max_records) {
+    const int max_records =
+      (replay->max_records == 0 ? 256 : 2 * replay->max_records);
+    az_replay_record_t *records = AZ_ALLOC(max_records, az_replay_record_t);
+    if (replay->num_records > 0) {
+      memcpy(records, replay->records,
+             replay->num_records * sizeof(az_replay_record_t));
+    }
+    free(replay->records);
+    replay->records = records;
+    replay->max_records = max_records;
+  }
+  az_replay_record_t *record = &replay->records[replay->num_records++];
+  AZ_ZERO_OBJECT(record);
+  record->kind = kind;
+  return record;
+}
+
+void az_replay_record_frame(az_replay_t *replay,
+                            const az_controls_t *controls) {
+  const uint8_t held = az_held_controls_bits(controls);
+  ++replay->num_frames;
+  // Extend the previous run of frames if nothing else happened since then and
+  // the same controls are still held.
+  if (replay->num_records > 0) {
+    az_replay_record_t *last = &replay->records[replay->num_records - 1];
+    if (last->kind == AZ_RPR_FRAMES && last->data.frames.held == held) {
+      ++last->data.frames.count;
+      return;
+    }
+  }
+  az_replay_record_t *record = append_record(replay, AZ_RPR_FRAMES);
+  record->data.frames.held = held;
+  record->data.frames.count = 1;
+}
+
+void az_replay_record_key_down(az_replay_t *replay, az_key_id_t key) {
+  append_record(replay, AZ_RPR_KEY_DOWN)->data.key = key;
+}
+
+void az_replay_record_save(az_replay_t *replay, bool save_ok) {
+  append_record(replay, AZ_RPR_SAVE)->data.save_ok = save_ok;
+}
+
+void az_replay_record_paused(az_replay_t *replay, bool exit_to_title,
+                             const az_player_t *player) {
+  az_replay_record_t *record = append_record(replay, AZ_RPR_PAUSED);
+  record->data.paused.exit_to_title = exit_to_title;
+  record->data.paused.gun1 = player->gun1;
+  record->data.paused.gun2 = player->gun2;
+  record->data.paused.next_gun = player->next_gun;
+  record->data.paused.ordnance = player->ordnance;
+}
+
+void az_replay_record_rebind(az_replay_t *replay, az_control_id_t control,
+                             az_key_id_t key) {
+  az_replay_record_t *record = append_record(replay, AZ_RPR_REBIND);
+  record->data.rebind.control = control;
+  record->data.rebind.key = key;
+}
+
+void az_replay_record_end(az_replay_t *replay, int action) {
+  append_record(replay, AZ_RPR_END)->data.action = action;
+}
+
+/*===========================================================================*/
+
+// Return the next record if it has the given kind, advancing the cursor past
+// it; otherwise, return NULL.
+static const az_replay_record_t *next_record(
+    const az_replay_t *replay, az_replay_cursor_t *cursor,
+    az_replay_record_kind_t kind) {
+  if (cursor->frames_left > 0) return NULL;
+  if (cursor->record_index >= replay->num_records) return NULL;
+  const az_replay_record_t *record = &replay->records[cursor->record_index];
+  if (record->kind != kind) return NULL;
+  ++cursor->record_index;
+  return record;
+}
+
+bool az_replay_next_frame(const az_replay_t *replay,
+                          az_replay_cursor_t *cursor, uint8_t *held_out) {
+  if (cursor->frames_left > 0) {
+    assert(cursor->record_index > 0);
+    const az_replay_record_t *record =
+      &replay->records[cursor->record_index - 1];
+    assert(record->kind == AZ_RPR_FRAMES);
+    --cursor->frames_left;
+    ++cursor->frame;
+    *held_out = record->data.frames.held;
+    return true;
+  }
+  const az_replay_record_t *record =
+    next_record(replay, cursor, AZ_RPR_FRAMES);
+  if (record == NULL) return false;
+  assert(record->data.frames.count >= 1);
+  cursor->frames_left = record->data.frames.count - 1;
+  ++cursor->frame;
+  *held_out = record->data.frames.held;
+  return true;
+}
+
+bool az_replay_next_key_down(const az_replay_t *replay,
+                             az_replay_cursor_t *cursor,
+                             az_key_id_t *key_out) {
+  const az_replay_record_t *record =
+    next_record(replay, cursor, AZ_RPR_KEY_DOWN);
+  if (record == NULL) return false;
+  *key_out = record->data.key;
+  return true;
+}
+
+bool az_replay_next_save(const az_replay_t *replay,
+                         az_replay_cursor_t *cursor, bool *save_ok_out) {
+  const az_replay_record_t *record = next_record(replay, cursor, AZ_RPR_SAVE);
+  if (record == NULL) return false;
+  *save_ok_out = record->data.save_ok;
+  return true;
+}
+
+const az_replay_record_t *az_replay_next_paused(const az_replay_t *replay,
+                                                az_replay_cursor_t *cursor) {
+  return next_record(replay, cursor, AZ_RPR_PAUSED);
+}
+
+bool az_replay_next_rebind(const az_replay_t *replay,
+                           az_replay_cursor_t *cursor,
+                           az_control_id_t *control_out, az_key_id_t *key_out) {
+  const az_replay_record_t *record =
+    next_record(replay, cursor, AZ_RPR_REBIND);
+  if (record == NULL) return false;
+  *control_out = record->data.rebind.control;
+  *key_out = record->data.rebind.key;
+  return true;
+}
+
+bool az_replay_next_end(const az_replay_t *replay,
+                        az_replay_cursor_t *cursor, int *action_out) {
+  const az_replay_record_t *record = next_record(replay, cursor, AZ_RPR_END);
+  if (record == NULL) return false;
+  *action_out = record->data.action;
+  return true;
+}
+
+/*===========================================================================*/
+
+static bool parse_words(FILE *file, uint64_t *array, int array_length) {
+  for (int i = 0; i < array_length; ++i) {
+    if (i > 0 && fgetc(file) != ':') return false;
+    if (fscanf(file, "%"SCNx64, &array[i]) < 1) return false;
+  }
+  return true;
+}
+
+#define READ_WORDS(prefix, array) do { \
+    if (fscanf(file, prefix) < 0) return false; \
+    if (!parse_words(file, (array), AZ_ARRAY_SIZE(array))) { \
+      return false; \
+    } \
+  } while (0)
+
+static bool parse_player(FILE *file, az_player_t *player) {
+  AZ_ZERO_OBJECT(player);
+  READ_WORDS("@P up=", player->upgrades.array);
+  READ_WORDS(" rv=", player->rooms_visited);
+  READ_WORDS(" zm=", player->zones_mapped);
+  READ_WORDS(" fl=", player->flags);
+  int gun1, gun2, next_gun, ordnance;
+  if (fscanf(file, " tt=%la cr=%d sh=%la ms=%la en=%la me=%la rk=%d mr=%d"
+             " bm=%d mb=%d g1=%d g2=%d ng=%d or=%d\n",
+             &player->total_time, &player->current_room, &player->shields,
+             &player->max_shields, &player->energy, &player->max_energy,
+             &player->rockets, &player->max_rockets, &player->bombs,
+             &player->max_bombs, &gun1, &gun2, &next_gun,
+             &ordnance) < 14) return false;
+  if (player->current_room < 0 ||
+      player->current_room >= AZ_MAX_NUM_ROOMS) return false;
+  if (gun1 < (int)AZ_GUN_NONE || gun1 > (int)AZ_GUN_BEAM ||
+      gun2 < (int)AZ_GUN_NONE || gun2 > (int)AZ_GUN_BEAM) return false;
+  if (ordnance < (int)AZ_ORDN_NONE || ordnance > (int)AZ_ORDN_BOMBS) {
+    return false;
+  }
+  player->gun1 = (az_gun_t)gun1;
+  player->gun2 = (az_gun_t)gun2;
+  player->next_gun = (next_gun != 0);
+  player->ordnance = (az_ordnance_t)ordnance;
+  return true;
+}
+
+#undef READ_WORDS
+
+static bool parse_record(FILE *file, char ch, az_replay_t *replay) {
+  switch (ch) {
+    case 'f': {
+      unsigned int held;
+      int count;
+      if (fscanf(file, "%x*%d", &held, &count) < 2) return false;
+      if (held > HELD_ALL || count < 1) return false;
+      az_replay_record_t *record = append_record(replay, AZ_RPR_FRAMES);
+      record->data.frames.held = held;
+      record->data.frames.count = count;
+      replay->num_frames += count;
+    } return true;
+    case 'k': {
+      int key;
+      if (fscanf(file, "%d", &key) < 1) return false;
+      if (key <= (int)AZ_KEY_UNKNOWN || key >= (int)AZ_NUM_ALLOWED_KEYS) {
+        return false;
+      }
+      az_replay_record_key_down(replay, (az_key_id_t)key);
+    } return true;
+    case 's': {
+      int save_ok;
+      if (fscanf(file, "%d", &save_ok) < 1) return false;
+      az_replay_record_save(replay, save_ok != 0);
+    } return true;
+    case 'p': {
+      int exit_to_title, gun1, gun2, next_gun, ordnance;
+      if (fscanf(file, "%d %d %d %d %d", &exit_to_title, &gun1, &gun2,
+                 &next_gun, &ordnance) < 5) return false;
+      if (gun1 < (int)AZ_GUN_NONE || gun1 > (int)AZ_GUN_BEAM ||
+          gun2 < (int)AZ_GUN_NONE || gun2 > (int)AZ_GUN_BEAM) return false;
+      if (ordnance < (int)AZ_ORDN_NONE || ordnance > (int)AZ_ORDN_BOMBS) {
+        return false;
+      }
+      az_replay_record_t *record = append_record(replay, AZ_RPR_PAUSED);
+      record->data.paused.exit_to_title = (exit_to_title != 0);
+      record->data.paused.gun1 = (az_gun_t)gun1;
+      record->data.paused.gun2 = (az_gun_t)gun2;
+      record->data.paused.next_gun = (next_gun != 0);
+      record->data.paused.ordnance = (az_ordnance_t)ordnance;
+    } return true;
+    case 'b': {
+      int control, key;
+      if (fscanf(file, "%d %d", &control, &key) < 2) return false;
+      if (control < (int)AZ_FIRST_CONTROL || control >= AZ_NUM_CONTROLS ||
+          !az_is_valid_prefs_key((az_key_id_t)key,
+                                 (az_control_id_t)control)) return false;
+      az_replay_record_rebind(replay, (az_control_id_t)control,
+                              (az_key_id_t)key);
+    } return true;
+    case 'e': {
+      int action;
+      if (fscanf(file, "%d", &action) < 1) return false;
+      az_replay_record_end(replay, action);
+    } return true;
+    default: return false;
+  }
+}
+
+static bool parse_replay(FILE *file, az_replay_t *replay) {
+  int version, present;
+  if (fscanf(file, "@R v=%d gi=%d pr=%d\n", &version,
+             &replay->saved_game_index, &present) < 3) return false;
+  if (version != REPLAY_VERSION) return false;
+  if (replay->saved_game_index < 0 ||
+      replay->saved_game_index >= AZ_NUM_SAVED_GAME_SLOTS) return false;
+  replay->saved_game.present = (present != 0);
+  if (fscanf(file, "@K") < 0) return false;
+  for (int i = AZ_FIRST_CONTROL; i < AZ_NUM_CONTROLS; ++i) {
+    int key;
+    if (fscanf(file, " %d", &key) < 1) return false;
+    if (!az_is_valid_prefs_key((az_key_id_t)key, (az_control_id_t)i)) {
+      return false;
+    }
+    replay->prefs.key_for_control[i] = (az_key_id_t)key;
+  }
+  if (fscanf(file, "\n") < 0) return false;
+  if (!parse_player(file, &replay->saved_game.player)) return false;
+  char ch;
+  while (fscanf(file, " %c", &ch) == 1) {
+    if (!parse_record(file, ch, replay)) return false;
+  }
+  return true;
+}
+
+bool az_load_replay_from_file(FILE *file, az_replay_t *replay_out) {
+  assert(file != NULL);
+  assert(replay_out != NULL);
+  reset_replay(replay_out);
+  const bool ok = parse_replay(file, replay_out);
+  if (!ok) az_destroy_replay(replay_out);
+  return ok;
+}
+
+bool az_load_replay_from_path(const char *filepath, az_replay_t *replay_out) {
+  assert(replay_out != NULL);
+  FILE *file = fopen(filepath, "r");
+  if (file == NULL) return false;
+  const bool ok = az_load_replay_from_file(file, replay_out);
+  fclose(file);
+  return ok;
+}
+
+/*===========================================================================*/
+
+static bool write_words(const char *prefix, const uint64_t *array,
+                        int array_length, FILE *file) {
+  if (fputs(prefix, file) < 0) return false;
+  for (int i = 0; i < array_length; ++i) {
+    if (fprintf(file, (i > 0 ? ":%"PRIx64 : "%"PRIx64), array[i]) < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#define WRITE_WORDS(prefix, array) do { \
+    if (!write_words(prefix, array, AZ_ARRAY_SIZE(array), file)) { \
+      return false; \
+    } \
+  } while (0)
+
+// Doubles are written in hex (%a) so that they read back in exactly; a replay
+// would quickly go off the rails otherwise.
+static bool write_player(const az_player_t *player, FILE *file) {
+  WRITE_WORDS("@P up=", player->upgrades.array);
+  WRITE_WORDS(" rv=", player->rooms_visited);
+  WRITE_WORDS(" zm=", player->zones_mapped);
+  WRITE_WORDS(" fl=", player->flags);
+  return (fprintf(file, " tt=%a cr=%d sh=%a ms=%a en=%a me=%a rk=%d mr=%d"
+                  " bm=%d mb=%d g1=%d g2=%d ng=%d or=%d\n",
+                  player->total_time, player->current_room, player->shields,
+                  player->max_shields, player->energy, player->max_energy,
+                  player->rockets, player->max_rockets, player->bombs,
+                  player->max_bombs, (int)player->gun1, (int)player->gun2,
+                  (player->next_gun ? 1 : 0), (int)player->ordnance) >= 0);
+}
+
+#undef WRITE_WORDS
+
+static bool write_record(const az_replay_record_t *record, FILE *file) {
+  switch (record->kind) {
+    case AZ_RPR_FRAMES:
+      return (fprintf(file, "f%x*%d\n", (unsigned int)record->data.frames.held,
+                      record->data.frames.count) >= 0);
+    case AZ_RPR_KEY_DOWN:
+      return (fprintf(file, "k%d\n", (int)record->data.key) >= 0);
+    case AZ_RPR_SAVE:
+      return (fprintf(file, "s%d\n", (record->data.save_ok ? 1 : 0)) >= 0);
+    case AZ_RPR_PAUSED:
+      return (fprintf(file, "p%d %d %d %d %d\n",
+                      (record->data.paused.exit_to_title ? 1 : 0),
+                      (int)record->data.paused.gun1,
+                      (int)record->data.paused.gun2,
+                      (record->data.paused.next_gun ? 1 : 0),
+                      (int)record->data.paused.ordnance) >= 0);
+    case AZ_RPR_REBIND:
+      return (fprintf(file, "b%d %d\n", (int)record->data.rebind.control,
+                      (int)record->data.rebind.key) >= 0);
+    case AZ_RPR_END:
+      return (fprintf(file, "e%d\n", record->data.action) >= 0);
+  }
+  AZ_ASSERT_UNREACHABLE();
+}
+
+bool az_save_replay_to_file(const az_replay_t *replay, FILE *file) {
+  assert(replay != NULL);
+  assert(file != NULL);
+  if (fprintf(file, "@R v=%d gi=%d pr=%d\n@K", REPLAY_VERSION,
+              replay->saved_game_index,
+              (replay->saved_game.present ? 1 : 0)) < 0) return false;
+  for (int i = AZ_FIRST_CONTROL; i < AZ_NUM_CONTROLS; ++i) {
+    if (fprintf(file, " %d", (int)replay->prefs.key_for_control[i]) < 0) {
+      return false;
+    }
+  }
+  if (fprintf(file, "\n") < 0) return false;
+  if (!write_player(&replay->saved_game.player, file)) return false;
+  for (int i = 0; i < replay->num_records; ++i) {
+    if (!write_record(&replay->records[i], file)) return false;
+  }
+  return true;
+}
+
+bool az_save_replay_to_path(const az_replay_t *replay, const char *filepath) {
+  assert(replay != NULL);
+  FILE *file = fopen(filepath, "w");
+  if (file == NULL) return false;
+  const bool ok = az_save_replay_to_file(replay, file);
+  fclose(file);
+  return ok;
+}
+
+/*===========================================================================*/
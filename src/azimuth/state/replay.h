@@ -0,0 +1,149 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_STATE_REPLAY_H_
+#define AZIMUTH_STATE_REPLAY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "azimuth/state/save.h"
+#include "azimuth/state/ship.h"
+#include "azimuth/util/key.h"
+#include "azimuth/util/prefs.h"
+
+/*===========================================================================*/
+
+// A replay records everything from outside the simulation that goes into one
+// run of the space event loop (held controls, key presses, and the outcomes of
+// saving and of the pause screen), so that the run can be reproduced exactly
+// later on, with or without a window.
+
+typedef enum {
+  AZ_RPR_FRAMES = 0, // a run of frames with the same controls held
+  AZ_RPR_KEY_DOWN, // a key was pressed at the end of the previous frame
+  AZ_RPR_SAVE, // the game was saved (successfully or not)
+  AZ_RPR_PAUSED, // the player left the pause screen
+  AZ_RPR_REBIND, // a key binding was changed (on the pause screen)
+  AZ_RPR_END // the event loop returned
+} az_replay_record_kind_t;
+
+typedef struct {
+  az_replay_record_kind_t kind;
+  union {
+    struct {
+      uint8_t held; // a bitset of held controls; see az_held_controls_bits
+      int count;
+    } frames;
+    az_key_id_t key;
+    bool save_ok;
+    struct {
+      bool exit_to_title;
+      // The pause screen lets the player change weapons, so we need to record
+      // what they ended up with:
+      az_gun_t gun1, gun2;
+      bool next_gun;
+      az_ordnance_t ordnance;
+    } paused;
+    struct {
+      az_control_id_t control;
+      az_key_id_t key;
+    } rebind;
+    int action; // the az_space_action_t that the event loop returned
+  } data;
+} az_replay_record_t;
+
+typedef struct {
+  // How the run started:
+  int saved_game_index;
+  az_saved_game_t saved_game;
+  // Only the key bindings matter to the simulation (they affect the text of
+  // some dialogue, as well as what each key press does), so the other
+  // preferences are just the defaults.  These are the bindings at the start of
+  // the run; see AZ_RPR_REBIND for later changes.
+  az_preferences_t prefs;
+  // What happened during the run:
+  int num_frames;
+  int num_records, max_records;
+  az_replay_record_t *records;
+} az_replay_t;
+
+// A position within a replay, for playing it back.
+typedef struct {
+  int frame; // number of frames read so far
+  int record_index; // index of the next record to read
+  int frames_left; // frames left in the run of the last-read FRAMES record
+} az_replay_cursor_t;
+
+// Pack the *_held fields of the controls into a bitset, or unpack it again.
+uint8_t az_held_controls_bits(const az_controls_t *controls);
+void az_set_held_controls(az_controls_t *controls, uint8_t bits);
+
+// Start a new, empty replay.  The saved game and preferences are copied.
+void az_init_replay(az_replay_t *replay, const az_saved_games_t *saved_games,
+                    const az_preferences_t *prefs, int saved_game_index);
+
+// Free the records of the replay.
+void az_destroy_replay(az_replay_t *replay);
+
+void az_replay_record_frame(az_replay_t *replay,
+                            const az_controls_t *controls);
+void az_replay_record_key_down(az_replay_t *replay, az_key_id_t key);
+void az_replay_record_save(az_replay_t *replay, bool save_ok);
+void az_replay_record_paused(az_replay_t *replay, bool exit_to_title,
+                             const az_player_t *player);
+void az_replay_record_rebind(az_replay_t *replay, az_control_id_t control,
+                             az_key_id_t key);
+void az_replay_record_end(az_replay_t *replay, int action);
+
+// Each of these reads the next record of the replay if it is of the
+// corresponding kind, and returns false (without advancing the cursor)
+// otherwise.  Records must be read in the same order that the event loop
+// produced them: first the frame, then any save or paused record (the latter
+// followed by any rebinds), then any end record, then any key-downs.
+bool az_replay_next_frame(const az_replay_t *replay,
+                          az_replay_cursor_t *cursor, uint8_t *held_out);
+bool az_replay_next_key_down(const az_replay_t *replay,
+                             az_replay_cursor_t *cursor, az_key_id_t *key_out);
+bool az_replay_next_save(const az_replay_t *replay,
+                         az_replay_cursor_t *cursor, bool *save_ok_out);
+const az_replay_record_t *az_replay_next_paused(const az_replay_t *replay,
+                                                az_replay_cursor_t *cursor);
+bool az_replay_next_rebind(const az_replay_t *replay,
+                           az_replay_cursor_t *cursor,
+                           az_control_id_t *control_out, az_key_id_t *key_out);
+bool az_replay_next_end(const az_replay_t *replay,
+                        az_replay_cursor_t *cursor, int *action_out);
+
+// Attempts to load a replay from the file located at the given path (or from
+// the given file).  Returns true on success, or false on failure.  On success,
+// the replay must later be freed with az_destroy_replay.
+bool az_load_replay_from_path(const char *filepath, az_replay_t *replay_out);
+bool az_load_replay_from_file(FILE *file, az_replay_t *replay_out);
+
+// Attempts to save the replay to the file located at the given path (or to the
+// given file).  Returns true on success, or false on failure.
+bool az_save_replay_to_path(const az_replay_t *replay, const char *filepath);
+bool az_save_replay_to_file(const az_replay_t *replay, FILE *file);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_STATE_REPLAY_H_
@@ -478,6 +478,14 @@ void az_destroy_room(az_room_t *room) {
   free(room->doors);
   free(room->nodes);
   free(room->walls);
+  if (room->prebuilt != NULL) {
+    free(room->prebuilt->baddies);
+    free(room->prebuilt->doors);
+    free(room->prebuilt->gravfields);
+    free(room->prebuilt->nodes);
+    free(room->prebuilt->walls);
+    free(room->prebuilt);
+  }
   AZ_ZERO_OBJECT(room);
 }
 
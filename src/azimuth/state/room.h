@@ -31,6 +31,7 @@
 #include "azimuth/state/node.h" // for az_node_kind_t
 #include "azimuth/state/player.h"
 #include "azimuth/state/script.h"
+#include "azimuth/state/uid.h" // for az_uuid_t
 #include "azimuth/state/wall.h"
 #include "azimuth/util/rw.h"
 
@@ -108,6 +109,21 @@ typedef uint_fast8_t az_room_flags_t;
 #define AZ_ROOMF_WITH_REFILL ((az_room_flags_t)(1u << 5))
 #define AZ_ROOMF_WITH_SAVE   ((az_room_flags_t)(1u << 6))
 
+// A room's objects, instantiated exactly as az_enter_room adds them to an
+// empty space state (with UIDs assigned, baddies initialized, walls placed,
+// and cargo and door markers filled in), so that entering the room can just
+// copy them in.  Each array has as many elements as the room has specs of
+// that kind.  The script pointers within are borrowed from the room's specs.
+// See az_prebuild_rooms in space.h.
+typedef struct {
+  az_baddie_t *baddies;
+  az_door_t *doors;
+  az_gravfield_t *gravfields;
+  az_node_t *nodes;
+  az_wall_t *walls;
+  az_uuid_t uuids[AZ_NUM_UUID_SLOTS];
+} az_prebuilt_room_t;
+
 // Represents one room of the planetoid.  This sturct owns all of its pointers.
 typedef struct {
   az_zone_key_t zone_key;
@@ -127,6 +143,8 @@ typedef struct {
   az_node_spec_t *nodes;
   int num_walls;
   az_wall_spec_t *walls;
+  // The room's objects, ready to copy into space; NULL if not prebuilt:
+  az_prebuilt_room_t *prebuilt;
 } az_room_t;
 
 // Attempt to open the file located at the given path and load room data from
@@ -22,7 +22,10 @@
 #include <assert.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "azimuth/constants.h"
 #include "azimuth/state/room.h"
 #include "azimuth/state/uid.h"
 #include "azimuth/state/upgrade.h"
@@ -32,20 +35,714 @@
 
 /*===========================================================================*/
 
+// Zero the first count elements of the array.
+#define ZERO_PREFIX(array, count) do { \
+    assert((count) <= AZ_ARRAY_SIZE(array)); \
+    az_zero_memory_((array), (count) * sizeof((array)[0])); \
+  } while (0)
+
+// Empty the slot list, without bothering to zero its free and live arrays
+// (which are only ever read below num_free and num_live).
+#define RESET_SLOTS(slots) \
+  ((slots)->high_water = (slots)->num_free = (slots)->num_live = 0)
+
 void az_clear_space(az_space_state_t *state) {
   state->darkness = state->dark_goal = 0.0;
   state->boss_uid = AZ_NULL_UID;
-  AZ_ZERO_ARRAY(state->baddies);
-  AZ_ZERO_ARRAY(state->doors);
-  AZ_ZERO_ARRAY(state->gravfields);
-  AZ_ZERO_ARRAY(state->nodes);
-  AZ_ZERO_ARRAY(state->particles);
-  AZ_ZERO_ARRAY(state->pickups);
-  AZ_ZERO_ARRAY(state->projectiles);
-  AZ_ZERO_ARRAY(state->specks);
+  // Slots at or above an array's high water mark haven't been touched since
+  // the array was last cleared, so they're still zero, and only the slots
+  // below the mark need zeroing.  Small rooms thus clear only a small part of
+  // the (mostly empty) object arrays.
+  ZERO_PREFIX(state->baddies, state->baddie_slots.high_water);
+  ZERO_PREFIX(state->doors, state->door_high_water);
+  ZERO_PREFIX(state->gravfields, state->gravfield_slots.high_water);
+  ZERO_PREFIX(state->nodes, state->node_high_water);
+  const int num_particles = state->particle_slots.high_water;
+  ZERO_PREFIX(state->particles.x, num_particles);
+  ZERO_PREFIX(state->particles.y, num_particles);
+  ZERO_PREFIX(state->particles.vx, num_particles);
+  ZERO_PREFIX(state->particles.vy, num_particles);
+  ZERO_PREFIX(state->particles.age, num_particles);
+  ZERO_PREFIX(state->particles.lifetime, num_particles);
+  ZERO_PREFIX(state->particles.kind, num_particles);
+  ZERO_PREFIX(state->particles.color, num_particles);
+  ZERO_PREFIX(state->particles.angle, num_particles);
+  ZERO_PREFIX(state->particles.param1, num_particles);
+  ZERO_PREFIX(state->particles.param2, num_particles);
+  ZERO_PREFIX(state->pickups, state->pickup_slots.high_water);
+  ZERO_PREFIX(state->projectiles, state->projectile_slots.high_water);
+  const int num_specks = state->speck_slots.high_water;
+  ZERO_PREFIX(state->specks.x, num_specks);
+  ZERO_PREFIX(state->specks.y, num_specks);
+  ZERO_PREFIX(state->specks.vx, num_specks);
+  ZERO_PREFIX(state->specks.vy, num_specks);
+  ZERO_PREFIX(state->specks.age, num_specks);
+  ZERO_PREFIX(state->specks.lifetime, num_specks);
+  ZERO_PREFIX(state->specks.kind, num_specks);
+  ZERO_PREFIX(state->specks.color, num_specks);
   AZ_ZERO_ARRAY(state->timers);
-  AZ_ZERO_ARRAY(state->walls);
+  // Likewise, only walls below the high water mark can be recorded in the
+  // wall grid, so remove just those from it, rather than zeroing the whole
+  // grid.
+  az_wall_grid_t *grid = &state->wall_grid;
+  for (int i = 0; i < state->wall_high_water; ++i) {
+    state->walls[i].kind = AZ_WALL_NOTHING;
+    az_update_wall_grid(state, &state->walls[i]);
+  }
+  ZERO_PREFIX(grid->extents, state->wall_high_water);
+  grid->origin = AZ_VZERO;
+  grid->cell_width = grid->cell_height = 0.0;
+  grid->last_blocker = 0;
+  ZERO_PREFIX(state->walls, state->wall_high_water);
+  AZ_ZERO_OBJECT(&state->baddie_sweep);
+  AZ_ZERO_OBJECT(&state->gravfield_index);
   AZ_ZERO_ARRAY(state->uuids);
+  RESET_SLOTS(&state->baddie_slots);
+  RESET_SLOTS(&state->gravfield_slots);
+  RESET_SLOTS(&state->particle_slots);
+  RESET_SLOTS(&state->pickup_slots);
+  RESET_SLOTS(&state->projectile_slots);
+  RESET_SLOTS(&state->speck_slots);
+  state->door_high_water = state->node_high_water = 0;
+  state->wall_high_water = 0;
+}
+
+// Objects refer to each other by UID (or UUID) rather than by pointer, so the
+// state holds no pointers into itself.  The pointers it does hold (to scripts,
+// paragraphs, and object data) are all owned by the planet or are static, and
+// so remain valid in a copy of the state.  Thus a snapshot is a plain copy,
+// and restoring one only needs to patch up the pointers to the planet and
+// preferences that the destination state is shared with.
+void az_snapshot_space_state(const az_space_state_t *state,
+                             az_space_snapshot_t *snapshot) {
+  assert(state != NULL);
+  assert(snapshot != NULL);
+  memcpy(&snapshot->state, state, sizeof(*state));
+}
+
+void az_restore_space_state(const az_space_snapshot_t *snapshot,
+                            az_space_state_t *state) {
+  assert(snapshot != NULL);
+  assert(state != NULL);
+  assert(state->planet == NULL || snapshot->state.planet == NULL ||
+         state->planet == snapshot->state.planet);
+  const az_planet_t *planet =
+    (state->planet != NULL ? state->planet : snapshot->state.planet);
+  const az_preferences_t *prefs =
+    (state->prefs != NULL ? state->prefs : snapshot->state.prefs);
+  az_tick_profile_t *profile = state->profile;
+  memcpy(state, &snapshot->state, sizeof(*state));
+  state->planet = planet;
+  state->prefs = prefs;
+  state->profile = profile;
+}
+
+// Record that an object was dropped because its array was full (if the state
+// is being profiled).
+static void count_dropped(az_space_state_t *state, az_object_pool_t pool) {
+  if (state->profile != NULL) ++state->profile->pool_dropped[pool];
+}
+
+// Take a free slot from the slot list and add it to the live list, returning
+// its index, or -1 if the array is full.
+#define TAKE_SLOT(slots) \
+  take_slot(AZ_ARRAY_SIZE((slots)->free), &(slots)->high_water, \
+            &(slots)->num_free, (slots)->free, &(slots)->num_live, \
+            (slots)->live)
+
+// Determine if the slot list has a free slot for TAKE_SLOT to take.
+#define HAS_FREE_SLOT(slots) \
+  ((slots)->num_free > 0 || \
+   (slots)->high_water < AZ_ARRAY_SIZE((slots)->free))
+
+static int take_slot(int capacity, int *high_water, int *num_free,
+                     const uint16_t *free, int *num_live, uint16_t *live) {
+  int index;
+  if (*num_free > 0) index = free[--*num_free];
+  else if (*high_water < capacity) index = (*high_water)++;
+  else return -1;
+  assert(*num_live < capacity);
+  live[(*num_live)++] = index;
+  return index;
+}
+
+// Remove the slots of objects whose kind is nothing_kind from the live list
+// (preserving the order of the rest), and push them onto the free stack.
+#define RECLAIM_SLOTS(slots, array, nothing_kind) \
+  RECLAIM_SLOTS_BY_KIND(slots, (array)[index].kind, nothing_kind)
+
+// Like RECLAIM_SLOTS, but kind_of_index is an expression giving the kind of
+// the object in slot `index`.
+#define RECLAIM_SLOTS_BY_KIND(slots, kind_of_index, nothing_kind) do { \
+    int num_kept = 0; \
+    for (int i = 0; i < (slots)->num_live; ++i) { \
+      const int index = (slots)->live[i]; \
+      if ((kind_of_index) == (nothing_kind)) { \
+        (slots)->free[(slots)->num_free++] = index; \
+      } else (slots)->live[num_kept++] = index; \
+    } \
+    (slots)->num_live = num_kept; \
+  } while (0)
+
+void az_reclaim_slots(az_space_state_t *state) {
+  RECLAIM_SLOTS(&state->baddie_slots, state->baddies, AZ_BAD_NOTHING);
+  RECLAIM_SLOTS(&state->gravfield_slots, state->gravfields, AZ_GRAV_NOTHING);
+  RECLAIM_SLOTS_BY_KIND(&state->particle_slots, state->particles.kind[index],
+                        AZ_PAR_NOTHING);
+  RECLAIM_SLOTS(&state->pickup_slots, state->pickups, AZ_PUP_NOTHING);
+  RECLAIM_SLOTS(&state->projectile_slots, state->projectiles,
+                AZ_PROJ_NOTHING);
+  RECLAIM_SLOTS_BY_KIND(&state->speck_slots, state->specks.kind[index],
+                        AZ_SPECK_NOTHING);
+}
+
+/*===========================================================================*/
+// Wall grid:
+
+// Return the row or column of the wall grid that contains the given offset
+// from the grid origin, clamped to the edges of the grid.
+static int wall_grid_index(double offset, double cell_size) {
+  const double index = floor(offset / cell_size);
+  if (!(index > 0.0)) return 0; // this also catches NaN
+  if (index >= AZ_WALL_GRID_SIZE - 1) return AZ_WALL_GRID_SIZE - 1;
+  return (int)index;
+}
+
+// Update the wall grid to reflect the wall's current position and kind,
+// assuming that the wall's placement is already up to date.
+static void record_wall_in_grid(az_space_state_t *state,
+                                const az_wall_t *wall) {
+  az_wall_grid_t *grid = &state->wall_grid;
+  const int index = wall - state->walls;
+  assert(0 <= index && index < AZ_ARRAY_SIZE(state->walls));
+  const int word = index / 64;
+  const uint64_t bit = UINT64_C(1) << (index % 64);
+  // Remove the wall from wherever it was recorded before:
+  if (grid->extents[index].recorded) {
+    for (int row = grid->extents[index].min_row;
+         row <= grid->extents[index].max_row; ++row) {
+      for (int col = grid->extents[index].min_col;
+           col <= grid->extents[index].max_col; ++col) {
+        grid->cells[row][col][word] &= ~bit;
+      }
+    }
+    grid->extents[index].recorded = false;
+  }
+  if (wall->kind == AZ_WALL_NOTHING) return;
+  // Record the wall in every cell that its bounding circle overlaps:
+  const double radius = wall->data->bounding_radius;
+  const az_vector_t rel = az_vsub(wall->position, grid->origin);
+  const int min_row = wall_grid_index(rel.y - radius, grid->cell_height);
+  const int max_row = wall_grid_index(rel.y + radius, grid->cell_height);
+  const int min_col = wall_grid_index(rel.x - radius, grid->cell_width);
+  const int max_col = wall_grid_index(rel.x + radius, grid->cell_width);
+  for (int row = min_row; row <= max_row; ++row) {
+    for (int col = min_col; col <= max_col; ++col) {
+      grid->cells[row][col][word] |= bit;
+    }
+  }
+  grid->extents[index].recorded = true;
+  grid->extents[index].min_row = min_row;
+  grid->extents[index].max_row = max_row;
+  grid->extents[index].min_col = min_col;
+  grid->extents[index].max_col = max_col;
+}
+
+void az_update_wall_grid(az_space_state_t *state, az_wall_t *wall) {
+  az_place_wall(wall);
+  record_wall_in_grid(state, wall);
+}
+
+// Lay the wall grid over the room's camera bounds (plus enough margin to
+// cover what the camera can see from the edge of those bounds), and record
+// all current walls (which must already be placed) in it.  (There's no need to
+// zero the grid's cells first, since record_wall_in_grid removes each wall
+// from wherever it was recorded before, and no other cells can have anything
+// in them.)
+static void build_wall_grid(az_space_state_t *state,
+                            const az_camera_bounds_t *bounds) {
+  az_wall_grid_t *grid = &state->wall_grid;
+  grid->last_blocker = 0;
+  // The bounding box of an annular sector is determined by its corners,
+  // together with the points where its outer arc crosses the axes.
+  const double max_r = bounds->min_r + bounds->r_span;
+  const double max_theta = bounds->min_theta + bounds->theta_span;
+  const az_vector_t points[] = {
+    az_vpolar(bounds->min_r, bounds->min_theta),
+    az_vpolar(bounds->min_r, max_theta),
+    az_vpolar(max_r, bounds->min_theta), az_vpolar(max_r, max_theta)
+  };
+  az_vector_t min = points[0], max = points[0];
+  AZ_ARRAY_LOOP(point, points) {
+    min.x = fmin(min.x, point->x); min.y = fmin(min.y, point->y);
+    max.x = fmax(max.x, point->x); max.y = fmax(max.y, point->y);
+  }
+  for (int i = 0; i < 4; ++i) {
+    const double theta = i * AZ_HALF_PI;
+    if (az_mod2pi_nonneg(theta - bounds->min_theta) > bounds->theta_span) {
+      continue;
+    }
+    const az_vector_t point = az_vpolar(max_r, theta);
+    min.x = fmin(min.x, point.x); min.y = fmin(min.y, point.y);
+    max.x = fmax(max.x, point.x); max.y = fmax(max.y, point.y);
+  }
+  const double margin = 0.5 * AZ_SCREEN_WIDTH;
+  grid->origin = (az_vector_t){min.x - margin, min.y - margin};
+  grid->cell_width = (max.x - min.x + 2 * margin) / AZ_WALL_GRID_SIZE;
+  grid->cell_height = (max.y - min.y + 2 * margin) / AZ_WALL_GRID_SIZE;
+  for (int i = 0; i < state->wall_high_water; ++i) {
+    record_wall_in_grid(state, &state->walls[i]);
+  }
+}
+
+// Determine if the wall should be ignored by impact checks with the given
+// skip_types (not counting AZ_IMPF_WALL, which skips all walls).
+static bool skip_wall(const az_wall_t *wall, az_impact_flags_t skip_types) {
+  if (wall->kind == AZ_WALL_NOTHING) return true;
+  return ((skip_types & AZ_IMPF_WEAK_WALL) &&
+          (wall->kind == AZ_WALL_DESTRUCTIBLE_CHARGED ||
+           wall->kind == AZ_WALL_DESTRUCTIBLE_ROCKET));
+}
+
+// Store the walls recorded in the given set of cells (minus any skipped walls)
+// into walls_out, in order of increasing index within the walls array (so
+// that ties between equally near walls are broken just as they would be by
+// looping over the whole array), and return the number of walls stored.
+static int list_wall_candidates(
+    az_space_state_t *state, const uint64_t mask[AZ_WALL_GRID_WORDS],
+    az_impact_flags_t skip_types, az_wall_t *walls_out[AZ_MAX_NUM_WALLS]) {
+  int num_walls = 0;
+  for (int i = 0; i < AZ_WALL_GRID_WORDS; ++i) {
+    for (uint64_t bits = mask[i]; bits != 0; bits &= bits - 1) {
+      az_wall_t *wall = &state->walls[64 * i + __builtin_ctzll(bits)];
+      if (!skip_wall(wall, skip_types)) walls_out[num_walls++] = wall;
+    }
+  }
+  return num_walls;
+}
+
+// Store in mask the union of the wall grid cells that might be touched
+// by a circle of the given radius travelling from start to start + delta (for
+// a ray, use a radius of zero).
+static void swept_wall_mask(
+    const az_space_state_t *state, az_vector_t start, az_vector_t delta,
+    double radius, uint64_t mask[AZ_WALL_GRID_WORDS]) {
+  const az_wall_grid_t *grid = &state->wall_grid;
+  for (int i = 0; i < AZ_WALL_GRID_WORDS; ++i) mask[i] = 0;
+  // Pad the radius slightly so that rounding error can never cause us to
+  // miss a cell that the bounding circle of a hit wall overlaps.
+  radius += 1.0;
+  const az_vector_t rel = az_vsub(start, grid->origin);
+  const int min_row = wall_grid_index(fmin(rel.y, rel.y + delta.y) - radius,
+                                      grid->cell_height);
+  const int max_row = wall_grid_index(fmax(rel.y, rel.y + delta.y) + radius,
+                                      grid->cell_height);
+  for (int row = min_row; row <= max_row; ++row) {
+    // Find the part of the path that lies within this row (the outermost rows
+    // extend forever), and then the columns that that part passes through.
+    double t_min = 0.0, t_max = 1.0;
+    if (delta.y != 0.0) {
+      const double y_lo = (row == 0 ? -INFINITY :
+                           row * grid->cell_height - radius);
+      const double y_hi = (row == AZ_WALL_GRID_SIZE - 1 ? INFINITY :
+                           (row + 1) * grid->cell_height + radius);
+      const double t_lo = (y_lo - rel.y) / delta.y;
+      const double t_hi = (y_hi - rel.y) / delta.y;
+      t_min = fmax(t_min, fmin(t_lo, t_hi));
+      t_max = fmin(t_max, fmax(t_lo, t_hi));
+      if (t_min > t_max) continue;
+    }
+    const double x_min = rel.x + delta.x * t_min;
+    const double x_max = rel.x + delta.x * t_max;
+    const int min_col =
+      wall_grid_index(fmin(x_min, x_max) - radius, grid->cell_width);
+    const int max_col =
+      wall_grid_index(fmax(x_min, x_max) + radius, grid->cell_width);
+    for (int col = min_col; col <= max_col; ++col) {
+      for (int i = 0; i < AZ_WALL_GRID_WORDS; ++i) {
+        mask[i] |= grid->cells[row][col][i];
+      }
+    }
+  }
+}
+
+// Find the walls that might be hit by a circle of the given radius travelling
+// from start to start + delta (for a ray, use a radius of zero), as for
+// list_wall_candidates.
+static int swept_wall_candidates(
+    az_space_state_t *state, az_vector_t start, az_vector_t delta,
+    double radius, az_impact_flags_t skip_types,
+    az_wall_t *walls_out[AZ_MAX_NUM_WALLS]) {
+  uint64_t mask[AZ_WALL_GRID_WORDS];
+  swept_wall_mask(state, start, delta, radius, mask);
+  return list_wall_candidates(state, mask, skip_types, walls_out);
+}
+
+// Find the walls that might be hit by a circle sweeping along an arc, as for
+// list_wall_candidates.
+static int arc_wall_candidates(
+    az_space_state_t *state, const az_arc_sweep_t *sweep,
+    az_impact_flags_t skip_types, az_wall_t *walls_out[AZ_MAX_NUM_WALLS]) {
+  const az_wall_grid_t *grid = &state->wall_grid;
+  uint64_t mask[AZ_WALL_GRID_WORDS] = {0};
+  // Use the bounding box of the swept region (padded as in
+  // swept_wall_candidates).
+  const az_vector_t rel_min = az_vsub(sweep->min, grid->origin);
+  const az_vector_t rel_max = az_vsub(sweep->max, grid->origin);
+  const int min_row = wall_grid_index(rel_min.y - 1.0, grid->cell_height);
+  const int max_row = wall_grid_index(rel_max.y + 1.0, grid->cell_height);
+  const int min_col = wall_grid_index(rel_min.x - 1.0, grid->cell_width);
+  const int max_col = wall_grid_index(rel_max.x + 1.0, grid->cell_width);
+  for (int row = min_row; row <= max_row; ++row) {
+    for (int col = min_col; col <= max_col; ++col) {
+      for (int i = 0; i < AZ_WALL_GRID_WORDS; ++i) {
+        mask[i] |= grid->cells[row][col][i];
+      }
+    }
+  }
+  return list_wall_candidates(state, mask, skip_types, walls_out);
+}
+
+/*===========================================================================*/
+// Baddie sweep:
+
+AZ_STATIC_ASSERT(AZ_MAX_NUM_BADDIES <= 64);
+
+// A bitset with a bit set for every index in the baddies array:
+#define ALL_BADDIES_MASK (UINT64_MAX >> (64 - AZ_MAX_NUM_BADDIES))
+
+void az_build_baddie_sweep(az_space_state_t *state) {
+  az_baddie_sweep_t *sweep = &state->baddie_sweep;
+  sweep->unindexed = 0;
+  // Start from the previous order, minus any baddies that have since been
+  // removed, and then add any new baddies at the end.  Baddies only move a
+  // little from one frame to the next, so the list will then be nearly
+  // sorted, and the insertion sort below will have very little to do.
+  uint64_t listed = 0;
+  int num_entries = 0;
+  for (int i = 0; i < sweep->num_entries; ++i) {
+    const int index = sweep->entries[i].index;
+    if (state->baddies[index].kind == AZ_BAD_NOTHING) continue;
+    listed |= UINT64_C(1) << index;
+    sweep->entries[num_entries++].index = index;
+  }
+  for (int i = 0; i < state->baddie_slots.num_live; ++i) {
+    const int index = state->baddie_slots.live[i];
+    if (state->baddies[index].kind == AZ_BAD_NOTHING) continue;
+    if (listed & (UINT64_C(1) << index)) continue;
+    sweep->entries[num_entries++].index = index;
+  }
+  // Update each entry's bounds and extents.  A baddie whose position isn't
+  // finite can't be sorted sensibly, so leave it out and always test it
+  // instead.  The hit functions test both the baddie's overall bounding circle
+  // and its bounds for its current pose, so the extents need only cover the
+  // intersection of the two.
+  int num_sorted = 0;
+  sweep->max_width = 0.0;
+  for (int i = 0; i < num_entries; ++i) {
+    az_baddie_extent_t entry = sweep->entries[i];
+    const az_baddie_t *baddie = &state->baddies[entry.index];
+    const double radius = baddie->data->overall_bounding_radius;
+    entry.min_x = baddie->position.x - radius;
+    entry.max_x = baddie->position.x + radius;
+    if (!isfinite(entry.min_x) || !isfinite(entry.max_x)) {
+      sweep->unindexed |= UINT64_C(1) << entry.index;
+      continue;
+    }
+    az_baddie_bounds_t *bounds = &sweep->bounds[entry.index];
+    az_get_baddie_bounds(baddie, bounds);
+    entry.min_x = fmax(entry.min_x, bounds->center.x - bounds->radius);
+    entry.max_x = fmin(entry.max_x, bounds->center.x + bounds->radius);
+    sweep->max_width = fmax(sweep->max_width, entry.max_x - entry.min_x);
+    // Insertion sort by min_x:
+    int j = num_sorted++;
+    for (; j > 0 && sweep->entries[j - 1].min_x > entry.min_x; --j) {
+      sweep->entries[j] = sweep->entries[j - 1];
+    }
+    sweep->entries[j] = entry;
+  }
+  sweep->num_entries = num_sorted;
+  // Sort the same baddies by position.  The entries are already sorted by
+  // min_x, which (since most baddies are about the same size) is nearly the
+  // same order, so again the insertion sort has little to do.
+  for (int i = 0; i < num_sorted; ++i) {
+    const int index = sweep->entries[i].index;
+    const az_baddie_point_t point = {
+      .position = state->baddies[index].position, .index = index
+    };
+    int j = i;
+    for (; j > 0 && sweep->points[j - 1].position.x > point.position.x; --j) {
+      sweep->points[j] = sweep->points[j - 1];
+    }
+    sweep->points[j] = point;
+  }
+  sweep->num_points = num_sorted;
+  sweep->valid = true;
+}
+
+void az_invalidate_baddie_sweep(az_space_state_t *state) {
+  state->baddie_sweep.valid = false;
+}
+
+void az_update_baddie_sweep(az_space_state_t *state,
+                            const az_baddie_t *baddie) {
+  const int index = baddie - state->baddies;
+  assert(0 <= index && index < AZ_ARRAY_SIZE(state->baddies));
+  state->baddie_sweep.unindexed |= UINT64_C(1) << index;
+}
+
+const az_baddie_bounds_t *az_get_indexed_baddie_bounds(
+    const az_space_state_t *state, const az_baddie_t *baddie) {
+  const int index = baddie - state->baddies;
+  assert(0 <= index && index < AZ_ARRAY_SIZE(state->baddies));
+  const az_baddie_sweep_t *sweep = &state->baddie_sweep;
+  if (!sweep->valid || (sweep->unindexed & (UINT64_C(1) << index))) {
+    return NULL;
+  }
+  return &sweep->bounds[index];
+}
+
+// Return a bitset of indices into the baddies array, marking the baddies
+// whose bounding circles might overlap the given range of x values.  Looping
+// over the set bits visits baddies in the same order as looping over the
+// whole array would, so ties between equally near baddies are unaffected.
+static uint64_t baddie_candidates(const az_space_state_t *state,
+                                  double min_x, double max_x) {
+  const az_baddie_sweep_t *sweep = &state->baddie_sweep;
+  if (!sweep->valid || !(min_x <= max_x)) return ALL_BADDIES_MASK;
+  // Pad the range slightly, as in swept_wall_candidates.
+  min_x -= 1.0;
+  max_x += 1.0;
+  // No entry that starts more than max_width before min_x can reach min_x,
+  // so binary search for the first entry that starts after that.
+  const double start_x = min_x - sweep->max_width;
+  int lo = 0, hi = sweep->num_entries;
+  while (lo < hi) {
+    const int mid = lo + (hi - lo) / 2;
+    if (sweep->entries[mid].min_x < start_x) lo = mid + 1;
+    else hi = mid;
+  }
+  uint64_t mask = sweep->unindexed;
+  for (int i = lo; i < sweep->num_entries; ++i) {
+    const az_baddie_extent_t *entry = &sweep->entries[i];
+    if (entry->min_x > max_x) break;
+    if (entry->max_x >= min_x) mask |= UINT64_C(1) << entry->index;
+  }
+  return mask;
+}
+
+// Return the index of the first of the sweep's points whose x-coordinate is
+// not less than x (or num_points if there is no such point).
+static int first_point_from(const az_baddie_sweep_t *sweep, double x) {
+  int lo = 0, hi = sweep->num_points;
+  while (lo < hi) {
+    const int mid = lo + (hi - lo) / 2;
+    if (sweep->points[mid].position.x < x) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+uint64_t az_baddies_near(const az_space_state_t *state, az_vector_t point,
+                         double max_dist) {
+  const az_baddie_sweep_t *sweep = &state->baddie_sweep;
+  if (!sweep->valid || !isfinite(point.x) || !isfinite(point.y) ||
+      !(max_dist >= 0.0)) {
+    return ALL_BADDIES_MASK;
+  }
+  // Pad the distance slightly, as in baddie_candidates.
+  const double reach = max_dist + 1.0;
+  uint64_t mask = sweep->unindexed;
+  for (int i = first_point_from(sweep, point.x - reach);
+       i < sweep->num_points; ++i) {
+    const az_baddie_point_t *sweep_point = &sweep->points[i];
+    if (sweep_point->position.x > point.x + reach) break;
+    if (fabs(sweep_point->position.y - point.y) <= reach) {
+      mask |= UINT64_C(1) << sweep_point->index;
+    }
+  }
+  return mask;
+}
+
+typedef struct {
+  az_vector_t start;
+  az_baddie_flags_t skip_flags;
+  az_uid_t skip_uid;
+  bool in_cone;
+  double angle, limit;
+} nearest_query_t;
+
+typedef struct {
+  int count, max_count;
+  double dists[AZ_MAX_NUM_BADDIES];
+  int indices[AZ_MAX_NUM_BADDIES];
+} nearest_results_t;
+
+// Return true if a baddie at dist1 with index1 should come before one at
+// dist2 with index2 in nearest-baddie results.  Ties are broken by index so
+// that the order in which baddies are considered doesn't matter.
+static bool nearer(double dist1, int index1, double dist2, int index2) {
+  return dist1 < dist2 || (dist1 == dist2 && index1 < index2);
+}
+
+// Add the baddie with the given index to the results if it matches the query
+// and is nearer than the farthest result so far (or if there's still room).
+static void consider_nearest(
+    const az_space_state_t *state, const nearest_query_t *query, int index,
+    nearest_results_t *results) {
+  const az_baddie_t *baddie = &state->baddies[index];
+  if (baddie->kind == AZ_BAD_NOTHING) return;
+  if (baddie->uid == query->skip_uid) return;
+  if (az_baddie_has_flag(baddie, query->skip_flags)) return;
+  const az_vector_t delta = az_vsub(baddie->position, query->start);
+  const double dist = az_vnorm(delta);
+  if (!(dist < INFINITY)) return;
+  if (query->in_cone &&
+      !(fabs(az_mod2pi(az_vtheta(delta) - query->angle)) <= query->limit)) {
+    return;
+  }
+  // If the results are full, bump the farthest one (if this baddie is nearer
+  // than it), and then insertion sort the baddie into place.
+  int i = results->count;
+  if (i == results->max_count) {
+    if (!nearer(dist, index, results->dists[i - 1], results->indices[i - 1])) {
+      return;
+    }
+    --i;
+  } else ++results->count;
+  for (; i > 0 && nearer(dist, index, results->dists[i - 1],
+                         results->indices[i - 1]); --i) {
+    results->dists[i] = results->dists[i - 1];
+    results->indices[i] = results->indices[i - 1];
+  }
+  results->dists[i] = dist;
+  results->indices[i] = index;
+}
+
+// Find the baddies nearest to the query's start point that match the query,
+// storing them in the results.
+static void find_nearest(const az_space_state_t *state,
+                         const nearest_query_t *query,
+                         nearest_results_t *results) {
+  const az_baddie_sweep_t *sweep = &state->baddie_sweep;
+  if (results->max_count <= 0) return;
+  if (!sweep->valid || !isfinite(query->start.x) ||
+      !isfinite(query->start.y)) {
+    for (int i = 0; i < AZ_MAX_NUM_BADDIES; ++i) {
+      consider_nearest(state, query, i, results);
+    }
+    return;
+  }
+  for (uint64_t bits = sweep->unindexed; bits != 0; bits &= bits - 1) {
+    consider_nearest(state, query, __builtin_ctzll(bits), results);
+  }
+  // Scan outwards from the start point along the x-axis, always taking the
+  // nearer of the next points on either side.  Once the results are full, no
+  // point whose x-coordinate is farther from the start point's than the
+  // farthest result can be any nearer, so we can stop there (padding the
+  // distance slightly, as in baddie_candidates).  Unindexed baddies were
+  // already considered above, so skip their (possibly stale) points.
+  const double x = query->start.x;
+  int right = first_point_from(sweep, x);
+  int left = right - 1;
+  while (left >= 0 || right < sweep->num_points) {
+    const double left_gap =
+      (left >= 0 ? x - sweep->points[left].position.x : INFINITY);
+    const double right_gap = (right < sweep->num_points ?
+                              sweep->points[right].position.x - x : INFINITY);
+    if (results->count == results->max_count &&
+        fmin(left_gap, right_gap) - 1.0 > results->dists[results->count - 1]) {
+      break;
+    }
+    const int index = (left_gap <= right_gap ? sweep->points[left--].index :
+                       sweep->points[right++].index);
+    if (sweep->unindexed & (UINT64_C(1) << index)) continue;
+    consider_nearest(state, query, index, results);
+  }
+}
+
+int az_find_nearest_baddies(
+    const az_space_state_t *state, az_vector_t point,
+    az_baddie_flags_t skip_flags, az_uid_t skip_uid, int max_count,
+    const az_baddie_t **baddies_out) {
+  const nearest_query_t query = {
+    .start = point, .skip_flags = skip_flags, .skip_uid = skip_uid
+  };
+  nearest_results_t results = {
+    .max_count = (max_count < AZ_MAX_NUM_BADDIES ? max_count :
+                  AZ_MAX_NUM_BADDIES)
+  };
+  find_nearest(state, &query, &results);
+  for (int i = 0; i < results.count; ++i) {
+    baddies_out[i] = &state->baddies[results.indices[i]];
+  }
+  return results.count;
+}
+
+const az_baddie_t *az_find_nearest_baddie_in_cone(
+    const az_space_state_t *state, az_vector_t start, double angle,
+    double limit, az_baddie_flags_t skip_flags) {
+  const nearest_query_t query = {
+    .start = start, .skip_flags = skip_flags, .skip_uid = AZ_NULL_UID,
+    .in_cone = true, .angle = angle, .limit = limit
+  };
+  nearest_results_t results = { .max_count = 1 };
+  find_nearest(state, &query, &results);
+  return (results.count > 0 ? &state->baddies[results.indices[0]] : NULL);
+}
+
+/*===========================================================================*/
+// Gravfield index:
+
+AZ_STATIC_ASSERT(AZ_MAX_NUM_GRAVFIELDS <= 64);
+
+void az_update_gravfield_index(az_space_state_t *state,
+                               const az_gravfield_t *gravfield) {
+  const int index = gravfield - state->gravfields;
+  assert(0 <= index && index < AZ_ARRAY_SIZE(state->gravfields));
+  assert(gravfield->kind != AZ_GRAV_NOTHING);
+  az_gravfield_index_t *gravfield_index = &state->gravfield_index;
+  az_gravfield_bounds(gravfield, &gravfield_index->bounds[index].min,
+                      &gravfield_index->bounds[index].max);
+  const uint64_t bit = UINT64_C(1) << index;
+  if (az_is_liquid(gravfield->kind)) gravfield_index->liquids |= bit;
+  else gravfield_index->liquids &= ~bit;
+}
+
+// Return false if the box from min to max definitely doesn't overlap the
+// gravfield's bounds.  (The comparisons are written so that NaNs give true.)
+static bool gravfield_bounds_overlap(const az_space_state_t *state, int index,
+                                     az_vector_t min, az_vector_t max) {
+  const az_vector_t bounds_min = state->gravfield_index.bounds[index].min;
+  const az_vector_t bounds_max = state->gravfield_index.bounds[index].max;
+  return !(max.x < bounds_min.x || min.x > bounds_max.x ||
+           max.y < bounds_min.y || min.y > bounds_max.y);
+}
+
+bool az_gravfield_might_contain(const az_space_state_t *state,
+                                const az_gravfield_t *gravfield,
+                                az_vector_t point) {
+  const int index = gravfield - state->gravfields;
+  assert(0 <= index && index < AZ_ARRAY_SIZE(state->gravfields));
+  return gravfield_bounds_overlap(state, index, point, point);
+}
+
+uint64_t az_liquid_candidates(const az_space_state_t *state, double radius,
+                              az_vector_t start, az_vector_t delta) {
+  const az_vector_t end = az_vadd(start, delta);
+  const az_vector_t min = {fmin(start.x, end.x) - radius,
+                           fmin(start.y, end.y) - radius};
+  const az_vector_t max = {fmax(start.x, end.x) + radius,
+                           fmax(start.y, end.y) + radius};
+  uint64_t mask = 0;
+  for (uint64_t bits = state->gravfield_index.liquids; bits != 0;
+       bits &= bits - 1) {
+    const int index = __builtin_ctzll(bits);
+    if (gravfield_bounds_overlap(state, index, min, max)) {
+      mask |= UINT64_C(1) << index;
+    }
+  }
+  return mask;
 }
 
 static void put_uuid(az_space_state_t *state, int slot,
@@ -58,8 +755,112 @@ static void put_uuid(az_space_state_t *state, int slot,
   }
 }
 
+// Copy count elements from source into the start of the array.
+#define COPY_PREFIX(array, source, count) do { \
+    assert((count) <= AZ_ARRAY_SIZE(array)); \
+    if ((count) > 0) memcpy((array), (source), (count) * sizeof((array)[0])); \
+  } while (0)
+
+// Return true if the room can be entered just by copying in its prebuilt
+// objects.  That requires the state to have no room objects (and nothing in
+// its UUID table), and every object slot to still have a null UID, exactly as
+// they were when the room was prebuilt; slots at or above the high water
+// marks haven't been used since the arrays were last cleared, so checking
+// that all the marks are zero covers both.
+static bool can_copy_prebuilt_room(const az_space_state_t *state,
+                                   const az_room_t *room) {
+  if (room->prebuilt == NULL) return false;
+  if (state->baddie_slots.high_water != 0 || state->door_high_water != 0 ||
+      state->gravfield_slots.high_water != 0 || state->node_high_water != 0 ||
+      state->wall_high_water != 0) return false;
+  AZ_ARRAY_LOOP(uuid, state->uuids) {
+    if (uuid->type != AZ_UUID_NOTHING) return false;
+  }
+  return true;
+}
+
+// Change each reference to the node with UID old_uid, in the UUID table and
+// in the first num_baddies baddies' cargo, to refer to new_uid instead, or
+// remove it if new_uid is AZ_NULL_UID.  Removing a cargo UUID shifts the rest
+// down, just as az_enter_room would have filled in the cargo without it.
+static void patch_node_uid(az_space_state_t *state, int num_baddies,
+                           az_uid_t old_uid, az_uid_t new_uid) {
+  AZ_ARRAY_LOOP(uuid, state->uuids) {
+    if (uuid->type != AZ_UUID_NODE || uuid->uid != old_uid) continue;
+    if (new_uid == AZ_NULL_UID) *uuid = AZ_NULL_UUID;
+    else uuid->uid = new_uid;
+  }
+  for (int i = 0; i < num_baddies; ++i) {
+    az_uuid_t *cargo_uuids = state->baddies[i].cargo_uuids;
+    int num_kept = 0;
+    for (int j = 0; j < AZ_MAX_BADDIE_CARGO_UUIDS; ++j) {
+      az_uuid_t cargo = cargo_uuids[j];
+      if (cargo.type == AZ_UUID_NODE && cargo.uid == old_uid) {
+        if (new_uid == AZ_NULL_UID) continue;
+        cargo.uid = new_uid;
+      }
+      cargo_uuids[num_kept++] = cargo;
+    }
+    while (num_kept < AZ_MAX_BADDIE_CARGO_UUIDS) {
+      cargo_uuids[num_kept++] = AZ_NULL_UUID;
+    }
+  }
+}
+
+static void copy_prebuilt_room(az_space_state_t *state,
+                               const az_room_t *room) {
+  const az_prebuilt_room_t *prebuilt = room->prebuilt;
+  COPY_PREFIX(state->uuids, prebuilt->uuids, AZ_NUM_UUID_SLOTS);
+  COPY_PREFIX(state->baddies, prebuilt->baddies, room->num_baddies);
+  for (int i = 0; i < room->num_baddies; ++i) {
+    const int index = TAKE_SLOT(&state->baddie_slots);
+    assert(index == i);
+    az_update_baddie_sweep(state, &state->baddies[index]);
+  }
+  COPY_PREFIX(state->doors, prebuilt->doors, room->num_doors);
+  state->door_high_water = room->num_doors;
+  COPY_PREFIX(state->gravfields, prebuilt->gravfields, room->num_gravfields);
+  for (int i = 0; i < room->num_gravfields; ++i) {
+    const int index = TAKE_SLOT(&state->gravfield_slots);
+    assert(index == i);
+    az_update_gravfield_index(state, &state->gravfields[index]);
+  }
+  // Upgrades that the player already has are left out, which moves any later
+  // nodes down into earlier slots (just as the general path would), so those
+  // nodes get new UIDs, and references to them must be patched.  Nodes only
+  // ever move down, so a patched reference can never match a node that is
+  // still to be patched.
+  int num_nodes = 0;
+  for (int i = 0; i < room->num_nodes; ++i) {
+    const az_node_t *node = &prebuilt->nodes[i];
+    az_uid_t new_uid = AZ_NULL_UID;
+    if (node->kind != AZ_NODE_UPGRADE ||
+        !az_has_upgrade(&state->ship.player, node->subkind.upgrade)) {
+      az_node_t *copy = &state->nodes[num_nodes];
+      *copy = *node;
+      if (num_nodes != i) {
+        copy->uid = AZ_NULL_UID;
+        az_assign_uid(num_nodes, &copy->uid);
+      }
+      new_uid = copy->uid;
+      ++num_nodes;
+    }
+    if (new_uid != node->uid) {
+      patch_node_uid(state, room->num_baddies, node->uid, new_uid);
+    }
+  }
+  state->node_high_water = num_nodes;
+  COPY_PREFIX(state->walls, prebuilt->walls, room->num_walls);
+  state->wall_high_water = room->num_walls;
+  build_wall_grid(state, &room->camera_bounds);
+}
+
 void az_enter_room(az_space_state_t *state, const az_room_t *room) {
   state->darkness = state->dark_goal = 0.0;
+  if (can_copy_prebuilt_room(state, room)) {
+    copy_prebuilt_room(state, room);
+    return;
+  }
   // Make a map from UUID table indices to the baddie (if any) carrying that
   // object as cargo.
   az_baddie_t *cargo_carriers[AZ_NUM_UUID_SLOTS];
@@ -81,86 +882,100 @@ void az_enter_room(az_space_state_t *state, const az_room_t *room) {
       }
     }
   }
+  // Doors, nodes, and walls each go into the first empty slot of their array.
+  // No slot before that one can become empty while we're adding objects, so
+  // rather than searching the whole array for each object, keep a cursor that
+  // just moves past filled slots.  This makes entering a room with hundreds
+  // of walls linear rather than quadratic in the number of walls.
+  int door_cursor = 0;
   for (int i = 0; i < room->num_doors; ++i) {
     const az_door_spec_t *spec = &room->doors[i];
-    AZ_ARRAY_LOOP(door, state->doors) {
-      if (door->kind == AZ_DOOR_NOTHING) {
-        door->kind = spec->kind;
-        az_assign_uid(door - state->doors, &door->uid);
-        put_uuid(state, spec->uuid_slot, AZ_UUID_DOOR, door->uid);
-        door->on_open = spec->on_open;
-        door->position = spec->position;
-        door->angle = spec->angle;
-        door->destination = spec->destination;
-        door->is_open = (spec->kind == AZ_DOOR_PASSAGE ||
-                         spec->kind == AZ_DOOR_ALWAYS_OPEN);
-        door->openness = (door->is_open ? 1.0 : 0.0);
-        door->lockedness = (spec->kind == AZ_DOOR_LOCKED ? 1.0 : 0.0);
-        const az_room_flags_t dest_flags =
-          state->planet->rooms[spec->destination].properties;
-        if (dest_flags & AZ_ROOMF_WITH_SAVE) {
-          door->marker = AZ_DOORMARK_SAVE;
-        } else if (dest_flags & AZ_ROOMF_WITH_REFILL) {
-          door->marker = AZ_DOORMARK_REFILL;
-        } else if (dest_flags & AZ_ROOMF_WITH_COMM) {
-          door->marker = AZ_DOORMARK_COMM;
-        }
-        break;
-      }
+    while (door_cursor < AZ_ARRAY_SIZE(state->doors) &&
+           state->doors[door_cursor].kind != AZ_DOOR_NOTHING) ++door_cursor;
+    if (door_cursor >= AZ_ARRAY_SIZE(state->doors)) break;
+    az_door_t *door = &state->doors[door_cursor++];
+    door->kind = spec->kind;
+    az_assign_uid(door - state->doors, &door->uid);
+    put_uuid(state, spec->uuid_slot, AZ_UUID_DOOR, door->uid);
+    door->on_open = spec->on_open;
+    door->position = spec->position;
+    door->angle = spec->angle;
+    door->destination = spec->destination;
+    door->is_open = (spec->kind == AZ_DOOR_PASSAGE ||
+                     spec->kind == AZ_DOOR_ALWAYS_OPEN);
+    door->openness = (door->is_open ? 1.0 : 0.0);
+    door->lockedness = (spec->kind == AZ_DOOR_LOCKED ? 1.0 : 0.0);
+    const az_room_flags_t dest_flags =
+      state->planet->rooms[spec->destination].properties;
+    if (dest_flags & AZ_ROOMF_WITH_SAVE) {
+      door->marker = AZ_DOORMARK_SAVE;
+    } else if (dest_flags & AZ_ROOMF_WITH_REFILL) {
+      door->marker = AZ_DOORMARK_REFILL;
+    } else if (dest_flags & AZ_ROOMF_WITH_COMM) {
+      door->marker = AZ_DOORMARK_COMM;
     }
   }
+  state->door_high_water = az_imax(state->door_high_water, door_cursor);
   for (int i = 0; i < room->num_gravfields; ++i) {
     const az_gravfield_spec_t *spec = &room->gravfields[i];
     assert(spec->strength == 1.0 || !az_is_liquid(spec->kind));
-    AZ_ARRAY_LOOP(gravfield, state->gravfields) {
-      if (gravfield->kind == AZ_GRAV_NOTHING) {
-        gravfield->kind = spec->kind;
-        az_assign_uid(gravfield - state->gravfields, &gravfield->uid);
-        put_uuid(state, spec->uuid_slot, AZ_UUID_GRAVFIELD, gravfield->uid);
-        gravfield->on_enter = spec->on_enter;
-        gravfield->position = spec->position;
-        gravfield->angle = spec->angle;
-        gravfield->strength = spec->strength;
-        gravfield->size = spec->size;
-        gravfield->age = 0.0;
-        gravfield->script_fired = false;
-        break;
-      }
-    }
+    const int index = TAKE_SLOT(&state->gravfield_slots);
+    if (index < 0) break;
+    az_gravfield_t *gravfield = &state->gravfields[index];
+    assert(gravfield->kind == AZ_GRAV_NOTHING);
+    gravfield->kind = spec->kind;
+    az_assign_uid(index, &gravfield->uid);
+    put_uuid(state, spec->uuid_slot, AZ_UUID_GRAVFIELD, gravfield->uid);
+    gravfield->on_enter = spec->on_enter;
+    gravfield->position = spec->position;
+    gravfield->angle = spec->angle;
+    gravfield->strength = spec->strength;
+    gravfield->size = spec->size;
+    gravfield->age = 0.0;
+    gravfield->script_fired = false;
+    az_update_gravfield_index(state, gravfield);
   }
+  int node_cursor = 0;
   for (int i = 0; i < room->num_nodes; ++i) {
     const az_node_spec_t *spec = &room->nodes[i];
     if (spec->kind == AZ_NODE_UPGRADE &&
         az_has_upgrade(&state->ship.player, spec->subkind.upgrade)) continue;
-    AZ_ARRAY_LOOP(node, state->nodes) {
-      if (node->kind == AZ_NODE_NOTHING) {
-        node->kind = spec->kind;
-        node->subkind = spec->subkind;
-        az_assign_uid(node - state->nodes, &node->uid);
-        put_uuid(state, spec->uuid_slot, AZ_UUID_NODE, node->uid);
-        node->on_use = spec->on_use;
-        node->position = spec->position;
-        node->angle = spec->angle;
-        node->status = AZ_NS_FAR;
-        break;
-      }
-    }
+    while (node_cursor < AZ_ARRAY_SIZE(state->nodes) &&
+           state->nodes[node_cursor].kind != AZ_NODE_NOTHING) ++node_cursor;
+    if (node_cursor >= AZ_ARRAY_SIZE(state->nodes)) break;
+    az_node_t *node = &state->nodes[node_cursor++];
+    node->kind = spec->kind;
+    node->subkind = spec->subkind;
+    az_assign_uid(node - state->nodes, &node->uid);
+    put_uuid(state, spec->uuid_slot, AZ_UUID_NODE, node->uid);
+    node->on_use = spec->on_use;
+    node->position = spec->position;
+    node->angle = spec->angle;
+    node->status = AZ_NS_FAR;
   }
+  state->node_high_water = az_imax(state->node_high_water, node_cursor);
+  int wall_cursor = 0;
   for (int i = 0; i < room->num_walls; ++i) {
     const az_wall_spec_t *spec = &room->walls[i];
-    AZ_ARRAY_LOOP(wall, state->walls) {
-      if (wall->kind == AZ_WALL_NOTHING) {
-        wall->kind = spec->kind;
-        wall->data = spec->data;
-        az_assign_uid(wall - state->walls, &wall->uid);
-        put_uuid(state, spec->uuid_slot, AZ_UUID_WALL, wall->uid);
-        wall->position = spec->position;
-        wall->angle = spec->angle;
-        wall->flare = 0.0;
-        break;
-      }
+    while (wall_cursor < AZ_ARRAY_SIZE(state->walls) &&
+           state->walls[wall_cursor].kind != AZ_WALL_NOTHING) ++wall_cursor;
+    if (wall_cursor >= AZ_ARRAY_SIZE(state->walls)) {
+      AZ_WARNING_ONCE("Failed to add wall; array is full.\n");
+      count_dropped(state, AZ_POOL_WALLS);
+      continue;
     }
+    az_wall_t *wall = &state->walls[wall_cursor++];
+    wall->kind = spec->kind;
+    wall->data = spec->data;
+    az_assign_uid(wall - state->walls, &wall->uid);
+    put_uuid(state, spec->uuid_slot, AZ_UUID_WALL, wall->uid);
+    wall->position = spec->position;
+    wall->angle = spec->angle;
+    wall->flare = 0.0;
+    az_place_wall(wall);
   }
+  state->wall_high_water = az_imax(state->wall_high_water, wall_cursor);
+  build_wall_grid(state, &room->camera_bounds);
   // Now that all objects are inserted and the UUID table is populated, fill in
   // each baddie's cargo table:
   for (int i = 0; i < AZ_ARRAY_SIZE(cargo_carriers); ++i) {
@@ -176,6 +991,48 @@ void az_enter_room(az_space_state_t *state, const az_room_t *room) {
   }
 }
 
+// Return a newly allocated copy of the first count elements of the array, or
+// NULL if count is zero.
+#define CLONE_PREFIX(array, count) \
+  clone_memory((array), (count), sizeof((array)[0]))
+
+static void *clone_memory(const void *source, int count, size_t size) {
+  assert(count >= 0);
+  if (count == 0) return NULL;
+  void *clone = AZ_ALLOC(count * size, char);
+  memcpy(clone, source, count * size);
+  return clone;
+}
+
+void az_prebuild_rooms(az_planet_t *planet) {
+  // Enter each room (by the general path, since the room isn't prebuilt yet)
+  // into a scratch state whose player has no upgrades, so that no nodes are
+  // left out, and save the resulting objects.
+  az_space_state_t *scratch = AZ_ALLOC(1, az_space_state_t);
+  scratch->planet = planet;
+  for (int i = 0; i < planet->num_rooms; ++i) {
+    az_room_t *room = &planet->rooms[i];
+    assert(room->prebuilt == NULL);
+    az_clear_space(scratch);
+    az_enter_room(scratch, room);
+    assert(scratch->baddie_slots.high_water == room->num_baddies);
+    assert(scratch->door_high_water == room->num_doors);
+    assert(scratch->gravfield_slots.high_water == room->num_gravfields);
+    assert(scratch->node_high_water == room->num_nodes);
+    assert(scratch->wall_high_water == room->num_walls);
+    az_prebuilt_room_t *prebuilt = AZ_ALLOC(1, az_prebuilt_room_t);
+    prebuilt->baddies = CLONE_PREFIX(scratch->baddies, room->num_baddies);
+    prebuilt->doors = CLONE_PREFIX(scratch->doors, room->num_doors);
+    prebuilt->gravfields =
+      CLONE_PREFIX(scratch->gravfields, room->num_gravfields);
+    prebuilt->nodes = CLONE_PREFIX(scratch->nodes, room->num_nodes);
+    prebuilt->walls = CLONE_PREFIX(scratch->walls, room->num_walls);
+    memcpy(prebuilt->uuids, scratch->uuids, sizeof(prebuilt->uuids));
+    room->prebuilt = prebuilt;
+  }
+  free(scratch);
+}
+
 /*===========================================================================*/
 
 void az_set_message(az_space_state_t *state, const char *paragraph) {
@@ -189,61 +1046,119 @@ void az_set_message(az_space_state_t *state, const char *paragraph) {
 
 az_baddie_t *az_add_baddie(az_space_state_t *state, az_baddie_kind_t kind,
                            az_vector_t position, double angle) {
-  AZ_ARRAY_LOOP(baddie, state->baddies) {
-    if (baddie->kind == AZ_BAD_NOTHING) {
-      az_assign_uid(baddie - state->baddies, &baddie->uid);
-      az_init_baddie(baddie, kind, position, angle);
-      return baddie;
-    }
+  const int index = TAKE_SLOT(&state->baddie_slots);
+  if (index < 0) {
+    AZ_WARNING_ONCE("Failed to add baddie (kind=%d); array is full.\n",
+                    (int)kind);
+    count_dropped(state, AZ_POOL_BADDIES);
+    return NULL;
   }
-  AZ_WARNING_ONCE("Failed to add baddie (kind=%d); array is full.\n",
-                  (int)kind);
-  return NULL;
+  az_baddie_t *baddie = &state->baddies[index];
+  assert(baddie->kind == AZ_BAD_NOTHING);
+  az_assign_uid(index, &baddie->uid);
+  az_init_baddie(baddie, kind, position, angle);
+  az_update_baddie_sweep(state, baddie);
+  return baddie;
 }
 
 bool az_insert_particle(az_space_state_t *state,
-                        az_particle_t **particle_out) {
-  AZ_ARRAY_LOOP(particle, state->particles) {
-    if (particle->kind == AZ_PAR_NOTHING) {
-      particle->age = 0.0;
-      *particle_out = particle;
-      return true;
-    }
+                        az_particle_t *particle_out) {
+  if (!HAS_FREE_SLOT(&state->particle_slots)) {
+    AZ_WARNING_ONCE("Failed to insert particle; array is full.\n");
+    count_dropped(state, AZ_POOL_PARTICLES);
+    return false;
   }
-  AZ_WARNING_ONCE("Failed to insert particle; array is full.\n");
-  return false;
+  AZ_ZERO_OBJECT(particle_out);
+  return true;
+}
+
+void az_add_particle(az_space_state_t *state, const az_particle_t *particle) {
+  assert(particle->kind != AZ_PAR_NOTHING);
+  const int index = TAKE_SLOT(&state->particle_slots);
+  if (index < 0) {
+    AZ_WARNING_ONCE("Failed to insert particle; array is full.\n");
+    count_dropped(state, AZ_POOL_PARTICLES);
+    return;
+  }
+  az_particle_array_t *particles = &state->particles;
+  assert(particles->kind[index] == AZ_PAR_NOTHING);
+  particles->kind[index] = particle->kind;
+  particles->color[index] = particle->color;
+  particles->x[index] = particle->position.x;
+  particles->y[index] = particle->position.y;
+  particles->vx[index] = particle->velocity.x;
+  particles->vy[index] = particle->velocity.y;
+  particles->angle[index] = particle->angle;
+  particles->age[index] = particle->age;
+  particles->lifetime[index] = particle->lifetime;
+  particles->param1[index] = particle->param1;
+  particles->param2[index] = particle->param2;
+}
+
+void az_get_particle(const az_space_state_t *state, int index,
+                     az_particle_t *particle_out) {
+  assert(0 <= index && index < AZ_MAX_NUM_PARTICLES);
+  const az_particle_array_t *particles = &state->particles;
+  particle_out->kind = particles->kind[index];
+  particle_out->color = particles->color[index];
+  particle_out->position =
+    (az_vector_t){particles->x[index], particles->y[index]};
+  particle_out->velocity =
+    (az_vector_t){particles->vx[index], particles->vy[index]};
+  particle_out->angle = particles->angle[index];
+  particle_out->age = particles->age[index];
+  particle_out->lifetime = particles->lifetime[index];
+  particle_out->param1 = particles->param1[index];
+  particle_out->param2 = particles->param2[index];
 }
 
 void az_add_beam(az_space_state_t *state, az_color_t color, az_vector_t start,
                  az_vector_t end, double lifetime, double semiwidth) {
-  az_particle_t *particle;
+  az_particle_t particle;
   if (az_insert_particle(state, &particle)) {
-    particle->kind = AZ_PAR_BEAM;
-    particle->color = color;
-    particle->position = start;
-    particle->velocity = AZ_VZERO;
+    particle.kind = AZ_PAR_BEAM;
+    particle.color = color;
+    particle.position = start;
+    particle.velocity = AZ_VZERO;
     const az_vector_t delta = az_vsub(end, start);
-    particle->angle = az_vtheta(delta);
-    particle->lifetime = lifetime;
-    particle->param1 = az_vnorm(delta);
-    particle->param2 = semiwidth;
+    particle.angle = az_vtheta(delta);
+    particle.lifetime = lifetime;
+    particle.param1 = az_vnorm(delta);
+    particle.param2 = semiwidth;
+    az_add_particle(state, &particle);
   }
 }
 
 void az_add_speck(az_space_state_t *state, az_color_t color, double lifetime,
                   az_vector_t position, az_vector_t velocity) {
-  AZ_ARRAY_LOOP(speck, state->specks) {
-    if (speck->kind == AZ_SPECK_NOTHING) {
-      speck->kind = AZ_SPECK_NORMAL;
-      speck->color = color;
-      speck->position = position;
-      speck->velocity = velocity;
-      speck->age = 0.0;
-      speck->lifetime = lifetime;
-      return;
-    }
+  const int index = TAKE_SLOT(&state->speck_slots);
+  if (index < 0) {
+    AZ_WARNING_ONCE("Failed to add speck; array is full.\n");
+    count_dropped(state, AZ_POOL_SPECKS);
+    return;
   }
-  AZ_WARNING_ONCE("Failed to add speck; array is full.\n");
+  az_speck_array_t *specks = &state->specks;
+  assert(specks->kind[index] == AZ_SPECK_NOTHING);
+  specks->kind[index] = AZ_SPECK_NORMAL;
+  specks->color[index] = color;
+  specks->x[index] = position.x;
+  specks->y[index] = position.y;
+  specks->vx[index] = velocity.x;
+  specks->vy[index] = velocity.y;
+  specks->age[index] = 0.0;
+  specks->lifetime[index] = lifetime;
+}
+
+void az_get_speck(const az_space_state_t *state, int index,
+                  az_speck_t *speck_out) {
+  assert(0 <= index && index < AZ_MAX_NUM_SPECKS);
+  const az_speck_array_t *specks = &state->specks;
+  speck_out->kind = specks->kind[index];
+  speck_out->color = specks->color[index];
+  speck_out->position = (az_vector_t){specks->x[index], specks->y[index]};
+  speck_out->velocity = (az_vector_t){specks->vx[index], specks->vy[index]};
+  speck_out->age = specks->age[index];
+  speck_out->lifetime = specks->lifetime[index];
 }
 
 void az_add_sploosh(az_space_state_t *state, const az_gravfield_t *gravfield,
@@ -252,39 +1167,49 @@ void az_add_sploosh(az_space_state_t *state, const az_gravfield_t *gravfield,
   if (az_vdot(normal, az_vpolar(1, gravfield->angle)) < 0) {
     normal = az_vneg(normal);
   }
-  az_particle_t *particle;
+  az_particle_t particle;
   if (az_insert_particle(state, &particle)) {
-    particle->kind = AZ_PAR_SPLOOSH;
-    particle->position = position;
-    particle->angle = az_vtheta(normal);
-    particle->velocity = AZ_VZERO;
-    particle->param1 =
+    particle.kind = AZ_PAR_SPLOOSH;
+    particle.position = position;
+    particle.angle = az_vtheta(normal);
+    particle.velocity = AZ_VZERO;
+    particle.param1 =
       4.0 * sqrt(fabs(az_vdot(velocity, az_vunit(normal))));
-    particle->param2 = radius;
-    particle->lifetime = 0.1 * sqrt(particle->param1);
+    particle.param2 = radius;
+    particle.lifetime = 0.1 * sqrt(particle.param1);
     if (gravfield->kind == AZ_GRAV_WATER) {
-      particle->color = (az_color_t){167, 205, 255, 192};
+      particle.color = (az_color_t){167, 205, 255, 192};
     } else {
       assert(gravfield->kind == AZ_GRAV_LAVA);
-      particle->color = (az_color_t){255, 205, 167, 192};
-      particle->param1 *= 0.5;
-      particle->lifetime *= 1.5;
+      particle.color = (az_color_t){255, 205, 167, 192};
+      particle.param1 *= 0.5;
+      particle.lifetime *= 1.5;
     }
+    az_add_particle(state, &particle);
   }
 }
 
 az_projectile_t *az_add_projectile(
     az_space_state_t *state, az_proj_kind_t kind, az_vector_t position,
     double angle, double power, az_uid_t fired_by) {
-  AZ_ARRAY_LOOP(proj, state->projectiles) {
-    if (proj->kind == AZ_PROJ_NOTHING) {
-      az_init_projectile(proj, kind, position, angle, power, fired_by);
-      return proj;
-    }
+  const int index = TAKE_SLOT(&state->projectile_slots);
+  if (index < 0) {
+    AZ_WARNING_ONCE("Failed to add projectile (kind=%d); array is full.\n",
+                    (int)kind);
+    count_dropped(state, AZ_POOL_PROJECTILES);
+    return NULL;
   }
-  AZ_WARNING_ONCE("Failed to add projectile (kind=%d); array is full.\n",
-                  (int)kind);
-  return NULL;
+  az_projectile_t *proj = &state->projectiles[index];
+  assert(proj->kind == AZ_PROJ_NOTHING);
+  az_init_projectile(proj, kind, position, angle, power, fired_by);
+  return proj;
+}
+
+void az_remove_projectile(az_space_state_t *state, az_projectile_t *proj) {
+  assert(proj >= state->projectiles &&
+         proj < state->projectiles + AZ_ARRAY_SIZE(state->projectiles));
+  assert(proj->kind != AZ_PROJ_NOTHING);
+  proj->kind = AZ_PROJ_NOTHING;
 }
 
 az_pickup_t *az_add_random_pickup(az_space_state_t *state,
@@ -295,19 +1220,29 @@ az_pickup_t *az_add_random_pickup(az_space_state_t *state,
                    (AZ_IMPF_SHIP | AZ_IMPF_BADDIE), AZ_NULL_UID, &impact);
   if (impact.type != AZ_IMP_NOTHING) return NULL;
   const az_pickup_kind_t kind =
-    az_choose_random_pickup_kind(&state->ship.player, potential_pickups);
+    az_choose_random_pickup_kind(&state->rng, &state->ship.player,
+                                 potential_pickups);
   if (kind == AZ_PUP_NOTHING) return NULL;
-  AZ_ARRAY_LOOP(pickup, state->pickups) {
-    if (pickup->kind == AZ_PUP_NOTHING) {
-      pickup->kind = kind;
-      pickup->position = position;
-      pickup->time_remaining = AZ_PICKUP_MAX_AGE;
-      return pickup;
-    }
+  const int index = TAKE_SLOT(&state->pickup_slots);
+  if (index < 0) {
+    AZ_WARNING_ONCE("Failed to add pickup (kind=%d); array is full.\n",
+                    (int)kind);
+    count_dropped(state, AZ_POOL_PICKUPS);
+    return NULL;
   }
-  AZ_WARNING_ONCE("Failed to add pickup (kind=%d); array is full.\n",
-                  (int)kind);
-  return NULL;
+  az_pickup_t *pickup = &state->pickups[index];
+  assert(pickup->kind == AZ_PUP_NOTHING);
+  pickup->kind = kind;
+  pickup->position = position;
+  pickup->time_remaining = AZ_PICKUP_MAX_AGE;
+  return pickup;
+}
+
+void az_remove_pickup(az_space_state_t *state, az_pickup_t *pickup) {
+  assert(pickup >= state->pickups &&
+         pickup < state->pickups + AZ_ARRAY_SIZE(state->pickups));
+  assert(pickup->kind != AZ_PUP_NOTHING);
+  pickup->kind = AZ_PUP_NOTHING;
 }
 
 /*===========================================================================*/
@@ -394,18 +1329,53 @@ void az_ray_impact(az_space_state_t *state, az_vector_t start,
                    az_vector_t delta, az_impact_flags_t skip_types,
                    az_uid_t skip_uid, az_impact_t *impact_out) {
   assert(impact_out != NULL);
-  impact_out->type = AZ_IMP_NOTHING;
-  az_vector_t *position = &impact_out->position;
-  az_vector_t *normal = &impact_out->normal;
+  const az_ray_t ray = {.start = start, .delta = delta};
+  az_ray_impact_batch(state, &ray, 1, skip_types, skip_uid, impact_out);
+}
+
+void az_ray_impact_batch(
+    az_space_state_t *state, const az_ray_t *rays, int num_rays,
+    az_impact_flags_t skip_types, az_uid_t skip_uid,
+    az_impact_t *impacts_out) {
+  assert(num_rays >= 0);
+  assert(num_rays <= AZ_MAX_RAY_BATCH_SIZE);
+  assert(impacts_out != NULL);
+  // Each ray gets shortened whenever it hits something, so that later
+  // objects only count if they are hit even sooner.  For each ray, objects
+  // are tested in exactly the order that they would be for a single ray, so
+  // every ray ends up with the same impact as it would on its own.
+  az_vector_t deltas[AZ_MAX_RAY_BATCH_SIZE];
+  for (int r = 0; r < num_rays; ++r) {
+    impacts_out[r].type = AZ_IMP_NOTHING;
+    deltas[r] = rays[r].delta;
+  }
 
   // Walls:
   if (!(skip_types & AZ_IMPF_WALL)) {
-    AZ_ARRAY_LOOP(wall, state->walls) {
-      if (wall->kind == AZ_WALL_NOTHING) continue;
-      if (az_ray_hits_wall(wall, start, delta, position, normal)) {
-        impact_out->type = AZ_IMP_WALL;
-        impact_out->target.wall = wall;
-        delta = az_vsub(*position, start);
+    uint64_t masks[AZ_MAX_RAY_BATCH_SIZE][AZ_WALL_GRID_WORDS];
+    uint64_t union_mask[AZ_WALL_GRID_WORDS] = {0};
+    for (int r = 0; r < num_rays; ++r) {
+      swept_wall_mask(state, rays[r].start, deltas[r], 0, masks[r]);
+      for (int i = 0; i < AZ_WALL_GRID_WORDS; ++i) {
+        union_mask[i] |= masks[r][i];
+      }
+    }
+    az_wall_t *walls[AZ_MAX_NUM_WALLS];
+    const int num_walls =
+      list_wall_candidates(state, union_mask, skip_types, walls);
+    for (int i = 0; i < num_walls; ++i) {
+      az_wall_t *wall = walls[i];
+      const int index = wall - state->walls;
+      const uint64_t bit = UINT64_C(1) << (index % 64);
+      for (int r = 0; r < num_rays; ++r) {
+        if (!(masks[r][index / 64] & bit)) continue;
+        az_impact_t *impact = &impacts_out[r];
+        if (az_ray_hits_wall(wall, rays[r].start, deltas[r],
+                             &impact->position, &impact->normal)) {
+          impact->type = AZ_IMP_WALL;
+          impact->target.wall = wall;
+          deltas[r] = az_vsub(impact->position, rays[r].start);
+        }
       }
     }
   }
@@ -414,64 +1384,107 @@ void az_ray_impact(az_space_state_t *state, az_vector_t start,
       !(skip_types & AZ_IMPF_DOOR_OUTSIDE)) {
     AZ_ARRAY_LOOP(door, state->doors) {
       if (door->kind == AZ_DOOR_NOTHING) continue;
-      if (!(skip_types & AZ_IMPF_DOOR_INSIDE) &&
-          az_ray_hits_door_inside(door, start, delta, position, normal)) {
-        impact_out->type = AZ_IMP_DOOR_INSIDE;
-        impact_out->target.door = door;
-        delta = az_vsub(*position, start);
-      }
-      if (!(skip_types & AZ_IMPF_DOOR_OUTSIDE) &&
-          az_ray_hits_door_outside(door, start, delta, position, normal)) {
-        impact_out->type = AZ_IMP_DOOR_OUTSIDE;
-        impact_out->target.door = door;
-        delta = az_vsub(*position, start);
+      for (int r = 0; r < num_rays; ++r) {
+        const az_vector_t start = rays[r].start;
+        az_impact_t *impact = &impacts_out[r];
+        if (!(skip_types & AZ_IMPF_DOOR_INSIDE) &&
+            az_ray_hits_door_inside(door, start, deltas[r],
+                                    &impact->position, &impact->normal)) {
+          impact->type = AZ_IMP_DOOR_INSIDE;
+          impact->target.door = door;
+          deltas[r] = az_vsub(impact->position, start);
+        }
+        if (!(skip_types & AZ_IMPF_DOOR_OUTSIDE) &&
+            az_ray_hits_door_outside(door, start, deltas[r],
+                                     &impact->position, &impact->normal)) {
+          impact->type = AZ_IMP_DOOR_OUTSIDE;
+          impact->target.door = door;
+          deltas[r] = az_vsub(impact->position, start);
+        }
       }
     }
   }
   // Liquids:
   if (skip_types & AZ_IMPF_NOT_LIQUID) {
-    AZ_ARRAY_LOOP(gravfield, state->gravfields) {
+    uint64_t ray_liquids[AZ_MAX_RAY_BATCH_SIZE];
+    uint64_t all_liquids = 0;
+    for (int r = 0; r < num_rays; ++r) {
+      ray_liquids[r] = az_liquid_candidates(state, 0.0, rays[r].start,
+                                            deltas[r]);
+      all_liquids |= ray_liquids[r];
+    }
+    for (uint64_t bits = all_liquids; bits != 0; bits &= bits - 1) {
+      const int index = __builtin_ctzll(bits);
+      az_gravfield_t *gravfield = &state->gravfields[index];
       if (!az_is_liquid(gravfield->kind)) continue;
-      if (az_ray_hits_liquid_surface(gravfield, start, delta, position,
-                                     normal)) {
-        impact_out->type = AZ_IMP_LIQUID_SURFACE;
-        impact_out->target.gravfield = gravfield;
-        delta = az_vsub(*position, start);
+      for (int r = 0; r < num_rays; ++r) {
+        if (!(ray_liquids[r] & (UINT64_C(1) << index))) continue;
+        az_impact_t *impact = &impacts_out[r];
+        if (az_ray_hits_liquid_surface(gravfield, rays[r].start, deltas[r],
+                                       &impact->position, &impact->normal)) {
+          impact->type = AZ_IMP_LIQUID_SURFACE;
+          impact->target.gravfield = gravfield;
+          deltas[r] = az_vsub(impact->position, rays[r].start);
+        }
       }
     }
   }
   // Ship:
   if (!(skip_types & AZ_IMPF_SHIP) && skip_uid != AZ_SHIP_UID &&
       az_ship_is_alive(&state->ship)) {
-    if (az_ray_hits_ship(&state->ship, start, delta, position, normal)) {
-      impact_out->type = AZ_IMP_SHIP;
-      delta = az_vsub(*position, start);
+    for (int r = 0; r < num_rays; ++r) {
+      az_impact_t *impact = &impacts_out[r];
+      if (az_ray_hits_ship(&state->ship, rays[r].start, deltas[r],
+                           &impact->position, &impact->normal)) {
+        impact->type = AZ_IMP_SHIP;
+        deltas[r] = az_vsub(impact->position, rays[r].start);
+      }
     }
   }
   // Baddies:
   const bool skip_non_wall_like_baddies = (skip_types & AZ_IMPF_BADDIE);
   if (!skip_non_wall_like_baddies ||
       (skip_types & AZ_IMPF_NOT_WALL_LIKE_BADDIE)) {
-    AZ_ARRAY_LOOP(baddie, state->baddies) {
+    uint64_t masks[AZ_MAX_RAY_BATCH_SIZE];
+    uint64_t union_mask = 0;
+    for (int r = 0; r < num_rays; ++r) {
+      const double start_x = rays[r].start.x;
+      const double end_x = start_x + deltas[r].x;
+      masks[r] = baddie_candidates(state, fmin(start_x, end_x),
+                                   fmax(start_x, end_x));
+      union_mask |= masks[r];
+    }
+    for (uint64_t bits = union_mask; bits != 0; bits &= bits - 1) {
+      const int index = __builtin_ctzll(bits);
+      az_baddie_t *baddie = &state->baddies[index];
       if (baddie->kind == AZ_BAD_NOTHING) continue;
       if (az_baddie_has_flag(baddie, AZ_BADF_INCORPOREAL)) continue;
       if (baddie->uid == skip_uid) continue;
       if (skip_non_wall_like_baddies &&
           !az_baddie_has_flag(baddie, AZ_BADF_WALL_LIKE)) continue;
-      const az_component_data_t *component;
-      if (az_ray_hits_baddie(baddie, start, delta,
-                             position, normal, &component)) {
-        impact_out->type = AZ_IMP_BADDIE;
-        impact_out->target.baddie.baddie = baddie;
-        impact_out->target.baddie.component = component;
-        delta = az_vsub(*position, start);
+      const az_baddie_bounds_t *bounds =
+        az_get_indexed_baddie_bounds(state, baddie);
+      for (int r = 0; r < num_rays; ++r) {
+        if (!(masks[r] & (UINT64_C(1) << index))) continue;
+        az_impact_t *impact = &impacts_out[r];
+        const az_component_data_t *component;
+        if (az_ray_hits_baddie(baddie, bounds, rays[r].start, deltas[r],
+                               &impact->position, &impact->normal,
+                               &component)) {
+          impact->type = AZ_IMP_BADDIE;
+          impact->target.baddie.baddie = baddie;
+          impact->target.baddie.component = component;
+          deltas[r] = az_vsub(impact->position, rays[r].start);
+        }
       }
     }
   }
 
-  if (impact_out->type == AZ_IMP_NOTHING) {
-    *position = az_vadd(start, delta);
-    *normal = AZ_VZERO;
+  for (int r = 0; r < num_rays; ++r) {
+    if (impacts_out[r].type == AZ_IMP_NOTHING) {
+      impacts_out[r].position = az_vadd(rays[r].start, deltas[r]);
+      impacts_out[r].normal = AZ_VZERO;
+    }
   }
 }
 
@@ -486,8 +1499,11 @@ void az_circle_impact(az_space_state_t *state, double radius,
 
   // Walls:
   if (!(skip_types & AZ_IMPF_WALL)) {
-    AZ_ARRAY_LOOP(wall, state->walls) {
-      if (wall->kind == AZ_WALL_NOTHING) continue;
+    az_wall_t *walls[AZ_MAX_NUM_WALLS];
+    const int num_walls =
+      swept_wall_candidates(state, start, delta, radius, skip_types, walls);
+    for (int i = 0; i < num_walls; ++i) {
+      az_wall_t *wall = walls[i];
       if (az_circle_hits_wall(wall, radius, start, delta,
                               position_out, normal_out)) {
         impact_out->type = AZ_IMP_WALL;
@@ -519,7 +1535,9 @@ void az_circle_impact(az_space_state_t *state, double radius,
   }
   // Liquids:
   if (skip_types & AZ_IMPF_NOT_LIQUID) {
-    AZ_ARRAY_LOOP(gravfield, state->gravfields) {
+    for (uint64_t bits = az_liquid_candidates(state, radius, start, delta);
+         bits != 0; bits &= bits - 1) {
+      az_gravfield_t *gravfield = &state->gravfields[__builtin_ctzll(bits)];
       if (!az_is_liquid(gravfield->kind)) continue;
       if (az_circle_hits_liquid_surface(gravfield, radius, start, delta,
                                         position_out, normal_out)) {
@@ -542,14 +1560,21 @@ void az_circle_impact(az_space_state_t *state, double radius,
   const bool skip_non_wall_like_baddies = (skip_types & AZ_IMPF_BADDIE);
   if (!skip_non_wall_like_baddies ||
       (skip_types & AZ_IMPF_NOT_WALL_LIKE_BADDIE)) {
-    AZ_ARRAY_LOOP(baddie, state->baddies) {
+    const double end_x = start.x + delta.x;
+    for (uint64_t bits = baddie_candidates(
+             state, fmin(start.x, end_x) - radius,
+             fmax(start.x, end_x) + radius);
+         bits != 0; bits &= bits - 1) {
+      az_baddie_t *baddie = &state->baddies[__builtin_ctzll(bits)];
       if (baddie->kind == AZ_BAD_NOTHING) continue;
       if (az_baddie_has_flag(baddie, AZ_BADF_INCORPOREAL)) continue;
       if (baddie->uid == skip_uid) continue;
       if (skip_non_wall_like_baddies &&
           !az_baddie_has_flag(baddie, AZ_BADF_WALL_LIKE)) continue;
+      const az_baddie_bounds_t *bounds =
+        az_get_indexed_baddie_bounds(state, baddie);
       const az_component_data_t *component;
-      if (az_circle_hits_baddie(baddie, radius, start, delta,
+      if (az_circle_hits_baddie(baddie, bounds, radius, start, delta,
                                 position_out, normal_out, &component)) {
         impact_out->type = AZ_IMP_BADDIE;
         impact_out->target.baddie.baddie = baddie;
@@ -565,6 +1590,139 @@ void az_circle_impact(az_space_state_t *state, double radius,
   }
 }
 
+// Determine if a ray (if is_ray is true) or a circle of the given radius
+// (otherwise) would hit the given object, without caring where.
+static bool path_hits_wall(const az_wall_t *wall, bool is_ray, double radius,
+                           az_vector_t start, az_vector_t delta) {
+  return (is_ray ? az_ray_hits_wall(wall, start, delta, NULL, NULL) :
+          az_circle_hits_wall(wall, radius, start, delta, NULL, NULL));
+}
+
+// The shared implementation of az_ray_blocked and az_circle_path_blocked.
+// The order in which objects are tested doesn't affect the answer, so walls
+// (the most common blockers) go first, starting with the last wall that
+// blocked a query, and the ship and baddies (which are rarely in the way of
+// a line-of-sight check) go last.
+static bool path_blocked(
+    az_space_state_t *state, bool is_ray, double radius,
+    az_vector_t start, az_vector_t delta,
+    az_impact_flags_t skip_types, az_uid_t skip_uid) {
+  // Walls:
+  if (!(skip_types & AZ_IMPF_WALL)) {
+    az_wall_grid_t *grid = &state->wall_grid;
+    assert(0 <= grid->last_blocker &&
+           grid->last_blocker < AZ_ARRAY_SIZE(state->walls));
+    const az_wall_t *last = &state->walls[grid->last_blocker];
+    if (!skip_wall(last, skip_types) &&
+        path_hits_wall(last, is_ray, radius, start, delta)) return true;
+    uint64_t mask[AZ_WALL_GRID_WORDS];
+    swept_wall_mask(state, start, delta, radius, mask);
+    for (int i = 0; i < AZ_WALL_GRID_WORDS; ++i) {
+      for (uint64_t bits = mask[i]; bits != 0; bits &= bits - 1) {
+        const int index = 64 * i + __builtin_ctzll(bits);
+        if (index == grid->last_blocker) continue;
+        const az_wall_t *wall = &state->walls[index];
+        if (skip_wall(wall, skip_types)) continue;
+        if (path_hits_wall(wall, is_ray, radius, start, delta)) {
+          grid->last_blocker = index;
+          return true;
+        }
+      }
+    }
+  }
+  // Doors:
+  if (!(skip_types & AZ_IMPF_DOOR_INSIDE) ||
+      !(skip_types & AZ_IMPF_DOOR_OUTSIDE)) {
+    AZ_ARRAY_LOOP(door, state->doors) {
+      if (door->kind == AZ_DOOR_NOTHING) continue;
+      if (!(skip_types & AZ_IMPF_DOOR_INSIDE) &&
+          (is_ray ?
+           az_ray_hits_door_inside(door, start, delta, NULL, NULL) :
+           az_circle_hits_door_inside(door, radius, start, delta,
+                                      NULL, NULL))) return true;
+      if (!(skip_types & AZ_IMPF_DOOR_OUTSIDE) &&
+          (is_ray ?
+           az_ray_hits_door_outside(door, start, delta, NULL, NULL) :
+           az_circle_hits_door_outside(door, radius, start, delta,
+                                       NULL, NULL))) return true;
+    }
+  }
+  // Liquids:
+  if (skip_types & AZ_IMPF_NOT_LIQUID) {
+    for (uint64_t bits = az_liquid_candidates(state, radius, start, delta);
+         bits != 0; bits &= bits - 1) {
+      const az_gravfield_t *gravfield =
+        &state->gravfields[__builtin_ctzll(bits)];
+      if (!az_is_liquid(gravfield->kind)) continue;
+      if (is_ray ?
+          az_ray_hits_liquid_surface(gravfield, start, delta, NULL, NULL) :
+          az_circle_hits_liquid_surface(gravfield, radius, start, delta,
+                                        NULL, NULL)) return true;
+    }
+  }
+  // Ship:
+  if (!(skip_types & AZ_IMPF_SHIP) && skip_uid != AZ_SHIP_UID &&
+      az_ship_is_alive(&state->ship)) {
+    if (is_ray ?
+        az_ray_hits_ship(&state->ship, start, delta, NULL, NULL) :
+        az_circle_hits_ship(&state->ship, radius, start, delta,
+                            NULL, NULL)) return true;
+  }
+  // Baddies:
+  const bool skip_non_wall_like_baddies = (skip_types & AZ_IMPF_BADDIE);
+  if (!skip_non_wall_like_baddies ||
+      (skip_types & AZ_IMPF_NOT_WALL_LIKE_BADDIE)) {
+    const double end_x = start.x + delta.x;
+    for (uint64_t bits = baddie_candidates(
+             state, fmin(start.x, end_x) - radius,
+             fmax(start.x, end_x) + radius);
+         bits != 0; bits &= bits - 1) {
+      const az_baddie_t *baddie = &state->baddies[__builtin_ctzll(bits)];
+      if (baddie->kind == AZ_BAD_NOTHING) continue;
+      if (az_baddie_has_flag(baddie, AZ_BADF_INCORPOREAL)) continue;
+      if (baddie->uid == skip_uid) continue;
+      if (skip_non_wall_like_baddies &&
+          !az_baddie_has_flag(baddie, AZ_BADF_WALL_LIKE)) continue;
+      const az_baddie_bounds_t *bounds =
+        az_get_indexed_baddie_bounds(state, baddie);
+      if (is_ray ?
+          az_ray_hits_baddie(baddie, bounds, start, delta, NULL, NULL, NULL) :
+          az_circle_hits_baddie(baddie, bounds, radius, start, delta,
+                                NULL, NULL, NULL)) return true;
+    }
+  }
+  return false;
+}
+
+bool az_ray_blocked(az_space_state_t *state, az_vector_t start,
+                    az_vector_t delta, az_impact_flags_t skip_types,
+                    az_uid_t skip_uid) {
+  return path_blocked(state, true, 0.0, start, delta, skip_types, skip_uid);
+}
+
+bool az_circle_path_blocked(az_space_state_t *state, double radius,
+                            az_vector_t start, az_vector_t delta,
+                            az_impact_flags_t skip_types, az_uid_t skip_uid) {
+  return path_blocked(state, false, radius, start, delta, skip_types,
+                      skip_uid);
+}
+
+bool az_ray_reaches_ship(az_space_state_t *state, az_vector_t start,
+                         az_impact_flags_t skip_types, az_uid_t skip_uid) {
+  assert(!(skip_types & AZ_IMPF_SHIP));
+  if (skip_uid == AZ_SHIP_UID || !az_ship_is_alive(&state->ship)) {
+    return false;
+  }
+  // Find where the ray would hit the ship, and then check whether anything
+  // else is in the way before that point.
+  az_vector_t hit;
+  if (!az_ray_hits_ship(&state->ship, start,
+                        az_vsub(state->ship.position, start), &hit, NULL)) {
+    return false;
+  }
+  return !az_ray_blocked(state, start, az_vsub(hit, start),
+                         skip_types | AZ_IMPF_SHIP, skip_uid);
+}
 
 void az_arc_circle_impact(
     az_space_state_t *state, double circle_radius,
@@ -574,11 +1732,23 @@ void az_arc_circle_impact(
   impact_out->type = AZ_IMP_NOTHING;
   az_vector_t *position_out = &impact_out->position;
   az_vector_t *normal_out = &impact_out->normal;
+  // Each impact below only ever shortens spin_angle, so any object that the
+  // full sweep can't reach can be skipped without calling the (much more
+  // expensive) exact hit functions.
+  az_arc_sweep_t sweep;
+  az_init_arc_sweep(circle_radius, start, spin_center, spin_angle, &sweep);
 
   // Walls:
   if (!(skip_types & AZ_IMPF_WALL)) {
-    AZ_ARRAY_LOOP(wall, state->walls) {
-      if (wall->kind == AZ_WALL_NOTHING) continue;
+    az_wall_t *walls[AZ_MAX_NUM_WALLS];
+    const int num_walls = arc_wall_candidates(state, &sweep, skip_types,
+                                              walls);
+    for (int i = 0; i < num_walls; ++i) {
+      az_wall_t *wall = walls[i];
+      if (!az_arc_sweep_might_hit_circle(&sweep, wall->position,
+                                         wall->data->bounding_radius)) {
+        continue;
+      }
       if (az_arc_circle_hits_wall(
               wall, circle_radius, start, spin_center, spin_angle,
               &spin_angle, position_out, normal_out)) {
@@ -592,6 +1762,8 @@ void az_arc_circle_impact(
       !(skip_types & AZ_IMPF_DOOR_OUTSIDE)) {
     AZ_ARRAY_LOOP(door, state->doors) {
       if (door->kind == AZ_DOOR_NOTHING) continue;
+      if (!az_arc_sweep_might_hit_circle(&sweep, door->position,
+                                         AZ_DOOR_BOUNDING_RADIUS)) continue;
       if (!(skip_types & AZ_IMPF_DOOR_INSIDE) &&
           az_arc_circle_hits_door_inside(
               door, circle_radius, start, spin_center, spin_angle,
@@ -625,15 +1797,25 @@ void az_arc_circle_impact(
   const bool skip_non_wall_like_baddies = (skip_types & AZ_IMPF_BADDIE);
   if (!skip_non_wall_like_baddies ||
       (skip_types & AZ_IMPF_NOT_WALL_LIKE_BADDIE)) {
-    AZ_ARRAY_LOOP(baddie, state->baddies) {
+    for (uint64_t bits = baddie_candidates(state, sweep.min.x, sweep.max.x);
+         bits != 0; bits &= bits - 1) {
+      az_baddie_t *baddie = &state->baddies[__builtin_ctzll(bits)];
       if (baddie->kind == AZ_BAD_NOTHING) continue;
       if (az_baddie_has_flag(baddie, AZ_BADF_INCORPOREAL)) continue;
       if (baddie->uid == skip_uid) continue;
       if (skip_non_wall_like_baddies &&
           !az_baddie_has_flag(baddie, AZ_BADF_WALL_LIKE)) continue;
+      if (!az_arc_sweep_might_hit_circle(
+              &sweep, baddie->position,
+              baddie->data->overall_bounding_radius)) continue;
+      const az_baddie_bounds_t *bounds =
+        az_get_indexed_baddie_bounds(state, baddie);
+      if (bounds != NULL &&
+          !az_arc_sweep_might_hit_circle(&sweep, bounds->center,
+                                         bounds->radius)) continue;
       const az_component_data_t *component;
       if (az_arc_circle_hits_baddie(
-              baddie, circle_radius, start, spin_center, spin_angle,
+              baddie, bounds, circle_radius, start, spin_center, spin_angle,
               &spin_angle, position_out, normal_out, &component)) {
         impact_out->type = AZ_IMP_BADDIE;
         impact_out->target.baddie.baddie = baddie;
@@ -35,6 +35,7 @@
 #include "azimuth/state/pickup.h"
 #include "azimuth/state/planet.h"
 #include "azimuth/state/player.h"
+#include "azimuth/state/profile.h"
 #include "azimuth/state/projectile.h"
 #include "azimuth/state/room.h"
 #include "azimuth/state/script.h"
@@ -46,6 +47,7 @@
 #include "azimuth/util/audio.h"
 #include "azimuth/util/clock.h"
 #include "azimuth/util/prefs.h"
+#include "azimuth/util/random.h"
 #include "azimuth/util/vector.h"
 
 /*===========================================================================*/
@@ -122,13 +124,141 @@ typedef struct {
   az_upgrade_t upgrade;
 } az_upgrade_mode_data_t;
 
+#define AZ_MAX_NUM_PARTICLES 500
+#define AZ_MAX_NUM_PICKUPS 100
+#define AZ_MAX_NUM_PROJECTILES 250
+#define AZ_MAX_NUM_SPECKS 750
+
+// Declares a struct tracking which slots of an object array are in use, so
+// that a new object can be inserted without searching the array, and so that
+// loops over the objects can skip the empty slots.  The live array lists the
+// indices of the slots in use, in the order they were filled.  When an object
+// is removed (by setting its kind to NOTHING), its slot stays on the live list
+// until the next az_reclaim_slots, which moves it onto the free stack; that
+// way, loops over the live list never see a slot listed twice, even if objects
+// are added or removed during the loop.  Slots at or above high_water haven't
+// been used since the array was last cleared.
+#define AZ_SLOT_LIST(capacity) \
+  struct { \
+    int high_water, num_free, num_live; \
+    uint16_t free[capacity], live[capacity]; \
+  }
+
+// The particles, stored as parallel arrays (one entry per slot) rather than
+// as an array of az_particle_t, so that az_tick_particles can update all of
+// them in a single tight loop that the compiler can vectorize.  Use
+// az_get_particle to read a whole particle at once.  (The cutscene and
+// victory screens keep their own small az_particle_t arrays, which they tick
+// with az_tick_particle.)
+typedef struct {
+  // Fields updated every frame:
+  double x[AZ_MAX_NUM_PARTICLES], y[AZ_MAX_NUM_PARTICLES];
+  double vx[AZ_MAX_NUM_PARTICLES], vy[AZ_MAX_NUM_PARTICLES];
+  double age[AZ_MAX_NUM_PARTICLES], lifetime[AZ_MAX_NUM_PARTICLES];
+  az_particle_kind_t kind[AZ_MAX_NUM_PARTICLES];
+  // Fields only needed for drawing:
+  az_color_t color[AZ_MAX_NUM_PARTICLES];
+  double angle[AZ_MAX_NUM_PARTICLES];
+  double param1[AZ_MAX_NUM_PARTICLES], param2[AZ_MAX_NUM_PARTICLES];
+} az_particle_array_t;
+
+// The specks, stored as parallel arrays in the same way as the particles (see
+// az_particle_array_t).  Use az_get_speck to read a whole speck at once.
+typedef struct {
+  // Fields updated every frame:
+  double x[AZ_MAX_NUM_SPECKS], y[AZ_MAX_NUM_SPECKS];
+  double vx[AZ_MAX_NUM_SPECKS], vy[AZ_MAX_NUM_SPECKS];
+  double age[AZ_MAX_NUM_SPECKS], lifetime[AZ_MAX_NUM_SPECKS];
+  az_speck_kind_t kind[AZ_MAX_NUM_SPECKS];
+  // Fields only needed for drawing:
+  az_color_t color[AZ_MAX_NUM_SPECKS];
+} az_speck_array_t;
+
+// The number of rows (and of columns) in the wall grid.
+#define AZ_WALL_GRID_SIZE 32
+#define AZ_WALL_GRID_WORDS ((AZ_MAX_NUM_WALLS + 63) / 64)
+
+// A uniform grid laid over the room, which lets the impact functions below
+// test only those walls that are near the path being checked.  Each cell
+// holds a bitset of indices into the walls array, marking the walls whose
+// bounding circles overlap that cell.  Walls that extend past the edges of
+// the grid are recorded in the outermost cells.
+typedef struct {
+  az_vector_t origin; // the corner of the grid with the least x and y
+  double cell_width, cell_height;
+  uint64_t cells[AZ_WALL_GRID_SIZE][AZ_WALL_GRID_SIZE][AZ_WALL_GRID_WORDS];
+  // The range of cells in which each wall is currently recorded:
+  struct {
+    bool recorded;
+    uint8_t min_row, max_row, min_col, max_col;
+  } extents[AZ_MAX_NUM_WALLS];
+  // The index of the wall that most recently blocked an az_ray_blocked or
+  // az_circle_path_blocked query; the next such query tests it first, since
+  // the same wall often blocks many baddies' lines of sight in a row.
+  int last_blocker;
+} az_wall_grid_t;
+
+typedef struct {
+  double min_x, max_x;
+  int index; // index into the baddies array
+} az_baddie_extent_t;
+
+typedef struct {
+  az_vector_t position;
+  int index; // index into the baddies array
+} az_baddie_point_t;
+
+// A sweep-and-prune index of the baddies' bounding circles along the x-axis,
+// which lets the impact functions below skip baddies that can't possibly be
+// hit.  This is rebuilt once per frame, right after the baddies are ticked
+// (while they're being ticked, they move around freely, so the index is
+// marked invalid).  Baddies that are added, moved, or changed in kind in
+// between rebuilds are flagged as unindexed, and are always tested.  The index
+// also records each baddie's bounds for its pose as of the last rebuild, which
+// remain valid until the next az_tick_baddies (unless the baddie is flagged),
+// since baddies' components only move while they're being ticked.  Finally,
+// the index records each baddie's position, sorted by x, so that the
+// nearest-baddie queries below needn't look at every baddie.
+typedef struct {
+  bool valid;
+  int num_entries, num_points;
+  // The largest (max_x - min_x) of any entry:
+  double max_width;
+  // Bitset of indices into the baddies array that must always be tested:
+  uint64_t unindexed;
+  // The x-extents of each live baddie's bounding circle, sorted by min_x:
+  az_baddie_extent_t entries[AZ_MAX_NUM_BADDIES];
+  // The bounds of each indexed baddie, indexed the same as the baddies array:
+  az_baddie_bounds_t bounds[AZ_MAX_NUM_BADDIES];
+  // The positions of the same baddies as the entries, sorted by x:
+  az_baddie_point_t points[AZ_MAX_NUM_BADDIES];
+} az_baddie_sweep_t;
+
+// Bounding boxes of the gravfields, which let the ship and the impact
+// functions below skip gravfields that are nowhere near the point or path
+// being checked.  Gravfields almost never move, so each box is computed when
+// its gravfield is added, and only recomputed if a script moves it.
+typedef struct {
+  // Bitset of indices into the gravfields array of the liquid gravfields
+  // (the only ones that the impact functions care about):
+  uint64_t liquids;
+  struct { az_vector_t min, max; } bounds[AZ_MAX_NUM_GRAVFIELDS];
+} az_gravfield_index_t;
+
 /*===========================================================================*/
 
 typedef struct {
   const az_planet_t *planet;
   const az_preferences_t *prefs;
+  // If this is non-NULL, az_tick_space_state records how long each part of
+  // each tick takes here.  Since timings aren't part of the simulation, this
+  // is ignored by hashes, and restoring a snapshot keeps the current value.
+  az_tick_profile_t *profile;
   int save_file_index;
   az_clock_t clock;
+  // All gameplay randomness comes from this seed (rather than from the global
+  // one), so that a simulation is repeatable from its initial state.
+  az_random_seed_t rng;
   az_camera_t camera;
   az_ship_t ship;
   az_message_t message;
@@ -170,26 +300,128 @@ typedef struct {
   az_door_t doors[AZ_MAX_NUM_DOORS];
   az_gravfield_t gravfields[AZ_MAX_NUM_GRAVFIELDS];
   az_node_t nodes[AZ_MAX_NUM_NODES];
-  az_particle_t particles[500];
-  az_pickup_t pickups[100];
-  az_projectile_t projectiles[250];
-  az_speck_t specks[750];
+  az_particle_array_t particles;
+  az_pickup_t pickups[AZ_MAX_NUM_PICKUPS];
+  az_projectile_t projectiles[AZ_MAX_NUM_PROJECTILES];
+  az_speck_array_t specks;
   az_timer_t timers[20];
   az_wall_t walls[AZ_MAX_NUM_WALLS];
+  az_wall_grid_t wall_grid;
+  az_baddie_sweep_t baddie_sweep;
+  az_gravfield_index_t gravfield_index;
   az_uuid_t uuids[AZ_NUM_UUID_SLOTS];
+  AZ_SLOT_LIST(AZ_MAX_NUM_BADDIES) baddie_slots;
+  AZ_SLOT_LIST(AZ_MAX_NUM_GRAVFIELDS) gravfield_slots;
+  AZ_SLOT_LIST(AZ_MAX_NUM_PARTICLES) particle_slots;
+  AZ_SLOT_LIST(AZ_MAX_NUM_PICKUPS) pickup_slots;
+  AZ_SLOT_LIST(AZ_MAX_NUM_PROJECTILES) projectile_slots;
+  AZ_SLOT_LIST(AZ_MAX_NUM_SPECKS) speck_slots;
+  // Doors, nodes, and walls are only ever added by az_enter_room, so rather
+  // than slot lists, they just have high water marks (slots at or above
+  // which haven't been used since the array was last cleared):
+  int door_high_water, node_high_water, wall_high_water;
 } az_space_state_t;
 
+// A saved copy of a space state, which can be restored later with
+// az_restore_space_state (e.g. to retry from a checkpoint, or to explore
+// several different inputs from the same starting point).
+typedef struct {
+  az_space_state_t state;
+} az_space_snapshot_t;
+
 /*===========================================================================*/
 
 // Remove all objects (baddies, doors, etc.), but leave other fields unchanged.
 void az_clear_space(az_space_state_t *state);
 
+// Copy the entire state into the (caller-allocated) snapshot.
+void az_snapshot_space_state(const az_space_state_t *state,
+                             az_space_snapshot_t *snapshot);
+
+// Set the state to exactly how the snapshot's state was when it was taken.
+// The state need not be the same one the snapshot was taken from, but it must
+// be for the same planet; it keeps its own preferences.
+void az_restore_space_state(const az_space_snapshot_t *snapshot,
+                            az_space_state_t *state);
+
 // Add all room objects to the space state, on top of whatever objects are
 // already there.  You may want to call az_clear_space first to ensure that
 // there is room for the new objects.  Note that this function does not make
-// any changes to the ship or any other fields.
+// any changes to the ship or any other fields.  If the room is prebuilt and
+// the state has no room objects yet (e.g. just after az_clear_space), this
+// just copies in the prebuilt objects.
 void az_enter_room(az_space_state_t *state, const az_room_t *room);
 
+// Prebuild every room of the planet (see az_prebuilt_room_t), so that
+// entering a room is much cheaper.  This must be called after the baddie and
+// wall data are initialized, and the rooms must not be changed afterwards.
+void az_prebuild_rooms(az_planet_t *planet);
+
+// Update the wall's placement (see az_place_wall) and the wall grid to reflect
+// the wall's current position and kind.  This must be called whenever a wall
+// is moved or removed after az_enter_room has added it.
+void az_update_wall_grid(az_space_state_t *state, az_wall_t *wall);
+
+// Rebuild the baddie sweep index from the baddies' current positions.
+void az_build_baddie_sweep(az_space_state_t *state);
+
+// Mark the baddie sweep index as invalid (so that the impact functions test
+// every baddie) until the next call to az_build_baddie_sweep.
+void az_invalidate_baddie_sweep(az_space_state_t *state);
+
+// Flag the baddie as unindexed in the baddie sweep index.  This must be
+// called whenever a baddie is moved or changes kind other than during
+// az_tick_baddies (baddies added with az_add_baddie are flagged
+// automatically).
+void az_update_baddie_sweep(az_space_state_t *state, const az_baddie_t *baddie);
+
+// Return the baddie's bounds from the baddie sweep index, or NULL if the index
+// doesn't currently have valid bounds for that baddie.  The result is suitable
+// for passing to az_ray_hits_baddie and friends.
+const az_baddie_bounds_t *az_get_indexed_baddie_bounds(
+    const az_space_state_t *state, const az_baddie_t *baddie);
+
+// Return a bitset of indices into the baddies array, marking (at least) every
+// baddie whose position lies within max_dist of the given point.  Looping
+// over the set bits visits baddies in the same order as looping over the
+// whole array would.
+uint64_t az_baddies_near(const az_space_state_t *state, az_vector_t point,
+                         double max_dist);
+
+// Find the (up to) max_count baddies whose positions are nearest to the given
+// point, ignoring baddies that have any of the skip_flags or whose UID is
+// skip_uid.  Store them in baddies_out, nearest first (with ties going to the
+// baddie earlier in the baddies array), and return how many were found.
+int az_find_nearest_baddies(
+    const az_space_state_t *state, az_vector_t point,
+    az_baddie_flags_t skip_flags, az_uid_t skip_uid, int max_count,
+    const az_baddie_t **baddies_out);
+
+// Return the baddie whose position is nearest to start, among those (without
+// any of the skip_flags) whose direction from start is within limit radians
+// of the given angle, or NULL if there is no such baddie.  Ties go to the
+// baddie earlier in the baddies array.
+const az_baddie_t *az_find_nearest_baddie_in_cone(
+    const az_space_state_t *state, az_vector_t start, double angle,
+    double limit, az_baddie_flags_t skip_flags);
+
+// Recompute the gravfield's bounds in the gravfield index.  This must be
+// called whenever a gravfield is moved after az_enter_room has added it.
+void az_update_gravfield_index(az_space_state_t *state,
+                               const az_gravfield_t *gravfield);
+
+// Return false if the point definitely doesn't lie within the gravfield (so
+// that az_point_within_gravfield needn't be called), or true if it might.
+bool az_gravfield_might_contain(const az_space_state_t *state,
+                                const az_gravfield_t *gravfield,
+                                az_vector_t point);
+
+// Return a bitset of indices into the gravfields array of the liquid
+// gravfields whose surfaces might be hit by a circle of the given radius
+// (which may be zero, for a ray) travelling from start by delta.
+uint64_t az_liquid_candidates(const az_space_state_t *state, double radius,
+                              az_vector_t start, az_vector_t delta);
+
 // Set the current message (displayed at the bottom of the screen) to the given
 // paragraph.  This will automatically intialize the various fields of
 // state->message appropriately.
@@ -200,7 +432,19 @@ void az_set_message(az_space_state_t *state, const char *paragraph);
 az_baddie_t *az_add_baddie(az_space_state_t *state, az_baddie_kind_t kind,
                            az_vector_t position, double angle);
 
-bool az_insert_particle(az_space_state_t *state, az_particle_t **particle_out);
+// If there is room for another particle, zero *particle_out and return true;
+// the caller should then fill in the new particle and pass it to
+// az_add_particle.  If the particle array is full, return false instead.
+bool az_insert_particle(az_space_state_t *state, az_particle_t *particle_out);
+
+// Copy the particle into a free slot of the particles array (or drop it, if
+// the array is full).
+void az_add_particle(az_space_state_t *state, const az_particle_t *particle);
+
+// Copy the particle in the given slot of the particles array into
+// *particle_out.
+void az_get_particle(const az_space_state_t *state, int index,
+                     az_particle_t *particle_out);
 
 void az_add_beam(az_space_state_t *state, az_color_t color, az_vector_t start,
                  az_vector_t end, double lifetime, double semiwidth);
@@ -208,6 +452,10 @@ void az_add_beam(az_space_state_t *state, az_color_t color, az_vector_t start,
 void az_add_speck(az_space_state_t *state, az_color_t color, double lifetime,
                   az_vector_t position, az_vector_t velocity);
 
+// Copy the speck in the given slot of the specks array into *speck_out.
+void az_get_speck(const az_space_state_t *state, int index,
+                  az_speck_t *speck_out);
+
 void az_add_sploosh(az_space_state_t *state, const az_gravfield_t *gravfield,
                     az_vector_t position, az_vector_t normal,
                     az_vector_t velocity, double radius);
@@ -218,6 +466,17 @@ az_projectile_t *az_add_projectile(
     az_space_state_t *state, az_proj_kind_t kind, az_vector_t position,
     double angle, double power, az_uid_t fired_by);
 
+// Remove the object from space.  Its slot becomes available for reuse after
+// the next call to az_reclaim_slots.
+void az_remove_pickup(az_space_state_t *state, az_pickup_t *pickup);
+void az_remove_projectile(az_space_state_t *state, az_projectile_t *proj);
+
+// Move the slots of all objects removed since the last call onto the free
+// stacks of their slot lists.  This must not be called during a loop over any
+// of the live lists; az_tick_space_state calls it once at the start of each
+// frame.
+void az_reclaim_slots(az_space_state_t *state);
+
 // Add a pickup of a randomly chosen kind, among those kinds allowed by the
 // potential_pickups argument, and return a pointer to it.  Returns NULL if no
 // pickup was placed, either because AZ_PUPF_NOTHING was selected, or if the
@@ -262,7 +521,9 @@ typedef enum {
 // Flags for which impact types to skip; liquid surface impacts are skipped by
 // default, unless AZ_IMPF_NOT_LIQUID is included.  If AZ_IMPF_BADDIE and
 // AZ_IMPF_NOT_WALL_LIKE_BADDIE are both included, then only baddies lacking
-// the AZ_BADF_WALL_LIKE property are skipped.
+// the AZ_BADF_WALL_LIKE property are skipped.  AZ_IMPF_WEAK_WALL skips just
+// those walls that a rocket can destroy (AZ_WALL_DESTRUCTIBLE_CHARGED and
+// AZ_WALL_DESTRUCTIBLE_ROCKET).
 typedef uint_fast8_t az_impact_flags_t;
 #define AZ_IMPF_NONE                 ((az_impact_flags_t)0)
 #define AZ_IMPF_BADDIE               ((az_impact_flags_t)(1u << 0))
@@ -272,6 +533,7 @@ typedef uint_fast8_t az_impact_flags_t;
 #define AZ_IMPF_SHIP                 ((az_impact_flags_t)(1u << 4))
 #define AZ_IMPF_WALL                 ((az_impact_flags_t)(1u << 5))
 #define AZ_IMPF_NOT_WALL_LIKE_BADDIE ((az_impact_flags_t)(1u << 6))
+#define AZ_IMPF_WEAK_WALL            ((az_impact_flags_t)(1u << 7))
 
 typedef struct {
   // What type of object was hit:
@@ -298,11 +560,48 @@ void az_ray_impact(
     az_space_state_t *state, az_vector_t start, az_vector_t delta,
     az_impact_flags_t skip_types, az_uid_t skip_uid, az_impact_t *impact_out);
 
+// The most rays that can be passed to az_ray_impact_batch at once.
+#define AZ_MAX_RAY_BATCH_SIZE 8
+
+typedef struct {
+  az_vector_t start, delta;
+} az_ray_t;
+
+// Like calling az_ray_impact on each of the rays in turn (storing the results
+// in the corresponding entries of impacts_out), but tests all the rays
+// against each wall, door, etc. together, so that each object is only looked
+// at once per batch rather than once per ray.  The results are exactly the
+// same as for separate calls, so this is useful whenever several rays need
+// casting with nothing changing in between.
+void az_ray_impact_batch(
+    az_space_state_t *state, const az_ray_t *rays, int num_rays,
+    az_impact_flags_t skip_types, az_uid_t skip_uid, az_impact_t *impacts_out);
+
 void az_circle_impact(
     az_space_state_t *state, double circle_radius,
     az_vector_t start, az_vector_t delta,
     az_impact_flags_t skip_types, az_uid_t skip_uid, az_impact_t *impact_out);
 
+// Determine whether az_ray_impact or az_circle_impact (respectively) would
+// find any impact at all.  These return as soon as they find a hit, without
+// looking for the nearest one, so they are much cheaper for line-of-sight
+// checks that only need a yes or no answer.
+bool az_ray_blocked(
+    az_space_state_t *state, az_vector_t start, az_vector_t delta,
+    az_impact_flags_t skip_types, az_uid_t skip_uid);
+bool az_circle_path_blocked(
+    az_space_state_t *state, double circle_radius,
+    az_vector_t start, az_vector_t delta,
+    az_impact_flags_t skip_types, az_uid_t skip_uid);
+
+// Determine whether a ray from start to the ship's position would hit the
+// ship before anything else; that is, whether az_ray_impact would report an
+// AZ_IMP_SHIP impact for that ray (for the given skip_types, which should not
+// include AZ_IMPF_SHIP).
+bool az_ray_reaches_ship(
+    az_space_state_t *state, az_vector_t start,
+    az_impact_flags_t skip_types, az_uid_t skip_uid);
+
 void az_arc_circle_impact(
     az_space_state_t *state, double circle_radius,
     az_vector_t start, az_vector_t spin_center, double spin_angle,
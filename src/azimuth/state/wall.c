@@ -22,6 +22,7 @@
 #include <assert.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "azimuth/util/misc.h"
 #include "azimuth/util/polygon.h"
@@ -1568,6 +1569,10 @@ static az_wall_data_t wall_datas[] = {
 
 const int AZ_NUM_WALL_DATAS = AZ_ARRAY_SIZE(wall_datas);
 
+static double wall_soa_xs[AZ_ARRAY_SIZE(wall_datas)][AZ_MAX_WALL_VERTICES + 1];
+static double wall_soa_ys[AZ_ARRAY_SIZE(wall_datas)][AZ_MAX_WALL_VERTICES + 1];
+static az_convex_decomp_t wall_decomps[AZ_ARRAY_SIZE(wall_datas)];
+
 static bool wall_data_initialized = false;
 
 void az_init_wall_datas(void) {
@@ -1581,6 +1586,17 @@ void az_init_wall_datas(void) {
       radius = fmax(radius, az_vnorm(polygon.vertices[i]));
     }
     data->bounding_radius = radius + 0.01; // small safety margin
+    assert(polygon.num_vertices <= AZ_MAX_WALL_VERTICES);
+    double *xs = wall_soa_xs[data - wall_datas];
+    double *ys = wall_soa_ys[data - wall_datas];
+    for (int i = 0; i <= polygon.num_vertices; ++i) {
+      xs[i] = polygon.vertices[i % polygon.num_vertices].x;
+      ys[i] = polygon.vertices[i % polygon.num_vertices].y;
+    }
+    data->polygon_soa = (az_polygon_soa_t){
+      .num_vertices = polygon.num_vertices, .xs = xs, .ys = ys};
+    az_convex_decomp_t *decomp = &wall_decomps[data - wall_datas];
+    data->decomp = (az_decompose_polygon(polygon, decomp) ? decomp : NULL);
   }
   wall_data_initialized = true;
 }
@@ -1600,43 +1616,141 @@ int az_wall_data_index(const az_wall_data_t *data) {
 
 /*===========================================================================*/
 
+void az_place_wall(az_wall_t *wall) {
+  az_wall_placement_t *placement = &wall->placement;
+  if (wall->kind == AZ_WALL_NOTHING) {
+    placement->valid = false;
+    return;
+  }
+  placement->cos_angle = cos(wall->angle);
+  placement->sin_angle = sin(wall->angle);
+  placement->valid = true;
+}
+
+// Rotate the vector by minus the placed wall's angle (giving exactly what
+// az_vrotate would, since cos is even and sin is odd).
+static az_vector_t unrotate(const az_wall_placement_t *placement,
+                            az_vector_t v) {
+  assert(placement->valid);
+  const double c = placement->cos_angle, s = placement->sin_angle;
+  return (az_vector_t){.x = v.x * c + v.y * s, .y = v.y * c - v.x * s};
+}
+
+// Rotate the vector by the placed wall's angle (giving exactly what
+// az_vrotate would).
+static az_vector_t rotate(const az_wall_placement_t *placement,
+                          az_vector_t v) {
+  assert(placement->valid);
+  const double c = placement->cos_angle, s = placement->sin_angle;
+  return (az_vector_t){.x = v.x * c - v.y * s, .y = v.y * c + v.x * s};
+}
+
+// Transform a point in room coordinates into the placed wall's own coordinates
+// (giving exactly what the *_trans functions in util/polygon.c would).
+static az_vector_t to_wall_coords(const az_wall_t *wall, az_vector_t point) {
+  return unrotate(&wall->placement, az_vsub(point, wall->position));
+}
+
+// Transform an impact position and normal found in the placed wall's own
+// coordinates back into room coordinates, exactly as the *_trans functions
+// in util/polygon.c do.
+static void place_impact(const az_wall_t *wall, az_vector_t *pos_out,
+                         az_vector_t *normal_out) {
+  if (pos_out != NULL) {
+    *pos_out = az_vadd(rotate(&wall->placement, *pos_out), wall->position);
+  }
+  if (normal_out != NULL) {
+    *normal_out = rotate(&wall->placement, *normal_out);
+  }
+}
+
+// Return a bitset of the edges of the wall's polygon that a circle of the
+// given radius (zero for a ray or a point) travelling delta from start (both
+// in the wall's own coordinates) might touch, judging by the convex pieces of
+// the polygon (see az_convex_decomp_edges); if the wall's data has no
+// decomposition, this just returns every edge.  If this returns zero, the
+// path misses the wall.
+static uint64_t candidate_edges(const az_wall_t *wall, double radius,
+                                az_vector_t start, az_vector_t delta) {
+  const az_convex_decomp_t *decomp = wall->data->decomp;
+  if (decomp == NULL) return UINT64_MAX;
+  return az_convex_decomp_edges(decomp, radius, start, delta);
+}
+
 bool az_point_touches_wall(const az_wall_t *wall, az_vector_t point) {
   assert(wall->kind != AZ_WALL_NOTHING);
-  return (az_vwithin(point, wall->position, wall->data->bounding_radius) &&
-          az_polygon_contains(wall->data->polygon,
-                              az_vrotate(az_vsub(point, wall->position),
-                                         -wall->angle)));
+  if (!az_vwithin(point, wall->position, wall->data->bounding_radius)) {
+    return false;
+  }
+  if (wall->placement.valid) {
+    const az_vector_t rel_point = to_wall_coords(wall, point);
+    return (candidate_edges(wall, 0.0, rel_point, AZ_VZERO) != 0 &&
+            az_polygon_contains_soa(wall->data->polygon_soa, rel_point));
+  }
+  return az_polygon_contains(wall->data->polygon,
+                             az_vrotate(az_vsub(point, wall->position),
+                                        -wall->angle));
 }
 
 bool az_circle_touches_wall(
     const az_wall_t *wall, double radius, az_vector_t center) {
   assert(wall->kind != AZ_WALL_NOTHING);
-  return (az_vwithin(center, wall->position,
-                     radius + wall->data->bounding_radius) &&
-          az_circle_touches_polygon_trans(wall->data->polygon, wall->position,
-                                          wall->angle, radius, center));
+  if (!az_vwithin(center, wall->position,
+                  radius + wall->data->bounding_radius)) return false;
+  if (wall->placement.valid) {
+    const az_vector_t rel_center = to_wall_coords(wall, center);
+    return (candidate_edges(wall, radius, rel_center, AZ_VZERO) != 0 &&
+            az_circle_touches_polygon(wall->data->polygon, radius,
+                                      rel_center));
+  }
+  return az_circle_touches_polygon_trans(wall->data->polygon, wall->position,
+                                         wall->angle, radius, center);
 }
 
 bool az_ray_hits_wall(const az_wall_t *wall, az_vector_t start,
                       az_vector_t delta, az_vector_t *point_out,
                       az_vector_t *normal_out) {
   assert(wall->kind != AZ_WALL_NOTHING);
-  return (az_ray_hits_bounding_circle(start, delta, wall->position,
-                                      wall->data->bounding_radius) &&
-          az_ray_hits_polygon_trans(wall->data->polygon, wall->position,
-                                    wall->angle, start, delta,
-                                    point_out, normal_out));
+  if (!az_ray_hits_bounding_circle(start, delta, wall->position,
+                                   wall->data->bounding_radius)) return false;
+  if (wall->placement.valid) {
+    const az_vector_t rel_start = to_wall_coords(wall, start);
+    const az_vector_t rel_delta = unrotate(&wall->placement, delta);
+    const uint64_t edges = candidate_edges(wall, 0.0, rel_start, rel_delta);
+    if (edges == 0 ||
+        !az_ray_hits_polygon_soa_edges(wall->data->polygon_soa, edges,
+                                       rel_start, rel_delta,
+                                       point_out, normal_out)) return false;
+    place_impact(wall, point_out, normal_out);
+    return true;
+  }
+  return az_ray_hits_polygon_trans(wall->data->polygon, wall->position,
+                                   wall->angle, start, delta,
+                                   point_out, normal_out);
 }
 
 bool az_circle_hits_wall(
     const az_wall_t *wall, double radius, az_vector_t start, az_vector_t delta,
     az_vector_t *pos_out, az_vector_t *normal_out) {
   assert(wall->kind != AZ_WALL_NOTHING);
-  return (az_ray_hits_bounding_circle(start, delta, wall->position,
-                                      wall->data->bounding_radius + radius) &&
-          az_circle_hits_polygon_trans(wall->data->polygon, wall->position,
-                                       wall->angle, radius, start, delta,
-                                       pos_out, normal_out));
+  if (!az_ray_hits_bounding_circle(start, delta, wall->position,
+                                   wall->data->bounding_radius + radius)) {
+    return false;
+  }
+  if (wall->placement.valid) {
+    const az_vector_t rel_start = to_wall_coords(wall, start);
+    const az_vector_t rel_delta = unrotate(&wall->placement, delta);
+    const uint64_t edges = candidate_edges(wall, radius, rel_start, rel_delta);
+    if (edges == 0 ||
+        !az_circle_hits_polygon_soa_edges(wall->data->polygon_soa, edges,
+                                          radius, rel_start, rel_delta,
+                                          pos_out, normal_out)) return false;
+    place_impact(wall, pos_out, normal_out);
+    return true;
+  }
+  return az_circle_hits_polygon_trans(wall->data->polygon, wall->position,
+                                      wall->angle, radius, start, delta,
+                                      pos_out, normal_out);
 }
 
 bool az_arc_circle_hits_wall(
@@ -1644,13 +1758,21 @@ bool az_arc_circle_hits_wall(
     az_vector_t start, az_vector_t spin_center, double spin_angle,
     double *angle_out, az_vector_t *pos_out, az_vector_t *normal_out) {
   assert(wall->kind != AZ_WALL_NOTHING);
-  return (az_arc_ray_might_hit_bounding_circle(
-              start, spin_center, spin_angle, wall->position,
-              wall->data->bounding_radius + circle_radius) &&
-          az_arc_circle_hits_polygon_trans(
-              wall->data->polygon, wall->position, wall->angle,
-              circle_radius, start, spin_center, spin_angle,
-              angle_out, pos_out, normal_out));
+  if (!az_arc_ray_might_hit_bounding_circle(
+          start, spin_center, spin_angle, wall->position,
+          wall->data->bounding_radius + circle_radius)) return false;
+  if (wall->placement.valid) {
+    if (!az_arc_circle_hits_polygon(
+            wall->data->polygon, circle_radius, to_wall_coords(wall, start),
+            to_wall_coords(wall, spin_center), spin_angle,
+            angle_out, pos_out, normal_out)) return false;
+    place_impact(wall, pos_out, normal_out);
+    return true;
+  }
+  return az_arc_circle_hits_polygon_trans(
+      wall->data->polygon, wall->position, wall->angle,
+      circle_radius, start, spin_center, spin_angle,
+      angle_out, pos_out, normal_out);
 }
 
 /*===========================================================================*/
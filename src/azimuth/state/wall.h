@@ -80,8 +80,28 @@ typedef struct {
   double impact_damage_coeff;
   double bounding_radius;
   az_polygon_t polygon;
+  // The same polygon as coordinate arrays, for the *_soa functions (set by
+  // az_init_wall_datas):
+  az_polygon_soa_t polygon_soa;
+  // The polygon split into convex pieces (set by az_init_wall_datas), or NULL
+  // if it couldn't be split:
+  const az_convex_decomp_t *decomp;
 } az_wall_data_t;
 
+// The most vertices that any wall data polygon may have.
+#define AZ_MAX_WALL_VERTICES 36
+
+// What the wall queries below cache about a wall's angle.  This is derived
+// entirely from the wall's angle, and is kept up to date by az_place_wall.
+// (It is deliberately small, since it is part of every az_wall_t, and so of
+// every space state snapshot and replay keyframe.)
+typedef struct {
+  bool valid; // if false, the wall hasn't been placed since it last changed
+  // The cosine and sine of the wall's angle, so that queries can be rotated
+  // into the wall's own coordinates without calling cos and sin each time:
+  double cos_angle, sin_angle;
+} az_wall_placement_t;
+
 typedef struct {
   az_wall_kind_t kind; // if AZ_WALL_NOTHING, this wall is not present
   const az_wall_data_t *data;
@@ -89,6 +109,7 @@ typedef struct {
   az_vector_t position;
   double angle;
   double flare; // from 0.0 (nothing) to 1.0 (was just now hit)
+  az_wall_placement_t placement;
 } az_wall_t;
 
 /*===========================================================================*/
@@ -110,6 +131,13 @@ int az_wall_data_index(const az_wall_data_t *data);
 
 /*===========================================================================*/
 
+// Recompute the wall's placement from its current kind, data, position, and
+// angle.  This must be called whenever any of those change (which
+// az_update_wall_grid does).  The functions below give the same results either
+// way, but are faster when the placement is valid, since they needn't call cos
+// and sin to transform each query into the wall's own coordinates.
+void az_place_wall(az_wall_t *wall);
+
 // Determine if the specified point overlaps the wall.
 bool az_point_touches_wall(const az_wall_t *wall, az_vector_t point);
 
@@ -23,7 +23,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__APPLE__)
 #include <SDL_filesystem.h>
+#endif
 
 #include "azimuth/util/rw.h"
 #include "azimuth/util/string.h"
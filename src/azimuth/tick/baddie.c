@@ -22,6 +22,7 @@
 #include <assert.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "azimuth/constants.h"
 #include "azimuth/state/baddie.h"
@@ -47,6 +48,7 @@
 #include "azimuth/tick/baddie_wyrm.h"
 #include "azimuth/tick/baddie_zipper.h"
 #include "azimuth/tick/object.h"
+#include "azimuth/tick/profile.h"
 #include "azimuth/tick/script.h"
 #include "azimuth/util/misc.h"
 #include "azimuth/util/random.h"
@@ -354,21 +356,26 @@ static void tick_baddie(az_space_state_t *state, az_baddie_t *baddie,
       break;
     case AZ_BAD_BEAM_WALL: break; // Do nothing.
     case AZ_BAD_SPARK:
-      if (az_random(0, 1) < 10.0 * time) {
+      if (az_rand_double(&state->rng, 0, 1) < 10.0 * time) {
         az_add_speck(
             state, (az_color_t){0, 255, 0, 255}, 1.0, baddie->position,
-            az_vpolar(az_random(20.0, 70.0), baddie->angle +
-                      az_random(AZ_DEG2RAD(-120), AZ_DEG2RAD(120))));
+            az_vpolar(az_rand_double(&state->rng, 20.0, 70.0),
+                      baddie->angle +
+                      az_rand_double(&state->rng, AZ_DEG2RAD(-120),
+                                     AZ_DEG2RAD(120))));
       }
-      if (az_random(0, 1) < time) {
-        const double angle = az_random(AZ_DEG2RAD(-135), AZ_DEG2RAD(135));
+      if (az_rand_double(&state->rng, 0, 1) < time) {
+        const double angle = az_rand_double(&state->rng, AZ_DEG2RAD(-135),
+                                            AZ_DEG2RAD(135));
         az_fire_baddie_projectile(state, baddie, AZ_PROJ_SPARK,
                                   0.0, 0.0, angle);
         for (int i = 0; i < 5; ++i) {
           az_add_speck(
               state, (az_color_t){0, 255, 0, 255}, 1.0, baddie->position,
-              az_vpolar(az_random(20.0, 70.0), baddie->angle + angle +
-                        az_random(AZ_DEG2RAD(-60), AZ_DEG2RAD(60))));
+              az_vpolar(az_rand_double(&state->rng, 20.0, 70.0),
+                        baddie->angle + angle +
+                        az_rand_double(&state->rng, AZ_DEG2RAD(-60),
+                                       AZ_DEG2RAD(60))));
         }
       }
       break;
@@ -418,8 +425,8 @@ static void tick_baddie(az_space_state_t *state, az_baddie_t *baddie,
       } else if (baddie->cooldown <= 0.0) {
         for (int i = 0; i < 360; i += 10) {
           az_fire_baddie_projectile(
-              state, baddie, (az_randint(0, 1) ? AZ_PROJ_FIREBALL_SLOW :
-                              AZ_PROJ_FIREBALL_FAST),
+              state, baddie, (az_rand_int(&state->rng, 0, 1) ?
+                              AZ_PROJ_FIREBALL_SLOW : AZ_PROJ_FIREBALL_FAST),
               baddie->data->main_body.bounding_radius, AZ_DEG2RAD(i), 0.0);
         }
         assert(!(baddie->data->main_body.immunities & AZ_DMGF_BOMB));
@@ -673,7 +680,7 @@ static void tick_baddie(az_space_state_t *state, az_baddie_t *baddie,
       break;
     case AZ_BAD_ERUPTION:
       if (baddie->state == 0) {
-        baddie->cooldown = az_random(1, 2);
+        baddie->cooldown = az_rand_double(&state->rng, 1, 2);
         baddie->state = 1;
       } else if (baddie->cooldown <= 0.0) {
         const az_projectile_t *proj =
@@ -828,10 +835,16 @@ static void tick_baddie(az_space_state_t *state, az_baddie_t *baddie,
 }
 
 void az_tick_baddies(az_space_state_t *state, double time) {
-  AZ_ARRAY_LOOP(baddie, state->baddies) {
+  for (int i = 0; i < state->baddie_slots.num_live; ++i) {
+    az_baddie_t *baddie = &state->baddies[state->baddie_slots.live[i]];
     if (baddie->kind == AZ_BAD_NOTHING) continue;
     assert(baddie->health > 0.0);
+    // Note the kind now, since the baddie may be killed (or change kind)
+    // during its tick.
+    const az_baddie_kind_t kind = baddie->kind;
+    const uint64_t start = az_profile_start(state);
     tick_baddie(state, baddie, time);
+    az_profile_stop_baddie(state, kind, start);
   }
 }
 
@@ -106,18 +106,19 @@ void az_tick_bad_red_atom(
   // Move electrons, and have them leave a flame trail:
   for (int i = 0; i < baddie->data->num_components; ++i) {
     az_component_t *component = &baddie->components[i];
-    az_particle_t *particle;
+    az_particle_t particle;
     if (times_per_second(state, 20, time) &&
         az_insert_particle(state, &particle)) {
-      particle->kind = AZ_PAR_EMBER;
-      particle->color = (az_color_t){255, 64, 0, 128};
-      particle->position =
+      particle.kind = AZ_PAR_EMBER;
+      particle.color = (az_color_t){255, 64, 0, 128};
+      particle.position =
         az_vadd(az_vrotate(component->position, baddie->angle),
                 baddie->position);
-      particle->velocity = AZ_VZERO;
-      particle->angle = baddie->angle + component->angle;
-      particle->lifetime = 0.3;
-      particle->param1 = 1.5 * baddie->data->components[i].bounding_radius;
+      particle.velocity = AZ_VZERO;
+      particle.angle = baddie->angle + component->angle;
+      particle.lifetime = 0.3;
+      particle.param1 = 1.5 * baddie->data->components[i].bounding_radius;
+      az_add_particle(state, &particle);
     }
     component->angle = az_mod2pi(component->angle + 5.0 * time);
     component->position = az_vpolar(5.0, component->angle);
@@ -120,7 +120,7 @@ void az_tick_bad_chomper_plant(
     az_vpluseq(&head_pos, delta);
     if (baddie->cooldown <= 0.0 && line_of_sight &&
         az_vwithin(ship_pos, head_pos, 150)) {
-      baddie->cooldown = az_random(0.35, 0.8);
+      baddie->cooldown = az_rand_double(&state->rng, 0.35, 0.8);
       baddie->state = 1;
     }
   }
@@ -176,7 +176,7 @@ void az_tick_bad_aquatic_chomper(
             AZ_DEG2RAD(i * 5), 0.0);
       }
       az_play_sound(&state->soundboard, AZ_SND_FIRE_FIREBALL);
-      baddie->cooldown = az_random(2.0, 4.0);
+      baddie->cooldown = az_rand_double(&state->rng, 2.0, 4.0);
     }
   } else {
     // Sway head side to side.
@@ -243,12 +243,13 @@ void az_tick_bad_jungle_chomper(
     if (baddie->cooldown <= 0.0) {
       az_fire_baddie_projectile(state, baddie,
           AZ_PROJ_FIREBALL_FAST, baddie->data->main_body.bounding_radius,
-          0.0, az_random(-1, 1) * AZ_DEG2RAD(10));
+          0.0, az_rand_double(&state->rng, -1, 1) * AZ_DEG2RAD(10));
       az_play_sound(&state->soundboard, AZ_SND_FIRE_FIREBALL);
       az_vpluseq(&head_pos, az_vpolar(-10, head_angle));
       if (line_of_sight) --baddie->state;
       else baddie->state = 0;
-      baddie->cooldown = (baddie->state == 0 ? 2.0 : az_random(0.1, 0.15));
+      baddie->cooldown = (baddie->state == 0 ? 2.0 :
+                          az_rand_double(&state->rng, 0.1, 0.15));
     }
   }
   // Update the baddie's position and components.
@@ -282,7 +283,7 @@ void az_tick_bad_fire_chomper(
           baddie->data->main_body.bounding_radius, 0.0, 0.0);
       az_play_sound(&state->soundboard, AZ_SND_FIRE_ROCKET);
       az_vpluseq(&head_pos, az_vpolar(-10, baddie->angle));
-      baddie->cooldown = az_random(2.0, 4.0);
+      baddie->cooldown = az_rand_double(&state->rng, 2.0, 4.0);
     }
   } else {
     // Sway head side to side.
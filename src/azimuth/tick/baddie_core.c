@@ -286,9 +286,10 @@ static void init_rainbow_beam(az_space_state_t *state, az_baddie_t *baddie,
         az_baddie_t *mine = az_add_baddie(
             state, AZ_BAD_PROXY_MINE,
             az_vadd(az_vpolar(FIRE_RADIUS, abs_angle), baddie->position),
-            az_random(-AZ_PI, AZ_PI));
+            az_rand_double(&state->rng, -AZ_PI, AZ_PI));
         if (mine != NULL) {
-          mine->velocity = az_vpolar(az_random(400, 900), abs_angle);
+          mine->velocity =
+            az_vpolar(az_rand_double(&state->rng, 400, 900), abs_angle);
         }
       }
     }
@@ -383,17 +384,18 @@ static void charge_rainbow_beam(
       az_vadd(baddie->position,
               az_vpolar(FIRE_RADIUS, baddie->angle + angle_offset));
     const double angle = 145.0 * baddie->cooldown;
-    az_particle_t *particle;
+    az_particle_t particle;
     if (az_insert_particle(state, &particle)) {
-      particle->kind = AZ_PAR_EMBER;
-      particle->color = az_hsva_color(2.0 * angle, 0.5, 1.0, 0.75);
-      particle->position =
+      particle.kind = AZ_PAR_EMBER;
+      particle.color = az_hsva_color(2.0 * angle, 0.5, 1.0, 0.75);
+      particle.position =
         az_vadd(center, az_vpolar(particle_distance, angle));
-      particle->velocity =
+      particle.velocity =
         az_vpolar(-particle_distance / particle_lifetime, angle);
-      particle->angle = angle;
-      particle->lifetime = particle_lifetime;
-      particle->param1 = 7.0;
+      particle.angle = angle;
+      particle.lifetime = particle_lifetime;
+      particle.param1 = 7.0;
+      az_add_particle(state, &particle);
     }
   }
   if (baddie->cooldown <= 0.0) {
@@ -432,8 +434,8 @@ static void fire_rainbow_beam(az_space_state_t *state, az_baddie_t *baddie,
     if (other->kind == AZ_BAD_OTH_TENTACLE) continue;
     if (other == baddie) continue;
     const az_component_data_t *component;
-    if (az_ray_hits_baddie(other, beam_start, beam_delta,
-                           NULL, NULL, &component)) {
+    if (az_ray_hits_baddie(other, az_get_indexed_baddie_bounds(state, other),
+                           beam_start, beam_delta, NULL, NULL, &component)) {
       az_try_damage_baddie(state, other, component,
                            (AZ_DMGF_HYPER_ROCKET | AZ_DMGF_BEAM), beam_damage);
     }
@@ -447,20 +449,22 @@ static void fire_rainbow_beam(az_space_state_t *state, az_baddie_t *baddie,
               6 + az_clock_zigzag(6, 1, state->clock));
   for (int i = 0; i < 5; ++i) {
     az_add_speck(state, beam_color, 1.0, impact.position,
-                 az_vpolar(az_random(20.0, 70.0),
+                 az_vpolar(az_rand_double(&state->rng, 20.0, 70.0),
                            az_vtheta(impact.normal) +
-                           az_random(-AZ_HALF_PI, AZ_HALF_PI)));
+                           az_rand_double(&state->rng, -AZ_HALF_PI,
+                                          AZ_HALF_PI)));
   }
-  az_particle_t *particle;
+  az_particle_t particle;
   if (az_clock_mod(2, 1, state->clock) == 0 &&
       az_insert_particle(state, &particle)) {
-    particle->kind = AZ_PAR_EXPLOSION;
-    particle->color = beam_color;
-    particle->position = impact.position;
-    particle->velocity = AZ_VZERO;
-    particle->angle = beam_angle;
-    particle->lifetime = 0.5;
-    particle->param1 = 8.0;
+    particle.kind = AZ_PAR_EXPLOSION;
+    particle.color = beam_color;
+    particle.position = impact.position;
+    particle.velocity = AZ_VZERO;
+    particle.angle = beam_angle;
+    particle.lifetime = 0.5;
+    particle.param1 = 8.0;
+    az_add_particle(state, &particle);
   }
   az_loop_sound(&state->soundboard, AZ_SND_CORE_BEAM_FIRE);
 
@@ -519,7 +523,7 @@ static void do_pillbox_1(az_space_state_t *state, az_baddie_t *baddie,
         set_tertiary_state(baddie, remaining);
       } else {
         set_secondary_state(baddie, (secondary == 0 ? 1 : 0));
-        set_tertiary_state(baddie, az_randint(3, 9));
+        set_tertiary_state(baddie, az_rand_int(&state->rng, 3, 9));
       }
       baddie->cooldown = 0.5;
     }
@@ -534,7 +538,7 @@ static void do_pillbox_2(az_space_state_t *state, az_baddie_t *baddie,
   const int secondary = get_secondary_state(baddie);
   if (secondary == 0) {
     if (baddie->cooldown <= 0.0 && !try_transition(state, baddie)) {
-      set_secondary_state(baddie, az_randint(1, 2));
+      set_secondary_state(baddie, az_rand_int(&state->rng, 1, 2));
       baddie->cooldown = 0.3;
     }
   } else {
@@ -574,15 +578,16 @@ static bool advance_prismatic(az_space_state_t *state, az_baddie_t *baddie,
       const az_vector_t base = az_vpolar(90.0, angle);
       const az_vector_t perp = az_vpolar(7.0, angle + AZ_HALF_PI);
       for (int j = 0; j < 12; ++j) {
-        az_particle_t *particle;
+        az_particle_t particle;
         if (az_insert_particle(state, &particle)) {
-          particle->kind = AZ_PAR_EMBER;
-          particle->color = az_hsva_color(j * AZ_DEG2RAD(60), 0.5, 1.0, 0.75);
-          particle->position = az_vadd(base, az_vmul(perp, j - 5.5));
-          particle->velocity = AZ_VZERO;
-          particle->angle = angle;
-          particle->lifetime = PRISMATIC_CHARGE_TIME - PRISMATIC_PUMP_TIME;
-          particle->param1 = 20.0;
+          particle.kind = AZ_PAR_EMBER;
+          particle.color = az_hsva_color(j * AZ_DEG2RAD(60), 0.5, 1.0, 0.75);
+          particle.position = az_vadd(base, az_vmul(perp, j - 5.5));
+          particle.velocity = AZ_VZERO;
+          particle.angle = angle;
+          particle.lifetime = PRISMATIC_CHARGE_TIME - PRISMATIC_PUMP_TIME;
+          particle.param1 = 20.0;
+          az_add_particle(state, &particle);
         }
       }
     }
@@ -642,7 +647,7 @@ static void do_starburst(az_space_state_t *state, az_baddie_t *baddie,
       baddie->angle = az_mod2pi(baddie->angle + baddie->param * time);
       if (baddie->param >= max_turn_rate) {
         set_tertiary_state(baddie, 1);
-        baddie->cooldown = az_random(0.5, 2.0);
+        baddie->cooldown = az_rand_double(&state->rng, 0.5, 2.0);
       }
       break;
     case 1: {
@@ -700,15 +705,17 @@ static void do_buzzsaw(az_space_state_t *state, az_baddie_t *baddie,
   baddie->angle = az_mod2pi(baddie->angle + turn_rate * time);
   if (baddie->cooldown <= 0.0) {
     const int secondary = get_secondary_state(baddie);
-    const double angle = (reverse ?
-                          az_random(AZ_DEG2RAD(60), AZ_DEG2RAD(80)) :
-                          az_random(AZ_DEG2RAD(-80), AZ_DEG2RAD(-60)));
+    const double angle =
+      (reverse ?
+       az_rand_double(&state->rng, AZ_DEG2RAD(60), AZ_DEG2RAD(80)) :
+       az_rand_double(&state->rng, AZ_DEG2RAD(-80), AZ_DEG2RAD(-60)));
     az_fire_baddie_projectile(state, baddie, AZ_PROJ_ORBITAL_TORPEDO,
                               120.0, AZ_DEG2RAD(45) * secondary, angle);
     az_play_sound(&state->soundboard, AZ_SND_FIRE_FIREBALL);
     set_secondary_state(baddie, az_modulo(secondary - 3, 8));
     if (!try_transition(state, baddie)) {
-      baddie->cooldown = az_random(1.0, 1.5) * (reverse ? 0.4 : 0.5);
+      baddie->cooldown =
+        az_rand_double(&state->rng, 1.0, 1.5) * (reverse ? 0.4 : 0.5);
     }
   }
 }
@@ -741,18 +748,19 @@ void az_tick_bad_zenith_core(az_space_state_t *state, az_baddie_t *baddie,
         if (other->kind == AZ_BAD_OTH_TENTACLE) ++num_tentacles;
       }
       if (num_tentacles < 9) {
-        const double rho = az_random(600, 675);
-        const double theta = az_random(-AZ_PI, AZ_PI);
-        az_particle_t *particle;
+        const double rho = az_rand_double(&state->rng, 600, 675);
+        const double theta = az_rand_double(&state->rng, -AZ_PI, AZ_PI);
+        az_particle_t particle;
         if (az_insert_particle(state, &particle)) {
-          particle->kind = AZ_PAR_LIGHTNING_BOLT;
-          particle->color = (az_color_t){128, 64, 255, 255};
-          particle->position = az_vpolar(80, theta);
-          particle->velocity = AZ_VZERO;
-          particle->angle = theta;
-          particle->lifetime = 2.0;
-          particle->param1 = rho - 80;
-          particle->param2 = 0.5;
+          particle.kind = AZ_PAR_LIGHTNING_BOLT;
+          particle.color = (az_color_t){128, 64, 255, 255};
+          particle.position = az_vpolar(80, theta);
+          particle.velocity = AZ_VZERO;
+          particle.angle = theta;
+          particle.lifetime = 2.0;
+          particle.param1 = rho - 80;
+          particle.param2 = 0.5;
+          az_add_particle(state, &particle);
         }
         az_play_sound(&state->soundboard, AZ_SND_ELECTRICITY);
         az_add_baddie(state, AZ_BAD_OTH_TENTACLE,
@@ -42,7 +42,7 @@ void az_tick_bad_spined_crawler(
   assert(baddie->kind == AZ_BAD_SPINED_CRAWLER);
   if (baddie->state == 0) {
     baddie->param = baddie->angle;
-    baddie->state = az_randint(1, 2);
+    baddie->state = az_rand_int(&state->rng, 1, 2);
   }
   if (baddie->state == 1 || baddie->state == 2) {
     const double angle = fabs(az_mod2pi(baddie->angle - baddie->param));
@@ -61,7 +61,8 @@ void az_tick_bad_spined_crawler(
         az_add_projectile(
             state, AZ_PROJ_STINGER,
             az_vadd(center, az_vpolar(10.0, theta)),
-            theta + az_random(-1, 1) * AZ_DEG2RAD(20), 1.0, baddie->uid);
+            theta + az_rand_double(&state->rng, -1, 1) * AZ_DEG2RAD(20), 1.0,
+            baddie->uid);
       }
       az_play_sound(&state->soundboard, AZ_SND_FIRE_STINGER);
       baddie->velocity = AZ_VZERO;
@@ -70,7 +71,9 @@ void az_tick_bad_spined_crawler(
     }
   } else if (baddie->state == 3) {
     baddie->velocity = AZ_VZERO;
-    if (baddie->cooldown <= 0.0) baddie->state = az_randint(1, 2);
+    if (baddie->cooldown <= 0.0) {
+      baddie->state = az_rand_int(&state->rng, 1, 2);
+    }
   } else baddie->state = 0;
 }
 
@@ -114,10 +117,13 @@ void az_tick_bad_crab_crawler(
       else if (baddie->state == 2 && rel_angle > 0.0) baddie->state = 1;
     }
   } else if (baddie->state == 3) {
-    if (baddie->cooldown <= 0.0) baddie->state = az_randint(1, 2);
-    else if (baddie->cooldown > claw_open_time) open_claws = false;
+    if (baddie->cooldown <= 0.0) {
+      baddie->state = az_rand_int(&state->rng, 1, 2);
+    } else if (baddie->cooldown > claw_open_time) {
+      open_claws = false;
+    }
   } else {
-    baddie->state = az_randint(1, 2);
+    baddie->state = az_rand_int(&state->rng, 1, 2);
   }
   // Open/close claws:
   const double old_claw_angle = baddie->components[1].angle;
@@ -149,7 +155,7 @@ void az_tick_bad_fire_crawler(
   assert(baddie->kind == AZ_BAD_FIRE_CRAWLER);
   az_crawl_around(state, baddie, time, true, 3.0, 40.0, 100.0);
   if (baddie->state <= 0) {
-    baddie->state = az_randint(2, 5);
+    baddie->state = az_rand_int(&state->rng, 2, 5);
     baddie->cooldown = 2.0;
   } else if (baddie->cooldown <= 0.0 &&
              az_ship_in_range(state, baddie, 300) &&
@@ -157,7 +163,7 @@ void az_tick_bad_fire_crawler(
     az_fire_baddie_projectile(
         state, baddie, AZ_PROJ_FIREBALL_SLOW, 0.0, 0.0,
         az_vtheta(az_vsub(state->ship.position, baddie->position)) +
-        AZ_DEG2RAD(5) * az_random(-1, 1) - baddie->angle);
+        AZ_DEG2RAD(5) * az_rand_double(&state->rng, -1, 1) - baddie->angle);
     az_play_sound(&state->soundboard, AZ_SND_FIRE_FIREBALL);
     baddie->cooldown = 0.1;
     --baddie->state;
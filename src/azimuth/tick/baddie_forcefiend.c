@@ -95,10 +95,10 @@ static bool there_are_no_gravity_torps(const az_space_state_t *state) {
   return true;
 }
 
-static void begin_chase(az_baddie_t *baddie) {
+static void begin_chase(az_space_state_t *state, az_baddie_t *baddie) {
   assert(baddie->kind == AZ_BAD_FORCEFIEND);
   set_primary_state(baddie, CHASE_STATE);
-  set_secondary_state(baddie, az_randint(0, 3));
+  set_secondary_state(baddie, az_rand_int(&state->rng, 0, 3));
   baddie->cooldown = 0.75;
 }
 
@@ -200,7 +200,7 @@ void az_tick_bad_forcefiend(az_space_state_t *state, az_baddie_t *baddie,
           az_play_sound(&state->soundboard, AZ_SND_FIRE_GRAVITY_TORPEDO);
         }
       }
-      if (get_num_eggs(state) < az_randint(4, 8)) {
+      if (get_num_eggs(state) < az_rand_int(&state->rng, 4, 8)) {
         az_add_baddie(state, AZ_BAD_FORCE_EGG,
                       baddie->position, baddie->angle);
         set_secondary_state(baddie, az_modulo(secondary + 1, 4));
@@ -247,10 +247,10 @@ void az_tick_bad_forcefiend(az_space_state_t *state, az_baddie_t *baddie,
       }
       if (get_num_eggs(state) >= 3) {
         set_primary_state(baddie, FORCE_FLURRY_STATE);
-        set_secondary_state(baddie, az_randint(10, 15));
+        set_secondary_state(baddie, az_rand_int(&state->rng, 10, 15));
         baddie->cooldown = 0.0;
       } else {
-        begin_chase(baddie);
+        begin_chase(state, baddie);
       }
     }
   }
@@ -271,7 +271,7 @@ void az_tick_bad_forcefiend(az_space_state_t *state, az_baddie_t *baddie,
         az_ship_within_angle(state, baddie, 0, AZ_DEG2RAD(60))) {
       const double min_rel_angle = az_mod2pi(min_abs_angle - baddie->angle);
       const double max_rel_angle = az_mod2pi(max_abs_angle - baddie->angle);
-      const double rel_angle = az_random(
+      const double rel_angle = az_rand_double(&state->rng, 
           fmin(fmax(min_rel_angle, -1.3), max_rel_angle),
           fmin(fmax(min_rel_angle,  1.3), max_rel_angle));
       az_projectile_t *force_wave =
@@ -284,7 +284,7 @@ void az_tick_bad_forcefiend(az_space_state_t *state, az_baddie_t *baddie,
       baddie->cooldown = 0.4 - 0.1 * hurt;
       const int remaining = get_secondary_state(baddie) - 1;
       if (remaining > 0) set_secondary_state(baddie, remaining);
-      else begin_chase(baddie);
+      else begin_chase(state, baddie);
     }
     if (az_ship_is_decloaked(&state->ship) &&
         az_vwithin(state->ship.position, baddie->position, 120.0)) {
@@ -292,7 +292,7 @@ void az_tick_bad_forcefiend(az_space_state_t *state, az_baddie_t *baddie,
       baddie->param = 0.0;
     } else if (az_mod2pi_nonneg(theta_to_ship - min_abs_angle) >
                2 * half_angle_span) {
-      begin_chase(baddie);
+      begin_chase(state, baddie);
     }
   }
   // CLAW_SWIPE/UNSWIPE_STATE: Swipe at ship with claws.
@@ -308,7 +308,7 @@ void az_tick_bad_forcefiend(az_space_state_t *state, az_baddie_t *baddie,
         az_vtheta(az_vsub(state->ship.position, baddie->position)));
     baddie->param = fmax(0.0, baddie->param - time / 0.5);
     if (baddie->param <= 0.0) {
-      begin_chase(baddie);
+      begin_chase(state, baddie);
     }
   }
   // Move claws:
@@ -414,7 +414,7 @@ static void tick_fish(az_space_state_t *state, az_baddie_t *baddie,
     az_snake_towards(state, baddie, time, 0, roam_speed, wiggle, dest, false);
     // If we're getting near a wall ahead, turn back.
     if (dist <= 90.0) {
-      const int shift = (az_randint(0, 1) ? 3 : -3);
+      const int shift = (az_rand_int(&state->rng, 0, 1) ? 3 : -3);
       baddie->state = az_modulo(baddie->state + shift, 8);
     }
   }
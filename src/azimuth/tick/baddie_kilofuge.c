@@ -186,11 +186,13 @@ static void choose_next_state(
     }
   }
 
-  if (az_randint(1, (baddie->state == HIDING_STATE ? 3 : 6)) == 1) {
+  if (az_rand_int(&state->rng, 1,
+                  (baddie->state == HIDING_STATE ? 3 : 6)) == 1) {
     release_gnat_swarm(state, baddie);
     baddie->state = WAITING_STATE;
     baddie->cooldown = 2.0 / speed_mult(baddie);
-  } else if (baddie->state != HIDING_STATE && az_randint(1, 7) == 1) {
+  } else if (baddie->state != HIDING_STATE &&
+             az_rand_int(&state->rng, 1, 7) == 1) {
     baddie->state = CROSSBEAM_STATE;
     baddie->cooldown = 2.5 / speed_mult(baddie);
     baddie->components[FIRST_EYE_COMPONENT_INDEX + 1].angle = AZ_DEG2RAD(-45);
@@ -340,9 +342,10 @@ static void fire_beam_from_eye(
   az_add_beam(state, beam_color, beam_start, impact.position, 0.0,
               power * (4.0 + 0.75 * az_clock_zigzag(8, 1, state->clock)));
   az_add_speck(state, AZ_WHITE, 1.0, impact.position,
-               az_vpolar(az_random(20.0, 70.0),
+               az_vpolar(az_rand_double(&state->rng, 20.0, 70.0),
                          az_vtheta(impact.normal) +
-                         az_random(-AZ_HALF_PI, AZ_HALF_PI)));
+                         az_rand_double(&state->rng, -AZ_HALF_PI,
+                                        AZ_HALF_PI)));
 }
 
 static void fire_meltbeam(
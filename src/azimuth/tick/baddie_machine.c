@@ -151,9 +151,10 @@ void az_tick_bad_heat_ray(
       az_add_beam(state, beam_color, beam_start, impact.position, 0.0,
                   4.0 + 0.5 * az_clock_zigzag(8, 1, state->clock));
       az_add_speck(state, AZ_WHITE, 1.0, impact.position,
-                   az_vpolar(az_random(20.0, 70.0),
+                   az_vpolar(az_rand_double(&state->rng, 20.0, 70.0),
                              az_vtheta(impact.normal) +
-                             az_random(-AZ_HALF_PI, AZ_HALF_PI)));
+                             az_rand_double(&state->rng, -AZ_HALF_PI,
+                                            AZ_HALF_PI)));
       if (az_ray_intersects_camera_rectangle(&state->camera, beam_start,
                                              beam_delta)) {
         az_loop_sound(&state->soundboard, AZ_SND_BEAM_FREEZE);
@@ -162,7 +163,7 @@ void az_tick_bad_heat_ray(
       }
     } else {
       baddie->state = 1;
-      baddie->cooldown = az_random(0.5, 3.0);
+      baddie->cooldown = az_rand_double(&state->rng, 0.5, 3.0);
     }
   }
   // State 1: Recharge until cooldown expires.
@@ -202,9 +203,10 @@ void az_tick_bad_death_ray(
     az_add_beam(state, beam_color, beam_start, impact.position, 0.0,
                 4.0 + 0.5 * az_clock_zigzag(8, 1, state->clock));
     az_add_speck(state, AZ_WHITE, 1.0, impact.position,
-                 az_vpolar(az_random(20.0, 70.0),
+                 az_vpolar(az_rand_double(&state->rng, 20.0, 70.0),
                            az_vtheta(impact.normal) +
-                           az_random(-AZ_HALF_PI, AZ_HALF_PI)));
+                           az_rand_double(&state->rng, -AZ_HALF_PI,
+                                          AZ_HALF_PI)));
     az_loop_sound(&state->soundboard, AZ_SND_BEAM_PIERCE);
   } else if (baddie->state == 0 && az_clock_mod(2, 2, state->clock)) {
     const az_color_t beam_color = {255, 128, 128, 128};
@@ -297,9 +299,10 @@ void az_tick_bad_boss_door(
                 (6.0 + 0.5 * az_clock_zigzag(8, 1, state->clock)) *
                 baddie->cooldown);
     az_add_speck(state, AZ_WHITE, 1.0, impact.position,
-                 az_vpolar(az_random(20.0, 70.0),
+                 az_vpolar(az_rand_double(&state->rng, 20.0, 70.0),
                            az_vtheta(impact.normal) +
-                           az_random(-AZ_HALF_PI, AZ_HALF_PI)));
+                           az_rand_double(&state->rng, -AZ_HALF_PI,
+                                          AZ_HALF_PI)));
     // When the cooldown timer reachers zero, stop firing the beam.
     if (baddie->cooldown <= 0.0) {
       baddie->state = 1;
@@ -336,7 +339,8 @@ void az_tick_bad_creepy_eye(
   }
   baddie->components[2].angle = -AZ_HALF_PI - baddie->components[1].angle;
   // Randomly blink:
-  if (baddie->cooldown <= 0.0 && az_random(0, 1) >= pow(0.8, time)) {
+  if (baddie->cooldown <= 0.0 &&
+      az_rand_double(&state->rng, 0, 1) >= pow(0.8, time)) {
     baddie->cooldown = 0.125;
   }
   // Regenerate health:
@@ -138,7 +138,7 @@ static void shuffle_marker_positions(
     az_space_state_t *state, az_vector_t positions_out[], int num_positions) {
   get_marker_positions(state, positions_out, num_positions);
   for (int i = num_positions - 1; i > 0; --i) {
-    const int j = az_randint(0, i);
+    const int j = az_rand_int(&state->rng, 0, i);
     const az_vector_t tmp = positions_out[i];
     positions_out[i] = positions_out[j];
     positions_out[j] = tmp;
@@ -545,7 +545,7 @@ void az_tick_bad_magbeest_head(az_space_state_t *state, az_baddie_t *baddie,
           // Position legs:
           if (hurt > 0.0) {
             const bool both = hurt >= 1/6.;
-            const bool left = both || az_randint(0, 1) != 0;
+            const bool left = both || az_rand_int(&state->rng, 0, 1) != 0;
             const bool right = both || !left;
             if (left) init_legs_popup(legs_l, marker_positions[1]);
             if (right) init_legs_popup(legs_r, marker_positions[2]);
@@ -905,11 +905,12 @@ void az_tick_bad_magbeest_legs_l(az_space_state_t *state, az_baddie_t *baddie,
       az_add_baddie(state, AZ_BAD_SCRAP_METAL,
                     az_vadd(magnet_abs_hinge_pos,
                             az_vpolar(1500.0, magnet_abs_angle +
-                                      az_random(-AZ_DEG2RAD(10),
-                                                AZ_DEG2RAD(10)))),
-                    az_random(-AZ_PI, AZ_PI));
+                                      az_rand_double(&state->rng,
+                                                     -AZ_DEG2RAD(10),
+                                                     AZ_DEG2RAD(10)))),
+                    az_rand_double(&state->rng, -AZ_PI, AZ_PI));
       --baddie->state;
-      baddie->cooldown = az_random(0.06, 0.12);
+      baddie->cooldown = az_rand_double(&state->rng, 0.06, 0.12);
     }
     // Apply force to scrap metal:
     double max_scrap_dist = 0.0;
@@ -940,11 +941,13 @@ void az_tick_bad_magbeest_legs_l(az_space_state_t *state, az_baddie_t *baddie,
         az_projectile_t *proj =
           az_add_projectile(state, AZ_PROJ_SCRAP_METAL, scrap->position,
                             magnet_abs_angle +
-                            az_random(-AZ_DEG2RAD(15), AZ_DEG2RAD(15)),
+                            az_rand_double(&state->rng, -AZ_DEG2RAD(15),
+                                           AZ_DEG2RAD(15)),
                             1.0, baddie->uid);
         if (proj != NULL) {
-          proj->angle = az_random(-AZ_PI, AZ_PI);
-          proj->velocity = az_vmul(proj->velocity, az_random(0.75, 1.25));
+          proj->angle = az_rand_double(&state->rng, -AZ_PI, AZ_PI);
+          proj->velocity = az_vmul(proj->velocity,
+                                   az_rand_double(&state->rng, 0.75, 1.25));
           ++num_scraps;
         }
         scrap->kind = AZ_BAD_NOTHING;
@@ -987,7 +990,8 @@ void az_tick_bad_magbeest_legs_l(az_space_state_t *state, az_baddie_t *baddie,
                                   baddie->angle);
       }
       if (baddie->cooldown <= 0.0) {
-        if (az_random(0.0, 1.0) < 1.0 - pow(0.75, baddie->param)) {
+        if (az_rand_double(&state->rng, 0.0, 1.0) <
+            1.0 - pow(0.75, baddie->param)) {
           baddie->state = MAGNET_FUSION_BEAM_CHARGE_STATE;
           baddie->cooldown = MAGNET_FUSION_BEAM_CHARGE_TIME;
           baddie->param = 0.0;
@@ -1104,7 +1108,8 @@ void az_tick_bad_magma_bomb(az_space_state_t *state, az_baddie_t *baddie,
   az_gravfield_t *lava = NULL;
   AZ_ARRAY_LOOP(gravfield, state->gravfields) {
     if (gravfield->kind != AZ_GRAV_LAVA) continue;
-    if (az_point_within_gravfield(gravfield, baddie->position)) {
+    if (az_gravfield_might_contain(state, gravfield, baddie->position) &&
+        az_point_within_gravfield(gravfield, baddie->position)) {
       lava = gravfield;
       break;
     }
@@ -1127,16 +1132,24 @@ void az_tick_bad_magma_bomb(az_space_state_t *state, az_baddie_t *baddie,
     az_add_projectile(state, AZ_PROJ_MAGMA_EXPLOSION, baddie->position,
                       az_vtheta(baddie->position), 1.0, AZ_NULL_UID);
     if (lava != NULL) {
-      for (int i = -4; i < 4; ++i) {
-        az_impact_t impact;
-        az_ray_impact(state, baddie->position,
-                      az_vpolar(1000.0, az_vtheta(baddie->position) +
-                                i * AZ_DEG2RAD(20)),
-                      (AZ_IMPF_BADDIE | AZ_IMPF_SHIP), baddie->uid, &impact);
+      // Adding projectiles can't change what the rays hit, so we can cast
+      // them all at once.
+      az_ray_t rays[8];
+      az_impact_t impacts[AZ_ARRAY_SIZE(rays)];
+      for (int i = 0; i < AZ_ARRAY_SIZE(rays); ++i) {
+        rays[i].start = baddie->position;
+        rays[i].delta = az_vpolar(1000.0, az_vtheta(baddie->position) +
+                                  (i - 4) * AZ_DEG2RAD(20));
+      }
+      az_ray_impact_batch(state, rays, AZ_ARRAY_SIZE(rays),
+                          (AZ_IMPF_BADDIE | AZ_IMPF_SHIP), baddie->uid,
+                          impacts);
+      for (int i = 0; i < AZ_ARRAY_SIZE(rays); ++i) {
         az_vector_t point, normal;
         if (az_ray_hits_liquid_surface(
                 lava, baddie->position,
-                az_vsub(impact.position, baddie->position), &point, &normal)) {
+                az_vsub(impacts[i].position, baddie->position),
+                &point, &normal)) {
           az_add_projectile(state, AZ_PROJ_ERUPTION, point,
                             az_vtheta(az_vneg(normal)), 1.0, AZ_NULL_UID);
         }
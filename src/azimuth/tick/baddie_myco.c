@@ -40,7 +40,8 @@ static void fire_spores(az_space_state_t *state, az_baddie_t *baddie,
                                               baddie->position)) -
                             baddie->angle), -limit), limit);
       az_fire_baddie_projectile(state, baddie, AZ_PROJ_MYCOSPORE, 10.0,
-                                angle, az_random(-spread, spread));
+                                angle,
+                                az_rand_double(&state->rng, -spread, spread));
       baddie->cooldown = 0.3;
     }
     baddie->state = 1;
@@ -58,10 +59,12 @@ static void fire_fireballs(az_space_state_t *state, az_baddie_t *baddie,
                                               baddie->position)) -
                             baddie->angle), -limit), limit);
       az_fire_baddie_projectile(state, baddie,
-                                (az_random(0, 1) < fast_chance ?
+                                (az_rand_double(&state->rng, 0, 1) <
+                                 fast_chance ?
                                  AZ_PROJ_FIREBALL_FAST :
                                  AZ_PROJ_FIREBALL_SLOW), 10.0,
-                                angle, az_random(-spread, spread));
+                                angle,
+                                az_rand_double(&state->rng, -spread, spread));
       az_play_sound(&state->soundboard, AZ_SND_FIRE_FIREBALL);
       baddie->cooldown = 0.2;
     }
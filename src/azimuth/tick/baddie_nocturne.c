@@ -134,11 +134,11 @@ void az_tick_bad_nocturne(az_space_state_t *state, az_baddie_t *baddie,
         assert(min_theta <= max_theta);
         for (int i = 0; i < 20; ++i) {
           const az_vector_t position =
-            az_vpolar(az_random(min_r, max_r),
-                      az_random(min_theta, max_theta));
+            az_vpolar(az_rand_double(&state->rng, min_r, max_r),
+                      az_rand_double(&state->rng, min_theta, max_theta));
           if (spot_is_clear(state, position)) {
             baddie->position = position;
-            baddie->angle = az_random(-AZ_PI, AZ_PI);
+            baddie->angle = az_rand_double(&state->rng, -AZ_PI, AZ_PI);
             baddie->state = ROAM_AROUND_STATE;
             break;
           }
@@ -73,22 +73,13 @@ void az_tick_bad_oth_brawler(
     fabs(az_mod2pi(az_vtheta(ship_delta) - baddie->angle)) <= AZ_DEG2RAD(10);
   // Figure out if we have a clear shot at the ship (ignoring walls that can be
   // destroyed by rockets, because we can just punch through those).
-  bool clear_shot = true;
-  az_impact_t impact;
-  az_ray_impact(state, baddie->position, ship_delta,
-                (AZ_IMPF_BADDIE | AZ_IMPF_WALL), baddie->uid, &impact);
-  if (impact.type != AZ_IMP_SHIP) clear_shot = false;
-  else {
-    AZ_ARRAY_LOOP(wall, state->walls) {
-      if (wall->kind == AZ_WALL_NOTHING ||
-          wall->kind == AZ_WALL_DESTRUCTIBLE_CHARGED ||
-          wall->kind == AZ_WALL_DESTRUCTIBLE_ROCKET) continue;
-      if (az_ray_hits_wall(wall, baddie->position, ship_delta, NULL, NULL)) {
-        clear_shot = false;
-        break;
-      }
-    }
-  }
+  const bool clear_shot =
+    (az_ray_reaches_ship(state, baddie->position,
+                         (AZ_IMPF_BADDIE | AZ_IMPF_WALL), baddie->uid) &&
+     !az_ray_blocked(state, baddie->position, ship_delta,
+                     (AZ_IMPF_BADDIE | AZ_IMPF_DOOR_INSIDE |
+                      AZ_IMPF_DOOR_OUTSIDE | AZ_IMPF_SHIP |
+                      AZ_IMPF_WEAK_WALL), baddie->uid));
   // Fire weapons:
   bool strafe = false;
   if (baddie->state <= 0) {
@@ -202,7 +193,7 @@ void az_tick_bad_oth_crawler(
           state, baddie, AZ_PROJ_OTH_MINIROCKET,
           0.0, az_vtheta(rel_impact) - baddie->angle, 0.0);
       az_play_sound(&state->soundboard, AZ_SND_FIRE_OTH_MINIROCKET);
-      baddie->cooldown = az_random(1.0, 2.0);
+      baddie->cooldown = az_rand_double(&state->rng, 1.0, 2.0);
     }
   }
   az_tick_oth_tendrils(baddie, &AZ_OTH_CRAWLER_TENDRILS, old_angle, time,
@@ -255,7 +246,7 @@ void az_tick_bad_oth_orb_2(
       az_can_see_ship(state, baddie)) {
     az_fire_baddie_projectile(state, baddie, AZ_PROJ_OTH_HOMING,
                               baddie->data->main_body.bounding_radius,
-                              az_random(-AZ_PI, AZ_PI), 0.0);
+                              az_rand_double(&state->rng, -AZ_PI, AZ_PI), 0.0);
     baddie->cooldown = 0.1;
   }
   az_tick_oth_tendrils(baddie, &AZ_OTH_ORB_TENDRILS, old_angle, time,
@@ -271,7 +262,8 @@ void az_tick_bad_oth_razor(
     baddie->temp_properties |= AZ_BADF_INCORPOREAL | AZ_BADF_NO_HOMING;
   }
   if (baddie->state == 0) {
-    baddie->velocity = az_vpolar(az_random(300, 500), baddie->angle);
+    baddie->velocity =
+      az_vpolar(az_rand_double(&state->rng, 300, 500), baddie->angle);
     baddie->state = 2;
   } else if (baddie->state == 1) {
     baddie->velocity = az_vpolar(300, baddie->angle);
@@ -335,7 +327,7 @@ void az_tick_bad_oth_snapdragon(
           if (razor == NULL) break;
         }
         az_play_sound(&state->soundboard, AZ_SND_LAUNCH_OTH_RAZORS);
-        baddie->cooldown = az_random(2.0, 4.0);
+        baddie->cooldown = az_rand_double(&state->rng, 2.0, 4.0);
         ++baddie->state;
         break;
       // State 8: Launch four Oth Razors that bounce aimlessly.
@@ -348,7 +340,7 @@ void az_tick_bad_oth_snapdragon(
           else break;
         }
         az_play_sound(&state->soundboard, AZ_SND_LAUNCH_OTH_RAZORS);
-        baddie->cooldown = az_random(2.0, 4.0);
+        baddie->cooldown = az_rand_double(&state->rng, 2.0, 4.0);
         baddie->state = 0;
         break;
       default:
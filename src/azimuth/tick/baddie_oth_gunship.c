@@ -133,11 +133,11 @@ static void begin_retreat(az_baddie_t *baddie) {
   baddie->cooldown = 0.5;
 }
 
-static void begin_dogfight(az_baddie_t *baddie) {
+static void begin_dogfight(az_space_state_t *state, az_baddie_t *baddie) {
   assert(baddie->kind == AZ_BAD_OTH_GUNSHIP);
   const double hurt = 1.0 - baddie->health / baddie->data->max_health;
   set_primary_state(baddie, DOGFIGHT_STATE);
-  set_secondary_state(baddie, az_randint(20, 40 - 15 * hurt));
+  set_secondary_state(baddie, az_rand_int(&state->rng, 20, 40 - 15 * hurt));
   baddie->cooldown = 0.2;
 }
 
@@ -212,7 +212,7 @@ void az_tick_bad_oth_gunship(
                 baddie->data->main_body.bounding_radius, AZ_DEG2RAD(i), 0);
           }
           az_play_sound(&state->soundboard, AZ_SND_FIRE_OTH_SPRAY);
-          begin_dogfight(baddie);
+          begin_dogfight(state, baddie);
         }
       } else {
         fly_towards(state, baddie, time, target);
@@ -230,7 +230,7 @@ void az_tick_bad_oth_gunship(
         }
       }
       if (nearest == NULL) {
-        begin_dogfight(baddie);
+        begin_dogfight(state, baddie);
         break;
       }
       if (best_dist <= TRACTOR_MAX_LENGTH) {
@@ -252,18 +252,19 @@ void az_tick_bad_oth_gunship(
             baddie->velocity, az_vpolar(FORWARD_ACCEL * time, baddie->angle)),
                                                   500.0), axis);
         if (baddie->cooldown <= 2.0) {
-          az_particle_t *particle;
+          az_particle_t particle;
           for (int offset = -30; offset <= 30; offset += 60) {
             if (az_insert_particle(state, &particle)) {
-              particle->kind = AZ_PAR_OTH_FRAGMENT;
-              particle->color = (az_color_t){192, 192, 192,
+              particle.kind = AZ_PAR_OTH_FRAGMENT;
+              particle.color = (az_color_t){192, 192, 192,
                   255 * (0.25 + 0.25 * (2.0 - baddie->cooldown))};
-              particle->position =
+              particle.position =
                 az_vadd(baddie->position,
                         az_vpolar(-17.0, baddie->angle + AZ_DEG2RAD(offset)));
-              particle->velocity = AZ_VZERO;
-              particle->lifetime = 0.5;
-              particle->param1 = 8.0;
+              particle.velocity = AZ_VZERO;
+              particle.lifetime = 0.5;
+              particle.param1 = 8.0;
+              az_add_particle(state, &particle);
             }
           }
         }
@@ -273,11 +274,11 @@ void az_tick_bad_oth_gunship(
           set_primary_state(baddie, CPLUS_READY_STATE);
           baddie->cooldown = CPLUS_DECAY_TIME;
         }
-      } else begin_dogfight(baddie);
+      } else begin_dogfight(state, baddie);
     } break;
     case CPLUS_READY_STATE: {
       if (baddie->cooldown <= 0.0) {
-        begin_dogfight(baddie);
+        begin_dogfight(state, baddie);
         break;
       }
       az_loop_sound(&state->soundboard, AZ_SND_CPLUS_READY);
@@ -307,17 +308,18 @@ void az_tick_bad_oth_gunship(
       if (fabs(az_mod2pi(az_vtheta(baddie->velocity) -
                          baddie->angle)) > AZ_DEG2RAD(5)) {
         az_play_sound(&state->soundboard, AZ_SND_CPLUS_IMPACT);
-        begin_dogfight(baddie);
+        begin_dogfight(state, baddie);
       } else {
-        az_particle_t *particle;
+        az_particle_t particle;
         if (az_insert_particle(state, &particle)) {
-          particle->kind = AZ_PAR_OTH_FRAGMENT;
-          particle->color = (az_color_t){192, 255, 192, 255};
-          particle->position =
+          particle.kind = AZ_PAR_OTH_FRAGMENT;
+          particle.color = (az_color_t){192, 255, 192, 255};
+          particle.position =
             az_vadd(baddie->position, az_vpolar(-15.0, baddie->angle));
-          particle->velocity = AZ_VZERO;
-          particle->lifetime = 0.3;
-          particle->param1 = 16;
+          particle.velocity = AZ_VZERO;
+          particle.lifetime = 0.3;
+          particle.param1 = 16;
+          az_add_particle(state, &particle);
         }
       }
     } break;
@@ -394,7 +396,7 @@ void az_tick_bad_oth_gunship(
       }
     } break;
     default:
-      begin_dogfight(baddie);
+      begin_dogfight(state, baddie);
       break;
   }
   az_tick_oth_tendrils(baddie, &AZ_OTH_GUNSHIP_TENDRILS, old_angle, time,
@@ -409,7 +411,7 @@ void az_on_oth_gunship_damaged(
     set_tractor_node(baddie, NULL);
     const int primary = get_primary_state(baddie);
     if (primary == SPIN_UP_CPLUS_STATE) {
-      begin_dogfight(baddie);
+      begin_dogfight(state, baddie);
     } else if (primary == DOGFIGHT_STATE) {
       const int secondary = get_secondary_state(baddie);
       if (secondary >= 5) {
@@ -418,7 +420,7 @@ void az_on_oth_gunship_damaged(
     }
     double theta =
       az_vtheta(az_vrot90ccw(az_vsub(baddie->position, state->ship.position)));
-    if (az_randint(0, 1)) theta = -theta;
+    if (az_rand_int(&state->rng, 0, 1)) theta = -theta;
     az_vpluseq(&baddie->velocity, az_vpolar(250, theta));
   }
 }
@@ -460,16 +462,17 @@ void az_tick_bad_reflection(az_space_state_t *state, az_baddie_t *baddie,
                 baddie->position);
       const double abs_angle =
         az_vtheta(az_vsub(state->ship.position, abs_position));
-      az_particle_t *particle;
+      az_particle_t particle;
       if (az_insert_particle(state, &particle)) {
-        particle->kind = AZ_PAR_NPS_PORTAL;
-        particle->color = (az_color_t){128, 64, 255, 255};
-        particle->position = abs_position;
-        particle->velocity = AZ_VZERO;
-        particle->angle = 0.0;
-        particle->age = 0.5 * nps_lifetime;
-        particle->lifetime = nps_lifetime;
-        particle->param1 = 50.0 * sqrt(nps_lifetime);
+        particle.kind = AZ_PAR_NPS_PORTAL;
+        particle.color = (az_color_t){128, 64, 255, 255};
+        particle.position = abs_position;
+        particle.velocity = AZ_VZERO;
+        particle.angle = 0.0;
+        particle.age = 0.5 * nps_lifetime;
+        particle.lifetime = nps_lifetime;
+        particle.param1 = 50.0 * sqrt(nps_lifetime);
+        az_add_particle(state, &particle);
       }
       const az_script_t *script = baddie->on_kill;
       az_init_baddie(baddie, AZ_BAD_OTH_GUNSHIP, abs_position, abs_angle);
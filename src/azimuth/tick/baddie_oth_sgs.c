@@ -207,17 +207,17 @@ static void spawn_razors(az_space_state_t *state, az_vector_t position,
 
 /*===========================================================================*/
 
-static void begin_dogfight(az_baddie_t *baddie) {
+static void begin_dogfight(az_space_state_t *state, az_baddie_t *baddie) {
   assert(baddie->kind == AZ_BAD_OTH_SUPERGUNSHIP);
   set_primary_state(baddie, DOGFIGHT_STATE);
-  set_secondary_state(baddie, az_randint(10, 20));
+  set_secondary_state(baddie, az_rand_int(&state->rng, 10, 20));
   baddie->cooldown = 0.2;
 }
 
-static void resume_dogfight(az_baddie_t *baddie) {
+static void resume_dogfight(az_space_state_t *state, az_baddie_t *baddie) {
   assert(baddie->kind == AZ_BAD_OTH_SUPERGUNSHIP);
   set_primary_state(baddie, DOGFIGHT_STATE);
-  set_secondary_state(baddie, az_randint(4, 7));
+  set_secondary_state(baddie, az_rand_int(&state->rng, 4, 7));
   baddie->cooldown = 0.2;
 }
 
@@ -298,7 +298,7 @@ void az_tick_bad_oth_supergunship(
 
   switch (get_primary_state(baddie)) {
     case INITIAL_STATE: {
-      begin_dogfight(baddie);
+      begin_dogfight(state, baddie);
     } break;
     case DOGFIGHT_STATE: {
       // For dogfighting, secondary state is number of shots left; tertiary
@@ -382,16 +382,17 @@ void az_tick_bad_oth_supergunship(
         az_add_beam(state, beam_color, beam_start, impact.position, 0.0,
                     (3.0 + 0.5 * az_clock_zigzag(8, 1, state->clock)));
         az_add_speck(state, AZ_WHITE, 1.0, impact.position,
-                     az_vpolar(az_random(20.0, 70.0),
+                     az_vpolar(az_rand_double(&state->rng, 20.0, 70.0),
                                az_vtheta(impact.normal) +
-                               az_random(-AZ_HALF_PI, AZ_HALF_PI)));
+                               az_rand_double(&state->rng, -AZ_HALF_PI,
+                                              AZ_HALF_PI)));
         az_loop_sound(&state->soundboard, AZ_SND_BEAM_NORMAL);
       }
       // When we run out of time, switch modes.
       if (baddie->cooldown <= 0.0) {
         if (get_secondary_state(baddie) != 0) {
           begin_charged_beam(baddie);
-        } else resume_dogfight(baddie);
+        } else resume_dogfight(state, baddie);
       }
     } break;
     case CHARGED_BEAM_STATE: {
@@ -415,9 +416,9 @@ void az_tick_bad_oth_supergunship(
       if (ready_to_fire) {
         fire_projectiles(state, baddie, AZ_PROJ_OTH_CHARGED_BEAM, 1, 0,
                          AZ_SND_FIRE_GUN_CHARGED_BEAM);
-        resume_dogfight(baddie);
+        resume_dogfight(state, baddie);
       } else if (baddie->cooldown <= 0.0) {
-        resume_dogfight(baddie);
+        resume_dogfight(state, baddie);
       }
     } break;
     case RETREAT_STATE: {
@@ -446,7 +447,7 @@ void az_tick_bad_oth_supergunship(
         baddie->cooldown = 0.0;
         if (az_ship_in_range(state, baddie, 300)) {
           fire_oth_spray(state, baddie);
-          begin_dogfight(baddie);
+          begin_dogfight(state, baddie);
         } else {
           set_primary_state(baddie, TRY_TO_CLOAK_STATE);
         }
@@ -473,7 +474,7 @@ void az_tick_bad_oth_supergunship(
         spawn_razors(state, baddie->position, baddie->angle + AZ_DEG2RAD(90),
                      180, 100);
         bool flee = az_ship_in_range(state, baddie, 250);
-        if (az_random(0, 1) < 0.5 * hurt) flee = !flee;
+        if (az_rand_double(&state->rng, 0, 1) < 0.5 * hurt) flee = !flee;
         if (flee) {
           set_primary_state(baddie, FLEE_WHILE_CLOAKED_STATE);
         } else {
@@ -486,7 +487,7 @@ void az_tick_bad_oth_supergunship(
         if (az_ship_in_range(state, baddie, 200)) {
           fire_oth_spray(state, baddie);
         }
-        begin_dogfight(baddie);
+        begin_dogfight(state, baddie);
       } else if (az_ship_is_decloaked(&state->ship)) {
         const az_vector_t target =
           az_vadd(az_vpolar(-75, state->ship.angle), state->ship.position);
@@ -518,7 +519,7 @@ void az_tick_bad_oth_supergunship(
           az_ship_within_angle(state, baddie, 0, AZ_DEG2RAD(2))) {
         fire_projectiles(state, baddie, AZ_PROJ_OTH_ROCKET, 1, 0,
                          AZ_SND_FIRE_OTH_ROCKET);
-        begin_dogfight(baddie);
+        begin_dogfight(state, baddie);
       }
     } break;
     case FLEE_WHILE_CLOAKED_STATE: {
@@ -530,7 +531,7 @@ void az_tick_bad_oth_supergunship(
         if (az_ship_in_range(state, baddie, 200)) {
           fire_oth_spray(state, baddie);
         }
-        begin_dogfight(baddie);
+        begin_dogfight(state, baddie);
       }
     } break;
     case BARRAGE_STATE: {
@@ -550,12 +551,12 @@ void az_tick_bad_oth_supergunship(
         if (secondary == 0 && az_can_see_ship(state, baddie)) {
           fire_projectiles(state, baddie, AZ_PROJ_OTH_BARRAGE, 1, 0,
                            AZ_SND_NOTHING);
-          begin_dogfight(baddie);
+          begin_dogfight(state, baddie);
         } else {
           fire_projectiles(state, baddie, AZ_PROJ_OTH_PHASE_ROCKET, 2, 0,
                            AZ_SND_FIRE_OTH_ROCKET);
           if (secondary >= 2) {
-            begin_dogfight(baddie);
+            begin_dogfight(state, baddie);
           } else {
             set_secondary_state(baddie, secondary + 1);
             baddie->cooldown = 0.4;
@@ -572,16 +573,17 @@ void az_tick_bad_oth_supergunship(
       }
       if (baddie->cooldown <= 0.0) {
         for (int i = 0; i < 2; ++i) {
-          az_fire_baddie_projectile(state, baddie, AZ_PROJ_OTH_MINIROCKET, 12,
-                                    az_random(-AZ_PI, AZ_PI), 0);
+          az_fire_baddie_projectile(
+              state, baddie, AZ_PROJ_OTH_MINIROCKET, 12,
+              az_rand_double(&state->rng, -AZ_PI, AZ_PI), 0);
         }
         az_play_sound(&state->soundboard, AZ_SND_FIRE_OTH_ROCKET);
         baddie->cooldown = 0.3;
         int secondary = get_secondary_state(baddie);
         if (secondary >= 3) {
           set_secondary_state(baddie, 0);
-          spawn_razors(state, baddie->position, az_random(-AZ_PI, AZ_PI), 360,
-                       150);
+          spawn_razors(state, baddie->position,
+                       az_rand_double(&state->rng, -AZ_PI, AZ_PI), 360, 150);
           az_play_sound(&state->soundboard, AZ_SND_LAUNCH_OTH_RAZORS);
         } else {
           set_secondary_state(baddie, secondary + 1);
@@ -589,7 +591,7 @@ void az_tick_bad_oth_supergunship(
       }
     } break;
     default:
-      begin_dogfight(baddie);
+      begin_dogfight(state, baddie);
       break;
   }
 
@@ -608,11 +610,11 @@ void az_on_oth_supergunship_damaged(
       case TRY_TO_CLOAK_STATE:
       case SNEAK_UP_BEHIND_STATE:
       case AMBUSH_STATE:
-        begin_dogfight(baddie);
+        begin_dogfight(state, baddie);
         break;
       case BEAM_SWEEP_STATE:
       case CHARGED_BEAM_STATE:
-        resume_dogfight(baddie);
+        resume_dogfight(state, baddie);
         break;
       case FLEE_WHILE_CLOAKED_STATE:
         begin_retreat(baddie);
@@ -625,7 +627,7 @@ void az_on_oth_supergunship_damaged(
     }
     double theta =
       az_vtheta(az_vrot90ccw(az_vsub(baddie->position, state->ship.position)));
-    if (az_randint(0, 1)) theta = -theta;
+    if (az_rand_int(&state->rng, 0, 1)) theta = -theta;
     baddie->velocity = az_vpolar(250, theta);
     az_baddie_t *decoy = az_add_baddie(state, AZ_BAD_OTH_DECOY,
                                        baddie->position, baddie->angle);
@@ -41,7 +41,8 @@ void az_tick_bad_spine_mine(
       az_fire_baddie_projectile(
           state, baddie, AZ_PROJ_SPINE,
           baddie->data->main_body.bounding_radius,
-          AZ_DEG2RAD(i) + az_random(AZ_DEG2RAD(-10), AZ_DEG2RAD(10)), 0.0);
+          AZ_DEG2RAD(i) + az_rand_double(&state->rng, AZ_DEG2RAD(-10),
+                                         AZ_DEG2RAD(10)), 0.0);
     }
     az_play_sound(&state->soundboard, AZ_SND_KILL_BOUNCER);
     baddie->kind = AZ_BAD_NOTHING;
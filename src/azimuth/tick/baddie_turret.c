@@ -104,9 +104,10 @@ void az_tick_bad_beam_turret(
     az_add_beam(state, beam_color, beam_start, impact.position, 0.0,
                 2.0 + 0.5 * az_clock_zigzag(8, 1, state->clock));
     az_add_speck(state, AZ_WHITE, 1.0, impact.position,
-                 az_vpolar(az_random(20.0, 70.0),
+                 az_vpolar(az_rand_double(&state->rng, 20.0, 70.0),
                            az_vtheta(impact.normal) +
-                           az_random(-AZ_HALF_PI, AZ_HALF_PI)));
+                           az_rand_double(&state->rng, -AZ_HALF_PI,
+                                          AZ_HALF_PI)));
     az_loop_sound(&state->soundboard, AZ_SND_BEAM_NORMAL);
   }
   // Otherwise, draw a laser-sight.
@@ -133,7 +134,7 @@ void az_tick_bad_broken_turret(
     }
   } else {
     // Try to aim gun (but sometimes twitch randomly):
-    const int aim = az_randint(-1, 1);
+    const int aim = az_rand_int(&state->rng, -1, 1);
     baddie->components[0].angle = fmax(-1.0, fmin(1.0, az_mod2pi(
         (aim == 0 ?
          az_angle_towards(
@@ -152,8 +153,8 @@ void az_tick_bad_broken_turret(
       baddie->cooldown = 1.0;
     }
     // Randomly go crazy:
-    if (az_random(0.0, 2.5) < time) {
-      baddie->state = az_randint(1, 2);
+    if (az_rand_double(&state->rng, 0.0, 2.5) < time) {
+      baddie->state = az_rand_int(&state->rng, 1, 2);
       const az_vector_t spark_start =
         az_vadd(baddie->position,
                 az_vpolar(20, baddie->angle +
@@ -163,9 +164,11 @@ void az_tick_bad_broken_turret(
         (baddie->state == 1 ? -AZ_DEG2RAD(65) : AZ_DEG2RAD(65));
       for (int i = 0; i < 8; ++i) {
         const double theta =
-          spark_angle + az_random(-AZ_DEG2RAD(25), AZ_DEG2RAD(25));
+          spark_angle + az_rand_double(&state->rng, -AZ_DEG2RAD(25),
+                                       AZ_DEG2RAD(25));
         az_add_speck(state, (az_color_t){255, 200, 100, 255}, 4.0,
-                     spark_start, az_vpolar(az_random(10, 70), theta));
+                     spark_start,
+                     az_vpolar(az_rand_double(&state->rng, 10, 70), theta));
       }
     }
   }
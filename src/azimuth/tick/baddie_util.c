@@ -58,12 +58,9 @@ bool az_ship_within_angle(
 
 bool az_can_see_ship(az_space_state_t *state, const az_baddie_t *baddie) {
   if (!az_ship_is_decloaked(&state->ship)) return false;
-  az_impact_t impact;
-  az_ray_impact(state, baddie->position,
-                az_vsub(state->ship.position, baddie->position),
-                (non_wall_types(baddie) & ~AZ_IMPF_SHIP),
-                baddie->uid, &impact);
-  return (impact.type == AZ_IMP_SHIP);
+  return az_ray_reaches_ship(state, baddie->position,
+                             (non_wall_types(baddie) & ~AZ_IMPF_SHIP),
+                             baddie->uid);
 }
 
 /*===========================================================================*/
@@ -81,11 +78,10 @@ double az_baddie_dist_to_wall(
 
 bool az_baddie_has_clear_path_to_position(
     az_space_state_t *state, az_baddie_t *baddie, az_vector_t position) {
-  az_impact_t impact;
-  az_circle_impact(state, baddie->data->main_body.bounding_radius,
-                   baddie->position, az_vsub(position, baddie->position),
-                   non_wall_types(baddie), baddie->uid, &impact);
-  return (impact.type == AZ_IMP_NOTHING);
+  return !az_circle_path_blocked(
+      state, baddie->data->main_body.bounding_radius, baddie->position,
+      az_vsub(position, baddie->position), non_wall_types(baddie),
+      baddie->uid);
 }
 
 /*===========================================================================*/
@@ -180,7 +176,9 @@ void az_snake_towards(
     az_space_state_t *state, az_baddie_t *baddie, double time,
     int first_tail_component, double speed, double wiggle,
     az_vector_t destination, bool ignore_walls) {
-  if (baddie->param == 0.0) baddie->param = az_random(-AZ_PI, AZ_PI);
+  if (baddie->param == 0.0) {
+    baddie->param = az_rand_double(&state->rng, -AZ_PI, AZ_PI);
+  }
   const az_vector_t old_position = baddie->position;
   const double old_angle = baddie->angle;
   const double dest_theta = az_vtheta(az_vsub(destination, old_position));
@@ -74,7 +74,7 @@ void az_tick_bad_rockwyrm(az_space_state_t *state, az_baddie_t *baddie,
     if (baddie->cooldown <= 0.0 &&
         az_ship_within_angle(state, baddie, 0, AZ_DEG2RAD(20)) &&
         az_can_see_ship(state, baddie)) {
-      if (hurt >= 0.35 && az_random(0, 1) < 0.25) {
+      if (hurt >= 0.35 && az_rand_double(&state->rng, 0, 1) < 0.25) {
         int num_wyrmlings = 0;
         AZ_ARRAY_LOOP(other, state->baddies) {
           if (other->kind == AZ_BAD_WYRMLING) ++num_wyrmlings;
@@ -99,16 +99,16 @@ void az_tick_bad_rockwyrm(az_space_state_t *state, az_baddie_t *baddie,
         }
         // Below 35% health, we have a 20% chance to go to state 20 (firing a
         // long spray of bullets).
-        if (hurt >= 0.65 && az_random(0, 1) < 0.2) {
+        if (hurt >= 0.65 && az_rand_double(&state->rng, 0, 1) < 0.2) {
           baddie->state = ROCKWYRM_STATE_AIM_SPRAY;
           baddie->cooldown = 3.0;
         }
         // Otherwise, we have a 50/50 chance to stay in state 0, or to go to
         // state 2 (drop eggs).
-        else if (az_random(0, 1) < 0.5) {
+        else if (az_rand_double(&state->rng, 0, 1) < 0.5) {
           baddie->state = ROCKWYRM_STATE_EGGS;
           baddie->cooldown = 1.0;
-        } else baddie->cooldown = az_random(2.0, 4.0);
+        } else baddie->cooldown = az_rand_double(&state->rng, 2.0, 4.0);
       }
     }
   }
@@ -118,12 +118,12 @@ void az_tick_bad_rockwyrm(az_space_state_t *state, az_baddie_t *baddie,
     if (baddie->cooldown <= 0.0) {
       AZ_ARRAY_LOOP(node, state->nodes) {
         if (node->kind != AZ_NODE_MARKER) continue;
-        if (az_random(0, 1) > hurt) continue;
+        if (az_rand_double(&state->rng, 0, 1) > hurt) continue;
         az_add_baddie(state, AZ_BAD_WYRMLING, node->position,
                       az_vtheta(az_vsub(baddie->position, node->position)));
       }
       baddie->state = ROCKWYRM_STATE_NORMAL;
-      baddie->cooldown = az_random(3.0, 5.0);
+      baddie->cooldown = az_rand_double(&state->rng, 3.0, 5.0);
     }
   }
   // State EGGS: Drop eggs:
@@ -139,17 +139,19 @@ void az_tick_bad_rockwyrm(az_space_state_t *state, az_baddie_t *baddie,
             state, AZ_BAD_WYRM_EGG,
             az_vadd(baddie->position,
                     az_vrotate(tail->position, baddie->angle)),
-            baddie->angle + tail->angle + AZ_PI + az_random(-spread, spread));
+            baddie->angle + tail->angle + AZ_PI +
+            az_rand_double(&state->rng, -spread, spread));
         if (egg != NULL) {
-          egg->velocity = az_vpolar(az_random(50, 150), egg->angle);
+          egg->velocity =
+            az_vpolar(az_rand_double(&state->rng, 50, 150), egg->angle);
           // Set the egg to hatch (without waiting for the ship to get
           // close first) after a random amount of time.
           egg->state = EGG_STATE_HATCH_AFTER_COOLDOWN;
-          egg->cooldown = az_random(2.0, 2.5);
+          egg->cooldown = az_rand_double(&state->rng, 2.0, 2.5);
         } else break;
       }
       baddie->state = ROCKWYRM_STATE_NORMAL;
-      baddie->cooldown = az_random(1.0, 3.0);
+      baddie->cooldown = az_rand_double(&state->rng, 1.0, 3.0);
     }
   }
   // State AIM_SPRAY: Wait until we have line of sight:
@@ -168,7 +170,7 @@ void az_tick_bad_rockwyrm(az_space_state_t *state, az_baddie_t *baddie,
         az_fire_baddie_projectile(
             state, baddie, AZ_PROJ_STINGER,
             baddie->data->main_body.bounding_radius, 0.0,
-            AZ_DEG2RAD(i * az_random(0, 10)));
+            AZ_DEG2RAD(i * az_rand_double(&state->rng, 0, 10)));
         az_play_sound(&state->soundboard, AZ_SND_FIRE_STINGER);
       }
       baddie->cooldown = 0.1;
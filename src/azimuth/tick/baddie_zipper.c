@@ -172,7 +172,8 @@ void az_tick_bad_super_hornet(az_space_state_t *state, az_baddie_t *baddie,
       az_ship_within_angle(state, baddie, AZ_PI, AZ_DEG2RAD(6)) &&
       az_can_see_ship(state, baddie)) {
     az_fire_baddie_projectile(state, baddie, AZ_PROJ_STINGER, 15.0, AZ_PI,
-                              az_random(-AZ_DEG2RAD(5), AZ_DEG2RAD(5)));
+                              az_rand_double(&state->rng, -AZ_DEG2RAD(5),
+                                             AZ_DEG2RAD(5)));
     az_play_sound(&state->soundboard, AZ_SND_FIRE_STINGER);
     baddie->cooldown = 0.1;
   }
@@ -245,7 +245,8 @@ void az_tick_cutscene(az_space_state_t *state, double time) {
         cutscene->param1 =
           0.5 - 0.4 * fmin(1.0, 0.2 * (cutscene->step_timer - delay));
         az_vector_t start = {320, 240};
-        az_vector_t velocity = az_vpolar(300, az_random(-AZ_PI, AZ_PI));
+        az_vector_t velocity =
+          az_vpolar(300, az_rand_double(&state->rng, -AZ_PI, AZ_PI));
         velocity.y *= 0.75;
         az_cutscene_add_particle(cutscene, true, AZ_PAR_OTH_FRAGMENT, AZ_WHITE,
                                  start, velocity, 0.0, 2.0, -25.0,
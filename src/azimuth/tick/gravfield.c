@@ -76,11 +76,14 @@ static void apply_gravfield_to_ship(
 }
 
 void az_tick_gravfields(az_space_state_t *state, double time) {
-  AZ_ARRAY_LOOP(gravfield, state->gravfields) {
+  for (int i = 0; i < state->gravfield_slots.num_live; ++i) {
+    az_gravfield_t *gravfield =
+      &state->gravfields[state->gravfield_slots.live[i]];
     if (gravfield->kind == AZ_GRAV_NOTHING) continue;
     assert(gravfield->strength == 1.0 || !az_is_liquid(gravfield->kind));
     gravfield->age += time * gravfield->strength;
     if (!gravfield->script_fired && gravfield->on_enter != NULL &&
+        az_gravfield_might_contain(state, gravfield, state->ship.position) &&
         az_point_within_gravfield(gravfield, state->ship.position)) {
       gravfield->script_fired = true;
       az_schedule_script(state, gravfield->on_enter);
@@ -95,9 +98,12 @@ void az_apply_gravfields_to_ship(az_space_state_t *state, double time,
   assert(ship_is_in_lava != NULL);
   *ship_is_in_water = false;
   *ship_is_in_lava = false;
-  AZ_ARRAY_LOOP(gravfield, state->gravfields) {
+  for (int i = 0; i < state->gravfield_slots.num_live; ++i) {
+    az_gravfield_t *gravfield =
+      &state->gravfields[state->gravfield_slots.live[i]];
     if (gravfield->kind == AZ_GRAV_NOTHING) continue;
-    if (az_point_within_gravfield(gravfield, state->ship.position)) {
+    if (az_gravfield_might_contain(state, gravfield, state->ship.position) &&
+        az_point_within_gravfield(gravfield, state->ship.position)) {
       apply_gravfield_to_ship(state, gravfield, time, ship_is_in_water,
                               ship_is_in_lava);
     }
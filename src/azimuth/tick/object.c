@@ -65,6 +65,7 @@ static void move_object_internal(
         az_vadd(object->obj.baddie->position, delta_position);
       object->obj.baddie->angle =
         az_mod2pi(object->obj.baddie->angle + delta_angle);
+      az_update_baddie_sweep(state, object->obj.baddie);
       // When a baddie is made to move, its cargo moves with it.
       move_baddie_cargo_internal(state, object->obj.baddie, delta_position,
                                  delta_angle, depth + 1);
@@ -82,6 +83,7 @@ static void move_object_internal(
         az_vadd(object->obj.gravfield->position, delta_position);
       object->obj.gravfield->angle =
         az_mod2pi(object->obj.gravfield->angle + delta_angle);
+      az_update_gravfield_index(state, object->obj.gravfield);
       break;
     case AZ_OBJ_NODE:
       assert(object->obj.node->kind != AZ_NODE_NOTHING);
@@ -148,6 +150,7 @@ static void move_object_internal(
         az_vadd(object->obj.wall->position, delta_position);
       object->obj.wall->angle =
         az_mod2pi(object->obj.wall->angle + delta_angle);
+      az_update_wall_grid(state, object->obj.wall);
       break;
   }
 }
@@ -192,38 +195,43 @@ static void kill_baddie_internal(
   const double step = 6.0;
   for (double y = -overall_radius; y <= overall_radius; y += step) {
     for (double x = -overall_radius; x <= overall_radius; x += step) {
-      const az_vector_t pos = {x + baddie->position.x + az_random(-3, 3),
-                               y + baddie->position.y + az_random(-3, 3)};
+      const az_vector_t pos = {
+        x + baddie->position.x + az_rand_double(&state->rng, -3, 3),
+        y + baddie->position.y + az_rand_double(&state->rng, -3, 3)};
       const az_death_style_t dstyle = baddie->data->death_style;
       const az_component_data_t *component;
       az_vector_t component_pos;
-      az_particle_t *particle;
+      az_particle_t particle;
       if (az_point_touches_baddie(baddie, pos, &component, &component_pos) &&
           az_insert_particle(state, &particle)) {
-        particle->kind = (dstyle == AZ_DEATH_EMBERS ? AZ_PAR_EMBER :
-                          dstyle == AZ_DEATH_OTH ? AZ_PAR_OTH_FRAGMENT :
-                          AZ_PAR_SHARD);
-        particle->color = baddie->data->color;
-        particle->position = pos;
-        particle->angle = az_random(0.0, AZ_TWO_PI);
-        particle->lifetime = az_random(0.5, 1.0);
-        particle->param1 = az_random(0.5, 1.5) * step *
-          (particle->kind == AZ_PAR_SHARD ? 0.25 :
-           particle->kind == AZ_PAR_EMBER ? 1.4 : 1.0);
-        particle->param2 = az_random(-10.0, 10.0);
+        particle.kind = (dstyle == AZ_DEATH_EMBERS ? AZ_PAR_EMBER :
+                         dstyle == AZ_DEATH_OTH ? AZ_PAR_OTH_FRAGMENT :
+                         AZ_PAR_SHARD);
+        particle.color = baddie->data->color;
+        particle.position = pos;
+        particle.angle = az_rand_double(&state->rng, 0.0, AZ_TWO_PI);
+        particle.lifetime = az_rand_double(&state->rng, 0.5, 1.0);
+        particle.param1 = az_rand_double(&state->rng, 0.5, 1.5) * step *
+          (particle.kind == AZ_PAR_SHARD ? 0.25 :
+           particle.kind == AZ_PAR_EMBER ? 1.4 : 1.0);
+        particle.param2 = az_rand_double(&state->rng, -10.0, 10.0);
         const double component_radius = component->bounding_radius;
-        particle->velocity = az_vsub(pos, component_pos);
+        particle.velocity = az_vsub(pos, component_pos);
         if (dstyle != AZ_DEATH_EMBERS) {
-          particle->velocity = az_vmul(particle->velocity, 5.0);
+          particle.velocity = az_vmul(particle.velocity, 5.0);
         }
-        particle->velocity.x += az_random(-component_radius, component_radius);
-        particle->velocity.y += az_random(-component_radius, component_radius);
+        particle.velocity.x +=
+          az_rand_double(&state->rng, -component_radius, component_radius);
+        particle.velocity.y +=
+          az_rand_double(&state->rng, -component_radius, component_radius);
+        az_add_particle(state, &particle);
       }
     }
   }
   for (int i = 0; i < 20; ++i) {
     az_add_speck(state, AZ_WHITE, 2.0, baddie->position,
-                 az_vpolar(az_random(20, 70), az_random(0, AZ_TWO_PI)));
+                 az_vpolar(az_rand_double(&state->rng, 20, 70),
+                           az_rand_double(&state->rng, 0, AZ_TWO_PI)));
   }
 
   if (pickups_and_scripts) {
@@ -462,38 +470,42 @@ void az_kill_ship(az_space_state_t *state) {
   az_ship_t *ship = &state->ship;
   assert(az_ship_is_alive(ship));
   // Add particles for ship debris:
-  az_particle_t *particle;
+  az_particle_t particle;
   if (az_insert_particle(state, &particle)) {
-    particle->kind = AZ_PAR_BOOM;
-    particle->color = AZ_WHITE;
-    particle->position = ship->position;
-    particle->velocity = AZ_VZERO;
-    particle->lifetime = 0.5;
-    particle->param1 = 30;
+    particle.kind = AZ_PAR_BOOM;
+    particle.color = AZ_WHITE;
+    particle.position = ship->position;
+    particle.velocity = AZ_VZERO;
+    particle.lifetime = 0.5;
+    particle.param1 = 30;
+    az_add_particle(state, &particle);
   }
   const double radius = 20.0;
   for (double y = -radius; y <= radius; y += 4.0) {
     for (double x = -radius; x <= radius; x += 3.0) {
-      const az_vector_t pos = {x + ship->position.x + az_random(-2.0, 2.0),
-                               y + ship->position.y + az_random(-2.0, 2.0)};
+      const az_vector_t pos = {
+        x + ship->position.x + az_rand_double(&state->rng, -2.0, 2.0),
+        y + ship->position.y + az_rand_double(&state->rng, -2.0, 2.0)};
       if (az_point_touches_ship(ship, pos) &&
           az_insert_particle(state, &particle)) {
-        particle->kind = AZ_PAR_SHARD;
-        particle->color = (az_color_t){160, 160, 160, 255};
-        particle->position = pos;
-        particle->velocity = az_vmul(az_vsub(pos, ship->position), 5.0);
-        particle->velocity.x += az_random(-50.0, 50.0);
-        particle->velocity.y += az_random(-50.0, 50.0);
-        particle->angle = az_random(0.0, AZ_TWO_PI);
-        particle->lifetime = az_random(0.5, 1.0);
-        particle->param1 = az_random(0.5, 1.5);
-        particle->param2 = az_random(-10.0, 10.0);
+        particle.kind = AZ_PAR_SHARD;
+        particle.color = (az_color_t){160, 160, 160, 255};
+        particle.position = pos;
+        particle.velocity = az_vmul(az_vsub(pos, ship->position), 5.0);
+        particle.velocity.x += az_rand_double(&state->rng, -50.0, 50.0);
+        particle.velocity.y += az_rand_double(&state->rng, -50.0, 50.0);
+        particle.angle = az_rand_double(&state->rng, 0.0, AZ_TWO_PI);
+        particle.lifetime = az_rand_double(&state->rng, 0.5, 1.0);
+        particle.param1 = az_rand_double(&state->rng, 0.5, 1.5);
+        particle.param2 = az_rand_double(&state->rng, -10.0, 10.0);
+        az_add_particle(state, &particle);
       }
     }
   }
   for (int i = 0; i < 20; ++i) {
     az_add_speck(state, AZ_WHITE, 2.0, ship->position,
-                 az_vpolar(az_random(20, 70), az_random(0, AZ_TWO_PI)));
+                 az_vpolar(az_rand_double(&state->rng, 20, 70),
+                           az_rand_double(&state->rng, 0, AZ_TWO_PI)));
   }
   az_play_sound(&state->soundboard, AZ_SND_EXPLODE_SHIP);
   // Destroy the ship:
@@ -516,30 +528,33 @@ static void break_wall_internal(
   const double radius = wall->data->bounding_radius;
   const double step = 3.0 + radius / 10.0;
   const double size = 0.7 + radius / 60.0;
-  az_particle_t *particle;
+  az_particle_t particle;
   for (double y = -radius; y <= radius; y += step) {
     for (double x = -radius; x <= radius; x += step) {
-      const az_vector_t pos = {x + wall->position.x + az_random(-5.0, 5.0),
-                               y + wall->position.y + az_random(-5.0, 5.0)};
+      const az_vector_t pos = {
+        x + wall->position.x + az_rand_double(&state->rng, -5.0, 5.0),
+        y + wall->position.y + az_rand_double(&state->rng, -5.0, 5.0)};
       if (az_point_touches_wall(wall, pos) &&
           az_insert_particle(state, &particle)) {
-        particle->kind = AZ_PAR_SHARD;
-        particle->color = wall->data->color1;
-        particle->position = pos;
-        particle->velocity =
+        particle.kind = AZ_PAR_SHARD;
+        particle.color = wall->data->color1;
+        particle.position = pos;
+        particle.velocity =
           az_vwithlen(az_vsub(pos, impact_point),
                       az_vdist(pos, wall->position) * 2.5);
-        particle->velocity.x += az_random(-radius, radius);
-        particle->velocity.y += az_random(-radius, radius);
-        particle->angle = az_random(0.0, AZ_TWO_PI);
-        particle->lifetime = az_random(0.3, 0.8);
-        particle->param1 = az_random(0.5, 1.5) * size;
-        particle->param2 = az_random(-10.0, 10.0);
+        particle.velocity.x += az_rand_double(&state->rng, -radius, radius);
+        particle.velocity.y += az_rand_double(&state->rng, -radius, radius);
+        particle.angle = az_rand_double(&state->rng, 0.0, AZ_TWO_PI);
+        particle.lifetime = az_rand_double(&state->rng, 0.3, 0.8);
+        particle.param1 = az_rand_double(&state->rng, 0.5, 1.5) * size;
+        particle.param2 = az_rand_double(&state->rng, -10.0, 10.0);
+        az_add_particle(state, &particle);
       }
     }
   }
   // Remove the wall.
   wall->kind = AZ_WALL_NOTHING;
+  az_update_wall_grid(state, wall);
 }
 
 bool az_try_break_wall(az_space_state_t *state, az_wall_t *wall,
@@ -35,9 +35,25 @@ void az_tick_particle(az_particle_t *particle, double time) {
   az_vpluseq(&particle->position, az_vmul(particle->velocity, time));
 }
 
+// az_tick_particles rounds its slot count up to an even number (see below).
+AZ_STATIC_ASSERT(AZ_MAX_NUM_PARTICLES % 2 == 0);
+
 void az_tick_particles(az_space_state_t *state, double time) {
-  AZ_ARRAY_LOOP(particle, state->particles) {
-    az_tick_particle(particle, time);
+  az_particle_array_t *particles = &state->particles;
+  // This does the same thing as calling az_tick_particle on each particle, in
+  // the same two passes as az_tick_specks (which see); az_add_particle, too,
+  // resets every field of a slot before reusing it.
+  const int num_slots = state->particle_slots.high_water;
+  const int num_even_slots = (num_slots + 1) & ~1;
+  for (int i = 0; i < num_even_slots; ++i) {
+    particles->x[i] += particles->vx[i] * time;
+    particles->y[i] += particles->vy[i] * time;
+  }
+  for (int i = 0; i < num_slots; ++i) {
+    particles->age[i] += time;
+    if (particles->age[i] > particles->lifetime[i]) {
+      particles->kind[i] = AZ_PAR_NOTHING;
+    }
   }
 }
 
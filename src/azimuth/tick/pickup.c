@@ -30,7 +30,8 @@
 void az_tick_pickups(az_space_state_t *state, double time) {
   az_ship_t *ship = &state->ship;
   az_player_t *player = &ship->player;
-  AZ_ARRAY_LOOP(pickup, state->pickups) {
+  for (int i = 0; i < state->pickup_slots.num_live; ++i) {
+    az_pickup_t *pickup = &state->pickups[state->pickup_slots.live[i]];
     if (pickup->kind == AZ_PUP_NOTHING) continue;
     pickup->time_remaining -= time;
     if (az_ship_is_alive(ship) &&
@@ -64,9 +65,9 @@ void az_tick_pickups(az_space_state_t *state, double time) {
           az_play_sound(&state->soundboard, AZ_SND_PICKUP_SHIELDS);
           break;
       }
-      pickup->kind = AZ_PUP_NOTHING;
+      az_remove_pickup(state, pickup);
     } else if (pickup->time_remaining <= 0.0) {
-      pickup->kind = AZ_PUP_NOTHING;
+      az_remove_pickup(state, pickup);
     } else if (az_ship_is_alive(ship)) {
       const double attract_range =
         (az_has_upgrade(player, AZ_UPG_MAGNET_SWEEP) ?
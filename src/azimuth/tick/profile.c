@@ -0,0 +1,51 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/tick/profile.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "azimuth/state/baddie.h"
+#include "azimuth/state/profile.h"
+#include "azimuth/state/space.h"
+
+/*===========================================================================*/
+
+uint64_t az_profile_start(const az_space_state_t *state) {
+  return (state->profile == NULL ? 0 : state->profile->clock());
+}
+
+void az_profile_stop(az_space_state_t *state, az_profile_section_t section,
+                     uint64_t start) {
+  if (state->profile == NULL) return;
+  assert(section >= 0 && section < AZ_NUM_PROFILE_SECTIONS);
+  state->profile->section_nanos[section] += state->profile->clock() - start;
+}
+
+void az_profile_stop_baddie(az_space_state_t *state, az_baddie_kind_t kind,
+                            uint64_t start) {
+  if (state->profile == NULL) return;
+  assert(kind > AZ_BAD_NOTHING && kind <= AZ_NUM_BADDIE_KINDS);
+  const uint64_t elapsed = state->profile->clock() - start;
+  state->profile->section_nanos[AZ_PROF_BADDIES] += elapsed;
+  state->profile->baddie_nanos[kind] += elapsed;
+}
+
+/*===========================================================================*/
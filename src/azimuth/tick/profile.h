@@ -0,0 +1,48 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_TICK_PROFILE_H_
+#define AZIMUTH_TICK_PROFILE_H_
+
+#include <stdint.h>
+
+#include "azimuth/state/baddie.h"
+#include "azimuth/state/profile.h"
+#include "azimuth/state/space.h"
+
+/*===========================================================================*/
+
+// If the state is being profiled (i.e. state->profile is non-NULL), return the
+// current time; otherwise, return zero without bothering to check the clock.
+uint64_t az_profile_start(const az_space_state_t *state);
+
+// If the state is being profiled, add the time since start (a value returned
+// by az_profile_start) to the given section of the state's profile.
+void az_profile_stop(az_space_state_t *state, az_profile_section_t section,
+                     uint64_t start);
+
+// Like az_profile_stop, but for the tick of a single baddie of the given kind;
+// this adds the time both to that kind and to AZ_PROF_BADDIES.
+void az_profile_stop_baddie(az_space_state_t *state, az_baddie_kind_t kind,
+                            uint64_t start);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_TICK_PROFILE_H_
@@ -21,6 +21,7 @@
 
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
 
 #include "azimuth/state/projectile.h"
 #include "azimuth/state/space.h"
@@ -48,11 +49,12 @@ void az_expire_projectile(az_space_state_t *state, az_projectile_t *proj) {
     const double base_speed = 0.5 * az_vnorm(proj->velocity);
     for (int i = 0; i < 3; ++i) {
       az_add_speck(state, AZ_WHITE, 1.0, proj->position,
-                   az_vpolar(base_speed + az_random(20, 70), proj->angle +
-                             AZ_DEG2RAD(15) * az_random(-1, 1)));
+                   az_vpolar(base_speed + az_rand_double(&state->rng, 20, 70),
+                             proj->angle + AZ_DEG2RAD(15) *
+                             az_rand_double(&state->rng, -1, 1)));
     }
   }
-  proj->kind = AZ_PROJ_NOTHING;
+  az_remove_projectile(state, proj);
 }
 
 // Common projectile impact code, called by both on_projectile_hit_wall and
@@ -125,14 +127,15 @@ static void on_projectile_impact(az_space_state_t *state,
     for (int i = -limit; i <= limit; ++i) {
       const double theta = mid_theta +
         (proj->kind == AZ_PROJ_GUN_PHASE_BURST ? AZ_DEG2RAD(i) :
-         0.2 * AZ_PI * (i + az_random(-.5, .5)));
+         0.2 * AZ_PI * (i + az_rand_double(&state->rng, -.5, .5)));
       az_projectile_t *shrapnel = az_add_projectile(
           state, proj->data->shrapnel_kind,
           az_vadd(proj->position, az_vpolar(0.1, theta)), theta, proj->power,
           proj->fired_by);
       if (shrapnel != NULL &&
           !(proj->data->properties & AZ_PROJF_FAST_SHRAPNEL)) {
-        shrapnel->velocity = az_vmul(shrapnel->velocity, az_random(0.5, 1.0));
+        shrapnel->velocity = az_vmul(shrapnel->velocity,
+                                     az_rand_double(&state->rng, 0.5, 1.0));
       }
     }
   }
@@ -142,57 +145,60 @@ static void on_projectile_impact(az_space_state_t *state,
   const bool few_specks = (proj->data->properties & AZ_PROJF_FEW_SPECKS);
   az_color_t speck_color = AZ_WHITE;
   if (splash || !few_specks) {
-    az_particle_t *particle;
+    az_particle_t particle;
     if (az_insert_particle(state, &particle)) {
-      particle->position = proj->position;
-      particle->velocity = AZ_VZERO;
-      particle->angle = proj->angle;
-      particle->param1 = (splash ? radius : 10.0);
+      particle.position = proj->position;
+      particle.velocity = AZ_VZERO;
+      particle.angle = proj->angle;
+      particle.param1 = (splash ? radius : 10.0);
       if ((proj->data->damage_kind & AZ_DMGF_CHARGED) && !splash) {
-        particle->kind = AZ_PAR_CHARGED_BOOM;
+        particle.kind = AZ_PAR_CHARGED_BOOM;
         if (proj->data->damage_kind & AZ_DMGF_FREEZE) {
           speck_color = (az_color_t){128, 224, 255, 255};
         } else if (proj->data->damage_kind & AZ_DMGF_PIERCE) {
           speck_color = (az_color_t){255, 128, 255, 255};
         }
-        particle->color = speck_color;
-        particle->lifetime = 0.5;
-        particle->param1 = 12 + proj->data->impact_damage * proj->power;
-        particle->param2 = 4.0;
+        particle.color = speck_color;
+        particle.lifetime = 0.5;
+        particle.param1 = 12 + proj->data->impact_damage * proj->power;
+        particle.param2 = 4.0;
       } else if (proj->data->damage_kind & AZ_DMGF_FREEZE) {
         speck_color = (az_color_t){192, 224, 255, 255};
         if (splash) {
-          particle->kind = AZ_PAR_ICE_BOOM;
-          particle->color = (az_color_t){128, 224, 255, 255};
-          particle->lifetime = 0.6;
+          particle.kind = AZ_PAR_ICE_BOOM;
+          particle.color = (az_color_t){128, 224, 255, 255};
+          particle.lifetime = 0.6;
         } else {
-          particle->kind = AZ_PAR_BOOM;
-          particle->color = speck_color;
-          particle->lifetime = 0.3;
+          particle.kind = AZ_PAR_BOOM;
+          particle.color = speck_color;
+          particle.lifetime = 0.3;
         }
       } else if (proj->data->damage_kind & AZ_DMGF_FLAME) {
         speck_color = (az_color_t){255, 128, 0, 192};
-        particle->kind = AZ_PAR_FIRE_BOOM;
-        particle->color = speck_color;
-        particle->lifetime = fmax(0.3, 0.003 * proj->data->splash_radius);
+        particle.kind = AZ_PAR_FIRE_BOOM;
+        particle.color = speck_color;
+        particle.lifetime = fmax(0.3, 0.003 * proj->data->splash_radius);
       } else if (splash) {
-        particle->kind = AZ_PAR_EXPLOSION;
-        particle->color = (az_color_t){255, 240, 224, 192};
-        particle->lifetime = 0.15 * cbrt(radius);
+        particle.kind = AZ_PAR_EXPLOSION;
+        particle.color = (az_color_t){255, 240, 224, 192};
+        particle.lifetime = 0.15 * cbrt(radius);
       } else {
-        particle->kind = AZ_PAR_BOOM;
-        particle->color = AZ_WHITE;
-        particle->lifetime = 0.3;
+        particle.kind = AZ_PAR_BOOM;
+        particle.color = AZ_WHITE;
+        particle.lifetime = 0.3;
       }
+      az_add_particle(state, &particle);
     }
   }
   if (few_specks) {
     az_add_speck(state, speck_color, 1.0, proj->position,
-                 az_vpolar(az_random(20, 70), az_random(0, AZ_TWO_PI)));
+                 az_vpolar(az_rand_double(&state->rng, 20, 70),
+                           az_rand_double(&state->rng, 0, AZ_TWO_PI)));
   } else {
     for (int i = 0; i < 5; ++i) {
       az_add_speck(state, speck_color, 1.0, proj->position,
-                   az_vpolar(az_random(20, 70), az_random(0, AZ_TWO_PI)));
+                   az_vpolar(az_rand_double(&state->rng, 20, 70),
+                             az_rand_double(&state->rng, 0, AZ_TWO_PI)));
     }
   }
 
@@ -212,13 +218,14 @@ static void on_projectile_impact(az_space_state_t *state,
       az_get_baddie_data(AZ_BAD_ICE_CRYSTAL)->overall_bounding_radius;
     for (int i = 0; i < 20; ++i) {
       const az_vector_t position = az_vadd(proj->position, az_vpolar(
-          az_random(0, proj->data->splash_radius), az_random(-AZ_PI, AZ_PI)));
+          az_rand_double(&state->rng, 0, proj->data->splash_radius),
+          az_rand_double(&state->rng, -AZ_PI, AZ_PI)));
       if (!az_position_visible(bounds, position)) continue;
       az_impact_t impact;
       az_circle_impact(state, crystal_radius, position, AZ_VZERO,
                        0, AZ_NULL_UID, &impact);
       if (impact.type != AZ_IMP_NOTHING) continue;
-      const double angle = az_random(-AZ_PI, AZ_PI);
+      const double angle = az_rand_double(&state->rng, -AZ_PI, AZ_PI);
       az_add_baddie(state, AZ_BAD_ICE_CRYSTAL, position, angle);
     }
   }
@@ -264,7 +271,48 @@ static void on_projectile_hit_wall(az_space_state_t *state,
     az_shake_camera(&state->camera, shake, shake * 0.75);
   }
   // Remove the projectile.
-  proj->kind = AZ_PROJ_NOTHING;
+  az_remove_projectile(state, proj);
+}
+
+// Return how good a target the baddie would be for a homing projectile at the
+// given position and angle (lower is better): the distance to the baddie,
+// plus a penalty for how far the projectile would have to turn to face it.
+static double homing_score(const az_baddie_t *baddie, az_vector_t position,
+                           double angle) {
+  return az_vdist(baddie->position, position) +
+    fabs(az_mod2pi(az_vtheta(az_vsub(baddie->position, position)) -
+                   angle)) * 100.0;
+}
+
+// Return the baddie that a projectile fired by the ship should home in on (or
+// ricochet towards) if it were facing the given angle, or NULL if there are no
+// suitable baddies.
+static const az_baddie_t *find_homing_target(
+    const az_space_state_t *state, const az_projectile_t *proj,
+    double angle) {
+  // A baddie's score is never less than its distance, so the best target is
+  // no farther away than the nearest suitable baddie's score.
+  const az_baddie_t *nearest;
+  if (az_find_nearest_baddies(state, proj->position, AZ_BADF_NO_HOMING_PROJ,
+                              proj->last_hit_uid, 1, &nearest) == 0) {
+    return NULL;
+  }
+  const uint64_t candidates = az_baddies_near(
+      state, proj->position, homing_score(nearest, proj->position, angle));
+  const az_baddie_t *best = NULL;
+  double best_score = INFINITY;
+  for (uint64_t bits = candidates; bits != 0; bits &= bits - 1) {
+    const az_baddie_t *baddie = &state->baddies[__builtin_ctzll(bits)];
+    if (baddie->kind == AZ_BAD_NOTHING) continue;
+    if (baddie->uid == proj->last_hit_uid) continue;
+    if (az_baddie_has_flag(baddie, AZ_BADF_NO_HOMING_PROJ)) continue;
+    const double score = homing_score(baddie, proj->position, angle);
+    if (score < best_score) {
+      best_score = score;
+      best = baddie;
+    }
+  }
+  return best;
 }
 
 // Common projectile impact code, called by both on_projectile_hit_baddie and
@@ -282,29 +330,20 @@ static void on_projectile_hit_target(
   // another target.
   if (proj->kind == AZ_PROJ_MISSILE_PIERCE) {
     if (proj->param < 4) {
-      const double old_proj_angle = proj->angle;
-      double best_dist = INFINITY;
-      AZ_ARRAY_LOOP(baddie, state->baddies) {
-        if (baddie->kind == AZ_BAD_NOTHING) continue;
-        if (baddie->uid == proj->last_hit_uid) continue;
-        if (az_baddie_has_flag(baddie, AZ_BADF_NO_HOMING_PROJ)) continue;
-        const double dist = az_vdist(baddie->position, proj->position) +
-          fabs(az_mod2pi(az_vtheta(az_vsub(baddie->position, proj->position)) -
-                         old_proj_angle)) * 100.0;
-        if (dist < best_dist) {
-          best_dist = dist;
-          proj->angle = az_vtheta(az_vsub(baddie->position, proj->position));
-        }
+      const az_baddie_t *target =
+        find_homing_target(state, proj, proj->angle);
+      if (target != NULL) {
+        proj->angle = az_vtheta(az_vsub(target->position, proj->position));
       }
       proj->velocity = az_vpolar(az_vnorm(proj->velocity) - 50.0, proj->angle);
       ++proj->param;
-    } else proj->kind = AZ_PROJ_NOTHING;
+    } else az_remove_projectile(state, proj);
     return;
   }
   // Remove the projectile (unless it's piercing, in which case it should
   // continue on beyond this target).
   if (!(proj->data->properties & AZ_PROJF_PIERCING)) {
-    proj->kind = AZ_PROJ_NOTHING;
+    az_remove_projectile(state, proj);
   }
 }
 
@@ -359,19 +398,10 @@ static void projectile_home_in(az_space_state_t *state,
       goal = state->ship.position;
     }
   } else {
-    double best_dist = INFINITY;
-    AZ_ARRAY_LOOP(baddie, state->baddies) {
-      if (baddie->kind == AZ_BAD_NOTHING) continue;
-      if (baddie->uid == proj->last_hit_uid) continue;
-      if (az_baddie_has_flag(baddie, AZ_BADF_NO_HOMING_PROJ)) continue;
-      const double dist = az_vdist(baddie->position, proj->position) +
-        fabs(az_mod2pi(az_vtheta(az_vsub(baddie->position, proj->position)) -
-                       proj->angle)) * 100.0;
-      if (dist < best_dist) {
-        best_dist = dist;
-        found_target = true;
-        goal = baddie->position;
-      }
+    const az_baddie_t *target = find_homing_target(state, proj, proj->angle);
+    if (target != NULL) {
+      found_target = true;
+      goal = target->position;
     }
   }
   if (!found_target) return;
@@ -385,16 +415,17 @@ static void leave_particle_trail(
     az_space_state_t *state, az_projectile_t *proj, az_particle_kind_t kind,
     az_color_t color, double lifetime, double param1, double param2) {
   assert(proj->kind != AZ_PROJ_NOTHING);
-  az_particle_t *particle;
+  az_particle_t particle;
   if (az_insert_particle(state, &particle)) {
-    particle->kind = kind;
-    particle->color = color;
-    particle->position = proj->position;
-    particle->velocity = AZ_VZERO;
-    particle->angle = proj->angle;
-    particle->lifetime = lifetime;
-    particle->param1 = param1;
-    particle->param2 = param2;
+    particle.kind = kind;
+    particle.color = color;
+    particle.position = proj->position;
+    particle.velocity = AZ_VZERO;
+    particle.angle = proj->angle;
+    particle.lifetime = lifetime;
+    particle.param1 = param1;
+    particle.param2 = param2;
+    az_add_particle(state, &particle);
   }
 }
 
@@ -403,14 +434,15 @@ static void leave_missile_trail(az_space_state_t *state,
                                 double time, az_color_t color) {
   assert(proj->kind != AZ_PROJ_NOTHING);
   if (times_per_second(20, proj, time)) {
-    az_particle_t *particle;
+    az_particle_t particle;
     if (az_insert_particle(state, &particle)) {
-      particle->kind = AZ_PAR_BOOM;
-      particle->color = color;
-      particle->position = proj->position;
-      particle->velocity = AZ_VZERO;
-      particle->lifetime = 0.5;
-      particle->param1 = 10.0;
+      particle.kind = AZ_PAR_BOOM;
+      particle.color = color;
+      particle.position = proj->position;
+      particle.velocity = AZ_VZERO;
+      particle.lifetime = 0.5;
+      particle.param1 = 10.0;
+      az_add_particle(state, &particle);
     }
   }
 }
@@ -443,7 +475,9 @@ static void projectile_special_logic(az_space_state_t *state,
         az_add_speck(state, (az_color_t){0, 255, 255, 255},
                      (proj->kind == AZ_PROJ_GUN_CHARGED_FREEZE ? 1.0 :
                       proj->kind == AZ_PROJ_GUN_FREEZE_SHRAPNEL ? 0.2 : 0.3),
-                     proj->position, az_vpolar(30.0, az_random(0, AZ_TWO_PI)));
+                     proj->position,
+                     az_vpolar(30.0,
+                               az_rand_double(&state->rng, 0, AZ_TWO_PI)));
       }
       break;
     case AZ_PROJ_GUN_HOMING:
@@ -482,12 +516,13 @@ static void projectile_special_logic(az_space_state_t *state,
             proj->age >= proj->data->lifetime) {
           for (int i = -2; i <= 2; ++i) {
             const double theta =
-              proj->angle + 0.1 * AZ_PI * (i + az_random(-.5, .5));
+              proj->angle +
+              0.1 * AZ_PI * (i + az_rand_double(&state->rng, -.5, .5));
             assert(proj->data->shrapnel_kind != AZ_PROJ_NOTHING);
             az_add_projectile(state, proj->data->shrapnel_kind, proj->position,
                               theta, proj->power, proj->fired_by);
           }
-          proj->kind = AZ_PROJ_NOTHING;
+          az_remove_projectile(state, proj);
         }
       }
       break;
@@ -522,15 +557,19 @@ static void projectile_special_logic(az_space_state_t *state,
       break;
     case AZ_PROJ_ROCKET:
       az_add_speck(state, (az_color_t){255, 255, 0, 255}, 1.0, proj->position,
-                   az_vrotate(az_vmul(proj->velocity, -az_random(0, 0.3)),
-                              (az_random(-AZ_DEG2RAD(30), AZ_DEG2RAD(30)))));
+                   az_vrotate(az_vmul(proj->velocity,
+                                      -az_rand_double(&state->rng, 0, 0.3)),
+                              az_rand_double(&state->rng, -AZ_DEG2RAD(30),
+                                             AZ_DEG2RAD(30))));
       break;
     case AZ_PROJ_HYPER_ROCKET:
       for (int i = 0; i < 6; ++i) {
         az_add_speck(state, (az_color_t){255, 255, 0, 255},
                      0.5 + 0.1 * i, proj->position,
-                     az_vrotate(az_vmul(proj->velocity, -az_random(0, 0.3)),
-                                (az_random(-AZ_DEG2RAD(5), AZ_DEG2RAD(5)))));
+                     az_vrotate(az_vmul(proj->velocity,
+                                        -az_rand_double(&state->rng, 0, 0.3)),
+                                az_rand_double(&state->rng, -AZ_DEG2RAD(5),
+                                               AZ_DEG2RAD(5))));
       }
       break;
     case AZ_PROJ_MISSILE_FREEZE:
@@ -577,7 +616,7 @@ static void projectile_special_logic(az_space_state_t *state,
                               az_mod2pi(proj->angle + AZ_DEG2RAD(i)),
                               proj->power, proj->fired_by);
           }
-          proj->kind = AZ_PROJ_NOTHING;
+          az_remove_projectile(state, proj);
           az_play_sound(&state->soundboard, AZ_SND_FIRE_ROCKET);
         }
       }
@@ -767,9 +806,10 @@ static void projectile_special_logic(az_space_state_t *state,
       }
       break;
     case AZ_PROJ_ICE_TORPEDO:
-      az_add_speck(state, (az_color_t){0, 255, 255, 255}, az_random(0.2, 1.0),
+      az_add_speck(state, (az_color_t){0, 255, 255, 255},
+                   az_rand_double(&state->rng, 0.2, 1.0),
                    az_vadd(proj->position,
-                           az_vpolar(az_random(-8.0, 8.0),
+                           az_vpolar(az_rand_double(&state->rng, -8.0, 8.0),
                                      proj->angle + AZ_HALF_PI)), AZ_VZERO);
       break;
     case AZ_PROJ_MAGNET_FUSION_BEAM: {
@@ -913,8 +953,9 @@ static void projectile_special_logic(az_space_state_t *state,
       if (times_per_second(30, proj, time)) {
         const az_vector_t real_position = proj->position;
         const double spread = 20 + 200 * proj->age;
-        az_vpluseq(&proj->position, az_vwithlen(az_vrot90ccw(proj->velocity),
-                                                az_random(-spread, spread)));
+        az_vpluseq(&proj->position,
+                   az_vwithlen(az_vrot90ccw(proj->velocity),
+                               az_rand_double(&state->rng, -spread, spread)));
         on_projectile_impact(state, proj, proj->velocity);
         proj->position = real_position;
       }
@@ -926,8 +967,9 @@ static void projectile_special_logic(az_space_state_t *state,
         const az_vector_t position = proj->position;
         const double power = proj->power;
         const az_uid_t fired_by = proj->fired_by;
-        proj->kind = AZ_PROJ_NOTHING; // We cannot use proj after this point.
-        const double base_angle = az_random(0, AZ_TWO_PI);
+        // We cannot use proj after this point:
+        az_remove_projectile(state, proj);
+        const double base_angle = az_rand_double(&state->rng, 0, AZ_TWO_PI);
         for (int i = 0; i < 3; ++i) {
           az_projectile_t *expander = az_add_projectile(
               state, AZ_PROJ_TRINE_TORPEDO_EXPANDER, position,
@@ -948,7 +990,8 @@ static void projectile_special_logic(az_space_state_t *state,
         const double power = proj->power;
         const az_uid_t fired_by = proj->fired_by;
         double goal_angle = proj->angle + AZ_PI;
-        proj->kind = AZ_PROJ_NOTHING; // We cannot use proj after this point.
+        // We cannot use proj after this point:
+        az_remove_projectile(state, proj);
         if (az_ship_is_decloaked(&state->ship)) {
           goal_angle = az_vtheta(az_vsub(state->ship.position, position));
         }
@@ -1065,8 +1108,10 @@ static void tick_projectile(az_space_state_t *state, az_projectile_t *proj,
           if (az_baddie_has_flag(baddie, AZ_BADF_INCORPOREAL)) continue;
           az_vector_t normal;
           const az_component_data_t *component;
-          if (az_ray_hits_baddie(baddie, start, delta,
-                                 &proj->position, &normal, &component)) {
+          if (az_ray_hits_baddie(baddie,
+                                 az_get_indexed_baddie_bounds(state, baddie),
+                                 start, delta, &proj->position, &normal,
+                                 &component)) {
             on_projectile_hit_baddie(state, proj, baddie, component, normal);
             assert(proj->kind != AZ_PROJ_NOTHING);
           }
@@ -1115,7 +1160,9 @@ static void tick_projectile(az_space_state_t *state, az_projectile_t *proj,
 }
 
 void az_tick_projectiles(az_space_state_t *state, double time) {
-  AZ_ARRAY_LOOP(proj, state->projectiles) {
+  for (int i = 0; i < state->projectile_slots.num_live; ++i) {
+    az_projectile_t *proj =
+      &state->projectiles[state->projectile_slots.live[i]];
     if (proj->kind == AZ_PROJ_NOTHING) continue;
     tick_projectile(state, proj, time);
   }
@@ -0,0 +1,163 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "azimuth/tick/replay.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azimuth/constants.h"
+#include "azimuth/state/planet.h"
+#include "azimuth/state/replay.h"
+#include "azimuth/state/space.h"
+#include "azimuth/tick/space.h"
+#include "azimuth/util/key.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/prefs.h"
+#include "azimuth/util/vector.h"
+
+/*===========================================================================*/
+
+void az_init_replay_playback(az_replay_playback_t *playback,
+                             const az_replay_t *replay,
+                             const az_planet_t *planet,
+                             az_space_state_t *state) {
+  AZ_ZERO_OBJECT(playback);
+  playback->replay = replay;
+  playback->state = state;
+  playback->prefs = replay->prefs;
+  az_begin_saved_game(state, planet, &playback->prefs, &replay->saved_game,
+                      replay->saved_game_index);
+}
+
+void az_destroy_replay_playback(az_replay_playback_t *playback) {
+  free(playback->keyframes);
+  AZ_ZERO_OBJECT(playback);
+}
+
+static void take_keyframe(az_replay_playback_t *playback) {
+  if (playback->num_keyframes >= playback->max_keyframes) {
+    const int max_keyframes =
+      (playback->max_keyframes == 0 ? 16 : 2 * playback->max_keyframes);
+    az_replay_keyframe_t *keyframes =
+      AZ_ALLOC(max_keyframes, az_replay_keyframe_t);
+    if (playback->num_keyframes > 0) {
+      memcpy(keyframes, playback->keyframes,
+             playback->num_keyframes * sizeof(az_replay_keyframe_t));
+    }
+    free(playback->keyframes);
+    playback->keyframes = keyframes;
+    playback->max_keyframes = max_keyframes;
+  }
+  az_replay_keyframe_t *keyframe =
+    &playback->keyframes[playback->num_keyframes++];
+  keyframe->cursor = playback->cursor;
+  keyframe->prefs = playback->prefs;
+  az_snapshot_space_state(playback->state, &keyframe->snapshot);
+}
+
+bool az_replay_tick(az_replay_playback_t *playback) {
+  if (playback->ended) return false;
+  az_space_state_t *state = playback->state;
+  // Keyframes are only ever taken in order, the first time we reach each
+  // multiple of the interval.
+  const int frame = playback->cursor.frame;
+  if (frame % AZ_REPLAY_KEYFRAME_INTERVAL == 0 &&
+      frame / AZ_REPLAY_KEYFRAME_INTERVAL == playback->num_keyframes) {
+    take_keyframe(playback);
+  }
+
+  if (state->intro && state->sync_vm.script == NULL) {
+    az_finish_space_intro(state);
+  }
+  uint8_t held;
+  if (!az_replay_next_frame(playback->replay, &playback->cursor, &held)) {
+    // The replay was cut off without recording how the loop ended (e.g. the
+    // game crashed), so just stop here.
+    playback->ended = true;
+    return false;
+  }
+  az_set_held_controls(&state->ship.controls, held);
+  az_tick_space_state(state, AZ_FRAME_TIME_SECONDS);
+  return true;
+}
+
+void az_replay_after_tick(az_replay_playback_t *playback) {
+  const az_replay_t *replay = playback->replay;
+  az_replay_cursor_t *cursor = &playback->cursor;
+  az_space_state_t *state = playback->state;
+  AZ_ZERO_OBJECT(&state->ship.controls);
+
+  if (state->mode == AZ_MODE_PAUSING) {
+    const az_replay_record_t *record = az_replay_next_paused(replay, cursor);
+    if (record != NULL) {
+      az_player_t *player = &state->ship.player;
+      player->gun1 = record->data.paused.gun1;
+      player->gun2 = record->data.paused.gun2;
+      player->next_gun = record->data.paused.next_gun;
+      player->ordnance = record->data.paused.ordnance;
+      if (!record->data.paused.exit_to_title) {
+        state->pausing_mode.step = AZ_PSS_FADE_IN;
+      }
+      az_control_id_t control;
+      az_key_id_t key;
+      while (az_replay_next_rebind(replay, cursor, &control, &key)) {
+        playback->prefs.key_for_control[control] = key;
+      }
+    }
+  } else if (state->mode == AZ_MODE_CONSOLE) {
+    bool save_ok;
+    if (az_replay_next_save(replay, cursor, &save_ok)) {
+      az_show_save_result(state, save_ok);
+    }
+  }
+  if (az_replay_next_end(replay, cursor, &playback->action)) {
+    playback->ended = true;
+    return;
+  }
+  az_key_id_t key;
+  while (az_replay_next_key_down(replay, cursor, &key)) {
+    az_space_key_down(state, key);
+  }
+}
+
+void az_seek_replay(az_replay_playback_t *playback, int frame) {
+  assert(frame >= 0);
+  // Find the latest keyframe at or before the target frame, unless we can get
+  // there sooner by just playing forward from where we are now.
+  const int index = az_imin(frame / AZ_REPLAY_KEYFRAME_INTERVAL,
+                            playback->num_keyframes - 1);
+  if (index >= 0 && (frame < playback->cursor.frame ||
+                     playback->keyframes[index].cursor.frame >
+                     playback->cursor.frame)) {
+    const az_replay_keyframe_t *keyframe = &playback->keyframes[index];
+    playback->cursor = keyframe->cursor;
+    playback->prefs = keyframe->prefs;
+    az_restore_space_state(&keyframe->snapshot, playback->state);
+    playback->ended = false;
+  }
+  while (playback->cursor.frame < frame && az_replay_tick(playback)) {
+    AZ_ZERO_OBJECT(&playback->state->soundboard);
+    az_replay_after_tick(playback);
+  }
+}
+
+/*===========================================================================*/
@@ -0,0 +1,81 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef AZIMUTH_TICK_REPLAY_H_
+#define AZIMUTH_TICK_REPLAY_H_
+
+#include <stdbool.h>
+
+#include "azimuth/state/planet.h"
+#include "azimuth/state/replay.h"
+#include "azimuth/state/space.h"
+#include "azimuth/util/prefs.h"
+
+/*===========================================================================*/
+
+// How many frames apart keyframes are taken during playback (every five
+// seconds of game time).
+#define AZ_REPLAY_KEYFRAME_INTERVAL 300
+
+// A snapshot of the playback partway through the replay.
+typedef struct {
+  az_replay_cursor_t cursor;
+  az_preferences_t prefs;
+  az_space_snapshot_t snapshot;
+} az_replay_keyframe_t;
+
+typedef struct {
+  const az_replay_t *replay;
+  az_space_state_t *state;
+  az_replay_cursor_t cursor;
+  az_preferences_t prefs; // the key bindings in effect at this point
+  bool ended;
+  int action; // the recorded az_space_action_t, once ended is true
+  int num_keyframes, max_keyframes;
+  az_replay_keyframe_t *keyframes;
+} az_replay_playback_t;
+
+// Reset the state to the start of the replay's run.  The replay and state must
+// outlive the playback.
+void az_init_replay_playback(az_replay_playback_t *playback,
+                             const az_replay_t *replay,
+                             const az_planet_t *planet,
+                             az_space_state_t *state);
+
+// Free the playback's keyframes.
+void az_destroy_replay_playback(az_replay_playback_t *playback);
+
+// Play back the first half of the next frame, up to the point where the event
+// loop would redraw the screen.  Returns false (without ticking) if the replay
+// has ended.
+bool az_replay_tick(az_replay_playback_t *playback);
+
+// Play back the rest of the frame begun by az_replay_tick (the parts of the
+// event loop after the redraw).  Sounds requested by the tick are left in the
+// soundboard for the caller to play or discard.
+void az_replay_after_tick(az_replay_playback_t *playback);
+
+// Jump to the start of the given frame, by restoring the latest keyframe at or
+// before it and then playing forward from there (discarding any sounds).
+void az_seek_replay(az_replay_playback_t *playback, int frame);
+
+/*===========================================================================*/
+
+#endif // AZIMUTH_TICK_REPLAY_H_
@@ -319,7 +319,9 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
       // Math:
       case AZ_OP_ABS: UNARY_OP(fabs(a)); break;
       case AZ_OP_MTAU: UNARY_OP(az_mod2pi(a)); break;
-      case AZ_OP_RAND: STACK_PUSH(az_random(0.0, 1.0)); break;
+      case AZ_OP_RAND:
+        STACK_PUSH(az_rand_double(&state->rng, 0.0, 1.0));
+        break;
       case AZ_OP_SQRT: UNARY_OP(a < 0.0 ? NAN : sqrt(a)); break;
       // Vectors:
       case AZ_OP_VADD: {
@@ -422,6 +424,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           case AZ_OBJ_SHIP: SCRIPT_ERROR("invalid object type");
           case AZ_OBJ_WALL:
             object.obj.wall->kind = AZ_WALL_NOTHING;
+            az_update_wall_grid(state, object.obj.wall);
             break;
         }
       } break;
@@ -624,6 +627,7 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
           az_init_baddie(baddie, (az_baddie_kind_t)kind, baddie->position,
                          baddie->angle);
           baddie->on_kill = baddie_script;
+          az_update_baddie_sweep(state, baddie);
         }
       } break;
       case AZ_OP_BOSS: {
@@ -759,16 +763,17 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
       case AZ_OP_BOLT: {
         az_vector_t p1, p2;
         STACK_POP(&p1.x, &p1.y, &p2.x, &p2.y);
-        az_particle_t *particle;
+        az_particle_t particle;
         if (az_insert_particle(state, &particle)) {
-          particle->kind = AZ_PAR_LIGHTNING_BOLT;
-          particle->color = (az_color_t){128, 64, 255, 255};
-          particle->position = p2;
-          particle->velocity = AZ_VZERO;
-          particle->angle = az_vtheta(az_vsub(p1, p2));
-          particle->lifetime = ins.immediate;
-          particle->param1 = az_vdist(p1, p2);
-          particle->param2 = 0.66;
+          particle.kind = AZ_PAR_LIGHTNING_BOLT;
+          particle.color = (az_color_t){128, 64, 255, 255};
+          particle.position = p2;
+          particle.velocity = AZ_VZERO;
+          particle.angle = az_vtheta(az_vsub(p1, p2));
+          particle.lifetime = ins.immediate;
+          particle.param1 = az_vdist(p1, p2);
+          particle.param2 = 0.66;
+          az_add_particle(state, &particle);
         }
         az_play_sound(&state->soundboard, AZ_SND_ELECTRICITY);
       } break;
@@ -776,15 +781,16 @@ static void run_vm(az_space_state_t *state, az_script_vm_t *vm) {
         az_vector_t position;
         STACK_POP(&position.x, &position.y);
         state->camera.wobble_goal = 0.5 * ins.immediate;
-        az_particle_t *particle;
+        az_particle_t particle;
         if (az_insert_particle(state, &particle)) {
-          particle->kind = AZ_PAR_NPS_PORTAL;
-          particle->color = (az_color_t){128, 64, 255, 255};
-          particle->position = position;
-          particle->velocity = AZ_VZERO;
-          particle->angle = 0.0;
-          particle->lifetime = ins.immediate;
-          particle->param1 = 50.0 * sqrt(ins.immediate);
+          particle.kind = AZ_PAR_NPS_PORTAL;
+          particle.color = (az_color_t){128, 64, 255, 255};
+          particle.position = position;
+          particle.velocity = AZ_VZERO;
+          particle.angle = 0.0;
+          particle.lifetime = ins.immediate;
+          particle.param1 = 50.0 * sqrt(ins.immediate);
+          az_add_particle(state, &particle);
         }
         az_play_sound(&state->soundboard, AZ_SND_NPS_PORTAL);
       } break;
@@ -23,6 +23,7 @@
 #include <math.h>
 #include <stdbool.h>
 #include <stddef.h> // for NULL
+#include <stdint.h>
 
 #include "azimuth/constants.h"
 #include "azimuth/state/door.h"
@@ -161,16 +162,17 @@ static void disable_ship_tractor_cloak(az_space_state_t *state) {
 
 static void add_cplus_boom(az_space_state_t *state,
                            const az_impact_t *impact) {
-  az_particle_t *particle;
+  az_particle_t particle;
   if (az_insert_particle(state, &particle)) {
-    particle->kind = AZ_PAR_BOOM;
-    particle->color = (az_color_t){0, 255, 0, 255};
-    particle->position =
+    particle.kind = AZ_PAR_BOOM;
+    particle.color = (az_color_t){0, 255, 0, 255};
+    particle.position =
       az_vsub(impact->position,
               az_vwithlen(impact->normal, AZ_SHIP_DEFLECTOR_RADIUS));
-    particle->velocity = AZ_VZERO;
-    particle->lifetime = 0.4;
-    particle->param1 = 40.0;
+    particle.velocity = AZ_VZERO;
+    particle.lifetime = 0.4;
+    particle.param1 = 40.0;
+    az_add_particle(state, &particle);
   }
 }
 
@@ -180,7 +182,9 @@ static void on_ship_impact(az_space_state_t *state, const az_impact_t *impact,
 
   // If we're entering or exiting a body of water, make a splash.
   const az_vector_t delta = az_vsub(impact->position, ship->position);
-  AZ_ARRAY_LOOP(gravfield, state->gravfields) {
+  for (uint64_t bits = az_liquid_candidates(state, 0.0, ship->position, delta);
+       bits != 0; bits &= bits - 1) {
+    az_gravfield_t *gravfield = &state->gravfields[__builtin_ctzll(bits)];
     if (!az_is_liquid(gravfield->kind)) continue;
     az_vector_t position, normal;
     if (az_ray_hits_liquid_surface(gravfield, ship->position, delta,
@@ -249,16 +253,17 @@ static void on_ship_impact(az_space_state_t *state, const az_impact_t *impact,
                                  0.5 * damage)) {
           ship->reactive_flare = 1.0;
           az_play_sound(&state->soundboard, AZ_SND_REACTIVE_ARMOR);
-          az_particle_t *particle;
+          az_particle_t particle;
           if (az_insert_particle(state, &particle)) {
-            particle->kind = AZ_PAR_BOOM;
-            particle->color = (az_color_t){255, 0, 0, 255};
-            particle->position =
+            particle.kind = AZ_PAR_BOOM;
+            particle.color = (az_color_t){255, 0, 0, 255};
+            particle.position =
               az_vsub(ship->position,
                       az_vwithlen(impact->normal, AZ_SHIP_DEFLECTOR_RADIUS));
-            particle->velocity = AZ_VZERO;
-            particle->lifetime = 0.4;
-            particle->param1 = 15.0;
+            particle.velocity = AZ_VZERO;
+            particle.lifetime = 0.4;
+            particle.param1 = 15.0;
+            az_add_particle(state, &particle);
           }
           // If the Reactive Armor killed the baddie, then we take no damage
           // from the impact and are not knocked around as much.
@@ -358,16 +363,17 @@ static void on_ship_impact(az_space_state_t *state, const az_impact_t *impact,
   }
 
   // Put a particle at the impact point and play a sound.
-  az_particle_t *particle;
+  az_particle_t particle;
   if (az_insert_particle(state, &particle)) {
-    particle->kind = AZ_PAR_BOOM;
-    particle->color = (az_color_t){255, 255, 255, 255};
-    particle->position =
+    particle.kind = AZ_PAR_BOOM;
+    particle.color = (az_color_t){255, 255, 255, 255};
+    particle.position =
       az_vsub(ship->position, az_vwithlen(impact->normal,
                                           AZ_SHIP_DEFLECTOR_RADIUS));
-    particle->velocity = AZ_VZERO;
-    particle->lifetime = 0.3;
-    particle->param1 = 10;
+    particle.velocity = AZ_VZERO;
+    particle.lifetime = 0.3;
+    particle.param1 = 10;
+    az_add_particle(state, &particle);
   }
   az_play_sound(&state->soundboard, AZ_SND_HIT_WALL);
 
@@ -403,17 +409,12 @@ static double auto_aim_angle(const az_space_state_t *state, double limit,
   const double forward = state->ship.angle;
   double best_dist = INFINITY;
   double best_angle = forward;
-  AZ_ARRAY_LOOP(baddie, state->baddies) {
-    if (baddie->kind == AZ_BAD_NOTHING) continue;
-    if (az_baddie_has_flag(baddie, ignore_flag)) continue;
+  const az_baddie_t *baddie =
+    az_find_nearest_baddie_in_cone(state, start, forward, limit, ignore_flag);
+  if (baddie != NULL) {
     const az_vector_t delta = az_vsub(baddie->position, start);
-    const double dist = az_vnorm(delta);
-    if (dist >= best_dist) continue;
-    const double angle = az_vtheta(delta);
-    if (fabs(az_mod2pi(angle - forward)) <= limit) {
-      best_dist = dist;
-      best_angle = angle;
-    }
+    best_dist = az_vnorm(delta);
+    best_angle = az_vtheta(delta);
   }
   AZ_ARRAY_LOOP(door, state->doors) {
     if (door->kind != AZ_DOOR_NORMAL) continue;
@@ -498,8 +499,10 @@ static void fire_ordn_single(
 static void beam_emit_particles(az_space_state_t *state, az_vector_t position,
                                 az_vector_t normal, az_color_t color) {
   az_add_speck(state, color, 1.0, position,
-               az_vpolar(az_random(20.0, 70.0), az_vtheta(normal) +
-                         az_random(-AZ_HALF_PI, AZ_HALF_PI)));
+               az_vpolar(az_rand_double(&state->rng, 20.0, 70.0),
+                         az_vtheta(normal) +
+                         az_rand_double(&state->rng, -AZ_HALF_PI,
+                                        AZ_HALF_PI)));
 }
 
 static void fire_beam(az_space_state_t *state, az_gun_t minor, double time) {
@@ -536,6 +539,27 @@ static void fire_beam(az_space_state_t *state, az_gun_t minor, double time) {
   // whatever it hits, creating additional beams.
   const int num_beams = (minor == AZ_GUN_TRIPLE ? 3 :
                          minor == AZ_GUN_BURST ? 3 : 1);
+  const az_impact_flags_t skip_types =
+    (minor == AZ_GUN_PHASE ?
+     AZ_IMPF_SHIP | AZ_IMPF_WALL | AZ_IMPF_DOOR_INSIDE | AZ_IMPF_DOOR_OUTSIDE :
+     minor == AZ_GUN_PIERCE ? AZ_IMPF_SHIP | AZ_IMPF_BADDIE : AZ_IMPF_SHIP);
+  // The three TRIPLE beams all start from the same place, so we cast them
+  // together up front (whereas each BURST beam starts from where the previous
+  // one hit).  If resolving one beam's impact might change what the later
+  // beams would hit (by damaging a baddie or opening a door), we throw away
+  // the rest of the batch and cast those beams afresh.
+  az_impact_t triple_impacts[3];
+  bool use_triple_impacts = false;
+  if (minor == AZ_GUN_TRIPLE) {
+    const az_ray_t rays[3] = {
+      {beam_start, az_vpolar(10000, beam_init_angle)},
+      {beam_start, az_vpolar(10000, beam_init_angle + AZ_DEG2RAD(10))},
+      {beam_start, az_vpolar(10000, beam_init_angle - AZ_DEG2RAD(10))}
+    };
+    az_ray_impact_batch(state, rays, 3, skip_types, AZ_SHIP_UID,
+                        triple_impacts);
+    use_triple_impacts = true;
+  }
   for (int beam_index = 0; beam_index < num_beams; ++beam_index) {
     // Determine how much damage the beam should do.  Note that for BURST
     // beams, the damage_mult will change with each loop iteration.
@@ -556,12 +580,11 @@ static void fire_beam(az_space_state_t *state, az_gun_t minor, double time) {
 
     // Determine what the beam hits (if anything).
     az_impact_t impact;
-    az_impact_flags_t skip_types = AZ_IMPF_SHIP;
-    if (minor == AZ_GUN_PHASE) {
-      skip_types |= AZ_IMPF_WALL | AZ_IMPF_DOOR_INSIDE | AZ_IMPF_DOOR_OUTSIDE;
-    } else if (minor == AZ_GUN_PIERCE) skip_types |= AZ_IMPF_BADDIE;
-    az_ray_impact(state, beam_start, az_vpolar(10000, beam_angle), skip_types,
-                  AZ_SHIP_UID, &impact);
+    if (use_triple_impacts) impact = triple_impacts[beam_index];
+    else {
+      az_ray_impact(state, beam_start, az_vpolar(10000, beam_angle),
+                    skip_types, AZ_SHIP_UID, &impact);
+    }
 
     // If this is a PHASE beam, hit all doors along the beam.
     if (minor == AZ_GUN_PHASE) {
@@ -583,8 +606,10 @@ static void fire_beam(az_space_state_t *state, az_gun_t minor, double time) {
         if (az_baddie_has_flag(baddie, AZ_BADF_INCORPOREAL)) continue;
         az_vector_t position, normal;
         const az_component_data_t *component;
-        if (az_ray_hits_baddie(baddie, beam_start, delta,
-                               &position, &normal, &component)) {
+        if (az_ray_hits_baddie(baddie,
+                               az_get_indexed_baddie_bounds(state, baddie),
+                               beam_start, delta, &position, &normal,
+                               &component)) {
           beam_emit_particles(state, position, normal, AZ_WHITE);
           az_try_damage_baddie(state, baddie, component, damage_kind, damage);
         }
@@ -619,6 +644,9 @@ static void fire_beam(az_space_state_t *state, az_gun_t minor, double time) {
       case AZ_IMP_SHIP: AZ_ASSERT_UNREACHABLE();
       case AZ_IMP_WALL: break;
     }
+    if (impact.type == AZ_IMP_BADDIE || impact.type == AZ_IMP_DOOR_OUTSIDE) {
+      use_triple_impacts = false;
+    }
     if (did_hit) {
       // Add particles off of whatever the beam hits:
       beam_emit_particles(state, impact.position, impact.normal, AZ_WHITE);
@@ -1030,22 +1058,23 @@ static void apply_cplus_drive(az_space_state_t *state, bool is_in_water,
         // If we're at least halfway charged, leave a double trail of smoke
         // behind the ship (green if we're fully charged, gray otherwise).
         if (ship->cplus.charge >= 0.5) {
-          az_particle_t *particle;
+          az_particle_t particle;
           for (int offset = -30; offset <= 30; offset += 60) {
             if (az_insert_particle(state, &particle)) {
-              particle->kind = AZ_PAR_EMBER;
+              particle.kind = AZ_PAR_EMBER;
               if (ship->cplus.charge == 1.0) {
-                particle->color = (az_color_t){64, 160, 64, 255};
+                particle.color = (az_color_t){64, 160, 64, 255};
               } else {
-                particle->color = (az_color_t){128, 128, 128,
+                particle.color = (az_color_t){128, 128, 128,
                     255 * (ship->cplus.charge - 0.25)};
               }
-              particle->position =
+              particle.position =
                 az_vadd(ship->position,
                         az_vpolar(-17.0, ship->angle + AZ_DEG2RAD(offset)));
-              particle->velocity = AZ_VZERO;
-              particle->lifetime = 0.5;
-              particle->param1 = 8.0;
+              particle.velocity = AZ_VZERO;
+              particle.lifetime = 0.5;
+              particle.param1 = 8.0;
+              az_add_particle(state, &particle);
             }
           }
         }
@@ -1100,15 +1129,16 @@ static void apply_cplus_drive(az_space_state_t *state, bool is_in_water,
         // As long as the C-plus drive is active, the ship moves at a constant
         // (fast) speed, and leaves a trail of green smoke behind it.
         ship->velocity = az_vpolar(1000.0, ship->angle);
-        az_particle_t *particle;
+        az_particle_t particle;
         if (az_insert_particle(state, &particle)) {
-          particle->kind = AZ_PAR_EMBER;
-          particle->color = (az_color_t){64, 255, 64, 255};
-          particle->position =
+          particle.kind = AZ_PAR_EMBER;
+          particle.color = (az_color_t){64, 255, 64, 255};
+          particle.position =
             az_vadd(ship->position, az_vpolar(-15.0, ship->angle));
-          particle->velocity = AZ_VZERO;
-          particle->lifetime = 0.3;
-          particle->param1 = 20;
+          particle.velocity = AZ_VZERO;
+          particle.lifetime = 0.3;
+          particle.param1 = 20;
+          az_add_particle(state, &particle);
         }
         az_persist_sound(&state->soundboard, AZ_SND_CPLUS_ACTIVE);
       }
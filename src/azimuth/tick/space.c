@@ -21,9 +21,14 @@
 
 #include <assert.h>
 #include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 #include "azimuth/state/dialog.h"
 #include "azimuth/state/planet.h"
+#include "azimuth/state/player.h"
+#include "azimuth/state/save.h"
+#include "azimuth/state/profile.h"
 #include "azimuth/state/space.h"
 #include "azimuth/tick/baddie.h"
 #include "azimuth/tick/camera.h"
@@ -34,12 +39,15 @@
 #include "azimuth/tick/object.h"
 #include "azimuth/tick/particle.h"
 #include "azimuth/tick/pickup.h"
+#include "azimuth/tick/profile.h"
 #include "azimuth/tick/projectile.h"
 #include "azimuth/tick/script.h"
 #include "azimuth/tick/ship.h"
 #include "azimuth/tick/speck.h"
 #include "azimuth/tick/wall.h"
+#include "azimuth/util/key.h"
 #include "azimuth/util/misc.h"
+#include "azimuth/util/prefs.h"
 #include "azimuth/util/random.h"
 #include "azimuth/util/vector.h"
 #include "azimuth/util/warning.h"
@@ -61,6 +69,7 @@ void az_after_entering_room(az_space_state_t *state) {
     if (az_circle_touches_wall(
             wall, WALL_REMOVAL_RADIUS, state->ship.position)) {
       wall->kind = AZ_WALL_NOTHING;
+      az_update_wall_grid(state, wall);
     }
   }
   const az_room_t *room =
@@ -98,15 +107,16 @@ static void tick_boss_death_mode(az_space_state_t *state, double time) {
         mode_data->progress = 0.0;
         if (state->boss_death_mode.boss.kind == AZ_BAD_OTH_GUNSHIP) {
           state->camera.wobble_goal = boom_time;
-          az_particle_t *particle;
+          az_particle_t particle;
           if (az_insert_particle(state, &particle)) {
-            particle->kind = AZ_PAR_NPS_PORTAL;
-            particle->color = (az_color_t){128, 64, 255, 255};
-            particle->position = state->boss_death_mode.boss.position;
-            particle->velocity = AZ_VZERO;
-            particle->angle = 0.0;
-            particle->lifetime = 2.0 * boom_time;
-            particle->param1 = 50.0 * sqrt(2.0 * boom_time);
+            particle.kind = AZ_PAR_NPS_PORTAL;
+            particle.color = (az_color_t){128, 64, 255, 255};
+            particle.position = state->boss_death_mode.boss.position;
+            particle.velocity = AZ_VZERO;
+            particle.angle = 0.0;
+            particle.lifetime = 2.0 * boom_time;
+            particle.param1 = 50.0 * sqrt(2.0 * boom_time);
+            az_add_particle(state, &particle);
           }
           az_play_sound(&state->soundboard, AZ_SND_NPS_PORTAL);
         } else {
@@ -125,7 +135,7 @@ static void tick_boss_death_mode(az_space_state_t *state, double time) {
           az_pickup_t *pickup = az_add_random_pickup(
               state, mode_data->boss.data->potential_pickups,
               az_vadd(mode_data->boss.position,
-                      az_random_point_in_circle(100.0)));
+                      az_rand_point_in_circle(&state->rng, 100.0)));
           if (pickup != NULL) {
             pickup->time_remaining = 1e9;
           }
@@ -683,24 +693,38 @@ static void tick_nuke(az_space_state_t *state, double time) {
   const double step = 0.1 * theta_span;
   for (double theta = center_theta - theta_span;
        theta < center_theta + theta_span; theta += step) {
-    if (az_random(0, 1) < 0.5 * (1.0 - pow(0.5, 3.0 * time))) {
+    if (az_rand_double(&state->rng, 0, 1) <
+        0.5 * (1.0 - pow(0.5, 3.0 * time))) {
       az_add_projectile(state, AZ_PROJ_PLANETARY_EXPLOSION,
                         az_vpolar(state->nuke.rho,
-                                  theta + step * az_random(-0.5, 0.5)),
+                                  theta + step *
+                                  az_rand_double(&state->rng, -0.5, 0.5)),
                         0, 1, AZ_NULL_UID);
     }
   }
 }
 
+// Make the given call, adding the time it takes to the given section of the
+// state's tick profile (if the state is being profiled).
+#define PROFILE(section, call) do { \
+    const uint64_t profile_start_ = az_profile_start(state); \
+    call; \
+    az_profile_stop(state, (section), profile_start_); \
+  } while (0)
+
 static void tick_most_objects(az_space_state_t *state, double time) {
   tick_darkness(state, time);
   az_tick_pickups(state, time);
-  az_tick_gravfields(state, time);
-  az_tick_walls(state, time);
+  PROFILE(AZ_PROF_GRAVFIELDS, az_tick_gravfields(state, time));
+  PROFILE(AZ_PROF_WALLS, az_tick_walls(state, time));
   az_tick_doors(state, time);
-  az_tick_projectiles(state, time);
+  PROFILE(AZ_PROF_PROJECTILES, az_tick_projectiles(state, time));
   tick_nuke(state, time);
-  az_tick_baddies(state, time);
+  // Baddies move around freely while they're ticked, so don't use the sweep
+  // index again until it's been rebuilt from their new positions.
+  az_invalidate_baddie_sweep(state);
+  az_tick_baddies(state, time); // this profiles each baddie by kind
+  az_build_baddie_sweep(state);
 }
 
 static void tick_all_objects(az_space_state_t *state, double time) {
@@ -708,7 +732,9 @@ static void tick_all_objects(az_space_state_t *state, double time) {
   // We just ticked baddies and projectiles, so the ship might've gotten blown
   // up and we could now be in game-over mode; only tick the ship if that's not
   // the case.
-  if (state->mode != AZ_MODE_GAME_OVER) az_tick_ship(state, time);
+  if (state->mode != AZ_MODE_GAME_OVER) {
+    PROFILE(AZ_PROF_SHIP, az_tick_ship(state, time));
+  }
   az_tick_nodes(state, time);
 }
 
@@ -722,7 +748,10 @@ static void hold_ship_sounds(az_space_state_t *state) {
 
 /*===========================================================================*/
 
-void az_tick_space_state(az_space_state_t *state, double time) {
+static void tick_space_state(az_space_state_t *state, double time) {
+  // Free up the slots of any objects removed during the previous frame.
+  az_reclaim_slots(state);
+
   // Cool down skip timer.
   if (state->skip.allowed) {
     assert(state->sync_vm.script != NULL);
@@ -764,9 +793,9 @@ void az_tick_space_state(az_space_state_t *state, double time) {
   // If we're fading the whole screen in or out, do that and then stop.
   if (state->global_fade.step != AZ_GFS_INACTIVE) {
     if (state->nuke.active) {
-      az_tick_particles(state, time);
-      az_tick_specks(state, time);
-      az_tick_projectiles(state, time);
+      PROFILE(AZ_PROF_PARTICLES, az_tick_particles(state, time));
+      PROFILE(AZ_PROF_SPECKS, az_tick_specks(state, time));
+      PROFILE(AZ_PROF_PROJECTILES, az_tick_projectiles(state, time));
       tick_nuke(state, time);
     }
     tick_global_fade(state, time);
@@ -778,14 +807,14 @@ void az_tick_space_state(az_space_state_t *state, double time) {
   if (state->cutscene.scene != AZ_SCENE_NOTHING) {
     if (state->cutscene.scene == state->cutscene.next) {
       if (state->sync_timer.is_active) {
-        tick_sync_timer(state, time);
+        PROFILE(AZ_PROF_SCRIPTS, tick_sync_timer(state, time));
       } else if (state->monologue.step != AZ_MLS_INACTIVE) {
-        tick_monologue(state, time);
+        PROFILE(AZ_PROF_SCRIPTS, tick_monologue(state, time));
       } else if (state->dialogue.step != AZ_DLS_INACTIVE) {
-        tick_dialogue(state, time);
+        PROFILE(AZ_PROF_SCRIPTS, tick_dialogue(state, time));
       } else assert(false);
     }
-    az_tick_cutscene(state, time);
+    PROFILE(AZ_PROF_SCRIPTS, az_tick_cutscene(state, time));
     return;
   }
 
@@ -796,27 +825,27 @@ void az_tick_space_state(az_space_state_t *state, double time) {
   }
 
   // These ticks happen even during dialogue/monologue.
-  az_tick_particles(state, time);
-  az_tick_specks(state, time);
+  PROFILE(AZ_PROF_PARTICLES, az_tick_particles(state, time));
+  PROFILE(AZ_PROF_SPECKS, az_tick_specks(state, time));
   tick_message(&state->message, time);
   tick_countdown(&state->countdown, time);
 
   // If there's a synchronous timer, tick that.
   if (state->sync_timer.is_active) {
-    tick_sync_timer(state, time);
+    PROFILE(AZ_PROF_SCRIPTS, tick_sync_timer(state, time));
     return;
   } else assert(state->sync_timer.time_remaining == 0.0);
 
   // If we're in monologue, advance the monologue and then stop.
   if (state->monologue.step != AZ_MLS_INACTIVE) {
-    tick_monologue(state, time);
+    PROFILE(AZ_PROF_SCRIPTS, tick_monologue(state, time));
     return;
   } else assert(state->monologue.paragraph == NULL);
 
   // If we're in dialogue, advance the dialogue and then stop.
   if (state->dialogue.step != AZ_DLS_INACTIVE) {
     az_tick_doors(state, time);
-    tick_dialogue(state, time);
+    PROFILE(AZ_PROF_SCRIPTS, tick_dialogue(state, time));
     return;
   } else assert(state->dialogue.paragraph == NULL);
 
@@ -841,7 +870,7 @@ void az_tick_space_state(az_space_state_t *state, double time) {
       tick_doorway_mode(state, time);
       if (state->doorway_mode.step == AZ_DWS_FADE_IN) {
         tick_all_objects(state, time);
-        az_tick_timers(state, time);
+        PROFILE(AZ_PROF_SCRIPTS, az_tick_timers(state, time));
       } else hold_ship_sounds(state);
       break;
     case AZ_MODE_GAME_OVER:
@@ -852,7 +881,7 @@ void az_tick_space_state(az_space_state_t *state, double time) {
     case AZ_MODE_NORMAL:
       tick_console_help(state, time);
       tick_all_objects(state, time);
-      az_tick_timers(state, time);
+      PROFILE(AZ_PROF_SCRIPTS, az_tick_timers(state, time));
       check_countdown(state, time);
       break;
     case AZ_MODE_PAUSING:
@@ -868,7 +897,206 @@ void az_tick_space_state(az_space_state_t *state, double time) {
       (state->mode == AZ_MODE_BOSS_DEATH &&
        state->boss_death_mode.boss.kind != AZ_BAD_NOTHING ?
        state->boss_death_mode.boss.position : state->ship.position);
-    az_tick_camera(state, goal, time);
+    PROFILE(AZ_PROF_CAMERA, az_tick_camera(state, goal, time));
+  }
+}
+
+void az_tick_space_state(az_space_state_t *state, double time) {
+  if (state->profile == NULL) {
+    tick_space_state(state, time);
+    return;
+  }
+  az_tick_profile_t *profile = state->profile;
+  az_begin_profiled_tick(profile);
+  const uint64_t start = profile->clock();
+  tick_space_state(state, time);
+  const uint64_t total_nanos = profile->clock() - start;
+#define RECORD_POOL(pool, slots) do { \
+    profile->pool_live[pool] = (slots)->num_live; \
+    profile->pool_high_water[pool] = (slots)->high_water; \
+  } while (0)
+  RECORD_POOL(AZ_POOL_BADDIES, &state->baddie_slots);
+  RECORD_POOL(AZ_POOL_PARTICLES, &state->particle_slots);
+  RECORD_POOL(AZ_POOL_PICKUPS, &state->pickup_slots);
+  RECORD_POOL(AZ_POOL_PROJECTILES, &state->projectile_slots);
+  RECORD_POOL(AZ_POOL_SPECKS, &state->speck_slots);
+#undef RECORD_POOL
+  // Walls have no slot list, since they are only ever added on entering a
+  // room, so count the live ones directly.
+  int num_walls = 0;
+  for (int i = 0; i < state->wall_high_water; ++i) {
+    if (state->walls[i].kind != AZ_WALL_NOTHING) ++num_walls;
+  }
+  profile->pool_live[AZ_POOL_WALLS] = num_walls;
+  profile->pool_high_water[AZ_POOL_WALLS] = state->wall_high_water;
+  az_end_profiled_tick(profile, total_nanos);
+}
+
+/*===========================================================================*/
+
+static void position_ship_at_save_point_if_any(az_space_state_t *state) {
+  const az_room_t *room =
+    &state->planet->rooms[state->ship.player.current_room];
+  state->ship.position = az_bounds_center(&room->camera_bounds);
+  AZ_ARRAY_LOOP(node, state->nodes) {
+    if (node->kind == AZ_NODE_CONSOLE &&
+        node->subkind.console == AZ_CONS_SAVE) {
+      state->ship.position = node->position;
+      state->ship.angle = node->angle;
+      break;
+    }
+  }
+}
+
+void az_begin_saved_game(az_space_state_t *state, const az_planet_t *planet,
+                         const az_preferences_t *prefs,
+                         const az_saved_game_t *saved_game,
+                         int saved_game_index) {
+  assert(saved_game_index >= 0);
+  assert(saved_game_index < AZ_NUM_SAVED_GAME_SLOTS);
+  AZ_ZERO_OBJECT(state);
+  state->planet = planet;
+  state->prefs = prefs;
+  state->save_file_index = saved_game_index;
+  state->rng = (az_random_seed_t){1, 1};
+  state->mode = AZ_MODE_NORMAL;
+
+  if (saved_game->present) {
+    // Resume saved game:
+    state->ship.player = saved_game->player;
+    az_enter_room(state, &planet->rooms[state->ship.player.current_room]);
+    position_ship_at_save_point_if_any(state);
+    az_after_entering_room(state);
+    state->console_help_message_cooldown = 10.0;
+  } else {
+    // Begin new game:
+    az_init_player(&state->ship.player);
+    state->intro = true;
+    state->ship.player.current_room = planet->start_room;
+    az_run_script(state, planet->on_start);
+  }
+}
+
+void az_finish_space_intro(az_space_state_t *state) {
+  assert(state->intro);
+  assert(state->sync_vm.script == NULL);
+  state->intro = false;
+  az_enter_room(state, &state->planet->rooms[state->planet->start_room]);
+  position_ship_at_save_point_if_any(state);
+  az_after_entering_room(state);
+}
+
+static const char save_failed_paragraph[] =
+  "$RERROR:$W Unable to save game.";
+static const char save_success_paragraph[] =
+  "Shields refilled and $Ggame saved$W.";
+
+void az_show_save_result(az_space_state_t *state, bool success) {
+  az_set_message(state, (success ? save_success_paragraph :
+                         save_failed_paragraph));
+}
+
+void az_space_key_down(az_space_state_t *state, az_key_id_t key_id) {
+  const az_preferences_t *prefs = state->prefs;
+  if (state->skip.allowed && !state->skip.active) {
+    assert(state->sync_vm.script != NULL);
+    if (prefs->key_for_control[AZ_CONTROL_PAUSE] == key_id) {
+      if (state->skip.cooldown < 1.0) {
+        state->skip.cooldown = 4.0;
+      } else {
+        state->skip.active = true;
+        state->skip.cooldown = 0.0;
+      }
+    } else if (key_id == AZ_KEY_RETURN) {
+      state->skip.cooldown = (state->skip.cooldown > 0.0 ? 4.0 : 0.3);
+    }
+  }
+  if (state->monologue.step != AZ_MLS_INACTIVE) {
+    if (state->monologue.step == AZ_MLS_TALK) {
+      state->monologue.step = AZ_MLS_WAIT;
+      state->monologue.progress = 0.0;
+      state->monologue.chars_to_print = state->monologue.paragraph_length;
+    } else if (state->monologue.step == AZ_MLS_WAIT &&
+               key_id == AZ_KEY_RETURN) {
+      assert(state->sync_vm.script != NULL);
+      az_resume_script(state, &state->sync_vm);
+    }
+    return;
+  } else if (state->dialogue.step != AZ_DLS_INACTIVE) {
+    if (state->dialogue.step == AZ_DLS_TALK) {
+      state->dialogue.step = AZ_DLS_WAIT;
+      state->dialogue.progress = 0.0;
+      state->dialogue.chars_to_print = state->dialogue.paragraph_length;
+    } else if (state->dialogue.step == AZ_DLS_WAIT &&
+               key_id == AZ_KEY_RETURN) {
+      assert(state->sync_vm.script != NULL);
+      az_resume_script(state, &state->sync_vm);
+    }
+    return;
+  } else if (state->mode == AZ_MODE_UPGRADE && !az_is_number_key(key_id)) {
+    if (state->upgrade_mode.step == AZ_UGS_MESSAGE) {
+      state->upgrade_mode.step = AZ_UGS_CLOSE;
+      state->upgrade_mode.progress = 0.0;
+    }
+    return;
+  } else if (state->mode == AZ_MODE_GAME_OVER) return;
+  // Handle the keystroke:
+  az_player_t *player = &state->ship.player;
+  az_controls_t *controls = &state->ship.controls;
+  switch (az_control_for_key(prefs, key_id)) {
+    case AZ_CONTROL_CHARGE:
+      az_select_gun(player, AZ_GUN_CHARGE);
+      break;
+    case AZ_CONTROL_FREEZE:
+      az_select_gun(player, AZ_GUN_FREEZE);
+      break;
+    case AZ_CONTROL_TRIPLE:
+      az_select_gun(player, AZ_GUN_TRIPLE);
+      break;
+    case AZ_CONTROL_HOMING:
+      az_select_gun(player, AZ_GUN_HOMING);
+      break;
+    case AZ_CONTROL_PHASE:
+      az_select_gun(player, AZ_GUN_PHASE);
+      break;
+    case AZ_CONTROL_BURST:
+      az_select_gun(player, AZ_GUN_BURST);
+      break;
+    case AZ_CONTROL_PIERCE:
+      az_select_gun(player, AZ_GUN_PIERCE);
+      break;
+    case AZ_CONTROL_BEAM:
+      az_select_gun(player, AZ_GUN_BEAM);
+      break;
+    case AZ_CONTROL_ROCKETS:
+      az_select_ordnance(player, AZ_ORDN_ROCKETS);
+      break;
+    case AZ_CONTROL_BOMBS:
+      az_select_ordnance(player, AZ_ORDN_BOMBS);
+      break;
+    case AZ_CONTROL_PAUSE:
+      if (state->mode == AZ_MODE_NORMAL &&
+          state->cutscene.scene == AZ_SCENE_NOTHING &&
+          !state->ship.autopilot.enabled) {
+        state->mode = AZ_MODE_PAUSING;
+        state->pausing_mode = (az_pausing_mode_data_t){
+          .step = AZ_PSS_FADE_OUT, .fade_alpha = 0.0
+        };
+      }
+      break;
+    case AZ_CONTROL_UP:
+      controls->up_pressed = true;
+      break;
+    case AZ_CONTROL_DOWN:
+      controls->down_pressed = true;
+      break;
+    case AZ_CONTROL_FIRE:
+      controls->fire_pressed = true;
+      break;
+    case AZ_CONTROL_UTIL:
+      controls->util_pressed = true;
+      break;
+    default: break;
   }
 }
 
@@ -21,7 +21,13 @@
 #ifndef AZIMUTH_TICK_SPACE_H_
 #define AZIMUTH_TICK_SPACE_H_
 
+#include <stdbool.h>
+
+#include "azimuth/state/planet.h"
+#include "azimuth/state/save.h"
 #include "azimuth/state/space.h"
+#include "azimuth/util/key.h"
+#include "azimuth/util/prefs.h"
 
 /*===========================================================================*/
 
@@ -33,6 +39,25 @@ void az_after_entering_room(az_space_state_t *state);
 
 void az_tick_space_state(az_space_state_t *state, double time);
 
+// Reset the state to the beginning of a playthrough: either resuming the given
+// saved game (at its save point) or, if it isn't present, starting a new game
+// with the planet's intro script.
+void az_begin_saved_game(az_space_state_t *state, const az_planet_t *planet,
+                         const az_preferences_t *prefs,
+                         const az_saved_game_t *saved_game,
+                         int saved_game_index);
+
+// Call this once the new-game intro script has finished, to start the ship in
+// the planet's first room.
+void az_finish_space_intro(az_space_state_t *state);
+
+// Show the player a message saying whether saving the game succeeded.
+void az_show_save_result(az_space_state_t *state, bool success);
+
+// Respond to the player pressing a key during space mode (e.g. advancing
+// dialogue, switching weapons, or pausing).
+void az_space_key_down(az_space_state_t *state, az_key_id_t key_id);
+
 /*===========================================================================*/
 
 #endif // AZIMUTH_TICK_SPACE_H_
@@ -26,6 +26,14 @@
 
 #include "azimuth/util/vector.h"
 
+// With GCC or Clang on x86, the *_soa functions can use SSE2 (which every
+// x86-64 CPU has) and, if cpuid says the CPU supports it, AVX2.
+#if defined(__GNUC__) && defined(__SSE2__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define POLYGON_X86_SIMD
+#include <immintrin.h>
+#endif
+
 /*===========================================================================*/
 
 static bool solve_quadratic(double a, double b, double c,
@@ -50,6 +58,29 @@ static bool circle_touches_line_segment_internal(
 
 /*===========================================================================*/
 
+// Determine if the edge from vi to vj crosses the ray cast from the point in
+// the +X direction.
+static bool edge_crosses_x_ray(az_vector_t vi, az_vector_t vj,
+                               az_vector_t point) {
+  // Common case: if the edge is completely above or below the ray, then
+  // skip it.
+  if ((vi.y > point.y && vj.y > point.y) ||
+      (vi.y <= point.y && vj.y <= point.y)) {
+    return false;
+  }
+  // Okay, the edge straddles the X-axis passing through the point.  But if
+  // both vertices are to the left of the point, then we can skip this edge.
+  if (vi.x < point.x && vj.x < point.x) return false;
+  // Conversely, if both vertices are to the right of the point, then we
+  // definitely hit the edge.
+  if (vi.x > point.x && vj.x > point.x) return true;
+  // Otherwise, we can't easily be sure.  Compute the intersection of the
+  // edge with the X-axis passing through the point.  If the X-coordinate of
+  // the intersection is to the right of the point, then this is an
+  // edge-crossing.
+  return (point.x <= vi.x + (point.y - vi.y) * (vj.x - vi.x) / (vj.y - vi.y));
+}
+
 bool az_polygon_contains(az_polygon_t polygon, az_vector_t point) {
   const az_vector_t *vertices = polygon.vertices;
   // We're going to do a simple ray-casting test, where we imagine casting a
@@ -61,32 +92,7 @@ bool az_polygon_contains(az_polygon_t polygon, az_vector_t point) {
   // of the "primary" vertex, and j is the index of the vertex that comes just
   // after it in the list (wrapping around at the end).
   for (int i = polygon.num_vertices - 1, j = 0; i >= 0; j = i--) {
-    // Common case: if the edge is completely above or below the ray, then
-    // skip it.
-    if ((vertices[i].y > point.y && vertices[j].y > point.y) ||
-        (vertices[i].y <= point.y && vertices[j].y <= point.y)) {
-      continue;
-    }
-    // Okay, the edge straddles the X-axis passing through the point.  But if
-    // both vertices are to the left of the point, then we can skip this edge.
-    if (vertices[i].x < point.x && vertices[j].x < point.x) {
-      continue;
-    }
-    // Conversely, if both vertices are to the right of the point, then we
-    // definitely hit the edge.
-    if (vertices[i].x > point.x && vertices[j].x > point.x) {
-      inside = !inside;
-      continue;
-    }
-    // Otherwise, we can't easily be sure.  Compute the intersection of the
-    // edge with the X-axis passing through the point.  If the X-coordinate of
-    // the intersection is to the right of the point, then this is an
-    // edge-crossing.
-    if (point.x <= vertices[i].x + (point.y - vertices[i].y) *
-        (vertices[j].x - vertices[i].x) / (vertices[j].y - vertices[i].y)) {
-      inside = !inside;
-      continue;
-    }
+    if (edge_crosses_x_ray(vertices[i], vertices[j], point)) inside = !inside;
   }
   return inside;
 }
@@ -248,6 +254,9 @@ bool az_ray_hits_polygon(
     if (normal_out != NULL) *normal_out = start;
     return true;
   }
+  // If the caller only wants to know whether there's a hit, the first one
+  // that we find will do.
+  const bool any_hit = (point_out == NULL && normal_out == NULL);
   bool hit = false;
   az_vector_t pos;
   // Check if the ray hits any edges of the polygon.
@@ -255,6 +264,7 @@ bool az_ray_hits_polygon(
     if (az_ray_hits_line_segment(
             polygon.vertices[i], polygon.vertices[j], start, delta,
             &pos, normal_out)) {
+      if (any_hit) return true;
       hit = true;
       delta = az_vsub(pos, start);
     }
@@ -408,12 +418,16 @@ bool az_circle_hits_polygon(
     if (normal_out != NULL) *normal_out = start;
     return true;
   }
+  // If the caller only wants to know whether there's a hit, the first one
+  // that we find will do.
+  const bool any_hit = (pos_out == NULL && normal_out == NULL);
   bool hit = false;
   az_vector_t pos;
   // Check if the circle hits any corners of the polygon.
   for (int i = 0; i < polygon.num_vertices; ++i) {
     if (az_circle_hits_point(polygon.vertices[i], radius, start, delta,
                              &pos, normal_out)) {
+      if (any_hit) return true;
       hit = true;
       delta = az_vsub(pos, start);
     }
@@ -423,6 +437,7 @@ bool az_circle_hits_polygon(
     if (circle_hits_line_segment_internal(
             polygon.vertices[i], polygon.vertices[j], radius, start, delta,
             &pos, normal_out)) {
+      if (any_hit) return true;
       hit = true;
       delta = az_vsub(pos, start);
     }
@@ -467,6 +482,82 @@ bool az_arc_ray_might_hit_bounding_circle(
                                 spin_center, spin_angle, NULL, NULL, NULL);
 }
 
+// Determine if the direction of rel (relative to the spin center) lies within
+// the angular range of the sweep's arc.
+static bool arc_sweep_covers_direction(const az_arc_sweep_t *sweep,
+                                       az_vector_t rel) {
+  if (sweep->abs_spin_angle >= AZ_TWO_PI) return true;
+  const bool after_first = (az_vcross(sweep->rel_first, rel) >= 0.0);
+  const bool before_last = (az_vcross(rel, sweep->rel_last) >= 0.0);
+  // An arc of at most a half turn is the intersection of two half-planes;
+  // a longer one is their union.
+  if (sweep->abs_spin_angle <= AZ_PI) return (after_first && before_last);
+  else return (after_first || before_last);
+}
+
+void az_init_arc_sweep(
+    double circle_radius, az_vector_t start, az_vector_t spin_center,
+    double spin_angle, az_arc_sweep_t *sweep_out) {
+  assert(circle_radius >= 0.0);
+  const az_vector_t rel_start = az_vsub(start, spin_center);
+  const az_vector_t rel_end = az_vrotate(rel_start, spin_angle);
+  sweep_out->spin_center = spin_center;
+  sweep_out->spin_radius = az_vnorm(rel_start);
+  sweep_out->circle_radius = circle_radius;
+  sweep_out->abs_spin_angle = fabs(spin_angle);
+  sweep_out->rel_first = (spin_angle >= 0.0 ? rel_start : rel_end);
+  sweep_out->rel_last = (spin_angle >= 0.0 ? rel_end : rel_start);
+  // The arc's bounding box is determined by its ends, together with the
+  // points where it crosses the axes.
+  az_vector_t min = {fmin(rel_start.x, rel_end.x),
+                     fmin(rel_start.y, rel_end.y)};
+  az_vector_t max = {fmax(rel_start.x, rel_end.x),
+                     fmax(rel_start.y, rel_end.y)};
+  const double spin_radius = sweep_out->spin_radius;
+  if (arc_sweep_covers_direction(sweep_out, (az_vector_t){1, 0})) {
+    max.x = spin_radius;
+  }
+  if (arc_sweep_covers_direction(sweep_out, (az_vector_t){0, 1})) {
+    max.y = spin_radius;
+  }
+  if (arc_sweep_covers_direction(sweep_out, (az_vector_t){-1, 0})) {
+    min.x = -spin_radius;
+  }
+  if (arc_sweep_covers_direction(sweep_out, (az_vector_t){0, -1})) {
+    min.y = -spin_radius;
+  }
+  sweep_out->min = az_vsub(az_vadd(spin_center, min),
+                           (az_vector_t){circle_radius, circle_radius});
+  sweep_out->max = az_vadd(az_vadd(spin_center, max),
+                           (az_vector_t){circle_radius, circle_radius});
+}
+
+// How much slack to allow in az_arc_sweep_might_hit_circle, so that rounding
+// error can never make it reject a circle that the exact functions would
+// count as hit.
+#define ARC_SWEEP_MARGIN 0.001
+
+bool az_arc_sweep_might_hit_circle(const az_arc_sweep_t *sweep,
+                                   az_vector_t center, double radius) {
+  assert(radius >= 0.0);
+  const double reach = sweep->circle_radius + radius + ARC_SWEEP_MARGIN;
+  // Rule out circles far from the sweep's bounding box.
+  const double slack = radius + ARC_SWEEP_MARGIN;
+  if (center.x + slack < sweep->min.x || center.x - slack > sweep->max.x ||
+      center.y + slack < sweep->min.y || center.y - slack > sweep->max.y) {
+    return false;
+  }
+  // If the circle lies in a direction that the arc covers, the nearest point
+  // of the arc to its center is straight out (or in) from the spin center;
+  // otherwise, it's one of the arc's ends.
+  const az_vector_t rel = az_vsub(center, sweep->spin_center);
+  if (arc_sweep_covers_direction(sweep, rel)) {
+    return (fabs(az_vnorm(rel) - sweep->spin_radius) <= reach);
+  }
+  return (az_vwithin(rel, sweep->rel_first, reach) ||
+          az_vwithin(rel, sweep->rel_last, reach));
+}
+
 bool az_arc_ray_hits_circle(
     double circle_radius, az_vector_t circle_center,
     az_vector_t start, az_vector_t spin_center, double spin_angle,
@@ -842,6 +933,728 @@ bool az_arc_circle_hits_polygon_trans(
 
 /*===========================================================================*/
 
+static az_vector_t soa_vertex(az_polygon_soa_t polygon, int i) {
+  return (az_vector_t){polygon.xs[i], polygon.ys[i]};
+}
+
+// The SIMD kernels below each look at several consecutive edges (or
+// vertices) of a polygon, starting at index first, and return a bitmask with
+// bit k set if the scalar code might report a hit (or, for crossing masks, an
+// edge-crossing) for edge first + k.  They repeat the scalar code's arithmetic
+// operation for operation, so that a zero bit means the scalar code would
+// definitely say no; the loops further down then run the scalar code itself
+// on any group of edges that isn't entirely zero, which keeps the results
+// bit-for-bit identical to the scalar functions.
+typedef int (*crossing_mask_fn_t)(const double *xs, const double *ys,
+                                  int first, az_vector_t point);
+typedef int (*ray_mask_fn_t)(const double *xs, const double *ys, int first,
+                             az_vector_t start, az_vector_t delta);
+typedef int (*circle_mask_fn_t)(const double *xs, const double *ys,
+                                int first, double radius, az_vector_t start,
+                                az_vector_t delta);
+
+typedef struct {
+  int width; // how many edges each kernel looks at
+  crossing_mask_fn_t crossings; // mirrors edge_crosses_x_ray
+  ray_mask_fn_t ray_edges; // mirrors az_ray_hits_line_segment
+  circle_mask_fn_t circle_vertices; // mirrors az_circle_hits_point
+  circle_mask_fn_t circle_edges; // mirrors circle_hits_line_segment_internal
+} soa_kernels_t;
+
+#ifdef POLYGON_X86_SIMD
+
+static int crossing_mask_sse2(const double *xs, const double *ys, int first,
+                              az_vector_t point) {
+  const __m128d ax = _mm_loadu_pd(xs + first), ay = _mm_loadu_pd(ys + first);
+  const __m128d bx = _mm_loadu_pd(xs + first + 1);
+  const __m128d by = _mm_loadu_pd(ys + first + 1);
+  const __m128d px = _mm_set1_pd(point.x), py = _mm_set1_pd(point.y);
+  const __m128d above = _mm_and_pd(_mm_cmpgt_pd(ay, py), _mm_cmpgt_pd(by, py));
+  const __m128d below = _mm_and_pd(_mm_cmple_pd(ay, py), _mm_cmple_pd(by, py));
+  const __m128d left = _mm_and_pd(_mm_cmplt_pd(ax, px), _mm_cmplt_pd(bx, px));
+  const __m128d right = _mm_and_pd(_mm_cmpgt_pd(ax, px), _mm_cmpgt_pd(bx, px));
+  const __m128d cross_x = _mm_add_pd(ax, _mm_div_pd(
+      _mm_mul_pd(_mm_sub_pd(py, ay), _mm_sub_pd(bx, ax)),
+      _mm_sub_pd(by, ay)));
+  const __m128d skip = _mm_or_pd(_mm_or_pd(above, below), left);
+  const __m128d hit = _mm_or_pd(right, _mm_cmple_pd(px, cross_x));
+  return _mm_movemask_pd(_mm_andnot_pd(skip, hit));
+}
+
+static int ray_mask_sse2(const double *xs, const double *ys, int first,
+                         az_vector_t start, az_vector_t delta) {
+  const __m128d x1 = _mm_loadu_pd(xs + first), y1 = _mm_loadu_pd(ys + first);
+  const __m128d x2 = _mm_loadu_pd(xs + first + 1);
+  const __m128d y2 = _mm_loadu_pd(ys + first + 1);
+  const __m128d dx = _mm_set1_pd(delta.x), dy = _mm_set1_pd(delta.y);
+  const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1.0);
+  const __m128d ex = _mm_sub_pd(x2, x1), ey = _mm_sub_pd(y2, y1);
+  const __m128d denom = _mm_sub_pd(_mm_mul_pd(dx, ey), _mm_mul_pd(dy, ex));
+  const __m128d rx = _mm_sub_pd(x1, _mm_set1_pd(start.x));
+  const __m128d ry = _mm_sub_pd(y1, _mm_set1_pd(start.y));
+  const __m128d u = _mm_div_pd(
+      _mm_sub_pd(_mm_mul_pd(rx, dy), _mm_mul_pd(ry, dx)), denom);
+  const __m128d t = _mm_div_pd(
+      _mm_sub_pd(_mm_mul_pd(rx, ey), _mm_mul_pd(ry, ex)), denom);
+  const __m128d miss = _mm_or_pd(
+      _mm_or_pd(_mm_cmpeq_pd(denom, zero),
+                _mm_or_pd(_mm_cmplt_pd(u, zero), _mm_cmpge_pd(u, one))),
+      _mm_or_pd(_mm_cmplt_pd(t, zero), _mm_cmpgt_pd(t, one)));
+  return ~_mm_movemask_pd(miss) & 0x3;
+}
+
+static int circle_vertex_mask_sse2(
+    const double *xs, const double *ys, int first, double radius,
+    az_vector_t start, az_vector_t delta) {
+  const __m128d rx = _mm_sub_pd(_mm_set1_pd(start.x),
+                                _mm_loadu_pd(xs + first));
+  const __m128d ry = _mm_sub_pd(_mm_set1_pd(start.y),
+                                _mm_loadu_pd(ys + first));
+  const __m128d dx = _mm_set1_pd(delta.x), dy = _mm_set1_pd(delta.y);
+  const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1.0);
+  const __m128d sq_radius = _mm_set1_pd(radius * radius);
+  const __m128d sq_dist = _mm_add_pd(_mm_mul_pd(rx, rx), _mm_mul_pd(ry, ry));
+  const __m128d within = _mm_cmple_pd(sq_dist, sq_radius);
+  // Same quadratic as in ray_hits_hollow_circle and solve_quadratic:
+  const __m128d a = _mm_set1_pd(delta.x * delta.x + delta.y * delta.y);
+  const __m128d b = _mm_mul_pd(_mm_set1_pd(2.0), _mm_add_pd(
+      _mm_mul_pd(rx, dx), _mm_mul_pd(ry, dy)));
+  const __m128d c = _mm_sub_pd(sq_dist, sq_radius);
+  const __m128d root = _mm_sqrt_pd(_mm_sub_pd(
+      _mm_mul_pd(b, b), _mm_mul_pd(_mm_mul_pd(_mm_set1_pd(4.0), a), c)));
+  const __m128d inv = _mm_div_pd(_mm_set1_pd(0.5), a);
+  const __m128d t1 = _mm_mul_pd(_mm_sub_pd(root, b), inv);
+  const __m128d t2 = _mm_mul_pd(
+      _mm_sub_pd(_mm_xor_pd(root, _mm_set1_pd(-0.0)), b), inv);
+  const __m128d use_t1 = _mm_and_pd(_mm_cmple_pd(zero, t1), _mm_or_pd(
+      _mm_cmple_pd(t1, t2), _mm_cmplt_pd(t2, zero)));
+  const __m128d t = _mm_or_pd(_mm_and_pd(use_t1, t1),
+                              _mm_andnot_pd(use_t1, t2));
+  const __m128d hit = _mm_and_pd(_mm_cmple_pd(zero, t), _mm_cmple_pd(t, one));
+  return _mm_movemask_pd(_mm_or_pd(within, hit));
+}
+
+static int circle_edge_mask_sse2(
+    const double *xs, const double *ys, int first, double radius,
+    az_vector_t start, az_vector_t delta) {
+  const __m128d x1 = _mm_loadu_pd(xs + first), y1 = _mm_loadu_pd(ys + first);
+  const __m128d x2 = _mm_loadu_pd(xs + first + 1);
+  const __m128d y2 = _mm_loadu_pd(ys + first + 1);
+  const __m128d zero = _mm_setzero_pd();
+  // Same as the to_line vector in az_circle_hits_line:
+  const __m128d rx = _mm_sub_pd(x1, _mm_set1_pd(start.x));
+  const __m128d ry = _mm_sub_pd(y1, _mm_set1_pd(start.y));
+  const __m128d ex = _mm_sub_pd(x1, x2), ey = _mm_sub_pd(y1, y2);
+  const __m128d sq_len = _mm_add_pd(_mm_mul_pd(ex, ex), _mm_mul_pd(ey, ey));
+  const __m128d k = _mm_div_pd(
+      _mm_add_pd(_mm_mul_pd(rx, ex), _mm_mul_pd(ry, ey)), sq_len);
+  const __m128d to_x = _mm_sub_pd(rx, _mm_mul_pd(ex, k));
+  const __m128d to_y = _mm_sub_pd(ry, _mm_mul_pd(ey, k));
+  const __m128d touching = _mm_cmple_pd(
+      _mm_add_pd(_mm_mul_pd(to_x, to_x), _mm_mul_pd(to_y, to_y)),
+      _mm_set1_pd(radius * radius));
+  const __m128d receding = _mm_cmple_pd(_mm_add_pd(
+      _mm_mul_pd(to_x, _mm_set1_pd(delta.x)),
+      _mm_mul_pd(to_y, _mm_set1_pd(delta.y))), zero);
+  // For a zero-length edge, az_vproj gives a zero vector rather than NaNs;
+  // rather than mirror that, just let the scalar code handle it.
+  const __m128d degenerate = _mm_cmpeq_pd(sq_len, zero);
+  return (_mm_movemask_pd(_mm_or_pd(degenerate, touching)) |
+          (~_mm_movemask_pd(receding) & 0x3));
+}
+
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+TARGET_AVX2 static int crossing_mask_avx2(
+    const double *xs, const double *ys, int first, az_vector_t point) {
+  const __m256d ax = _mm256_loadu_pd(xs + first);
+  const __m256d ay = _mm256_loadu_pd(ys + first);
+  const __m256d bx = _mm256_loadu_pd(xs + first + 1);
+  const __m256d by = _mm256_loadu_pd(ys + first + 1);
+  const __m256d px = _mm256_set1_pd(point.x), py = _mm256_set1_pd(point.y);
+  const __m256d above = _mm256_and_pd(_mm256_cmp_pd(ay, py, _CMP_GT_OQ),
+                                      _mm256_cmp_pd(by, py, _CMP_GT_OQ));
+  const __m256d below = _mm256_and_pd(_mm256_cmp_pd(ay, py, _CMP_LE_OQ),
+                                      _mm256_cmp_pd(by, py, _CMP_LE_OQ));
+  const __m256d left = _mm256_and_pd(_mm256_cmp_pd(ax, px, _CMP_LT_OQ),
+                                     _mm256_cmp_pd(bx, px, _CMP_LT_OQ));
+  const __m256d right = _mm256_and_pd(_mm256_cmp_pd(ax, px, _CMP_GT_OQ),
+                                      _mm256_cmp_pd(bx, px, _CMP_GT_OQ));
+  const __m256d cross_x = _mm256_add_pd(ax, _mm256_div_pd(
+      _mm256_mul_pd(_mm256_sub_pd(py, ay), _mm256_sub_pd(bx, ax)),
+      _mm256_sub_pd(by, ay)));
+  const __m256d skip = _mm256_or_pd(_mm256_or_pd(above, below), left);
+  const __m256d hit =
+    _mm256_or_pd(right, _mm256_cmp_pd(px, cross_x, _CMP_LE_OQ));
+  return _mm256_movemask_pd(_mm256_andnot_pd(skip, hit));
+}
+
+TARGET_AVX2 static int ray_mask_avx2(
+    const double *xs, const double *ys, int first,
+    az_vector_t start, az_vector_t delta) {
+  const __m256d x1 = _mm256_loadu_pd(xs + first);
+  const __m256d y1 = _mm256_loadu_pd(ys + first);
+  const __m256d x2 = _mm256_loadu_pd(xs + first + 1);
+  const __m256d y2 = _mm256_loadu_pd(ys + first + 1);
+  const __m256d dx = _mm256_set1_pd(delta.x), dy = _mm256_set1_pd(delta.y);
+  const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0);
+  const __m256d ex = _mm256_sub_pd(x2, x1), ey = _mm256_sub_pd(y2, y1);
+  const __m256d denom =
+    _mm256_sub_pd(_mm256_mul_pd(dx, ey), _mm256_mul_pd(dy, ex));
+  const __m256d rx = _mm256_sub_pd(x1, _mm256_set1_pd(start.x));
+  const __m256d ry = _mm256_sub_pd(y1, _mm256_set1_pd(start.y));
+  const __m256d u = _mm256_div_pd(
+      _mm256_sub_pd(_mm256_mul_pd(rx, dy), _mm256_mul_pd(ry, dx)), denom);
+  const __m256d t = _mm256_div_pd(
+      _mm256_sub_pd(_mm256_mul_pd(rx, ey), _mm256_mul_pd(ry, ex)), denom);
+  const __m256d miss = _mm256_or_pd(
+      _mm256_or_pd(_mm256_cmp_pd(denom, zero, _CMP_EQ_OQ),
+                   _mm256_or_pd(_mm256_cmp_pd(u, zero, _CMP_LT_OQ),
+                                _mm256_cmp_pd(u, one, _CMP_GE_OQ))),
+      _mm256_or_pd(_mm256_cmp_pd(t, zero, _CMP_LT_OQ),
+                   _mm256_cmp_pd(t, one, _CMP_GT_OQ)));
+  return ~_mm256_movemask_pd(miss) & 0xf;
+}
+
+TARGET_AVX2 static int circle_vertex_mask_avx2(
+    const double *xs, const double *ys, int first, double radius,
+    az_vector_t start, az_vector_t delta) {
+  const __m256d rx = _mm256_sub_pd(_mm256_set1_pd(start.x),
+                                   _mm256_loadu_pd(xs + first));
+  const __m256d ry = _mm256_sub_pd(_mm256_set1_pd(start.y),
+                                   _mm256_loadu_pd(ys + first));
+  const __m256d dx = _mm256_set1_pd(delta.x), dy = _mm256_set1_pd(delta.y);
+  const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0);
+  const __m256d sq_radius = _mm256_set1_pd(radius * radius);
+  const __m256d sq_dist =
+    _mm256_add_pd(_mm256_mul_pd(rx, rx), _mm256_mul_pd(ry, ry));
+  const __m256d within = _mm256_cmp_pd(sq_dist, sq_radius, _CMP_LE_OQ);
+  // Same quadratic as in ray_hits_hollow_circle and solve_quadratic:
+  const __m256d a = _mm256_set1_pd(delta.x * delta.x + delta.y * delta.y);
+  const __m256d b = _mm256_mul_pd(_mm256_set1_pd(2.0), _mm256_add_pd(
+      _mm256_mul_pd(rx, dx), _mm256_mul_pd(ry, dy)));
+  const __m256d c = _mm256_sub_pd(sq_dist, sq_radius);
+  const __m256d root = _mm256_sqrt_pd(_mm256_sub_pd(
+      _mm256_mul_pd(b, b),
+      _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(4.0), a), c)));
+  const __m256d inv = _mm256_div_pd(_mm256_set1_pd(0.5), a);
+  const __m256d t1 = _mm256_mul_pd(_mm256_sub_pd(root, b), inv);
+  const __m256d t2 = _mm256_mul_pd(
+      _mm256_sub_pd(_mm256_xor_pd(root, _mm256_set1_pd(-0.0)), b), inv);
+  const __m256d use_t1 = _mm256_and_pd(
+      _mm256_cmp_pd(zero, t1, _CMP_LE_OQ),
+      _mm256_or_pd(_mm256_cmp_pd(t1, t2, _CMP_LE_OQ),
+                   _mm256_cmp_pd(t2, zero, _CMP_LT_OQ)));
+  const __m256d t = _mm256_blendv_pd(t2, t1, use_t1);
+  const __m256d hit = _mm256_and_pd(_mm256_cmp_pd(zero, t, _CMP_LE_OQ),
+                                    _mm256_cmp_pd(t, one, _CMP_LE_OQ));
+  return _mm256_movemask_pd(_mm256_or_pd(within, hit));
+}
+
+TARGET_AVX2 static int circle_edge_mask_avx2(
+    const double *xs, const double *ys, int first, double radius,
+    az_vector_t start, az_vector_t delta) {
+  const __m256d x1 = _mm256_loadu_pd(xs + first);
+  const __m256d y1 = _mm256_loadu_pd(ys + first);
+  const __m256d x2 = _mm256_loadu_pd(xs + first + 1);
+  const __m256d y2 = _mm256_loadu_pd(ys + first + 1);
+  const __m256d zero = _mm256_setzero_pd();
+  // Same as the to_line vector in az_circle_hits_line:
+  const __m256d rx = _mm256_sub_pd(x1, _mm256_set1_pd(start.x));
+  const __m256d ry = _mm256_sub_pd(y1, _mm256_set1_pd(start.y));
+  const __m256d ex = _mm256_sub_pd(x1, x2), ey = _mm256_sub_pd(y1, y2);
+  const __m256d sq_len =
+    _mm256_add_pd(_mm256_mul_pd(ex, ex), _mm256_mul_pd(ey, ey));
+  const __m256d k = _mm256_div_pd(
+      _mm256_add_pd(_mm256_mul_pd(rx, ex), _mm256_mul_pd(ry, ey)), sq_len);
+  const __m256d to_x = _mm256_sub_pd(rx, _mm256_mul_pd(ex, k));
+  const __m256d to_y = _mm256_sub_pd(ry, _mm256_mul_pd(ey, k));
+  const __m256d touching = _mm256_cmp_pd(
+      _mm256_add_pd(_mm256_mul_pd(to_x, to_x), _mm256_mul_pd(to_y, to_y)),
+      _mm256_set1_pd(radius * radius), _CMP_LE_OQ);
+  const __m256d receding = _mm256_cmp_pd(_mm256_add_pd(
+      _mm256_mul_pd(to_x, _mm256_set1_pd(delta.x)),
+      _mm256_mul_pd(to_y, _mm256_set1_pd(delta.y))), zero, _CMP_LE_OQ);
+  const __m256d degenerate = _mm256_cmp_pd(sq_len, zero, _CMP_EQ_OQ);
+  return (_mm256_movemask_pd(_mm256_or_pd(degenerate, touching)) |
+          (~_mm256_movemask_pd(receding) & 0xf));
+}
+
+#undef TARGET_AVX2
+
+#endif // POLYGON_X86_SIMD
+
+static const soa_kernels_t soa_kernels[] = {
+  [AZ_POLYGON_SCALAR] = { .width = 1 },
+#ifdef POLYGON_X86_SIMD
+  [AZ_POLYGON_SSE2] = {
+    .width = 2, .crossings = crossing_mask_sse2, .ray_edges = ray_mask_sse2,
+    .circle_vertices = circle_vertex_mask_sse2,
+    .circle_edges = circle_edge_mask_sse2
+  },
+  [AZ_POLYGON_AVX2] = {
+    .width = 4, .crossings = crossing_mask_avx2, .ray_edges = ray_mask_avx2,
+    .circle_vertices = circle_vertex_mask_avx2,
+    .circle_edges = circle_edge_mask_avx2
+  },
+#endif
+};
+
+static bool polygon_impl_chosen = false;
+static az_polygon_impl_t polygon_impl;
+
+static bool polygon_impl_supported(az_polygon_impl_t impl) {
+  switch (impl) {
+    case AZ_POLYGON_SCALAR: return true;
+#ifdef POLYGON_X86_SIMD
+    case AZ_POLYGON_SSE2: return true;
+    case AZ_POLYGON_AVX2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+#else
+    case AZ_POLYGON_SSE2:
+    case AZ_POLYGON_AVX2:
+      return false;
+#endif
+  }
+  return false;
+}
+
+az_polygon_impl_t az_get_polygon_impl(void) {
+  if (!polygon_impl_chosen) {
+    polygon_impl = (polygon_impl_supported(AZ_POLYGON_AVX2) ? AZ_POLYGON_AVX2 :
+                    polygon_impl_supported(AZ_POLYGON_SSE2) ? AZ_POLYGON_SSE2 :
+                    AZ_POLYGON_SCALAR);
+    polygon_impl_chosen = true;
+  }
+  return polygon_impl;
+}
+
+bool az_set_polygon_impl(az_polygon_impl_t impl) {
+  if (!polygon_impl_supported(impl)) return false;
+  polygon_impl = impl;
+  polygon_impl_chosen = true;
+  return true;
+}
+
+bool az_polygon_contains_soa(az_polygon_soa_t polygon, az_vector_t point) {
+  const soa_kernels_t *kernels = &soa_kernels[az_get_polygon_impl()];
+  bool inside = false;
+  int i = 0;
+  // The order of the edges doesn't matter here, so we can just count
+  // crossings a group at a time, and then finish off any leftover edges.
+  if (kernels->crossings != NULL) {
+    for (; i + kernels->width <= polygon.num_vertices; i += kernels->width) {
+      for (int mask = kernels->crossings(polygon.xs, polygon.ys, i, point);
+           mask != 0; mask &= mask - 1) {
+        inside = !inside;
+      }
+    }
+  }
+  for (; i < polygon.num_vertices; ++i) {
+    if (edge_crosses_x_ray(soa_vertex(polygon, i), soa_vertex(polygon, i + 1),
+                           point)) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+// A bitset standing for every edge of a polygon (even one with more than 64
+// edges), for the functions below.
+#define ALL_EDGES UINT64_MAX
+
+// Determine if the given edge (or vertex) is in the bitset.
+static bool has_edge(uint64_t edges, int index) {
+  return (edges == ALL_EDGES || ((edges >> index) & 1));
+}
+
+// Determine if any of the count edges (or vertices) starting at first are in
+// the bitset.
+static bool has_any_edge(uint64_t edges, int first, int count) {
+  return (edges == ALL_EDGES ||
+          (edges & (((UINT64_C(1) << count) - 1) << first)) != 0);
+}
+
+static bool ray_hits_polygon_soa_internal(
+    az_polygon_soa_t polygon, uint64_t edges,
+    az_vector_t start, az_vector_t delta,
+    az_vector_t *point_out, az_vector_t *normal_out) {
+  // This is az_ray_hits_polygon, step for step; see the comment above
+  // soa_kernels_t.
+  if (az_polygon_contains_soa(polygon, start)) {
+    if (point_out != NULL) *point_out = start;
+    if (normal_out != NULL) *normal_out = start;
+    return true;
+  }
+  const soa_kernels_t *kernels = &soa_kernels[az_get_polygon_impl()];
+  const bool any_hit = (point_out == NULL && normal_out == NULL);
+  bool hit = false;
+  az_vector_t pos;
+  // Edges must be tested in the same order (last to first) as in
+  // az_ray_hits_polygon, since each hit shortens the ray.
+  for (int last = polygon.num_vertices - 1; last >= 0;) {
+    int first = last;
+    if (kernels->ray_edges != NULL && last + 1 >= kernels->width) {
+      first = last + 1 - kernels->width;
+      if (!has_any_edge(edges, first, kernels->width) ||
+          !kernels->ray_edges(polygon.xs, polygon.ys, first, start, delta)) {
+        last = first - 1;
+        continue;
+      }
+    }
+    for (; last >= first; --last) {
+      if (!has_edge(edges, last)) continue;
+      if (az_ray_hits_line_segment(
+              soa_vertex(polygon, last), soa_vertex(polygon, last + 1),
+              start, delta, &pos, normal_out)) {
+        if (any_hit) return true;
+        hit = true;
+        delta = az_vsub(pos, start);
+      }
+    }
+  }
+  if (hit && point_out != NULL) {
+    *point_out = pos;
+  }
+  return hit;
+}
+
+static bool circle_hits_polygon_soa_internal(
+    az_polygon_soa_t polygon, uint64_t edges,
+    double radius, az_vector_t start, az_vector_t delta,
+    az_vector_t *pos_out, az_vector_t *normal_out) {
+  // This is az_circle_hits_polygon, step for step; see the comment above
+  // soa_kernels_t.
+  if (az_polygon_contains_soa(polygon, start)) {
+    if (pos_out != NULL) *pos_out = start;
+    if (normal_out != NULL) *normal_out = start;
+    return true;
+  }
+  const soa_kernels_t *kernels = &soa_kernels[az_get_polygon_impl()];
+  const bool any_hit = (pos_out == NULL && normal_out == NULL);
+  bool hit = false;
+  az_vector_t pos;
+  // Vertex i is the start of edge i and the end of edge i - 1 (or, for vertex
+  // zero, of the last edge).
+  const uint64_t vertices = (edges == ALL_EDGES ? ALL_EDGES :
+                             edges | (edges << 1) |
+                             (edges >> (polygon.num_vertices - 1)));
+  // Check if the circle hits any corners of the polygon (first to last).
+  for (int first = 0; first < polygon.num_vertices;) {
+    int end = first + 1;
+    if (kernels->circle_vertices != NULL &&
+        first + kernels->width <= polygon.num_vertices) {
+      end = first + kernels->width;
+      if (!has_any_edge(vertices, first, kernels->width) ||
+          !kernels->circle_vertices(polygon.xs, polygon.ys, first, radius,
+                                    start, delta)) {
+        first = end;
+        continue;
+      }
+    }
+    for (; first < end; ++first) {
+      if (!has_edge(vertices, first)) continue;
+      if (az_circle_hits_point(soa_vertex(polygon, first), radius, start,
+                               delta, &pos, normal_out)) {
+        if (any_hit) return true;
+        hit = true;
+        delta = az_vsub(pos, start);
+      }
+    }
+  }
+  // Check if the circle hits any edges of the polygon (last to first).
+  for (int last = polygon.num_vertices - 1; last >= 0;) {
+    int first = last;
+    if (kernels->circle_edges != NULL && last + 1 >= kernels->width) {
+      first = last + 1 - kernels->width;
+      if (!has_any_edge(edges, first, kernels->width) ||
+          !kernels->circle_edges(polygon.xs, polygon.ys, first, radius,
+                                 start, delta)) {
+        last = first - 1;
+        continue;
+      }
+    }
+    for (; last >= first; --last) {
+      if (!has_edge(edges, last)) continue;
+      if (circle_hits_line_segment_internal(
+              soa_vertex(polygon, last), soa_vertex(polygon, last + 1),
+              radius, start, delta, &pos, normal_out)) {
+        if (any_hit) return true;
+        hit = true;
+        delta = az_vsub(pos, start);
+      }
+    }
+  }
+  if (hit && pos_out != NULL) {
+    *pos_out = pos;
+  }
+  return hit;
+}
+
+bool az_ray_hits_polygon_soa(
+    az_polygon_soa_t polygon, az_vector_t start, az_vector_t delta,
+    az_vector_t *point_out, az_vector_t *normal_out) {
+  return ray_hits_polygon_soa_internal(polygon, ALL_EDGES, start, delta,
+                                       point_out, normal_out);
+}
+
+bool az_circle_hits_polygon_soa(
+    az_polygon_soa_t polygon, double radius,
+    az_vector_t start, az_vector_t delta,
+    az_vector_t *pos_out, az_vector_t *normal_out) {
+  return circle_hits_polygon_soa_internal(polygon, ALL_EDGES, radius,
+                                          start, delta, pos_out, normal_out);
+}
+
+bool az_ray_hits_polygon_soa_edges(
+    az_polygon_soa_t polygon, uint64_t edges,
+    az_vector_t start, az_vector_t delta,
+    az_vector_t *point_out, az_vector_t *normal_out) {
+  assert(polygon.num_vertices <= 64);
+  return ray_hits_polygon_soa_internal(polygon, edges, start, delta,
+                                       point_out, normal_out);
+}
+
+bool az_circle_hits_polygon_soa_edges(
+    az_polygon_soa_t polygon, uint64_t edges,
+    double radius, az_vector_t start, az_vector_t delta,
+    az_vector_t *pos_out, az_vector_t *normal_out) {
+  assert(polygon.num_vertices <= 64);
+  return circle_hits_polygon_soa_internal(polygon, edges, radius,
+                                          start, delta, pos_out, normal_out);
+}
+
+/*===========================================================================*/
+
+// Determine if the three points make a left turn (or, if allow_straight is
+// true, go straight ahead).
+static bool left_turn(az_vector_t a, az_vector_t b, az_vector_t c,
+                      bool allow_straight) {
+  const double cross = az_vcross(az_vsub(b, a), az_vsub(c, b));
+  return (cross > 0.0 || (allow_straight && cross == 0.0));
+}
+
+// Determine if the point is within (or on the boundary of) the
+// counterclockwise triangle abc.
+static bool triangle_contains(az_vector_t a, az_vector_t b, az_vector_t c,
+                              az_vector_t point) {
+  return (az_vcross(az_vsub(b, a), az_vsub(point, a)) >= 0.0 &&
+          az_vcross(az_vsub(c, b), az_vsub(point, b)) >= 0.0 &&
+          az_vcross(az_vsub(a, c), az_vsub(point, c)) >= 0.0);
+}
+
+// A piece of a polygon during decomposition, as a counterclockwise list of
+// indices into the polygon's vertex array.
+typedef struct {
+  int num_corners;
+  int corners[64];
+} decomp_piece_t;
+
+// Triangulate the polygon (whose vertices, in counterclockwise order, are
+// the num_indices entries of indices) by ear clipping, and store the
+// triangles in pieces.  Returns the number of triangles, or -1 if the polygon
+// has no ear to clip (which can only happen if it's degenerate).
+static int triangulate(az_polygon_t polygon, int *indices, int num_indices,
+                       decomp_piece_t pieces[62]) {
+  const az_vector_t *vertices = polygon.vertices;
+  int num_pieces = 0;
+  while (num_indices > 3) {
+    // Prefer proper ears, but settle for a degenerate (zero-area) ear at a
+    // vertex where the boundary goes straight ahead if there's no other kind.
+    int ear = -1;
+    for (int pass = 0; pass < 2 && ear < 0; ++pass) {
+      for (int i = 0; i < num_indices && ear < 0; ++i) {
+        const int prev = indices[(i + num_indices - 1) % num_indices];
+        const int cur = indices[i];
+        const int next = indices[(i + 1) % num_indices];
+        if (!left_turn(vertices[prev], vertices[cur], vertices[next],
+                       pass == 1)) continue;
+        bool is_ear = true;
+        for (int j = 0; j < num_indices && is_ear; ++j) {
+          const int other = indices[j];
+          if (other == prev || other == cur || other == next) continue;
+          if (triangle_contains(vertices[prev], vertices[cur], vertices[next],
+                                vertices[other])) is_ear = false;
+        }
+        if (is_ear) ear = i;
+      }
+    }
+    if (ear < 0) return -1;
+    decomp_piece_t *piece = &pieces[num_pieces++];
+    piece->num_corners = 3;
+    piece->corners[0] = indices[(ear + num_indices - 1) % num_indices];
+    piece->corners[1] = indices[ear];
+    piece->corners[2] = indices[(ear + 1) % num_indices];
+    for (int i = ear; i + 1 < num_indices; ++i) indices[i] = indices[i + 1];
+    --num_indices;
+  }
+  decomp_piece_t *piece = &pieces[num_pieces++];
+  piece->num_corners = 3;
+  for (int i = 0; i < 3; ++i) piece->corners[i] = indices[i];
+  return num_pieces;
+}
+
+// If pieces p and q share a side, and joining them along it would give a
+// convex piece, store the joined piece in *p and return true.
+static bool try_merge_pieces(az_polygon_t polygon, decomp_piece_t *p,
+                             const decomp_piece_t *q) {
+  const az_vector_t *vertices = polygon.vertices;
+  for (int i = 0; i < p->num_corners; ++i) {
+    const int a = p->corners[i];
+    const int b = p->corners[(i + 1) % p->num_corners];
+    // Since both pieces are counterclockwise, q must have the side b -> a.
+    int j = 0;
+    while (j < q->num_corners &&
+           !(q->corners[j] == b &&
+             q->corners[(j + 1) % q->num_corners] == a)) ++j;
+    if (j == q->num_corners) continue;
+    // The joined piece goes around p from b to a, then around q from just
+    // after a to just before b.
+    decomp_piece_t merged = {.num_corners = 0};
+    for (int k = 0; k < p->num_corners; ++k) {
+      merged.corners[merged.num_corners++] =
+        p->corners[(i + 1 + k) % p->num_corners];
+    }
+    for (int k = 2; k < q->num_corners; ++k) {
+      merged.corners[merged.num_corners++] =
+        q->corners[(j + k) % q->num_corners];
+    }
+    for (int k = 0; k < merged.num_corners; ++k) {
+      if (!left_turn(vertices[merged.corners[k]],
+                     vertices[merged.corners[(k + 1) % merged.num_corners]],
+                     vertices[merged.corners[(k + 2) % merged.num_corners]],
+                     true)) return false;
+    }
+    *p = merged;
+    return true;
+  }
+  return false;
+}
+
+bool az_decompose_polygon(az_polygon_t polygon,
+                          az_convex_decomp_t *decomp_out) {
+  const int num_vertices = polygon.num_vertices;
+  if (num_vertices < 3 || num_vertices > 64) return false;
+  // Work with the vertices in counterclockwise order.
+  double twice_area = 0.0;
+  for (int i = num_vertices - 1, j = 0; i >= 0; j = i--) {
+    twice_area += az_vcross(polygon.vertices[i], polygon.vertices[j]);
+  }
+  if (!(twice_area != 0.0)) return false;
+  const bool reversed = (twice_area < 0.0);
+  int indices[64];
+  for (int i = 0; i < num_vertices; ++i) {
+    indices[i] = (reversed ? num_vertices - 1 - i : i);
+  }
+  decomp_piece_t pieces[62];
+  int num_pieces = triangulate(polygon, indices, num_vertices, pieces);
+  if (num_pieces < 0) return false;
+  // Remove diagonals, one at a time, for as long as we can do so without
+  // making any piece concave (this is the Hertel-Mehlhorn algorithm, which
+  // gives at most four times the fewest possible pieces).
+  for (bool merged_any = true; merged_any;) {
+    merged_any = false;
+    for (int p = 0; p < num_pieces && !merged_any; ++p) {
+      for (int q = p + 1; q < num_pieces && !merged_any; ++q) {
+        if (try_merge_pieces(polygon, &pieces[p], &pieces[q])) {
+          pieces[q] = pieces[--num_pieces];
+          merged_any = true;
+        }
+      }
+    }
+  }
+  if (num_pieces > AZ_MAX_CONVEX_PIECES) return false;
+  // Record the sides of each piece as half-planes.
+  decomp_out->num_pieces = num_pieces;
+  decomp_out->num_planes = 0;
+  for (int p = 0; p < num_pieces; ++p) {
+    const decomp_piece_t *piece = &pieces[p];
+    az_convex_piece_t *out = &decomp_out->pieces[p];
+    out->min = out->max = polygon.vertices[piece->corners[0]];
+    out->first_plane = decomp_out->num_planes;
+    out->num_planes = 0;
+    out->edges = 0;
+    for (int k = 0; k < piece->num_corners; ++k) {
+      const int a = piece->corners[k];
+      const int b = piece->corners[(k + 1) % piece->num_corners];
+      const az_vector_t va = polygon.vertices[a];
+      const az_vector_t vb = polygon.vertices[b];
+      out->min.x = fmin(out->min.x, va.x); out->min.y = fmin(out->min.y, va.y);
+      out->max.x = fmax(out->max.x, va.x); out->max.y = fmax(out->max.y, va.y);
+      // Is this side one of the polygon's own edges?
+      if (b == (a + 1) % num_vertices) out->edges |= UINT64_C(1) << a;
+      else if (a == (b + 1) % num_vertices) out->edges |= UINT64_C(1) << b;
+      if (decomp_out->num_planes >= AZ_MAX_CONVEX_PLANES) return false;
+      const az_vector_t side = az_vsub(vb, va);
+      if (side.x == 0.0 && side.y == 0.0) return false;
+      az_half_plane_t *plane = &decomp_out->planes[decomp_out->num_planes++];
+      plane->normal = az_vunit((az_vector_t){side.y, -side.x});
+      plane->offset = az_vdot(plane->normal, va);
+      ++out->num_planes;
+    }
+    // A piece made only of diagonals still needs a nonzero bitset, so that a
+    // path starting inside it isn't mistaken for a miss; any edge will do.
+    if (out->edges == 0) out->edges = UINT64_C(1) << piece->corners[0];
+  }
+  return true;
+}
+
+// How far to push out each side of a convex piece when testing paths against
+// it, so that rounding error can never make us skip an edge that the exact
+// edge tests would count as hit.
+#define CONVEX_MARGIN 1e-6
+
+// Determine if a circle with the given radius travelling delta from start
+// might touch the convex piece.  This is the slab method: each side of the
+// piece (pushed out by the radius) bounds the fraction of the path that can
+// be inside the piece, and the path misses if those bounds leave nothing.
+static bool path_might_touch_piece(
+    const az_convex_decomp_t *decomp, const az_convex_piece_t *piece,
+    double radius, az_vector_t start, az_vector_t delta) {
+  const double margin = radius + CONVEX_MARGIN;
+  // Start with the bounding box, which rejects most pieces outright.
+  const az_vector_t end = az_vadd(start, delta);
+  if (fmax(start.x, end.x) + margin < piece->min.x ||
+      fmin(start.x, end.x) - margin > piece->max.x ||
+      fmax(start.y, end.y) + margin < piece->min.y ||
+      fmin(start.y, end.y) - margin > piece->max.y) return false;
+  double t_min = 0.0, t_max = 1.0;
+  for (int i = 0; i < piece->num_planes; ++i) {
+    const az_half_plane_t *plane = &decomp->planes[piece->first_plane + i];
+    // How far start is inside this side, and how fast the path moves out.
+    const double depth =
+      plane->offset + margin - az_vdot(plane->normal, start);
+    const double rate = az_vdot(plane->normal, delta);
+    if (rate == 0.0) {
+      if (depth < 0.0) return false;
+    } else if (rate > 0.0) {
+      t_max = fmin(t_max, depth / rate);
+    } else {
+      t_min = fmax(t_min, depth / rate);
+    }
+    if (t_min > t_max) return false;
+  }
+  return true;
+}
+
+uint64_t az_convex_decomp_edges(
+    const az_convex_decomp_t *decomp, double radius,
+    az_vector_t start, az_vector_t delta) {
+  assert(radius >= 0.0);
+  uint64_t edges = 0;
+  for (int i = 0; i < decomp->num_pieces; ++i) {
+    const az_convex_piece_t *piece = &decomp->pieces[i];
+    if ((edges & piece->edges) == piece->edges) continue;
+    if (path_might_touch_piece(decomp, piece, radius, start, delta)) {
+      edges |= piece->edges;
+    }
+  }
+  return edges;
+}
+
+/*===========================================================================*/
+
 az_vector_t az_find_knee(az_vector_t hip, az_vector_t foot, double thigh,
                          double shin, az_vector_t knee_dir) {
   const double dist = az_vdist(hip, foot);
@@ -22,6 +22,7 @@
 #define AZIMUTH_UTIL_POLYGON_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "azimuth/util/misc.h" // for AZ_ARRAY_SIZE
 #include "azimuth/util/vector.h"
@@ -84,7 +85,9 @@ bool az_ray_hits_bounding_circle(az_vector_t start, az_vector_t delta,
 // the shape (if point_out is non-NULL) and a vector normal to the shape at the
 // impact point in *normal_out (if normal_out is non-NULL).  No guarantees are
 // made about the length of the normal vector, and in particular it may be zero
-// (if there is no well-defined normal for the collision).
+// (if there is no well-defined normal for the collision).  If point_out and
+// normal_out are both NULL, the polygon functions return as soon as they find
+// any hit at all, rather than searching for the nearest one.
 
 // Determine if the ray will hit the given circle.
 bool az_ray_hits_circle(
@@ -121,7 +124,8 @@ bool az_ray_hits_polygon_trans(
 // (depending on the function).  If it does, the function stores in *pos_out
 // the first position of the circle at which it touches the shape (if pos_out
 // is non-NULL) and the normal vector in *normal_out (if normal_out is
-// non-NULL).
+// non-NULL).  As for rays, if pos_out and normal_out are both NULL, the
+// polygon functions return as soon as they find any hit at all.
 
 // Determine if the circle will ever intersect the given point.
 bool az_circle_hits_point(
@@ -172,6 +176,33 @@ bool az_arc_ray_might_hit_bounding_circle(
     az_vector_t start, az_vector_t spin_center, double spin_angle,
     az_vector_t circle_center, double circle_radius);
 
+// The region swept out by a circle travelling from start around spin_center
+// by spin_angle radians: an arc of the annulus centered on spin_center, as
+// wide as the circle.  Setting this up once lets many shapes be tested
+// against the same sweep much more cheaply than with
+// az_arc_ray_might_hit_bounding_circle.
+typedef struct {
+  az_vector_t spin_center;
+  double spin_radius, circle_radius;
+  double abs_spin_angle;
+  // The two ends of the arc that the circle's center follows, relative to
+  // spin_center, in counterclockwise order:
+  az_vector_t rel_first, rel_last;
+  // The bounding box of the whole swept region:
+  az_vector_t min, max;
+} az_arc_sweep_t;
+
+void az_init_arc_sweep(
+    double circle_radius, az_vector_t start, az_vector_t spin_center,
+    double spin_angle, az_arc_sweep_t *sweep_out);
+
+// Determine if the swept circle might ever touch the specified circle (for
+// example, the bounding circle of some shape).  False positives are possible
+// (though rare), but if this returns false then the swept circle definitely
+// won't touch the circle, nor anything inside it.
+bool az_arc_sweep_might_hit_circle(const az_arc_sweep_t *sweep,
+                                   az_vector_t center, double radius);
+
 // The following functions each determine if a circular ray, travelling from
 // start around spin_center by spin_angle radians, will ever intersect a
 // particular shape (depending on the function).  If it does, the function
@@ -267,6 +298,118 @@ bool az_arc_circle_hits_polygon_trans(
 
 /*===========================================================================*/
 
+// A polygon stored as separate arrays of x and y coordinates, each with
+// num_vertices + 1 entries: the first vertex is repeated at the end, so that
+// edge i always runs from vertex i to vertex i + 1.  This layout lets the
+// functions below test several edges at once with SIMD instructions.
+typedef struct {
+  int num_vertices;
+  const double *xs, *ys;
+} az_polygon_soa_t;
+
+// Which implementation the *_soa functions use.  All of them give
+// bit-for-bit identical results to the scalar az_polygon_contains,
+// az_ray_hits_polygon, and az_circle_hits_polygon functions; the SIMD ones
+// just get there faster, by rejecting several edges at a time and only falling
+// back to the scalar code for edges that might actually be hit.
+typedef enum {
+  AZ_POLYGON_SCALAR = 0,
+  AZ_POLYGON_SSE2, // two edges at a time
+  AZ_POLYGON_AVX2 // four edges at a time
+} az_polygon_impl_t;
+
+// Return the implementation in use.  Unless az_set_polygon_impl has been
+// called, this is the fastest one that the CPU supports (as reported by
+// cpuid).
+az_polygon_impl_t az_get_polygon_impl(void);
+
+// Switch to the given implementation and return true, or return false (and
+// change nothing) if it isn't supported by this build or this CPU.
+bool az_set_polygon_impl(az_polygon_impl_t impl);
+
+// Like az_polygon_contains, but for a polygon stored as coordinate arrays.
+bool az_polygon_contains_soa(az_polygon_soa_t polygon, az_vector_t point);
+
+// Like az_ray_hits_polygon, but for a polygon stored as coordinate arrays.
+bool az_ray_hits_polygon_soa(
+    az_polygon_soa_t polygon, az_vector_t start, az_vector_t delta,
+    az_vector_t *point_out, az_vector_t *normal_out);
+
+// Like az_circle_hits_polygon, but for a polygon stored as coordinate arrays.
+bool az_circle_hits_polygon_soa(
+    az_polygon_soa_t polygon, double radius,
+    az_vector_t start, az_vector_t delta,
+    az_vector_t *pos_out, az_vector_t *normal_out);
+
+// Like az_ray_hits_polygon_soa and az_circle_hits_polygon_soa, but only
+// testing the edges (and, for circles, the ends of the edges) in the given
+// bitset, in which bit i stands for the edge from vertex i to vertex i + 1.
+// As long as every edge that the ray or circle touches is in the bitset, the
+// results are the same as for the full functions.
+bool az_ray_hits_polygon_soa_edges(
+    az_polygon_soa_t polygon, uint64_t edges,
+    az_vector_t start, az_vector_t delta,
+    az_vector_t *point_out, az_vector_t *normal_out);
+bool az_circle_hits_polygon_soa_edges(
+    az_polygon_soa_t polygon, uint64_t edges,
+    double radius, az_vector_t start, az_vector_t delta,
+    az_vector_t *pos_out, az_vector_t *normal_out);
+
+/*===========================================================================*/
+
+// The most pieces, and the most sides in total, that a convex decomposition
+// can have.
+#define AZ_MAX_CONVEX_PIECES 16
+#define AZ_MAX_CONVEX_PLANES 64
+
+// One side of a convex piece: the points p within the piece are those with
+// az_vdot(normal, p) <= offset for every side.
+typedef struct {
+  az_vector_t normal; // unit length, pointing out of the piece
+  double offset;
+} az_half_plane_t;
+
+typedef struct {
+  az_vector_t min, max; // bounding box corners
+  int first_plane, num_planes; // the piece's sides, in the planes array
+  // Bitset of the polygon edges (bit i being the edge from vertex i to vertex
+  // i + 1) that lie along this piece's sides; the other sides are diagonals
+  // through the inside of the polygon.
+  uint64_t edges;
+} az_convex_piece_t;
+
+// A simple (but possibly concave) polygon split into convex pieces whose
+// union is the whole polygon.  Each piece is just a list of half-planes, so
+// testing a path against it takes a handful of dot products, whereas testing
+// against the whole polygon means walking all of its edges.
+typedef struct {
+  int num_pieces;
+  az_convex_piece_t pieces[AZ_MAX_CONVEX_PIECES];
+  int num_planes;
+  az_half_plane_t planes[AZ_MAX_CONVEX_PLANES];
+} az_convex_decomp_t;
+
+// Split the polygon (which must have at most 64 vertices, no two consecutive
+// vertices the same, and no self-intersections) into convex pieces, by
+// triangulating it and then removing as many diagonals as possible while
+// keeping every piece convex.  Returns false (in which case *decomp_out is
+// unspecified) if the polygon is degenerate or needs more pieces or sides
+// than an az_convex_decomp_t can hold.
+bool az_decompose_polygon(az_polygon_t polygon,
+                          az_convex_decomp_t *decomp_out);
+
+// Return a bitset (as for az_ray_hits_polygon_soa_edges) of the polygon edges
+// that a circle with the given radius (zero for a ray) travelling delta from
+// start (in the polygon's own coordinates) might touch, by testing the path
+// against each convex piece with the slab method.  This errs on the side of
+// including too many edges, never too few.  If it returns zero, the path
+// misses the polygon entirely (and doesn't start inside it).
+uint64_t az_convex_decomp_edges(
+    const az_convex_decomp_t *decomp, double radius,
+    az_vector_t start, az_vector_t delta);
+
+/*===========================================================================*/
+
 // Find the position of the knee of a two-piece leg, given the location of the
 // hip and the foot, the lengths of the two leg segments, and the rough
 // direction in which the knee should point (to choose between the two possible
@@ -44,31 +44,46 @@ double az_rand_sdouble(az_random_seed_t *seed) {
 
 /*===========================================================================*/
 
-static az_random_seed_t global_seed = {1, 1};
-
-double az_random(double min, double max) {
+double az_rand_double(az_random_seed_t *seed, double min, double max) {
   assert(isfinite(min));
   assert(isfinite(max));
   assert(min <= max);
   if (min == max) return min;
-  return min + (max - min) * az_rand_udouble(&global_seed);
+  return min + (max - min) * az_rand_udouble(seed);
 }
 
-int az_randint(int min, int max) {
+int az_rand_int(az_random_seed_t *seed, int min, int max) {
   assert(min <= max);
   if (min == max) return min;
   // This will result in a nonuniform distribution when (1 + max - min) is not
   // a power of two, but it's good enough for our purposes.
-  return min + az_rand_uint32(&global_seed) % (uint32_t)(1 + max - min);
+  return min + az_rand_uint32(seed) % (uint32_t)(1 + max - min);
 }
 
-az_vector_t az_random_point_in_circle(double radius) {
+az_vector_t az_rand_point_in_circle(az_random_seed_t *seed, double radius) {
   assert(radius >= 0.0);
   // Select a point using the technique described by this Stack Overflow
   // answer: http://stackoverflow.com/a/5838055
-  const double u = az_random(0, radius) + az_random(0, radius);
+  const double u =
+    az_rand_double(seed, 0, radius) + az_rand_double(seed, 0, radius);
   return az_vpolar((u > radius ? 2 * radius - u : u),
-                   az_random(0, AZ_TWO_PI));
+                   az_rand_double(seed, 0, AZ_TWO_PI));
+}
+
+/*===========================================================================*/
+
+static az_random_seed_t global_seed = {1, 1};
+
+double az_random(double min, double max) {
+  return az_rand_double(&global_seed, min, max);
+}
+
+int az_randint(int min, int max) {
+  return az_rand_int(&global_seed, min, max);
+}
+
+az_vector_t az_random_point_in_circle(double radius) {
+  return az_rand_point_in_circle(&global_seed, radius);
 }
 
 /*===========================================================================*/
@@ -46,6 +46,14 @@ double az_rand_udouble(az_random_seed_t *seed);
 // can generate a repeatable sequence of pseudorandom numbers.
 double az_rand_sdouble(az_random_seed_t *seed);
 
+// Like az_random, az_randint, and az_random_point_in_circle below, but using
+// (and updating) the given seed instead of the global one.  Simulation code
+// should use these with the seed stored in the simulation state, so that the
+// outcome doesn't depend on anything else that happens to use randomness.
+double az_rand_double(az_random_seed_t *seed, double min, double max);
+int az_rand_int(az_random_seed_t *seed, int min, int max);
+az_vector_t az_rand_point_in_circle(az_random_seed_t *seed, double radius);
+
 /*===========================================================================*/
 
 // Returns a random double from min (inclusive) to max (exclusive), using the
@@ -59,7 +67,7 @@ double az_random(double min, double max);
 int az_randint(int min, int max);
 
 // Returns a point selected uniformly from the set of points that are within
-// radius of the origin.
+// radius of the origin, using the global random seed.
 az_vector_t az_random_point_in_circle(double radius);
 
 /*===========================================================================*/
@@ -781,7 +781,8 @@ void az_draw_baddie(const az_baddie_t *baddie, az_clock_t clock) {
 }
 
 void az_draw_background_baddies(const az_space_state_t *state) {
-  AZ_ARRAY_LOOP(baddie, state->baddies) {
+  for (int i = 0; i < state->baddie_slots.num_live; ++i) {
+    const az_baddie_t *baddie = &state->baddies[state->baddie_slots.live[i]];
     if (baddie->kind == AZ_BAD_NOTHING ||
         baddie->kind == AZ_BAD_MARKER) continue;
     if (!az_baddie_has_flag(baddie, AZ_BADF_DRAW_BG)) continue;
@@ -790,7 +791,8 @@ void az_draw_background_baddies(const az_space_state_t *state) {
 }
 
 void az_draw_foreground_baddies(const az_space_state_t *state) {
-  AZ_ARRAY_LOOP(baddie, state->baddies) {
+  for (int i = 0; i < state->baddie_slots.num_live; ++i) {
+    const az_baddie_t *baddie = &state->baddies[state->baddie_slots.live[i]];
     if (baddie->kind == AZ_BAD_NOTHING ||
         baddie->kind == AZ_BAD_MARKER) continue;
     if (az_baddie_has_flag(baddie, AZ_BADF_DRAW_BG)) continue;
@@ -277,7 +277,9 @@ void az_draw_gravfield(const az_gravfield_t *gravfield) {
 }
 
 void az_draw_gravfields(const az_space_state_t *state) {
-  AZ_ARRAY_LOOP(gravfield, state->gravfields) {
+  for (int i = 0; i < state->gravfield_slots.num_live; ++i) {
+    const az_gravfield_t *gravfield =
+      &state->gravfields[state->gravfield_slots.live[i]];
     if (gravfield->kind == AZ_GRAV_NOTHING) continue;
     if (az_is_liquid(gravfield->kind)) continue;
     az_draw_gravfield(gravfield);
@@ -285,7 +287,9 @@ void az_draw_gravfields(const az_space_state_t *state) {
 }
 
 void az_draw_liquid(const az_space_state_t *state) {
-  AZ_ARRAY_LOOP(gravfield, state->gravfields) {
+  for (int i = 0; i < state->gravfield_slots.num_live; ++i) {
+    const az_gravfield_t *gravfield =
+      &state->gravfields[state->gravfield_slots.live[i]];
     if (az_is_liquid(gravfield->kind)) {
       az_draw_gravfield(gravfield);
     }
@@ -371,12 +371,14 @@ void az_draw_particle(const az_particle_t *particle, az_clock_t clock) {
 }
 
 void az_draw_particles(const az_space_state_t *state) {
-  AZ_ARRAY_LOOP(particle, state->particles) {
-    if (particle->kind == AZ_PAR_NOTHING) continue;
+  for (int i = 0; i < state->particle_slots.num_live; ++i) {
+    az_particle_t particle;
+    az_get_particle(state, state->particle_slots.live[i], &particle);
+    if (particle.kind == AZ_PAR_NOTHING) continue;
     glPushMatrix(); {
-      az_gl_translated(particle->position);
-      az_gl_rotated(particle->angle);
-      az_draw_particle(particle, state->clock);
+      az_gl_translated(particle.position);
+      az_gl_rotated(particle.angle);
+      az_draw_particle(&particle, state->clock);
     } glPopMatrix();
   }
 }
@@ -115,7 +115,8 @@ static void draw_pickup(az_pickup_kind_t kind, az_clock_t clock) {
 }
 
 void az_draw_pickups(const az_space_state_t *state) {
-  AZ_ARRAY_LOOP(pickup, state->pickups) {
+  for (int i = 0; i < state->pickup_slots.num_live; ++i) {
+    const az_pickup_t *pickup = &state->pickups[state->pickup_slots.live[i]];
     if (pickup->kind == AZ_PUP_NOTHING) continue;
     glPushMatrix(); {
       glTranslated(pickup->position.x, pickup->position.y, 0);
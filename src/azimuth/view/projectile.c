@@ -606,7 +606,9 @@ void az_draw_projectile(const az_projectile_t *proj, az_clock_t clock) {
 }
 
 void az_draw_projectiles(const az_space_state_t *state) {
-  AZ_ARRAY_LOOP(proj, state->projectiles) {
+  for (int i = 0; i < state->projectile_slots.num_live; ++i) {
+    const az_projectile_t *proj =
+      &state->projectiles[state->projectile_slots.live[i]];
     if (proj->kind == AZ_PROJ_NOTHING) continue;
     glPushMatrix(); {
       az_gl_translated(proj->position);
@@ -31,7 +31,6 @@
 #include "azimuth/state/player.h"
 #include "azimuth/state/ship.h"
 #include "azimuth/state/space.h"
-#include "azimuth/util/misc.h"
 #include "azimuth/util/vector.h"
 #include "azimuth/view/util.h"
 
@@ -43,7 +42,9 @@ void az_draw_ship(az_space_state_t *state) {
 
   // Draw the magnet sweep:
   if (az_has_upgrade(&ship->player, AZ_UPG_MAGNET_SWEEP)) {
-    AZ_ARRAY_LOOP(pickup, state->pickups) {
+    for (int i = 0; i < state->pickup_slots.num_live; ++i) {
+      const az_pickup_t *pickup =
+        &state->pickups[state->pickup_slots.live[i]];
       if (pickup->kind == AZ_PUP_NOTHING) continue;
       if (az_vwithin(pickup->position, ship->position,
                      AZ_MAGNET_SWEEP_ATTRACT_RANGE)) {
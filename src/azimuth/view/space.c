@@ -21,11 +21,14 @@
 
 #include <assert.h>
 #include <math.h>
+#include <stdbool.h>
 
 #include <SDL_opengl.h>
 
 #include "azimuth/constants.h"
+#include "azimuth/state/baddie.h"
 #include "azimuth/state/player.h"
+#include "azimuth/state/profile.h"
 #include "azimuth/state/space.h"
 #include "azimuth/util/misc.h" // for AZ_ASSERT_UNREACHABLE
 #include "azimuth/util/vector.h"
@@ -41,6 +44,7 @@
 #include "azimuth/view/projectile.h"
 #include "azimuth/view/ship.h"
 #include "azimuth/view/speck.h"
+#include "azimuth/view/string.h"
 #include "azimuth/view/util.h"
 #include "azimuth/view/wall.h"
 
@@ -270,6 +274,63 @@ static void draw_global_fade(const az_space_state_t *state) {
   }
 }
 
+// The number of baddie kinds to list in the tick profile overlay:
+#define PROFILE_NUM_TOP_BADDIES 3
+// The width of the tick profile overlay's name column, in characters (enough
+// for the longest baddie kind name), and of its whole lines:
+#define PROFILE_NAME_CHARS 22
+#define PROFILE_LINE_CHARS (PROFILE_NAME_CHARS + 14)
+
+// Draw a breakdown of recent tick times (in the top-right corner of the
+// screen) if the state is being profiled.
+static void draw_tick_profile(const az_space_state_t *state) {
+  const az_tick_profile_t *profile = state->profile;
+  if (profile == NULL) return;
+  const int num_lines = 2 + AZ_NUM_PROFILE_SECTIONS + PROFILE_NUM_TOP_BADDIES;
+  const double left = AZ_SCREEN_WIDTH - 10 - 8 * PROFILE_LINE_CHARS;
+  const double top = 30;
+  glColor4f(0, 0, 0, 0.75); // black tint
+  glBegin(GL_QUADS); {
+    glVertex2d(left - 5, top - 5);
+    glVertex2d(left - 5, top + 10 * num_lines);
+    glVertex2d(AZ_SCREEN_WIDTH - 5, top + 10 * num_lines);
+    glVertex2d(AZ_SCREEN_WIDTH - 5, top - 5);
+  } glEnd();
+  const double total = fmax(profile->average_total, 1.0);
+  glColor3f(1, 1, 1); // white
+  az_draw_printf(8, AZ_ALIGN_LEFT, left, top, "tick %6.3fms peak %6.3fms",
+                 profile->average_total * 1e-6,
+                 az_peak_tick_nanos(profile) * 1e-6);
+  for (int i = 0; i < AZ_NUM_PROFILE_SECTIONS; ++i) {
+    const double nanos = profile->average_sections[i];
+    glColor3f(0.75, 0.75, 0.75); // light gray
+    az_draw_printf(8, AZ_ALIGN_LEFT, left, top + 10 * (i + 1),
+                   "%-*s %6.3fms %3.0f%%", PROFILE_NAME_CHARS,
+                   az_profile_section_name((az_profile_section_t)i),
+                   nanos * 1e-6, 100.0 * nanos / total);
+  }
+  // List the baddie kinds that have been taking the most time lately.
+  bool listed[AZ_NUM_BADDIE_KINDS + 1] = {false};
+  for (int i = 0; i < PROFILE_NUM_TOP_BADDIES; ++i) {
+    int worst = 0;
+    for (int kind = 1; kind <= AZ_NUM_BADDIE_KINDS; ++kind) {
+      if (!listed[kind] && (worst == 0 || profile->average_baddies[kind] >
+                            profile->average_baddies[worst])) {
+        worst = kind;
+      }
+    }
+    const double nanos = profile->average_baddies[worst];
+    if (nanos <= 0.0) break;
+    listed[worst] = true;
+    glColor3f(1, 0.5, 0.5); // light red
+    az_draw_printf(8, AZ_ALIGN_LEFT, left,
+                   top + 10 * (AZ_NUM_PROFILE_SECTIONS + 2 + i),
+                   "%-*s %6.3fms %3.0f%%", PROFILE_NAME_CHARS,
+                   az_baddie_kind_name((az_baddie_kind_t)worst),
+                   nanos * 1e-6, 100.0 * nanos / total);
+  }
+}
+
 void az_space_draw_screen(az_space_state_t *state) {
   // If we're watching a cutscene, draw that instead of our normal camera view.
   if (state->cutscene.scene != AZ_SCENE_NOTHING) {
@@ -278,6 +339,7 @@ void az_space_draw_screen(az_space_state_t *state) {
     az_draw_monologue(state);
     draw_global_fade(state);
     az_draw_skip_message(state);
+    draw_tick_profile(state);
     return;
   }
 
@@ -369,6 +431,7 @@ void az_space_draw_screen(az_space_state_t *state) {
   az_draw_hud(state);
   draw_global_fade(state);
   az_draw_skip_message(state);
+  draw_tick_profile(state);
 }
 
 /*===========================================================================*/
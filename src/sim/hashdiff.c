@@ -0,0 +1,168 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include "sim/hashdiff.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azimuth/state/hash.h"
+#include "azimuth/state/space.h"
+#include "azimuth/util/misc.h"
+
+/*===========================================================================*/
+
+// The longest line we expect in a hash stream; each part takes 17 characters.
+#define MAX_LINE_LENGTH 1024
+// The most tokens (frame number plus hash parts) we expect on one line.  This
+// is more than AZ_NUM_HASH_PARTS + 1 so that we can still compare streams
+// written by a build that hashed more parts than we do.
+#define MAX_TOKENS 64
+
+void az_write_hash_header(FILE *file) {
+  fprintf(file, "# frame");
+  for (int i = 0; i < AZ_NUM_HASH_PARTS; ++i) {
+    fprintf(file, " %s", az_hash_part_name((az_hash_part_t)i));
+  }
+  fprintf(file, "\n");
+}
+
+void az_write_hash_line(FILE *file, int frame, const az_space_state_t *state) {
+  az_space_hash_t hash;
+  az_hash_space_state(state, &hash);
+  fprintf(file, "%d", frame);
+  AZ_ARRAY_LOOP(part, hash.parts) {
+    fprintf(file, " %08x%08x", (unsigned int)(*part >> 32),
+            (unsigned int)(*part & 0xffffffffu));
+  }
+  fprintf(file, "\n");
+}
+
+/*===========================================================================*/
+
+typedef struct {
+  const char *path;
+  FILE *file;
+  char line[MAX_LINE_LENGTH];
+  int num_tokens;
+  char *tokens[MAX_TOKENS];
+} hash_stream_t;
+
+// Read the next line of the stream and split it into tokens.  Returns false
+// at end of file (or on a read error).
+static bool read_hash_line(hash_stream_t *stream) {
+  stream->num_tokens = 0;
+  if (fgets(stream->line, sizeof(stream->line), stream->file) == NULL) {
+    return false;
+  }
+  for (char *token = strtok(stream->line, " \t\r\n");
+       token != NULL && stream->num_tokens < MAX_TOKENS;
+       token = strtok(NULL, " \t\r\n")) {
+    stream->tokens[stream->num_tokens++] = token;
+  }
+  return true;
+}
+
+static bool open_hash_stream(const char *path, hash_stream_t *stream) {
+  stream->path = path;
+  stream->file = fopen(path, "r");
+  if (stream->file == NULL) {
+    fprintf(stderr, "ERROR: could not open %s\n", path);
+    return false;
+  }
+  if (!read_hash_line(stream) || stream->num_tokens < 2 ||
+      strcmp(stream->tokens[0], "#") != 0 ||
+      strcmp(stream->tokens[1], "frame") != 0) {
+    fprintf(stderr, "ERROR: %s is not a hash stream\n", path);
+    fclose(stream->file);
+    return false;
+  }
+  return true;
+}
+
+static int diff_hash_streams(hash_stream_t *a, hash_stream_t *b) {
+  // Remember the part names from the first stream's header.  The header
+  // tokens are "#", "frame", and then the part names; the frame lines have
+  // the frame number in place of those first two tokens.
+  const int num_parts = a->num_tokens - 2;
+  char names[MAX_TOKENS][32];
+  for (int i = 0; i < num_parts; ++i) {
+    snprintf(names[i], sizeof(names[i]), "%s", a->tokens[i + 2]);
+  }
+  bool same_parts = (a->num_tokens == b->num_tokens);
+  for (int i = 2; same_parts && i < a->num_tokens; ++i) {
+    same_parts = (strcmp(a->tokens[i], b->tokens[i]) == 0);
+  }
+  if (!same_parts) {
+    printf("%s and %s hash different parts of the state\n", a->path, b->path);
+    return EXIT_FAILURE;
+  }
+
+  int num_lines = 0;
+  while (true) {
+    const bool more_a = read_hash_line(a);
+    const bool more_b = read_hash_line(b);
+    if (!more_a && !more_b) {
+      printf("hash streams are identical (%d frames)\n", num_lines);
+      return EXIT_SUCCESS;
+    } else if (!more_a || !more_b) {
+      printf("hash streams agree for %d frames, but %s ends first\n",
+             num_lines, (more_a ? b->path : a->path));
+      return EXIT_FAILURE;
+    }
+    ++num_lines;
+    if (a->num_tokens != num_parts + 1 || b->num_tokens != num_parts + 1) {
+      printf("malformed line after %d frames\n", num_lines - 1);
+      return EXIT_FAILURE;
+    }
+    if (strcmp(a->tokens[0], b->tokens[0]) != 0) {
+      printf("frame numbers differ after %d frames (%s vs. %s)\n",
+             num_lines - 1, a->tokens[0], b->tokens[0]);
+      return EXIT_FAILURE;
+    }
+    bool differ = false;
+    for (int i = 0; i < num_parts; ++i) {
+      if (strcmp(a->tokens[i + 1], b->tokens[i + 1]) == 0) continue;
+      if (!differ) printf("first divergence at frame %s:", a->tokens[0]);
+      differ = true;
+      printf(" %s", names[i]);
+    }
+    if (differ) {
+      printf("\n");
+      return EXIT_FAILURE;
+    }
+  }
+}
+
+int az_diff_hash_files(const char *path_a, const char *path_b) {
+  hash_stream_t a, b;
+  if (!open_hash_stream(path_a, &a)) return EXIT_FAILURE;
+  if (!open_hash_stream(path_b, &b)) {
+    fclose(a.file);
+    return EXIT_FAILURE;
+  }
+  const int result = diff_hash_streams(&a, &b);
+  fclose(a.file);
+  fclose(b.file);
+  return result;
+}
+
+/*===========================================================================*/
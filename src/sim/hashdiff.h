@@ -0,0 +1,48 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#pragma once
+#ifndef SIM_HASHDIFF_H_
+#define SIM_HASHDIFF_H_
+
+#include <stdio.h>
+
+#include "azimuth/state/space.h"
+
+/*===========================================================================*/
+
+// A hash stream is a text file with a header line naming the hash parts (see
+// azimuth/state/hash.h), followed by one line per frame giving the frame
+// number and the hash of each part in hex.
+
+// Write the header line for a hash stream.
+void az_write_hash_header(FILE *file);
+
+// Hash the given state and write it to the stream as the given frame.
+void az_write_hash_line(FILE *file, int frame, const az_space_state_t *state);
+
+// Compare the hash streams in the two given files, and print a report of the
+// first frame at which they differ (and which parts of the state differ on
+// that frame) to stdout.  Returns EXIT_SUCCESS if the streams are identical,
+// or EXIT_FAILURE if they differ or if either one couldn't be read.
+int az_diff_hash_files(const char *path_a, const char *path_b);
+
+/*===========================================================================*/
+
+#endif // SIM_HASHDIFF_H_
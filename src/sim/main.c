@@ -0,0 +1,364 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+// The headless simulator runs the space simulation for a single room without
+// any window, GL context, or audio device, and reports how fast it went.  The
+// (optional) input file has one line per frame, each giving the controls that
+// are held during that frame: u/d/l/r for up/down/left/right, f for fire, o
+// for ordnance, and t for utility.  Capital U/D/F/T additionally mark that
+// control as having just been pressed on that frame.  Any other characters
+// (e.g. '.' for an idle frame) are ignored, and lines starting with '#' are
+// comments that don't count as frames.  Once the input runs out, the
+// remaining frames are ticked with no controls held.
+//
+// Alternatively, given --replay and a replay file saved by the game, the
+// simulator plays back the recorded session as fast as it can (optionally
+// stopping at a given frame), instead of starting in a single room.
+//
+// Either mode may be preceded by --hashes and a file name, in which case the
+// simulator writes a hash of the space state (see azimuth/state/hash.h) for
+// the initial state and after every tick to that file.  Two such hash streams
+// (e.g. from before and after a change that shouldn't affect the simulation)
+// can then be compared with --diff-hashes, which reports the first frame on
+// which they diverge and which parts of the state differ on that frame.
+//
+// Similarly, given --profile and a file name, the simulator times each part of
+// every tick (see azimuth/state/profile.h) and writes the timings for each
+// frame to that file as CSV.
+
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "azimuth/constants.h"
+#include "azimuth/state/baddie.h" // for az_init_baddie_datas
+#include "azimuth/state/music.h" // for az_init_music_datas
+#include "azimuth/state/planet.h"
+#include "azimuth/state/player.h"
+#include "azimuth/state/profile.h"
+#include "azimuth/state/replay.h"
+#include "azimuth/state/sound.h" // for az_init_sound_datas
+#include "azimuth/state/space.h"
+#include "azimuth/state/wall.h" // for az_init_wall_datas
+#include "azimuth/system/resource.h"
+#include "azimuth/system/timer.h"
+#include "azimuth/tick/replay.h"
+#include "azimuth/tick/script.h"
+#include "azimuth/tick/space.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/prefs.h"
+#include "sim/hashdiff.h"
+
+/*===========================================================================*/
+
+static az_planet_t planet;
+static az_preferences_t preferences;
+static az_space_state_t state;
+static FILE *hash_file = NULL;
+static FILE *profile_file = NULL;
+static az_tick_profile_t profile;
+
+static void close_output_files(void) {
+  if (hash_file != NULL) fclose(hash_file);
+  if (profile_file != NULL) fclose(profile_file);
+}
+
+// Write the hash of the current state, if we're writing a hash stream.
+static void write_hash(int frame) {
+  if (hash_file != NULL) az_write_hash_line(hash_file, frame, &state);
+}
+
+// Write out the timings for the frame that was just ticked, if we're
+// profiling.
+static void write_profile(int frame) {
+  if (profile_file != NULL) {
+    az_write_profile_csv_row(profile_file, frame, &profile);
+  }
+}
+
+// Open an output file for one of the options above, and write its header.
+static FILE *open_output_file(const char *path, void (*write_header)(FILE*)) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    fprintf(stderr, "ERROR: could not open %s\n", path);
+    exit(EXIT_FAILURE);
+  }
+  write_header(file);
+  return file;
+}
+
+static void destroy_planet(void) {
+  az_destroy_planet(&planet);
+}
+
+static bool load_scenario(void) {
+  if (!az_init_music_datas(&az_system_resource_reader)) return false;
+  if (!az_read_planet(&az_system_resource_reader, &planet)) return false;
+  az_prebuild_rooms(&planet);
+  atexit(destroy_planet);
+  return true;
+}
+
+static void begin_room(az_room_key_t room_key) {
+  AZ_ZERO_OBJECT(&state);
+  state.planet = &planet;
+  state.prefs = &preferences;
+  state.rng = (az_random_seed_t){1, 1};
+  state.mode = AZ_MODE_NORMAL;
+  az_init_player(&state.ship.player);
+  state.ship.player.current_room = room_key;
+  const az_room_t *room = &planet.rooms[room_key];
+  az_enter_room(&state, room);
+  // Start the ship at the room's save point if it has one, otherwise at the
+  // center of the room.
+  state.ship.position = az_bounds_center(&room->camera_bounds);
+  AZ_ARRAY_LOOP(node, state.nodes) {
+    if (node->kind == AZ_NODE_CONSOLE &&
+        node->subkind.console == AZ_CONS_SAVE) {
+      state.ship.position = node->position;
+      state.ship.angle = node->angle;
+      break;
+    }
+  }
+  az_after_entering_room(&state);
+}
+
+// Read the controls for the next frame from the input file (if any).
+static void read_controls(FILE *input, az_controls_t *controls) {
+  AZ_ZERO_OBJECT(controls);
+  if (input == NULL) return;
+  int ch;
+  bool comment;
+  do {
+    comment = false;
+    ch = fgetc(input);
+    if (ch == '#') comment = true;
+    for (; ch != EOF && ch != '\n'; ch = fgetc(input)) {
+      if (comment) continue;
+      switch (ch) {
+        case 'U': controls->up_pressed = true; // fallthrough
+        case 'u': controls->up_held = true; break;
+        case 'D': controls->down_pressed = true; // fallthrough
+        case 'd': controls->down_held = true; break;
+        case 'l': controls->left_held = true; break;
+        case 'r': controls->right_held = true; break;
+        case 'F': controls->fire_pressed = true; // fallthrough
+        case 'f': controls->fire_held = true; break;
+        case 'o': controls->ordn_held = true; break;
+        case 'T': controls->util_pressed = true; // fallthrough
+        case 't': controls->util_held = true; break;
+        default: break;
+      }
+    }
+  } while (comment && ch != EOF);
+}
+
+// There is no one to press a key in a headless run, so dismiss anything that
+// would otherwise wait forever for the player to press one.
+static void dismiss_prompts(void) {
+  if (state.monologue.step == AZ_MLS_WAIT) {
+    assert(state.sync_vm.script != NULL);
+    az_resume_script(&state, &state.sync_vm);
+  } else if (state.dialogue.step == AZ_DLS_WAIT) {
+    assert(state.sync_vm.script != NULL);
+    az_resume_script(&state, &state.sync_vm);
+  } else if (state.mode == AZ_MODE_UPGRADE &&
+             state.upgrade_mode.step == AZ_UGS_MESSAGE) {
+    state.upgrade_mode.step = AZ_UGS_CLOSE;
+    state.upgrade_mode.progress = 0.0;
+  }
+}
+
+static void print_summary(int num_frames, uint64_t elapsed_nanos) {
+  const double seconds = elapsed_nanos * 1e-9;
+  const double game_seconds = num_frames * AZ_FRAME_TIME_SECONDS;
+  printf("Ticked %d frames in %.3f seconds (%.1f fps, %.1fx real time)\n",
+         num_frames, seconds, (seconds > 0.0 ? num_frames / seconds : 0.0),
+         (seconds > 0.0 ? game_seconds / seconds : 0.0));
+  int num_baddies = 0, num_particles = 0, num_projectiles = 0, num_specks = 0;
+  AZ_ARRAY_LOOP(baddie, state.baddies) {
+    if (baddie->kind != AZ_BAD_NOTHING) ++num_baddies;
+  }
+  AZ_ARRAY_LOOP(kind, state.particles.kind) {
+    if (*kind != AZ_PAR_NOTHING) ++num_particles;
+  }
+  AZ_ARRAY_LOOP(proj, state.projectiles) {
+    if (proj->kind != AZ_PROJ_NOTHING) ++num_projectiles;
+  }
+  AZ_ARRAY_LOOP(kind, state.specks.kind) {
+    if (*kind != AZ_SPECK_NOTHING) ++num_specks;
+  }
+  const az_ship_t *ship = &state.ship;
+  printf("room=%d mode=%d clock=%lu\n", (int)ship->player.current_room,
+         (int)state.mode, state.clock);
+  printf("ship: alive=%d position=(%.3f, %.3f) velocity=(%.3f, %.3f) "
+         "angle=%.5f shields=%.2f energy=%.2f\n",
+         (int)az_ship_is_alive(ship), ship->position.x, ship->position.y,
+         ship->velocity.x, ship->velocity.y, ship->angle,
+         ship->player.shields, ship->player.energy);
+  printf("objects: baddies=%d projectiles=%d particles=%d specks=%d\n",
+         num_baddies, num_projectiles, num_particles, num_specks);
+  if (profile_file != NULL) {
+    printf("peak objects (dropped):");
+    for (int i = 0; i < AZ_NUM_OBJECT_POOLS; ++i) {
+      printf(" %s=%d (%d)", az_object_pool_name((az_object_pool_t)i),
+             profile.peak_pool_live[i], profile.total_pool_dropped[i]);
+    }
+    printf("\n");
+  }
+}
+
+static int play_replay(const char *replay_path, int stop_frame) {
+  az_replay_t replay;
+  if (!az_load_replay_from_path(replay_path, &replay)) {
+    fprintf(stderr, "ERROR: failed to load replay from %s\n", replay_path);
+    return EXIT_FAILURE;
+  }
+  if (replay.saved_game.present &&
+      replay.saved_game.player.current_room >= planet.num_rooms) {
+    fprintf(stderr, "ERROR: replay starts in nonexistent room %d\n",
+            replay.saved_game.player.current_room);
+    az_destroy_replay(&replay);
+    return EXIT_FAILURE;
+  }
+  az_replay_playback_t playback;
+  az_init_replay_playback(&playback, &replay, &planet, &state);
+  if (profile_file != NULL) state.profile = &profile;
+
+  const uint64_t start_time = az_current_time_nanos();
+  write_hash(playback.cursor.frame);
+  while (playback.cursor.frame < stop_frame && az_replay_tick(&playback)) {
+    AZ_ZERO_OBJECT(&state.soundboard);
+    az_replay_after_tick(&playback);
+    write_hash(playback.cursor.frame);
+    write_profile(playback.cursor.frame);
+  }
+  const uint64_t elapsed = az_current_time_nanos() - start_time;
+
+  print_summary(playback.cursor.frame, elapsed);
+  if (playback.ended) printf("replay ended: action=%d\n", playback.action);
+  az_destroy_replay_playback(&playback);
+  az_destroy_replay(&replay);
+  return EXIT_SUCCESS;
+}
+
+static int print_usage(const char *program) {
+  fprintf(stderr, "Usage: %s [<options>] <room> <num_frames> "
+          "[<input_file>]\n"
+          "       %s [<options>] --replay <replay_file> [<stop_frame>]\n"
+          "       %s --diff-hashes <hash_file> <hash_file>\n"
+          "Options: --hashes <hash_file>  --profile <csv_file>\n",
+          program, program, program);
+  return EXIT_FAILURE;
+}
+
+int main(int argc, char **argv) {
+  const char *program = argv[0];
+  if (argc == 4 && strcmp(argv[1], "--diff-hashes") == 0) {
+    return az_diff_hash_files(argv[2], argv[3]);
+  }
+  atexit(close_output_files);
+  while (argc >= 3 && strncmp(argv[1], "--", 2) == 0 &&
+         strcmp(argv[1], "--replay") != 0) {
+    if (strcmp(argv[1], "--hashes") == 0 && hash_file == NULL) {
+      hash_file = open_output_file(argv[2], az_write_hash_header);
+    } else if (strcmp(argv[1], "--profile") == 0 && profile_file == NULL) {
+      profile_file = open_output_file(argv[2], az_write_profile_csv_header);
+      az_reset_tick_profile(&profile, az_current_time_nanos);
+    } else return print_usage(program);
+    argc -= 2;
+    argv += 2;
+  }
+  if (argc < 3 || argc > 4) return print_usage(program);
+  if (strcmp(argv[1], "--replay") == 0) {
+    int stop_frame = INT_MAX;
+    if (argc >= 4 && (sscanf(argv[3], "%d", &stop_frame) < 1 ||
+                      stop_frame < 0)) {
+      fprintf(stderr, "Invalid stop frame: %s\n", argv[3]);
+      return EXIT_FAILURE;
+    }
+    az_init_sound_datas();
+    az_init_baddie_datas();
+    az_init_wall_datas();
+    if (!load_scenario()) {
+      fprintf(stderr, "ERROR: failed to load scenario.\n");
+      return EXIT_FAILURE;
+    }
+    az_reset_prefs_to_defaults(&preferences);
+    return play_replay(argv[2], stop_frame);
+  }
+  int room_key = 0;
+  if (sscanf(argv[1], "%d", &room_key) < 1) {
+    fprintf(stderr, "Invalid room number: %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  int num_frames = 0;
+  if (sscanf(argv[2], "%d", &num_frames) < 1 || num_frames < 0) {
+    fprintf(stderr, "Invalid frame count: %s\n", argv[2]);
+    return EXIT_FAILURE;
+  }
+  FILE *input = NULL;
+  if (argc >= 4) {
+    input = fopen(argv[3], "r");
+    if (input == NULL) {
+      fprintf(stderr, "ERROR: could not open %s\n", argv[3]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  az_init_sound_datas();
+  az_init_baddie_datas();
+  az_init_wall_datas();
+  if (!load_scenario()) {
+    fprintf(stderr, "ERROR: failed to load scenario.\n");
+    return EXIT_FAILURE;
+  }
+  if (room_key < 0 || room_key >= planet.num_rooms) {
+    fprintf(stderr, "ERROR: no room %d (planet has %d rooms)\n",
+            room_key, planet.num_rooms);
+    return EXIT_FAILURE;
+  }
+  az_reset_prefs_to_defaults(&preferences);
+  begin_room(room_key);
+  if (profile_file != NULL) state.profile = &profile;
+
+  const uint64_t start_time = az_current_time_nanos();
+  write_hash(0);
+  for (int frame = 0; frame < num_frames; ++frame) {
+    read_controls(input, &state.ship.controls);
+    az_tick_space_state(&state, AZ_FRAME_TIME_SECONDS);
+    // Nothing ever drains the soundboard in a headless run, so just discard
+    // whatever the tick asked for.
+    AZ_ZERO_OBJECT(&state.soundboard);
+    AZ_ZERO_OBJECT(&state.ship.controls);
+    dismiss_prompts();
+    write_hash(frame + 1);
+    write_profile(frame + 1);
+  }
+  const uint64_t elapsed = az_current_time_nanos() - start_time;
+  if (input != NULL) fclose(input);
+
+  print_summary(num_frames, elapsed);
+  return EXIT_SUCCESS;
+}
+
+/*===========================================================================*/
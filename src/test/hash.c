@@ -0,0 +1,95 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include <stdbool.h>
+
+#include "azimuth/state/hash.h"
+#include "azimuth/state/planet.h"
+#include "azimuth/state/player.h"
+#include "azimuth/state/space.h"
+#include "azimuth/util/color.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/prefs.h"
+#include "azimuth/util/random.h"
+#include "azimuth/util/vector.h"
+#include "test/test.h"
+
+/*===========================================================================*/
+
+static az_space_state_t state1, state2;
+
+static void init_state(az_space_state_t *state, az_planet_t *planet,
+                       az_preferences_t *prefs) {
+  AZ_ZERO_OBJECT(state);
+  state->planet = planet;
+  state->prefs = prefs;
+  state->rng = (az_random_seed_t){7, 11};
+  az_init_player(&state->ship.player);
+  state->ship.position = (az_vector_t){10, 20};
+  az_set_message(state, "Hello");
+}
+
+// Return a bitmask of which hash parts differ between the two hashes.
+static int differing_parts(const az_space_hash_t *hash1,
+                           const az_space_hash_t *hash2) {
+  int mask = 0;
+  for (int i = 0; i < AZ_NUM_HASH_PARTS; ++i) {
+    if (hash1->parts[i] != hash2->parts[i]) mask |= (1 << i);
+  }
+  return mask;
+}
+
+void test_hash_space_state(void) {
+  az_planet_t planet1 = {0}, planet2 = {0};
+  az_preferences_t prefs1, prefs2;
+  az_reset_prefs_to_defaults(&prefs1);
+  az_reset_prefs_to_defaults(&prefs2);
+  az_space_hash_t hash1, hash2;
+
+  // Equal states should have equal hashes, even if they point to different
+  // (but equivalent) planets and preferences.
+  init_state(&state1, &planet1, &prefs1);
+  init_state(&state2, &planet2, &prefs2);
+  az_hash_space_state(&state1, &hash1);
+  az_hash_space_state(&state2, &hash2);
+  EXPECT_INT_EQ(0, differing_parts(&hash1, &hash2));
+
+  // Adding a speck should change only the specks hash.
+  az_add_speck(&state2, AZ_WHITE, 1.0, (az_vector_t){1, 2},
+               (az_vector_t){3, 4});
+  az_hash_space_state(&state2, &hash2);
+  EXPECT_INT_EQ(1 << AZ_HASH_SPECKS, differing_parts(&hash1, &hash2));
+
+  // Even the smallest change to the ship position should change the ship
+  // hash as well.
+  state2.ship.position.x += 1e-9;
+  az_hash_space_state(&state2, &hash2);
+  EXPECT_INT_EQ((1 << AZ_HASH_SPECKS) | (1 << AZ_HASH_SHIP),
+                differing_parts(&hash1, &hash2));
+
+  // Advancing the random seed changes the mode hash, and killing the speck
+  // should put the specks hash back the way it was.
+  az_rand_udouble(&state2.rng);
+  state2.specks.kind[0] = AZ_SPECK_NOTHING;
+  az_hash_space_state(&state2, &hash2);
+  EXPECT_INT_EQ((1 << AZ_HASH_MODE) | (1 << AZ_HASH_SHIP),
+                differing_parts(&hash1, &hash2));
+}
+
+/*===========================================================================*/
@@ -17,11 +17,16 @@
 | with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
 =============================================================================*/
 
+#include "azimuth/state/baddie.h"
+#include "azimuth/state/wall.h"
 #include "test/test.h"
 
 /*===========================================================================*/
 
 int main(int argc, char **argv) {
+  az_init_baddie_datas(); // needed by tests that add baddies
+  az_init_wall_datas(); // needed by tests that add walls
+
   RUN_TEST(test_alloc);
   RUN_TEST(test_arc_circle_hits_circle);
   RUN_TEST(test_arc_circle_hits_line);
@@ -29,11 +34,15 @@ int main(int argc, char **argv) {
   RUN_TEST(test_arc_circle_hits_point);
   RUN_TEST(test_arc_circle_hits_polygon);
   RUN_TEST(test_arc_circle_hits_polygon_trans);
+  RUN_TEST(test_arc_circle_impact);
   RUN_TEST(test_arc_ray_hits_circle);
   RUN_TEST(test_arc_ray_hits_line);
   RUN_TEST(test_arc_ray_hits_line_segment);
   RUN_TEST(test_arc_ray_hits_polygon);
   RUN_TEST(test_arc_ray_hits_polygon_trans);
+  RUN_TEST(test_arc_sweep_might_hit_circle);
+  RUN_TEST(test_baddie_bounds);
+  RUN_TEST(test_baddie_sweep);
   RUN_TEST(test_array_size);
   RUN_TEST(test_circle_hits_arc);
   RUN_TEST(test_circle_hits_circle);
@@ -54,17 +63,22 @@ int main(int argc, char **argv) {
   RUN_TEST(test_cubic_bezier_arc_length);
   RUN_TEST(test_cubic_bezier_arc_param);
   RUN_TEST(test_cubic_bezier_point);
+  RUN_TEST(test_decompose_polygon);
   RUN_TEST(test_find_knee);
+  RUN_TEST(test_gravfield_index);
+  RUN_TEST(test_hash_space_state);
   RUN_TEST(test_hint_matches);
   RUN_TEST(test_hsva_color);
   RUN_TEST(test_is_number_key);
   RUN_TEST(test_lead_target);
   RUN_TEST(test_modulo);
   RUN_TEST(test_mod2pi);
+  RUN_TEST(test_nearest_baddies);
   RUN_TEST(test_paragraph_length);
   RUN_TEST(test_paragraph_read);
   RUN_TEST(test_parse_music);
   RUN_TEST(test_parse_music_instructions);
+  RUN_TEST(test_particle_array);
   RUN_TEST(test_persist_sound);
   RUN_TEST(test_player_flags);
   RUN_TEST(test_player_give_upgrade);
@@ -72,10 +86,13 @@ int main(int argc, char **argv) {
   RUN_TEST(test_player_set_zone_mapped);
   RUN_TEST(test_polygon_contains);
   RUN_TEST(test_polygon_contains_circle);
+  RUN_TEST(test_polygon_soa);
   RUN_TEST(test_position_visible);
+  RUN_TEST(test_prebuilt_rooms);
   RUN_TEST(test_prefs_defaults);
   RUN_TEST(test_prefs_missing_values);
   RUN_TEST(test_prefs_save_load);
+  RUN_TEST(test_rand_seeded);
   RUN_TEST(test_randint);
   RUN_TEST(test_random);
   RUN_TEST(test_ray_hits_arc);
@@ -84,14 +101,20 @@ int main(int argc, char **argv) {
   RUN_TEST(test_ray_hits_line_segment);
   RUN_TEST(test_ray_hits_polygon);
   RUN_TEST(test_ray_hits_polygon_trans);
+  RUN_TEST(test_ray_blocked);
+  RUN_TEST(test_ray_impact_batch);
+  RUN_TEST(test_replay_record);
+  RUN_TEST(test_replay_save_load);
   RUN_TEST(test_script_clone);
   RUN_TEST(test_script_print);
   RUN_TEST(test_script_scan);
   RUN_TEST(test_select_gun);
   RUN_TEST(test_signmod);
   RUN_TEST(test_sound_volume);
+  RUN_TEST(test_space_snapshot);
   RUN_TEST(test_strdup);
   RUN_TEST(test_strprintf);
+  RUN_TEST(test_tick_profile);
   RUN_TEST(test_transition_color);
   RUN_TEST(test_uids);
   RUN_TEST(test_vaddlen);
@@ -102,6 +125,7 @@ int main(int argc, char **argv) {
   RUN_TEST(test_vrotate);
   RUN_TEST(test_vunit);
   RUN_TEST(test_vwithlen);
+  RUN_TEST(test_wall_decomps);
   RUN_TEST(test_zero_array);
   RUN_TEST(test_zero_object);
 
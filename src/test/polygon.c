@@ -21,6 +21,7 @@
 #include <stddef.h> // for NULL
 
 #include "azimuth/util/polygon.h"
+#include "azimuth/util/random.h"
 #include "azimuth/util/vector.h"
 #include "test/test.h"
 
@@ -1135,6 +1136,73 @@ void test_arc_circle_hits_polygon_trans(void) {
   EXPECT_VAPPROX(((az_vector_t){1, 0}), az_vunit(normal));
 }
 
+void test_arc_sweep_might_hit_circle(void) {
+  // A quarter turn counterclockwise from (10, 0) around the origin:
+  az_arc_sweep_t sweep;
+  az_init_arc_sweep(1.0, (az_vector_t){10, 0}, AZ_VZERO, AZ_HALF_PI, &sweep);
+  EXPECT_APPROX(-1.0, sweep.min.x);
+  EXPECT_APPROX(-1.0, sweep.min.y);
+  EXPECT_APPROX(11.0, sweep.max.x);
+  EXPECT_APPROX(11.0, sweep.max.y);
+  EXPECT_TRUE(az_arc_sweep_might_hit_circle(&sweep, (az_vector_t){7, 7}, 0.5));
+  EXPECT_FALSE(az_arc_sweep_might_hit_circle(&sweep, (az_vector_t){4, 4}, 0.5));
+  EXPECT_FALSE(az_arc_sweep_might_hit_circle(&sweep, (az_vector_t){10, -3},
+                                             1.0));
+  EXPECT_FALSE(az_arc_sweep_might_hit_circle(&sweep, (az_vector_t){-7, 7},
+                                             1.0));
+  // The same arc, traversed clockwise:
+  az_init_arc_sweep(1.0, (az_vector_t){0, 10}, AZ_VZERO, -AZ_HALF_PI, &sweep);
+  EXPECT_TRUE(az_arc_sweep_might_hit_circle(&sweep, (az_vector_t){7, 7}, 0.5));
+  EXPECT_FALSE(az_arc_sweep_might_hit_circle(&sweep, (az_vector_t){-7, 7},
+                                             1.0));
+
+  // For random sweeps, skipping circles that the sweep rejects must never
+  // change the result of the exact hit test, but most circles that aren't hit
+  // should get rejected.  The arcs go up to more than a full turn either way,
+  // and two thirds of the circles are centered on the ray from spin_center
+  // through the start or the end of the arc, so that they straddle it.
+  az_random_seed_t seed = {1357, 2468};
+  int hits = 0, wide_hits = 0, misses = 0, rejections = 0;
+  for (int trial = 0; trial < 20000; ++trial) {
+    const double circle_radius = (trial % 4 == 0 ? 0.0 :
+                                  az_rand_double(&seed, 0.0, 5.0));
+    const az_vector_t spin_center = az_rand_point_in_circle(&seed, 50.0);
+    const az_vector_t start = az_rand_point_in_circle(&seed, 50.0);
+    const double spin_angle = az_rand_double(&seed, -7.0, 7.0);
+    az_vector_t center = az_rand_point_in_circle(&seed, 100.0);
+    if (trial % 3 != 0) {
+      const az_vector_t rel = az_vsub(start, spin_center);
+      center = az_vadd(spin_center, az_vmul(
+          (trial % 3 == 1 ? rel : az_vrotate(rel, spin_angle)),
+          az_rand_double(&seed, 0.5, 1.5)));
+    }
+    const double radius = az_rand_double(&seed, 0.0, 20.0);
+    az_init_arc_sweep(circle_radius, start, spin_center, spin_angle, &sweep);
+    const bool might_hit = az_arc_sweep_might_hit_circle(&sweep, center,
+                                                         radius);
+    double angle1 = 99999, angle2 = 99999;
+    az_vector_t pos1 = nix, pos2 = nix;
+    const bool hit = az_arc_circle_hits_circle(
+        radius, center, circle_radius, start, spin_center, spin_angle,
+        &angle1, &pos1, NULL);
+    const bool filtered_hit = might_hit && az_arc_circle_hits_circle(
+        radius, center, circle_radius, start, spin_center, spin_angle,
+        &angle2, &pos2, NULL);
+    if (hit) {
+      ++hits;
+      if (fabs(spin_angle) > AZ_PI) ++wide_hits;
+    } else if (!might_hit) ++rejections;
+    if (hit != filtered_hit ||
+        (hit && (angle1 != angle2 || pos1.x != pos2.x || pos1.y != pos2.y))) {
+      ++misses;
+    }
+  }
+  EXPECT_INT_EQ(0, misses);
+  EXPECT_TRUE(hits > 2000);
+  EXPECT_TRUE(wide_hits > 1000);
+  EXPECT_TRUE(rejections > 5000);
+}
+
 /*===========================================================================*/
 
 void test_find_knee(void) {
@@ -1188,3 +1256,128 @@ void test_lead_target(void) {
 }
 
 /*===========================================================================*/
+
+// Check that every available implementation of the *_soa functions gives
+// exactly the same answers as the scalar functions they mirror.
+void test_polygon_soa(void) {
+  const az_polygon_impl_t original_impl = az_get_polygon_impl();
+  for (int impl = AZ_POLYGON_SCALAR; impl <= AZ_POLYGON_AVX2; ++impl) {
+    if (!az_set_polygon_impl(impl)) continue;
+    az_random_seed_t seed = {12345, 67890};
+    int mismatches = 0;
+    for (int trial = 0; trial < 100; ++trial) {
+      // Make a random star-shaped polygon with 3 to 24 vertices.
+      const int num_vertices = az_rand_int(&seed, 3, 24);
+      const az_vector_t position = az_rand_point_in_circle(&seed, 5.0);
+      az_vector_t vertices[24];
+      double xs[25], ys[25];
+      for (int i = 0; i < num_vertices; ++i) {
+        vertices[i] = az_vadd(position, az_vpolar(
+            az_rand_double(&seed, 1.0, 10.0), AZ_TWO_PI * i / num_vertices));
+        xs[i] = vertices[i].x;
+        ys[i] = vertices[i].y;
+      }
+      xs[num_vertices] = xs[0];
+      ys[num_vertices] = ys[0];
+      const az_polygon_t polygon = {num_vertices, vertices};
+      const az_polygon_soa_t soa = {num_vertices, xs, ys};
+      for (int query = 0; query < 50; ++query) {
+        const az_vector_t start = az_rand_point_in_circle(&seed, 15.0);
+        const az_vector_t delta = az_rand_point_in_circle(&seed, 30.0);
+        const double radius = az_rand_double(&seed, 0.0, 3.0);
+        if (az_polygon_contains(polygon, start) !=
+            az_polygon_contains_soa(soa, start)) ++mismatches;
+        az_vector_t pos1 = nix, normal1 = nix, pos2 = nix, normal2 = nix;
+        if (az_ray_hits_polygon(polygon, start, delta, &pos1, &normal1) !=
+            az_ray_hits_polygon_soa(soa, start, delta, &pos2, &normal2) ||
+            pos1.x != pos2.x || pos1.y != pos2.y ||
+            normal1.x != normal2.x || normal1.y != normal2.y) ++mismatches;
+        pos1 = normal1 = pos2 = normal2 = nix;
+        if (az_circle_hits_polygon(polygon, radius, start, delta,
+                                   &pos1, &normal1) !=
+            az_circle_hits_polygon_soa(soa, radius, start, delta,
+                                       &pos2, &normal2) ||
+            pos1.x != pos2.x || pos1.y != pos2.y ||
+            normal1.x != normal2.x || normal1.y != normal2.y) ++mismatches;
+      }
+    }
+    EXPECT_INT_EQ(0, mismatches);
+  }
+  EXPECT_TRUE(az_set_polygon_impl(original_impl));
+}
+
+void test_decompose_polygon(void) {
+  // An L-shape splits into two rectangles (in either orientation).
+  const az_vector_t l_shape[] = {{0, 0}, {2, 0}, {2, 1}, {1, 1}, {1, 3},
+                                 {0, 3}};
+  az_vector_t l_reversed[AZ_ARRAY_SIZE(l_shape)];
+  for (int i = 0; i < AZ_ARRAY_SIZE(l_shape); ++i) {
+    l_reversed[i] = l_shape[AZ_ARRAY_SIZE(l_shape) - 1 - i];
+  }
+  const az_polygon_t l_polygon = AZ_INIT_POLYGON(l_shape);
+  const az_polygon_t l_reversed_polygon = AZ_INIT_POLYGON(l_reversed);
+  az_convex_decomp_t decomp;
+  EXPECT_TRUE(az_decompose_polygon(l_polygon, &decomp));
+  EXPECT_INT_EQ(2, decomp.num_pieces);
+  EXPECT_TRUE((decomp.pieces[0].edges | decomp.pieces[1].edges) == 0x3f);
+  EXPECT_TRUE(az_decompose_polygon(l_reversed_polygon, &decomp));
+  EXPECT_INT_EQ(2, decomp.num_pieces);
+  // A path that misses every piece has no candidate edges, but one that
+  // starts inside the polygon always does.
+  EXPECT_TRUE(az_convex_decomp_edges(&decomp, 0.0, (az_vector_t){1.5, 1.5},
+                                     (az_vector_t){1, 1}) == 0);
+  EXPECT_TRUE(az_convex_decomp_edges(&decomp, 1.0, (az_vector_t){1.5, 1.5},
+                                     (az_vector_t){1, 1}) != 0);
+  EXPECT_TRUE(az_convex_decomp_edges(&decomp, 0.0, (az_vector_t){0.5, 2},
+                                     AZ_VZERO) != 0);
+
+  // For random star-shaped (and so mostly concave) polygons, testing only the
+  // candidate edges should give exactly the same results as testing them all.
+  az_random_seed_t seed = {2468, 1357};
+  int mismatches = 0;
+  for (int trial = 0; trial < 100; ++trial) {
+    const int num_vertices = 2 * az_rand_int(&seed, 3, 12);
+    az_vector_t vertices[24];
+    double xs[25], ys[25];
+    for (int i = 0; i < num_vertices; ++i) {
+      const double radius = (i % 2 ? az_rand_double(&seed, 1.0, 5.0) :
+                             az_rand_double(&seed, 6.0, 10.0));
+      vertices[i] = az_vpolar(radius, AZ_TWO_PI * i / num_vertices);
+      xs[i] = vertices[i].x;
+      ys[i] = vertices[i].y;
+    }
+    xs[num_vertices] = xs[0];
+    ys[num_vertices] = ys[0];
+    const az_polygon_t polygon = {num_vertices, vertices};
+    const az_polygon_soa_t soa = {num_vertices, xs, ys};
+    if (!az_decompose_polygon(polygon, &decomp)) {
+      ++mismatches;
+      continue;
+    }
+    for (int query = 0; query < 50; ++query) {
+      const az_vector_t start = az_rand_point_in_circle(&seed, 15.0);
+      const az_vector_t delta = az_rand_point_in_circle(&seed, 30.0);
+      const double radius = az_rand_double(&seed, 0.0, 3.0);
+      az_vector_t pos1 = nix, normal1 = nix, pos2 = nix, normal2 = nix;
+      uint64_t edges = az_convex_decomp_edges(&decomp, 0.0, start, delta);
+      if (az_ray_hits_polygon_soa(soa, start, delta, &pos1, &normal1) !=
+          (edges != 0 &&
+           az_ray_hits_polygon_soa_edges(soa, edges, start, delta,
+                                         &pos2, &normal2)) ||
+          pos1.x != pos2.x || pos1.y != pos2.y ||
+          normal1.x != normal2.x || normal1.y != normal2.y) ++mismatches;
+      pos1 = normal1 = pos2 = normal2 = nix;
+      edges = az_convex_decomp_edges(&decomp, radius, start, delta);
+      if (az_circle_hits_polygon_soa(soa, radius, start, delta,
+                                     &pos1, &normal1) !=
+          (edges != 0 &&
+           az_circle_hits_polygon_soa_edges(soa, edges, radius, start, delta,
+                                            &pos2, &normal2)) ||
+          pos1.x != pos2.x || pos1.y != pos2.y ||
+          normal1.x != normal2.x || normal1.y != normal2.y) ++mismatches;
+    }
+  }
+  EXPECT_INT_EQ(0, mismatches);
+}
+
+/*===========================================================================*/
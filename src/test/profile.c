@@ -0,0 +1,99 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "azimuth/state/baddie.h"
+#include "azimuth/state/profile.h"
+#include "test/test.h"
+
+/*===========================================================================*/
+
+static az_tick_profile_t profile;
+
+// A stand-in clock for the profile, which never advances.
+static uint64_t fake_clock(void) {
+  return 1234;
+}
+
+void test_tick_profile(void) {
+  az_reset_tick_profile(&profile, fake_clock);
+  EXPECT_TRUE(profile.clock == fake_clock);
+
+  // Whatever time isn't accounted for by the other sections goes to "other".
+  az_begin_profiled_tick(&profile);
+  profile.section_nanos[AZ_PROF_SHIP] = 100;
+  profile.section_nanos[AZ_PROF_BADDIES] = 300;
+  profile.baddie_nanos[AZ_BAD_ZIPPER] = 300;
+  az_end_profiled_tick(&profile, 1000);
+  EXPECT_INT_EQ(600, profile.section_nanos[AZ_PROF_OTHER]);
+  EXPECT_APPROX(1000.0, profile.average_total);
+  EXPECT_APPROX(300.0, profile.average_baddies[AZ_BAD_ZIPPER]);
+
+  // Beginning a new tick clears the previous tick's timings, but not the
+  // averages.
+  az_begin_profiled_tick(&profile);
+  EXPECT_INT_EQ(0, profile.section_nanos[AZ_PROF_SHIP]);
+  EXPECT_INT_EQ(0, profile.baddie_nanos[AZ_BAD_ZIPPER]);
+  profile.section_nanos[AZ_PROF_SHIP] = 3000;
+  az_end_profiled_tick(&profile, 2000);
+  EXPECT_INT_EQ(0, profile.section_nanos[AZ_PROF_OTHER]);
+  EXPECT_APPROX(1500.0, profile.average_total);
+  EXPECT_APPROX(150.0, profile.average_baddies[AZ_BAD_ZIPPER]);
+  EXPECT_INT_EQ(2000, az_peak_tick_nanos(&profile));
+
+  // Once a hitch is more than AZ_PROFILE_WINDOW ticks old, it no longer
+  // counts as the peak.
+  for (int i = 0; i < AZ_PROFILE_WINDOW; ++i) {
+    az_begin_profiled_tick(&profile);
+    az_end_profiled_tick(&profile, 500);
+  }
+  EXPECT_INT_EQ(500, az_peak_tick_nanos(&profile));
+  EXPECT_TRUE(profile.average_total > 500.0);
+  EXPECT_TRUE(profile.average_total < 1500.0);
+
+  // Object array usage peaks over all ticks, while dropped objects are
+  // counted per tick and in total.
+  az_begin_profiled_tick(&profile);
+  profile.pool_live[AZ_POOL_SPECKS] = 700;
+  profile.pool_dropped[AZ_POOL_SPECKS] = 3;
+  az_end_profiled_tick(&profile, 500);
+  az_begin_profiled_tick(&profile);
+  EXPECT_INT_EQ(0, profile.pool_dropped[AZ_POOL_SPECKS]);
+  profile.pool_live[AZ_POOL_SPECKS] = 200;
+  profile.pool_dropped[AZ_POOL_SPECKS] = 2;
+  az_end_profiled_tick(&profile, 500);
+  EXPECT_INT_EQ(700, profile.peak_pool_live[AZ_POOL_SPECKS]);
+  EXPECT_INT_EQ(5, profile.total_pool_dropped[AZ_POOL_SPECKS]);
+  EXPECT_STRING_EQ("walls", az_object_pool_name(AZ_POOL_WALLS));
+
+  // Baddie kind names are used as CSV column names, and must fit in the
+  // overlay's 22-character name column.
+  EXPECT_STRING_EQ("zipper", az_baddie_kind_name(AZ_BAD_ZIPPER));
+  int num_bad_names = 0;
+  for (int kind = 1; kind <= AZ_NUM_BADDIE_KINDS; ++kind) {
+    const char *name = az_baddie_kind_name((az_baddie_kind_t)kind);
+    if (strlen(name) == 0 || strlen(name) > 22 ||
+        strpbrk(name, " ,") != NULL) ++num_bad_names;
+  }
+  EXPECT_INT_EQ(0, num_bad_names);
+}
+
+/*===========================================================================*/
@@ -23,6 +23,27 @@
 
 /*===========================================================================*/
 
+void test_rand_seeded(void) {
+  // Two generators started from the same seed should produce the same
+  // sequence, independent of each other and of the global generator.
+  az_random_seed_t seed1 = {1, 1}, seed2 = {1, 1};
+  for (int i = 0; i < 100; ++i) {
+    const double r = az_rand_double(&seed1, -2.0, 3.0);
+    ASSERT_TRUE(r >= -2.0);
+    ASSERT_TRUE(r < 3.0);
+    az_random(0.0, 1.0);
+    EXPECT_TRUE(az_rand_double(&seed2, -2.0, 3.0) == r);
+  }
+  for (int i = 0; i < 100; ++i) {
+    const int r = az_rand_int(&seed1, -7, 5);
+    ASSERT_TRUE(r >= -7);
+    ASSERT_TRUE(r <= 5);
+    EXPECT_INT_EQ(r, az_rand_int(&seed2, -7, 5));
+  }
+  EXPECT_INT_EQ(seed1.z, seed2.z);
+  EXPECT_INT_EQ(seed1.w, seed2.w);
+}
+
 void test_random(void) {
   EXPECT_TRUE(az_random(3.5, 3.5) == 3.5);
   EXPECT_TRUE(az_random(-1.25, -1.25) == -1.25);
@@ -0,0 +1,142 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "azimuth/state/player.h"
+#include "azimuth/state/replay.h"
+#include "azimuth/state/save.h"
+#include "azimuth/state/ship.h"
+#include "azimuth/util/key.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/prefs.h"
+#include "test/test.h"
+
+/*===========================================================================*/
+
+static void record_test_replay(az_replay_t *replay) {
+  az_saved_games_t saved_games;
+  az_reset_saved_games(&saved_games);
+  az_saved_game_t *saved_game = &saved_games.games[1];
+  saved_game->present = true;
+  az_init_player(&saved_game->player);
+  saved_game->player.current_room = 17;
+  saved_game->player.total_time = 1234.0 / 3.0;
+  saved_game->player.shields = 0.1;
+  az_preferences_t prefs;
+  az_reset_prefs_to_defaults(&prefs);
+  prefs.key_for_control[AZ_CONTROL_FIRE] = AZ_KEY_Q;
+  az_init_replay(replay, &saved_games, &prefs, 1);
+
+  az_controls_t controls = { .up_held = true, .fire_held = true };
+  for (int i = 0; i < 100; ++i) az_replay_record_frame(replay, &controls);
+  az_replay_record_key_down(replay, AZ_KEY_RETURN);
+  az_replay_record_frame(replay, &controls);
+  controls.fire_held = false;
+  az_replay_record_frame(replay, &controls);
+  az_replay_record_save(replay, true);
+  az_player_t player = saved_game->player;
+  player.gun1 = AZ_GUN_CHARGE;
+  az_replay_record_paused(replay, false, &player);
+  az_replay_record_rebind(replay, AZ_CONTROL_UP, AZ_KEY_W);
+  az_replay_record_frame(replay, &controls);
+  az_replay_record_end(replay, 2);
+}
+
+static void expect_test_replay(const az_replay_t *replay) {
+  EXPECT_INT_EQ(1, replay->saved_game_index);
+  EXPECT_TRUE(replay->saved_game.present);
+  EXPECT_INT_EQ(17, replay->saved_game.player.current_room);
+  EXPECT_TRUE(replay->saved_game.player.total_time == 1234.0 / 3.0);
+  EXPECT_TRUE(replay->saved_game.player.shields == 0.1);
+  EXPECT_INT_EQ(AZ_KEY_Q, replay->prefs.key_for_control[AZ_CONTROL_FIRE]);
+  EXPECT_INT_EQ(103, replay->num_frames);
+  // The first 100 frames should have been run-length encoded into one record.
+  EXPECT_INT_EQ(9, replay->num_records);
+
+  az_replay_cursor_t cursor = {0};
+  uint8_t held;
+  az_key_id_t key;
+  bool save_ok;
+  int action;
+  for (int i = 0; i < 99; ++i) {
+    ASSERT_TRUE(az_replay_next_frame(replay, &cursor, &held));
+    EXPECT_FALSE(az_replay_next_key_down(replay, &cursor, &key));
+  }
+  ASSERT_TRUE(az_replay_next_frame(replay, &cursor, &held));
+  az_controls_t controls = {0};
+  az_set_held_controls(&controls, held);
+  EXPECT_TRUE(controls.up_held && controls.fire_held);
+  EXPECT_FALSE(controls.down_held || controls.left_held ||
+               controls.right_held || controls.ordn_held ||
+               controls.util_held);
+  EXPECT_FALSE(az_replay_next_save(replay, &cursor, &save_ok));
+  ASSERT_TRUE(az_replay_next_key_down(replay, &cursor, &key));
+  EXPECT_INT_EQ(AZ_KEY_RETURN, key);
+  EXPECT_FALSE(az_replay_next_key_down(replay, &cursor, &key));
+  ASSERT_TRUE(az_replay_next_frame(replay, &cursor, &held));
+  ASSERT_TRUE(az_replay_next_frame(replay, &cursor, &held));
+  az_set_held_controls(&controls, held);
+  EXPECT_TRUE(controls.up_held);
+  EXPECT_FALSE(controls.fire_held);
+  ASSERT_TRUE(az_replay_next_save(replay, &cursor, &save_ok));
+  EXPECT_TRUE(save_ok);
+  const az_replay_record_t *paused = az_replay_next_paused(replay, &cursor);
+  ASSERT_TRUE(paused != NULL);
+  EXPECT_FALSE(paused->data.paused.exit_to_title);
+  EXPECT_INT_EQ(AZ_GUN_CHARGE, paused->data.paused.gun1);
+  az_control_id_t control;
+  ASSERT_TRUE(az_replay_next_rebind(replay, &cursor, &control, &key));
+  EXPECT_INT_EQ(AZ_CONTROL_UP, control);
+  EXPECT_INT_EQ(AZ_KEY_W, key);
+  EXPECT_FALSE(az_replay_next_end(replay, &cursor, &action));
+  ASSERT_TRUE(az_replay_next_frame(replay, &cursor, &held));
+  EXPECT_FALSE(az_replay_next_frame(replay, &cursor, &held));
+  ASSERT_TRUE(az_replay_next_end(replay, &cursor, &action));
+  EXPECT_INT_EQ(2, action);
+  EXPECT_INT_EQ(103, cursor.frame);
+}
+
+void test_replay_record(void) {
+  az_replay_t replay;
+  record_test_replay(&replay);
+  expect_test_replay(&replay);
+  az_destroy_replay(&replay);
+}
+
+void test_replay_save_load(void) {
+  az_replay_t expected_replay, actual_replay;
+  record_test_replay(&expected_replay);
+  {
+    FILE *file = tmpfile();
+    ASSERT_TRUE(file != NULL);
+    EXPECT_TRUE(az_save_replay_to_file(&expected_replay, file));
+    rewind(file);
+    EXPECT_TRUE(az_load_replay_from_file(file, &actual_replay));
+    fclose(file);
+  }
+  az_destroy_replay(&expected_replay);
+  RETURN_IF_FAILED();
+  expect_test_replay(&actual_replay);
+  az_destroy_replay(&actual_replay);
+}
+
+/*===========================================================================*/
@@ -0,0 +1,956 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "azimuth/state/baddie.h"
+#include "azimuth/state/door.h"
+#include "azimuth/state/gravfield.h"
+#include "azimuth/state/node.h"
+#include "azimuth/state/particle.h"
+#include "azimuth/state/planet.h"
+#include "azimuth/state/room.h"
+#include "azimuth/state/space.h"
+#include "azimuth/state/upgrade.h"
+#include "azimuth/state/wall.h"
+#include "azimuth/util/color.h"
+#include "azimuth/util/misc.h"
+#include "azimuth/util/prefs.h"
+#include "azimuth/util/random.h"
+#include "azimuth/util/vector.h"
+#include "test/test.h"
+
+/*===========================================================================*/
+
+static az_space_state_t state1, state2;
+static az_space_snapshot_t snapshot;
+
+// Check that az_ray_impact and az_circle_impact give the same results for
+// state1 whether or not its baddie sweep index is used.
+static void check_sweep_impacts(az_vector_t start, az_vector_t delta) {
+  for (int i = 0; i < 2; ++i) {
+    const double radius = 5.0 * i;
+    az_impact_t with_sweep, without_sweep;
+    az_circle_impact(&state1, radius, start, delta, AZ_IMPF_NONE,
+                     AZ_NULL_UID, &with_sweep);
+    const az_baddie_sweep_t sweep = state1.baddie_sweep;
+    az_invalidate_baddie_sweep(&state1);
+    az_circle_impact(&state1, radius, start, delta, AZ_IMPF_NONE,
+                     AZ_NULL_UID, &without_sweep);
+    state1.baddie_sweep = sweep;
+    EXPECT_INT_EQ(without_sweep.type, with_sweep.type);
+    EXPECT_VAPPROX(without_sweep.position, with_sweep.position);
+    if (without_sweep.type == AZ_IMP_BADDIE &&
+        with_sweep.type == AZ_IMP_BADDIE) {
+      EXPECT_TRUE(without_sweep.target.baddie.baddie ==
+                  with_sweep.target.baddie.baddie);
+    }
+  }
+}
+
+// Add a diagonal row of twenty boxes to state1, from (0, 0) to (1900, 323).
+static void add_box_row(void) {
+  for (int i = 0; i < 20; ++i) {
+    az_add_baddie(&state1, AZ_BAD_BOX, (az_vector_t){100.0 * i, 17.0 * i},
+                  0.0);
+  }
+}
+
+static az_room_t impact_rooms[2];
+static az_planet_t impact_planet = {.num_rooms = 2, .rooms = impact_rooms};
+
+// Set up state1 in room 0 of impact_planet, which has the row of boxes, the
+// ship, a closed door leading to room 1, a pool of water, and walls of
+// several kinds (including a weak wall just in front of a strong one).
+static void enter_impact_room(az_preferences_t *prefs) {
+  static az_door_spec_t doors[1];
+  static az_gravfield_spec_t gravfields[1];
+  static az_wall_spec_t walls[5];
+  doors[0] = (az_door_spec_t){.kind = AZ_DOOR_NORMAL,
+                              .position = {-400, 0}, .destination = 1};
+  gravfields[0] = (az_gravfield_spec_t){
+    .kind = AZ_GRAV_WATER, .position = {0, -300}, .angle = -AZ_HALF_PI,
+    .strength = 1.0, .size.trapezoid = {.front_semiwidth = 150,
+                                        .rear_semiwidth = 120,
+                                        .semilength = 50}};
+  walls[0] = (az_wall_spec_t){.kind = AZ_WALL_INDESTRUCTIBLE,
+                              .data = az_get_wall_data(1),
+                              .position = {2300, 200}};
+  walls[1] = (az_wall_spec_t){.kind = AZ_WALL_DESTRUCTIBLE_ROCKET,
+                              .data = az_get_wall_data(0),
+                              .position = {1000, -200}};
+  walls[2] = (az_wall_spec_t){.kind = AZ_WALL_INDESTRUCTIBLE,
+                              .data = az_get_wall_data(0),
+                              .position = {1000, -400}};
+  walls[3] = (az_wall_spec_t){.kind = AZ_WALL_DESTRUCTIBLE_CHARGED,
+                              .data = az_get_wall_data(2),
+                              .position = {600, 600}, .angle = 1.0};
+  walls[4] = (az_wall_spec_t){.kind = AZ_WALL_DESTRUCTIBLE_BOMB,
+                              .data = az_get_wall_data(1),
+                              .position = {-300, 500}, .angle = 0.5};
+  const az_camera_bounds_t bounds = {.r_span = 3000, .theta_span = 6.3};
+  impact_rooms[0] = (az_room_t){
+    .camera_bounds = bounds,
+    .num_doors = AZ_ARRAY_SIZE(doors), .doors = doors,
+    .num_gravfields = AZ_ARRAY_SIZE(gravfields), .gravfields = gravfields,
+    .num_walls = AZ_ARRAY_SIZE(walls), .walls = walls};
+  impact_rooms[1] = (az_room_t){.camera_bounds = bounds};
+  AZ_ZERO_OBJECT(&state1);
+  state1.planet = &impact_planet;
+  state1.prefs = prefs;
+  state1.ship.player.shields = 100.0;
+  state1.ship.position = (az_vector_t){1500, -300};
+  az_enter_room(&state1, &impact_rooms[0]);
+  add_box_row();
+  az_build_baddie_sweep(&state1);
+}
+
+// A reference version of az_ray_impact for state1, which tests every object
+// in the same order that az_ray_impact does, but without using the wall
+// grid, the baddie sweep, the liquid index, or baddie bounds.
+static void slow_ray_impact(az_vector_t start, az_vector_t delta,
+                            az_impact_flags_t skip_types, az_uid_t skip_uid,
+                            az_impact_t *impact) {
+  impact->type = AZ_IMP_NOTHING;
+  if (!(skip_types & AZ_IMPF_WALL)) {
+    AZ_ARRAY_LOOP(wall, state1.walls) {
+      if (wall->kind == AZ_WALL_NOTHING) continue;
+      if ((skip_types & AZ_IMPF_WEAK_WALL) &&
+          (wall->kind == AZ_WALL_DESTRUCTIBLE_CHARGED ||
+           wall->kind == AZ_WALL_DESTRUCTIBLE_ROCKET)) continue;
+      if (az_ray_hits_wall(wall, start, delta, &impact->position,
+                           &impact->normal)) {
+        impact->type = AZ_IMP_WALL;
+        impact->target.wall = wall;
+        delta = az_vsub(impact->position, start);
+      }
+    }
+  }
+  AZ_ARRAY_LOOP(door, state1.doors) {
+    if (door->kind == AZ_DOOR_NOTHING) continue;
+    if (!(skip_types & AZ_IMPF_DOOR_INSIDE) &&
+        az_ray_hits_door_inside(door, start, delta, &impact->position,
+                                &impact->normal)) {
+      impact->type = AZ_IMP_DOOR_INSIDE;
+      impact->target.door = door;
+      delta = az_vsub(impact->position, start);
+    }
+    if (!(skip_types & AZ_IMPF_DOOR_OUTSIDE) &&
+        az_ray_hits_door_outside(door, start, delta, &impact->position,
+                                 &impact->normal)) {
+      impact->type = AZ_IMP_DOOR_OUTSIDE;
+      impact->target.door = door;
+      delta = az_vsub(impact->position, start);
+    }
+  }
+  if (skip_types & AZ_IMPF_NOT_LIQUID) {
+    AZ_ARRAY_LOOP(gravfield, state1.gravfields) {
+      if (!az_is_liquid(gravfield->kind)) continue;
+      if (az_ray_hits_liquid_surface(gravfield, start, delta,
+                                     &impact->position, &impact->normal)) {
+        impact->type = AZ_IMP_LIQUID_SURFACE;
+        impact->target.gravfield = gravfield;
+        delta = az_vsub(impact->position, start);
+      }
+    }
+  }
+  if (!(skip_types & AZ_IMPF_SHIP) && skip_uid != AZ_SHIP_UID &&
+      az_ship_is_alive(&state1.ship) &&
+      az_ray_hits_ship(&state1.ship, start, delta, &impact->position,
+                       &impact->normal)) {
+    impact->type = AZ_IMP_SHIP;
+    delta = az_vsub(impact->position, start);
+  }
+  const bool skip_non_wall_like_baddies = (skip_types & AZ_IMPF_BADDIE);
+  if (!skip_non_wall_like_baddies ||
+      (skip_types & AZ_IMPF_NOT_WALL_LIKE_BADDIE)) {
+    AZ_ARRAY_LOOP(baddie, state1.baddies) {
+      if (baddie->kind == AZ_BAD_NOTHING) continue;
+      if (az_baddie_has_flag(baddie, AZ_BADF_INCORPOREAL)) continue;
+      if (baddie->uid == skip_uid) continue;
+      if (skip_non_wall_like_baddies &&
+          !az_baddie_has_flag(baddie, AZ_BADF_WALL_LIKE)) continue;
+      const az_component_data_t *component;
+      if (az_ray_hits_baddie(baddie, NULL, start, delta, &impact->position,
+                             &impact->normal, &component)) {
+        impact->type = AZ_IMP_BADDIE;
+        impact->target.baddie.baddie = baddie;
+        impact->target.baddie.component = component;
+        delta = az_vsub(impact->position, start);
+      }
+    }
+  }
+}
+
+// Determine if two impacts are exactly the same.
+static bool same_impact(const az_impact_t *impact1,
+                        const az_impact_t *impact2) {
+  if (impact1->type != impact2->type) return false;
+  if (impact1->type == AZ_IMP_NOTHING) return true;
+  if (impact1->position.x != impact2->position.x ||
+      impact1->position.y != impact2->position.y ||
+      impact1->normal.x != impact2->normal.x ||
+      impact1->normal.y != impact2->normal.y) return false;
+  switch (impact1->type) {
+    case AZ_IMP_BADDIE:
+      return (impact1->target.baddie.baddie ==
+              impact2->target.baddie.baddie &&
+              impact1->target.baddie.component ==
+              impact2->target.baddie.component);
+    case AZ_IMP_DOOR_INSIDE:
+    case AZ_IMP_DOOR_OUTSIDE:
+      return impact1->target.door == impact2->target.door;
+    case AZ_IMP_LIQUID_SURFACE:
+      return impact1->target.gravfield == impact2->target.gravfield;
+    case AZ_IMP_WALL:
+      return impact1->target.wall == impact2->target.wall;
+    default: return true;
+  }
+}
+
+// Pick a random point near one of state1's objects (chosen at random).
+static az_vector_t random_target(az_random_seed_t *seed) {
+  az_vector_t targets[AZ_MAX_NUM_BADDIES + AZ_MAX_NUM_WALLS + 3];
+  int num_targets = 0;
+  targets[num_targets++] = state1.ship.position;
+  targets[num_targets++] = state1.gravfields[0].position;
+  targets[num_targets++] = state1.doors[0].position;
+  AZ_ARRAY_LOOP(wall, state1.walls) {
+    if (wall->kind != AZ_WALL_NOTHING) targets[num_targets++] = wall->position;
+  }
+  AZ_ARRAY_LOOP(baddie, state1.baddies) {
+    if (baddie->kind != AZ_BAD_NOTHING) {
+      targets[num_targets++] = baddie->position;
+    }
+  }
+  return az_vadd(targets[az_rand_int(seed, 0, num_targets - 1)],
+                 az_rand_point_in_circle(seed, 30.0));
+}
+
+// Pick a random ray starting somewhere in the impact room and aimed past one
+// of state1's objects, so that most rays hit something.
+static az_ray_t random_aimed_ray(az_random_seed_t *seed) {
+  const az_vector_t start = az_vadd((az_vector_t){900, 0},
+                                    az_rand_point_in_circle(seed, 1600.0));
+  const az_vector_t target = random_target(seed);
+  return (az_ray_t){.start = start,
+                    .delta = az_vmul(az_vsub(target, start), 1.5)};
+}
+
+// A reference version of az_arc_circle_impact for state1, which tests every
+// object in the same order that az_arc_circle_impact does, but without first
+// checking whether the object is within the arc's swept region.
+static void slow_arc_circle_impact(
+    double circle_radius, az_vector_t start, az_vector_t spin_center,
+    double spin_angle, az_impact_flags_t skip_types, az_impact_t *impact) {
+  impact->type = AZ_IMP_NOTHING;
+  az_vector_t *position = &impact->position, *normal = &impact->normal;
+  if (!(skip_types & AZ_IMPF_WALL)) {
+    AZ_ARRAY_LOOP(wall, state1.walls) {
+      if (wall->kind == AZ_WALL_NOTHING) continue;
+      if ((skip_types & AZ_IMPF_WEAK_WALL) &&
+          (wall->kind == AZ_WALL_DESTRUCTIBLE_CHARGED ||
+           wall->kind == AZ_WALL_DESTRUCTIBLE_ROCKET)) continue;
+      if (az_arc_circle_hits_wall(wall, circle_radius, start, spin_center,
+                                  spin_angle, &spin_angle, position, normal)) {
+        impact->type = AZ_IMP_WALL;
+        impact->target.wall = wall;
+      }
+    }
+  }
+  AZ_ARRAY_LOOP(door, state1.doors) {
+    if (door->kind == AZ_DOOR_NOTHING) continue;
+    if (!(skip_types & AZ_IMPF_DOOR_INSIDE) &&
+        az_arc_circle_hits_door_inside(
+            door, circle_radius, start, spin_center, spin_angle,
+            &spin_angle, position, normal)) {
+      impact->type = AZ_IMP_DOOR_INSIDE;
+      impact->target.door = door;
+    }
+    if (!(skip_types & AZ_IMPF_DOOR_OUTSIDE) &&
+        az_arc_circle_hits_door_outside(
+            door, circle_radius, start, spin_center, spin_angle,
+            &spin_angle, position, normal)) {
+      impact->type = AZ_IMP_DOOR_OUTSIDE;
+      impact->target.door = door;
+    }
+  }
+  if (!(skip_types & AZ_IMPF_SHIP) && az_ship_is_alive(&state1.ship) &&
+      az_arc_circle_hits_ship(&state1.ship, circle_radius, start,
+                              spin_center, spin_angle, &spin_angle,
+                              position, normal)) {
+    impact->type = AZ_IMP_SHIP;
+  }
+  const bool skip_non_wall_like_baddies = (skip_types & AZ_IMPF_BADDIE);
+  if (!skip_non_wall_like_baddies ||
+      (skip_types & AZ_IMPF_NOT_WALL_LIKE_BADDIE)) {
+    AZ_ARRAY_LOOP(baddie, state1.baddies) {
+      if (baddie->kind == AZ_BAD_NOTHING) continue;
+      if (az_baddie_has_flag(baddie, AZ_BADF_INCORPOREAL)) continue;
+      if (skip_non_wall_like_baddies &&
+          !az_baddie_has_flag(baddie, AZ_BADF_WALL_LIKE)) continue;
+      const az_component_data_t *component;
+      if (az_arc_circle_hits_baddie(
+              baddie, NULL, circle_radius, start, spin_center, spin_angle,
+              &spin_angle, position, normal, &component)) {
+        impact->type = AZ_IMP_BADDIE;
+        impact->target.baddie.baddie = baddie;
+        impact->target.baddie.component = component;
+      }
+    }
+  }
+  impact->angle = spin_angle;
+}
+
+void test_arc_circle_impact(void) {
+  az_preferences_t prefs;
+  az_reset_prefs_to_defaults(&prefs);
+  enter_impact_room(&prefs);
+  // Skipping objects outside of the arc's swept region should never change
+  // the impact.  The arcs go up to more than a full turn either way, and
+  // most of them start or end right at one of the objects, so that the
+  // object straddles the ray from spin_center through the start or end.
+  const az_impact_flags_t flag_sets[] = {
+    AZ_IMPF_NONE, AZ_IMPF_WEAK_WALL, AZ_IMPF_SHIP,
+    AZ_IMPF_BADDIE | AZ_IMPF_DOOR_INSIDE, AZ_IMPF_WALL
+  };
+  az_random_seed_t seed = {3579, 7531};
+  int num_mismatches = 0, num_wide_hits = 0;
+  int type_counts[AZ_IMP_WALL + 1] = {0};
+  for (int trial = 0; trial < 600; ++trial) {
+    const az_impact_flags_t skip_types =
+      flag_sets[trial % AZ_ARRAY_SIZE(flag_sets)];
+    const double circle_radius = (trial % 4 == 0 ? 0.0 :
+                                  az_rand_double(&seed, 0.0, 20.0));
+    const az_vector_t target = random_target(&seed);
+    const az_vector_t spin_center =
+      az_vadd(target, az_rand_point_in_circle(&seed, 800.0));
+    const double spin_angle = az_rand_double(&seed, -7.0, 7.0);
+    az_vector_t start;
+    switch (trial % 3) {
+      case 0: start = target; break;
+      case 1:
+        start = az_vadd(spin_center, az_vrotate(
+            az_vsub(target, spin_center), -spin_angle));
+        break;
+      default:
+        start = az_vadd(spin_center, az_rand_point_in_circle(&seed, 800.0));
+        break;
+    }
+    az_impact_t impact, expected;
+    az_arc_circle_impact(&state1, circle_radius, start, spin_center,
+                         spin_angle, skip_types, AZ_NULL_UID, &impact);
+    slow_arc_circle_impact(circle_radius, start, spin_center, spin_angle,
+                           skip_types, &expected);
+    if (!same_impact(&impact, &expected) || impact.angle != expected.angle) {
+      ++num_mismatches;
+    }
+    ++type_counts[impact.type];
+    if (impact.type != AZ_IMP_NOTHING && fabs(impact.angle) > AZ_PI) {
+      ++num_wide_hits;
+    }
+  }
+  EXPECT_INT_EQ(0, num_mismatches);
+  EXPECT_TRUE(num_wide_hits > 0);
+  EXPECT_TRUE(type_counts[AZ_IMP_NOTHING] > 0);
+  EXPECT_TRUE(type_counts[AZ_IMP_BADDIE] > 0);
+  EXPECT_TRUE(type_counts[AZ_IMP_DOOR_OUTSIDE] > 0);
+  EXPECT_TRUE(type_counts[AZ_IMP_SHIP] > 0);
+  EXPECT_TRUE(type_counts[AZ_IMP_WALL] > 0);
+}
+
+void test_baddie_bounds(void) {
+  // For baddies with many components, scattered into random poses, the hit
+  // functions should give exactly the same results with or without bounds.
+  const az_baddie_kind_t kinds[] = {AZ_BAD_KILOFUGE, AZ_BAD_FORCEFIEND,
+                                    AZ_BAD_OTH_SUPERGUNSHIP, AZ_BAD_BOX};
+  az_random_seed_t seed = {4321, 8765};
+  int num_hits = 0, num_mismatches = 0;
+  for (int trial = 0; trial < 400; ++trial) {
+    az_baddie_t baddie = {0};
+    az_init_baddie(&baddie, kinds[trial % AZ_ARRAY_SIZE(kinds)],
+                   az_rand_point_in_circle(&seed, 100.0),
+                   az_rand_double(&seed, -AZ_PI, AZ_PI));
+    for (int i = 0; i < baddie.data->num_components; ++i) {
+      baddie.components[i].position = az_vadd(
+          baddie.components[i].position,
+          az_rand_point_in_circle(&seed, 30.0));
+      baddie.components[i].angle = az_rand_double(&seed, -AZ_PI, AZ_PI);
+    }
+    az_baddie_bounds_t bounds;
+    az_get_baddie_bounds(&baddie, &bounds);
+    for (int i = 0; i < 50; ++i) {
+      const az_vector_t start = az_rand_point_in_circle(&seed, 400.0);
+      const az_vector_t delta = az_rand_point_in_circle(&seed, 400.0);
+      const double radius = az_rand_double(&seed, 0.0, 10.0);
+      az_vector_t pos1 = AZ_VZERO, pos2 = AZ_VZERO;
+      const bool ray1 = az_ray_hits_baddie(&baddie, NULL, start, delta,
+                                           &pos1, NULL, NULL);
+      const bool ray2 = az_ray_hits_baddie(&baddie, &bounds, start, delta,
+                                           &pos2, NULL, NULL);
+      if (ray1) ++num_hits;
+      if (ray1 != ray2 || pos1.x != pos2.x || pos1.y != pos2.y) {
+        ++num_mismatches;
+      }
+      const bool circle1 = az_circle_hits_baddie(
+          &baddie, NULL, radius, start, delta, &pos1, NULL, NULL);
+      const bool circle2 = az_circle_hits_baddie(
+          &baddie, &bounds, radius, start, delta, &pos2, NULL, NULL);
+      if (circle1 != circle2 || pos1.x != pos2.x || pos1.y != pos2.y) {
+        ++num_mismatches;
+      }
+      const double spin_angle = az_rand_double(&seed, -AZ_PI, AZ_PI);
+      double angle1 = 0.0, angle2 = 0.0;
+      const bool arc1 = az_arc_circle_hits_baddie(
+          &baddie, NULL, radius, start, delta, spin_angle, &angle1, NULL,
+          NULL, NULL);
+      const bool arc2 = az_arc_circle_hits_baddie(
+          &baddie, &bounds, radius, start, delta, spin_angle, &angle2, NULL,
+          NULL, NULL);
+      if (arc1 != arc2 || angle1 != angle2) ++num_mismatches;
+    }
+  }
+  EXPECT_INT_EQ(0, num_mismatches);
+  EXPECT_TRUE(num_hits > 100);
+}
+
+void test_baddie_sweep(void) {
+  az_planet_t planet = {0};
+  az_preferences_t prefs;
+  az_reset_prefs_to_defaults(&prefs);
+  AZ_ZERO_OBJECT(&state1);
+  state1.planet = &planet;
+  state1.prefs = &prefs;
+  add_box_row();
+  az_build_baddie_sweep(&state1);
+  EXPECT_TRUE(state1.baddie_sweep.valid);
+  EXPECT_INT_EQ(20, state1.baddie_sweep.num_entries);
+  EXPECT_INT_EQ(0, state1.baddie_sweep.unindexed);
+  check_sweep_impacts((az_vector_t){-50, 0}, (az_vector_t){3000, 400});
+  check_sweep_impacts((az_vector_t){950, -100}, (az_vector_t){0, 400});
+  check_sweep_impacts((az_vector_t){2500, 200}, (az_vector_t){-600, 0});
+  check_sweep_impacts((az_vector_t){5000, 0}, (az_vector_t){100, 100});
+
+  // Moving a baddie (and flagging it) keeps impacts correct without a
+  // rebuild, as does adding a new one.
+  state1.baddies[3].position = (az_vector_t){-500, -500};
+  az_update_baddie_sweep(&state1, &state1.baddies[3]);
+  az_add_baddie(&state1, AZ_BAD_BOX, (az_vector_t){-500, 500}, 0.0);
+  check_sweep_impacts((az_vector_t){-1000, -500}, (az_vector_t){1000, 0});
+  check_sweep_impacts((az_vector_t){-500, 1000}, (az_vector_t){0, -1000});
+
+  // Rebuilding keeps the entries sorted, and drops removed baddies.
+  state1.baddies[5].kind = AZ_BAD_NOTHING;
+  az_build_baddie_sweep(&state1);
+  EXPECT_INT_EQ(20, state1.baddie_sweep.num_entries);
+  EXPECT_INT_EQ(0, state1.baddie_sweep.unindexed);
+  for (int i = 1; i < state1.baddie_sweep.num_entries; ++i) {
+    EXPECT_TRUE(state1.baddie_sweep.entries[i - 1].min_x <=
+                state1.baddie_sweep.entries[i].min_x);
+  }
+  check_sweep_impacts((az_vector_t){-1000, -500}, (az_vector_t){3000, 900});
+}
+
+void test_gravfield_index(void) {
+  AZ_ZERO_OBJECT(&state1);
+  // A trapezoid, a sector, and a water pool (whose surface is an arc around
+  // the origin, like those in the planet's rooms):
+  az_gravfield_t *trapezoid = &state1.gravfields[0];
+  trapezoid->kind = AZ_GRAV_TRAPEZOID;
+  trapezoid->position = (az_vector_t){-200, 100};
+  trapezoid->angle = 0.7;
+  trapezoid->size.trapezoid.front_offset = 10.0;
+  trapezoid->size.trapezoid.front_semiwidth = 60.0;
+  trapezoid->size.trapezoid.rear_semiwidth = 30.0;
+  trapezoid->size.trapezoid.semilength = 80.0;
+  az_gravfield_t *sector = &state1.gravfields[1];
+  sector->kind = AZ_GRAV_SECTOR_PULL;
+  sector->position = (az_vector_t){150, 200};
+  sector->angle = 2.5;
+  sector->size.sector.sweep_degrees = 250.0;
+  sector->size.sector.inner_radius = 40.0;
+  sector->size.sector.thickness = 70.0;
+  az_gravfield_t *water = &state1.gravfields[2];
+  water->kind = AZ_GRAV_WATER;
+  water->position = az_vpolar(300.0, -1.2);
+  water->angle = -1.2;
+  water->size.trapezoid.front_offset = 0.0;
+  water->size.trapezoid.front_semiwidth = 150.0;
+  water->size.trapezoid.rear_semiwidth = 120.0;
+  water->size.trapezoid.semilength = 50.0;
+  for (int i = 0; i < 3; ++i) {
+    az_update_gravfield_index(&state1, &state1.gravfields[i]);
+  }
+  EXPECT_TRUE(state1.gravfield_index.liquids == (UINT64_C(1) << 2));
+
+  // Every point within a gravfield must be within its bounds, and every
+  // path that hits the water's surface must have it as a candidate; but
+  // points and paths far from the gravfields should be ruled out.
+  az_random_seed_t seed = {1234, 5678};
+  int num_within = 0, num_ruled_out = 0;
+  for (int trial = 0; trial < 30000; ++trial) {
+    const az_vector_t point = az_rand_point_in_circle(&seed, 600.0);
+    for (int i = 0; i < 3; ++i) {
+      const az_gravfield_t *gravfield = &state1.gravfields[i];
+      const bool might_contain =
+        az_gravfield_might_contain(&state1, gravfield, point);
+      if (az_point_within_gravfield(gravfield, point)) {
+        ++num_within;
+        EXPECT_TRUE(might_contain);
+      } else if (!might_contain) ++num_ruled_out;
+    }
+    const az_vector_t delta = az_rand_point_in_circle(&seed, 100.0);
+    const uint64_t candidates =
+      az_liquid_candidates(&state1, 5.0, point, delta);
+    EXPECT_TRUE((candidates & ~state1.gravfield_index.liquids) == 0);
+    if (az_circle_hits_liquid_surface(water, 5.0, point, delta, NULL, NULL)) {
+      EXPECT_TRUE(candidates & (UINT64_C(1) << 2));
+    }
+  }
+  EXPECT_TRUE(num_within > 1000);
+  EXPECT_TRUE(num_ruled_out > 40000);
+
+  // Moving a gravfield (and updating the index) moves its bounds.
+  const az_vector_t sector_center = (az_vector_t){150, 200};
+  EXPECT_TRUE(az_gravfield_might_contain(&state1, sector, sector_center));
+  sector->position = (az_vector_t){-1000, -1000};
+  az_update_gravfield_index(&state1, sector);
+  EXPECT_FALSE(az_gravfield_might_contain(&state1, sector, sector_center));
+}
+
+void test_nearest_baddies(void) {
+  az_planet_t planet = {0};
+  az_preferences_t prefs;
+  az_reset_prefs_to_defaults(&prefs);
+  AZ_ZERO_OBJECT(&state1);
+  state1.planet = &planet;
+  state1.prefs = &prefs;
+  az_random_seed_t seed = {2468, 1357};
+  for (int i = 0; i < 40; ++i) {
+    az_baddie_t *baddie = az_add_baddie(
+        &state1, AZ_BAD_BOX, az_rand_point_in_circle(&seed, 1000.0), 0.0);
+    if (i % 5 == 0) baddie->temp_properties |= AZ_BADF_INVINCIBLE;
+  }
+  // Put two baddies at the same spot, to test tie-breaking.
+  state1.baddies[12].position = state1.baddies[30].position;
+  az_build_baddie_sweep(&state1);
+  // Remove one baddie, and move another (flagging it) without a rebuild.
+  state1.baddies[8].kind = AZ_BAD_NOTHING;
+  state1.baddies[21].position = (az_vector_t){-3000, 50};
+  az_update_baddie_sweep(&state1, &state1.baddies[21]);
+  const az_uid_t skip_uid = state1.baddies[17].uid;
+
+  int num_mismatches = 0;
+  for (int trial = 0; trial < 300; ++trial) {
+    const az_vector_t point = az_rand_point_in_circle(&seed, 2000.0);
+    // Find the four nearest non-invincible baddies by brute force (with ties
+    // going to the earlier baddie).
+    const int k = 4;
+    int expected[4];
+    int num_expected = 0;
+    for (int i = 0; i < AZ_ARRAY_SIZE(state1.baddies); ++i) {
+      const az_baddie_t *baddie = &state1.baddies[i];
+      if (baddie->kind == AZ_BAD_NOTHING || baddie->uid == skip_uid ||
+          (baddie->temp_properties & AZ_BADF_INVINCIBLE)) continue;
+      const double dist = az_vdist(baddie->position, point);
+      int j = (num_expected < k ? num_expected++ : k);
+      for (; j > 0 && dist < az_vdist(state1.baddies[expected[j - 1]].position,
+                                      point); --j) {
+        if (j < k) expected[j] = expected[j - 1];
+      }
+      if (j < k) expected[j] = i;
+    }
+    const az_baddie_t *found[4];
+    const int num_found = az_find_nearest_baddies(
+        &state1, point, AZ_BADF_INVINCIBLE, skip_uid, k, found);
+    EXPECT_INT_EQ(num_expected, num_found);
+    for (int i = 0; i < num_expected && i < num_found; ++i) {
+      if (found[i] != &state1.baddies[expected[i]]) ++num_mismatches;
+    }
+    // Every baddie within a given distance should be marked as near.
+    const double max_dist = az_rand_double(&seed, 0.0, 800.0);
+    const uint64_t near = az_baddies_near(&state1, point, max_dist);
+    for (int i = 0; i < AZ_ARRAY_SIZE(state1.baddies); ++i) {
+      const az_baddie_t *baddie = &state1.baddies[i];
+      if (baddie->kind != AZ_BAD_NOTHING &&
+          az_vdist(baddie->position, point) <= max_dist &&
+          !(near & (UINT64_C(1) << i))) ++num_mismatches;
+    }
+    // Find the nearest baddie within a cone by brute force.
+    const double angle = az_rand_double(&seed, -AZ_PI, AZ_PI);
+    const double limit = az_rand_double(&seed, 0.0, AZ_HALF_PI);
+    const az_baddie_t *best = NULL;
+    double best_dist = INFINITY;
+    AZ_ARRAY_LOOP(baddie, state1.baddies) {
+      if (baddie->kind == AZ_BAD_NOTHING) continue;
+      const az_vector_t delta = az_vsub(baddie->position, point);
+      if (az_vnorm(delta) < best_dist &&
+          fabs(az_mod2pi(az_vtheta(delta) - angle)) <= limit) {
+        best_dist = az_vnorm(delta);
+        best = baddie;
+      }
+    }
+    if (az_find_nearest_baddie_in_cone(&state1, point, angle, limit,
+                                       AZ_BADF_NO_HOMING_PROJ) != best) {
+      ++num_mismatches;
+    }
+  }
+  EXPECT_INT_EQ(0, num_mismatches);
+
+  // Of the two baddies at the same spot, the earlier one comes first.
+  const az_baddie_t *found[2];
+  EXPECT_INT_EQ(2, az_find_nearest_baddies(
+      &state1, state1.baddies[30].position, 0, AZ_NULL_UID, 2, found));
+  EXPECT_TRUE(found[0] == &state1.baddies[12]);
+  EXPECT_TRUE(found[1] == &state1.baddies[30]);
+
+  // A flagged baddie that has moved only a little is still listed at its old
+  // position in the sweep, but should be found just once.
+  az_baddie_t *moved = &state1.baddies[25];
+  const az_vector_t old_position = moved->position;
+  moved->position = az_vadd(old_position, (az_vector_t){5, 0});
+  az_update_baddie_sweep(&state1, moved);
+  const az_baddie_t *nearby[4];
+  EXPECT_INT_EQ(4, az_find_nearest_baddies(
+      &state1, old_position, 0, AZ_NULL_UID, 4, nearby));
+  EXPECT_TRUE(nearby[0] == moved);
+  for (int i = 0; i < AZ_ARRAY_SIZE(nearby); ++i) {
+    for (int j = 0; j < i; ++j) EXPECT_TRUE(nearby[i] != nearby[j]);
+  }
+  EXPECT_TRUE(az_find_nearest_baddie_in_cone(
+      &state1, old_position, 0.0, AZ_PI, 0) == moved);
+}
+
+void test_particle_array(void) {
+  AZ_ZERO_OBJECT(&state1);
+  // A new particle starts out zeroed (so in particular, with zero age), and
+  // reads back from its slot exactly as it was added.
+  az_particle_t particle = {.kind = AZ_PAR_BOOM, .age = 1.0};
+  EXPECT_TRUE(az_insert_particle(&state1, &particle));
+  EXPECT_INT_EQ(AZ_PAR_NOTHING, particle.kind);
+  EXPECT_APPROX(0.0, particle.age);
+  particle.kind = AZ_PAR_EMBER;
+  particle.color = (az_color_t){10, 20, 30, 40};
+  particle.position = (az_vector_t){1, 2};
+  particle.velocity = (az_vector_t){3, 4};
+  particle.angle = 0.5;
+  particle.lifetime = 2.0;
+  particle.param1 = 7.0;
+  particle.param2 = -1.0;
+  az_add_particle(&state1, &particle);
+  EXPECT_INT_EQ(1, state1.particle_slots.num_live);
+  az_particle_t copy;
+  az_get_particle(&state1, state1.particle_slots.live[0], &copy);
+  EXPECT_INT_EQ(AZ_PAR_EMBER, copy.kind);
+  EXPECT_INT_EQ(30, copy.color.b);
+  EXPECT_VAPPROX(particle.position, copy.position);
+  EXPECT_VAPPROX(particle.velocity, copy.velocity);
+  EXPECT_APPROX(0.5, copy.angle);
+  EXPECT_APPROX(0.0, copy.age);
+  EXPECT_APPROX(2.0, copy.lifetime);
+  EXPECT_APPROX(7.0, copy.param1);
+  EXPECT_APPROX(-1.0, copy.param2);
+
+  // Once the array is full, there's no room to insert another particle.
+  for (int i = 1; i < AZ_MAX_NUM_PARTICLES; ++i) {
+    EXPECT_TRUE(az_insert_particle(&state1, &copy));
+    az_add_particle(&state1, &particle);
+  }
+  EXPECT_FALSE(az_insert_particle(&state1, &copy));
+  EXPECT_INT_EQ(AZ_MAX_NUM_PARTICLES, state1.particle_slots.num_live);
+}
+
+void test_prebuilt_rooms(void) {
+  // Room 0 has some of each kind of object, including an upgrade and a
+  // console that a baddie carries as cargo.  Room 1 is the door's destination.
+  az_baddie_spec_t baddies[] = {
+    {.kind = AZ_BAD_BOX, .position = {100, 50}, .cargo_slots = {2, 3}},
+    {.kind = AZ_BAD_BOX, .position = {-80, 20}, .angle = 1.0, .uuid_slot = 1}
+  };
+  az_door_spec_t doors[] = {
+    {.kind = AZ_DOOR_NORMAL, .position = {0, 300}, .destination = 1}
+  };
+  az_gravfield_spec_t gravfields[] = {
+    {.kind = AZ_GRAV_TRAPEZOID, .position = {50, 0}, .strength = 1.0,
+     .size.trapezoid = {.front_semiwidth = 20, .rear_semiwidth = 40,
+                        .semilength = 100}}
+  };
+  az_node_spec_t nodes[] = {
+    {.kind = AZ_NODE_UPGRADE, .subkind.upgrade = AZ_UPG_GUN_CHARGE,
+     .position = {10, 10}, .uuid_slot = 2},
+    {.kind = AZ_NODE_CONSOLE, .subkind.console = AZ_CONS_SAVE,
+     .position = {-10, 10}, .uuid_slot = 3}
+  };
+  az_wall_spec_t walls[] = {
+    {.kind = AZ_WALL_INDESTRUCTIBLE, .data = az_get_wall_data(0),
+     .position = {200, 0}},
+    {.kind = AZ_WALL_DESTRUCTIBLE_BOMB, .data = az_get_wall_data(1),
+     .position = {-200, 40}, .angle = 2.0, .uuid_slot = 4}
+  };
+  az_room_t rooms[2] = {
+    {.camera_bounds = {.r_span = 500, .theta_span = 6.3},
+     .num_baddies = AZ_ARRAY_SIZE(baddies), .baddies = baddies,
+     .num_doors = AZ_ARRAY_SIZE(doors), .doors = doors,
+     .num_gravfields = AZ_ARRAY_SIZE(gravfields), .gravfields = gravfields,
+     .num_nodes = AZ_ARRAY_SIZE(nodes), .nodes = nodes,
+     .num_walls = AZ_ARRAY_SIZE(walls), .walls = walls},
+    {.properties = AZ_ROOMF_WITH_SAVE,
+     .camera_bounds = {.r_span = 500, .theta_span = 6.3}}
+  };
+  az_planet_t planet = {.num_rooms = 2, .rooms = rooms};
+  az_prebuild_rooms(&planet);
+  EXPECT_TRUE(rooms[0].prebuilt != NULL);
+  EXPECT_TRUE(rooms[1].prebuilt != NULL);
+
+  // Copying in the prebuilt room should give exactly the same state as the
+  // general path, whether or not the upgrade gets left out.
+  for (int has_upgrade = 0; has_upgrade < 2; ++has_upgrade) {
+    AZ_ZERO_OBJECT(&state1);
+    state1.planet = &planet;
+    if (has_upgrade) az_give_upgrade(&state1.ship.player, AZ_UPG_GUN_CHARGE);
+    memcpy(&state2, &state1, sizeof(state1));
+    az_enter_room(&state1, &rooms[0]);
+    az_prebuilt_room_t *prebuilt = rooms[0].prebuilt;
+    rooms[0].prebuilt = NULL;
+    az_enter_room(&state2, &rooms[0]);
+    rooms[0].prebuilt = prebuilt;
+    EXPECT_TRUE(memcmp(&state1, &state2, sizeof(state1)) == 0);
+    EXPECT_INT_EQ(2 - has_upgrade, state1.node_high_water);
+    EXPECT_INT_EQ(AZ_DOORMARK_SAVE, state1.doors[0].marker);
+    EXPECT_INT_EQ(AZ_UUID_NODE, state1.baddies[0].cargo_uuids[0].type);
+    EXPECT_TRUE(state1.baddies[0].cargo_uuids[has_upgrade ? 0 : 1].uid ==
+                state1.nodes[has_upgrade ? 0 : 1].uid);
+    EXPECT_INT_EQ(has_upgrade ? AZ_UUID_NOTHING : AZ_UUID_NODE,
+                  state1.baddies[0].cargo_uuids[1].type);
+  }
+
+  // The spec arrays are on the stack, so only destroy the prebuilt objects.
+  for (int i = 0; i < AZ_ARRAY_SIZE(rooms); ++i) {
+    az_room_t room = {.prebuilt = rooms[i].prebuilt};
+    az_destroy_room(&room);
+  }
+}
+
+void test_ray_blocked(void) {
+  az_preferences_t prefs;
+  az_reset_prefs_to_defaults(&prefs);
+  enter_impact_room(&prefs);
+  // The yes-or-no queries should agree with the full impact queries, for
+  // paths aimed at each kind of object, whether or not weak walls count.
+  const az_impact_flags_t flag_sets[] = {
+    AZ_IMPF_NONE, AZ_IMPF_WEAK_WALL, AZ_IMPF_NOT_LIQUID,
+    AZ_IMPF_WEAK_WALL | AZ_IMPF_NOT_LIQUID | AZ_IMPF_SHIP,
+    AZ_IMPF_WALL | AZ_IMPF_BADDIE
+  };
+  az_random_seed_t seed = {1357, 9753};
+  int num_mismatches = 0, num_blocked = 0, num_clear = 0, num_walls = 0;
+  for (int trial = 0; trial < 1000; ++trial) {
+    const az_impact_flags_t skip_types =
+      flag_sets[trial % AZ_ARRAY_SIZE(flag_sets)];
+    const az_ray_t ray = random_aimed_ray(&seed);
+    az_impact_t impact;
+    slow_ray_impact(ray.start, ray.delta, skip_types, AZ_NULL_UID, &impact);
+    const bool ray_blocked = az_ray_blocked(
+        &state1, ray.start, ray.delta, skip_types, AZ_NULL_UID);
+    if (ray_blocked != (impact.type != AZ_IMP_NOTHING)) ++num_mismatches;
+    if (ray_blocked) ++num_blocked;
+    else ++num_clear;
+    if (impact.type == AZ_IMP_WALL) ++num_walls;
+    az_circle_impact(&state1, 10.0, ray.start, ray.delta, skip_types,
+                     AZ_NULL_UID, &impact);
+    const bool circle_blocked = az_circle_path_blocked(
+        &state1, 10.0, ray.start, ray.delta, skip_types, AZ_NULL_UID);
+    if (circle_blocked != (impact.type != AZ_IMP_NOTHING)) ++num_mismatches;
+    // Check az_ray_reaches_ship against the reference, too.
+    slow_ray_impact(ray.start, az_vsub(state1.ship.position, ray.start),
+                    skip_types & ~AZ_IMPF_SHIP, AZ_NULL_UID, &impact);
+    if (az_ray_reaches_ship(&state1, ray.start, skip_types & ~AZ_IMPF_SHIP,
+                            AZ_NULL_UID) != (impact.type == AZ_IMP_SHIP)) {
+      ++num_mismatches;
+    }
+  }
+  EXPECT_INT_EQ(0, num_mismatches);
+  EXPECT_TRUE(num_blocked > 100);
+  EXPECT_TRUE(num_clear > 100);
+  EXPECT_TRUE(num_walls > 100);
+
+  // A ray straight down from (1000, 0) is blocked by the weak wall, or (with
+  // weak walls skipped) by the strong wall behind it, and either way the
+  // blocking wall gets cached.
+  const az_vector_t start = {1000, 0}, down = {0, -600};
+  EXPECT_TRUE(az_ray_blocked(&state1, start, down, AZ_IMPF_NONE,
+                             AZ_NULL_UID));
+  EXPECT_INT_EQ(1, state1.wall_grid.last_blocker);
+  EXPECT_TRUE(az_ray_blocked(&state1, start, down, AZ_IMPF_WEAK_WALL,
+                             AZ_NULL_UID));
+  EXPECT_INT_EQ(2, state1.wall_grid.last_blocker);
+  // The cached blocker is tried first, but if it has moved out of the way,
+  // the query must still find (or not find) the other walls.
+  state1.walls[2].position = (az_vector_t){-2000, -2000};
+  az_update_wall_grid(&state1, &state1.walls[2]);
+  EXPECT_INT_EQ(2, state1.wall_grid.last_blocker);
+  EXPECT_FALSE(az_ray_blocked(&state1, start, down, AZ_IMPF_WEAK_WALL,
+                              AZ_NULL_UID));
+  EXPECT_TRUE(az_ray_blocked(&state1, start, down, AZ_IMPF_NONE,
+                             AZ_NULL_UID));
+  EXPECT_INT_EQ(1, state1.wall_grid.last_blocker);
+  // A weak cached blocker doesn't count when weak walls are skipped.
+  EXPECT_FALSE(az_circle_path_blocked(&state1, 5.0, start, down,
+                                      AZ_IMPF_WEAK_WALL, AZ_NULL_UID));
+  // Nor does one that has been destroyed.
+  state1.walls[1].kind = AZ_WALL_NOTHING;
+  az_update_wall_grid(&state1, &state1.walls[1]);
+  EXPECT_FALSE(az_ray_blocked(&state1, start, down, AZ_IMPF_NONE,
+                              AZ_NULL_UID));
+  // Moving the strong wall back makes the path blocked again.
+  state1.walls[2].position = (az_vector_t){1000, -400};
+  az_update_wall_grid(&state1, &state1.walls[2]);
+  EXPECT_TRUE(az_ray_blocked(&state1, start, down, AZ_IMPF_NONE,
+                             AZ_NULL_UID));
+  EXPECT_INT_EQ(2, state1.wall_grid.last_blocker);
+}
+
+void test_ray_impact_batch(void) {
+  az_preferences_t prefs;
+  az_reset_prefs_to_defaults(&prefs);
+  enter_impact_room(&prefs);
+  // Fans of rays, like those of a TRIPLE beam, should give the same impacts
+  // as casting each ray on its own.
+  const az_impact_flags_t flag_sets[] = {
+    AZ_IMPF_NONE, AZ_IMPF_NOT_LIQUID, AZ_IMPF_WEAK_WALL | AZ_IMPF_SHIP,
+    AZ_IMPF_BADDIE | AZ_IMPF_NOT_LIQUID,
+    AZ_IMPF_WALL | AZ_IMPF_DOOR_INSIDE | AZ_IMPF_DOOR_OUTSIDE
+  };
+  az_random_seed_t seed = {2468, 8642};
+  int num_mismatches = 0, num_recasts = 0, num_stale = 0;
+  int type_counts[AZ_IMP_WALL + 1] = {0};
+  for (int trial = 0; trial < 600; ++trial) {
+    const az_impact_flags_t skip_types =
+      flag_sets[trial % AZ_ARRAY_SIZE(flag_sets)];
+    const az_uid_t skip_uid =
+      (trial % 7 == 0 ? state1.baddies[trial % 20].uid : AZ_NULL_UID);
+    const int num_rays = az_rand_int(&seed, 1, AZ_MAX_RAY_BATCH_SIZE);
+    az_ray_t rays[AZ_MAX_RAY_BATCH_SIZE];
+    rays[0] = random_aimed_ray(&seed);
+    for (int r = 1; r < num_rays; ++r) {
+      rays[r] = (az_ray_t){
+        .start = rays[0].start,
+        .delta = az_vrotate(rays[0].delta,
+                            AZ_DEG2RAD(3) * ((r + 1) / 2) *
+                            (r % 2 ? 1 : -1))};
+    }
+    az_impact_t impacts[AZ_MAX_RAY_BATCH_SIZE];
+    az_ray_impact_batch(&state1, rays, num_rays, skip_types, skip_uid,
+                        impacts);
+    for (int r = 0; r < num_rays; ++r) {
+      az_impact_t expected;
+      slow_ray_impact(rays[r].start, rays[r].delta, skip_types, skip_uid,
+                      &expected);
+      if (!same_impact(&impacts[r], &expected)) ++num_mismatches;
+      ++type_counts[impacts[r].type];
+    }
+
+    // Resolve the impacts in order, as fire_beam does.  Once a ray destroys
+    // a baddie or opens a door, the batch results for the later rays are
+    // stale, and those rays must be cast again on their own.
+    az_baddie_t saved_baddie;
+    az_baddie_t *removed = NULL;
+    az_door_t saved_door;
+    az_door_t *opened = NULL;
+    for (int r = 0; r < num_rays; ++r) {
+      if (removed != NULL || opened != NULL) {
+        az_impact_t impact, expected;
+        az_ray_impact(&state1, rays[r].start, rays[r].delta, skip_types,
+                      skip_uid, &impact);
+        slow_ray_impact(rays[r].start, rays[r].delta, skip_types, skip_uid,
+                        &expected);
+        if (!same_impact(&impact, &expected)) ++num_mismatches;
+        if (!same_impact(&impact, &impacts[r])) ++num_stale;
+        ++type_counts[impact.type];
+        ++num_recasts;
+      } else if (impacts[r].type == AZ_IMP_BADDIE) {
+        removed = impacts[r].target.baddie.baddie;
+        saved_baddie = *removed;
+        removed->kind = AZ_BAD_NOTHING;
+      } else if (impacts[r].type == AZ_IMP_DOOR_OUTSIDE) {
+        opened = impacts[r].target.door;
+        saved_door = *opened;
+        opened->is_open = true;
+        opened->openness = 1.0;
+      }
+    }
+    if (removed != NULL) *removed = saved_baddie;
+    if (opened != NULL) *opened = saved_door;
+  }
+  EXPECT_INT_EQ(0, num_mismatches);
+  EXPECT_TRUE(num_recasts > 50);
+  EXPECT_TRUE(num_stale > 0);
+  EXPECT_TRUE(type_counts[AZ_IMP_NOTHING] > 0);
+  EXPECT_TRUE(type_counts[AZ_IMP_BADDIE] > 0);
+  EXPECT_TRUE(type_counts[AZ_IMP_DOOR_INSIDE] > 0);
+  EXPECT_TRUE(type_counts[AZ_IMP_DOOR_OUTSIDE] > 0);
+  EXPECT_TRUE(type_counts[AZ_IMP_LIQUID_SURFACE] > 0);
+  EXPECT_TRUE(type_counts[AZ_IMP_SHIP] > 0);
+  EXPECT_TRUE(type_counts[AZ_IMP_WALL] > 0);
+}
+
+void test_space_snapshot(void) {
+  az_planet_t planet = {0};
+  az_preferences_t prefs1, prefs2;
+  az_reset_prefs_to_defaults(&prefs1);
+  az_reset_prefs_to_defaults(&prefs2);
+
+  AZ_ZERO_OBJECT(&state1);
+  state1.planet = &planet;
+  state1.prefs = &prefs1;
+  state1.rng = (az_random_seed_t){7, 11};
+  state1.ship.position = (az_vector_t){10, 20};
+  az_add_speck(&state1, AZ_WHITE, 1.0, (az_vector_t){1, 2},
+               (az_vector_t){3, 4});
+  az_set_message(&state1, "Hello");
+  az_snapshot_space_state(&state1, &snapshot);
+
+  // Changing the original state shouldn't affect the snapshot.
+  state1.ship.position = (az_vector_t){-5, -5};
+  state1.specks.kind[0] = AZ_SPECK_NOTHING;
+  az_restore_space_state(&snapshot, &state1);
+  EXPECT_VAPPROX(((az_vector_t){10, 20}), state1.ship.position);
+  EXPECT_INT_EQ(AZ_SPECK_NORMAL, state1.specks.kind[0]);
+
+  // Restoring into a different state should keep that state's preferences.
+  AZ_ZERO_OBJECT(&state2);
+  state2.planet = &planet;
+  state2.prefs = &prefs2;
+  az_restore_space_state(&snapshot, &state2);
+  EXPECT_TRUE(state2.planet == &planet);
+  EXPECT_TRUE(state2.prefs == &prefs2);
+  EXPECT_INT_EQ(7, state2.rng.z);
+  EXPECT_INT_EQ(11, state2.rng.w);
+  EXPECT_VAPPROX(((az_vector_t){10, 20}), state2.ship.position);
+  EXPECT_INT_EQ(1, state2.speck_slots.num_live);
+  az_speck_t speck;
+  az_get_speck(&state2, 0, &speck);
+  EXPECT_VAPPROX(((az_vector_t){1, 2}), speck.position);
+  EXPECT_STRING_EQ("Hello", state2.message.paragraph);
+}
+
+/*===========================================================================*/
@@ -0,0 +1,84 @@
+/*=============================================================================
+| Copyright 2012 Matthew D. Steele <mdsteele@alum.mit.edu>                    |
+|                                                                             |
+| This file is part of Azimuth.                                               |
+|                                                                             |
+| Azimuth is free software: you can redistribute it and/or modify it under    |
+| the terms of the GNU General Public License as published by the Free        |
+| Software Foundation, either version 3 of the License, or (at your option)   |
+| any later version.                                                          |
+|                                                                             |
+| Azimuth is distributed in the hope that it will be useful, but WITHOUT      |
+| ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       |
+| FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for   |
+| more details.                                                               |
+|                                                                             |
+| You should have received a copy of the GNU General Public License along     |
+| with Azimuth.  If not, see <http://www.gnu.org/licenses/>.                  |
+=============================================================================*/
+
+#include <stdbool.h>
+
+#include "azimuth/state/wall.h"
+#include "azimuth/util/polygon.h"
+#include "azimuth/util/random.h"
+#include "azimuth/util/vector.h"
+#include "test/test.h"
+
+/*===========================================================================*/
+
+// Determine if the point is within slack of the inside of any of the
+// decomposition's pieces.
+static bool decomp_contains(const az_convex_decomp_t *decomp, double slack,
+                            az_vector_t point) {
+  for (int i = 0; i < decomp->num_pieces; ++i) {
+    const az_convex_piece_t *piece = &decomp->pieces[i];
+    bool inside = true;
+    for (int j = 0; j < piece->num_planes; ++j) {
+      const az_half_plane_t *plane = &decomp->planes[piece->first_plane + j];
+      if (az_vdot(plane->normal, point) > plane->offset + slack) {
+        inside = false;
+        break;
+      }
+    }
+    if (inside) return true;
+  }
+  return false;
+}
+
+void test_wall_decomps(void) {
+  // Every wall polygon should split into convex pieces, and the union of
+  // those pieces should be the polygon (give or take rounding error right
+  // along its edges).
+  az_random_seed_t seed = {2468, 1357};
+  int num_failures = 0, num_mismatches = 0;
+  for (int i = 0; i < AZ_NUM_WALL_DATAS; ++i) {
+    const az_wall_data_t *data = az_get_wall_data(i);
+    az_convex_decomp_t decomp;
+    if (!az_decompose_polygon(data->polygon, &decomp)) {
+      ++num_failures;
+      continue;
+    }
+    EXPECT_TRUE(data->decomp != NULL);
+    for (int j = 0; j < 200; ++j) {
+      const az_vector_t point =
+        az_rand_point_in_circle(&seed, data->bounding_radius);
+      const bool contains = az_polygon_contains(data->polygon, point);
+      if (contains && !decomp_contains(&decomp, 1e-9, point)) {
+        ++num_mismatches;
+      }
+      if (!contains && decomp_contains(&decomp, -1e-9, point)) {
+        ++num_mismatches;
+      }
+      // The candidate edges for a point inside the polygon must not be empty.
+      if (contains &&
+          az_convex_decomp_edges(&decomp, 0.0, point, AZ_VZERO) == 0) {
+        ++num_mismatches;
+      }
+    }
+  }
+  EXPECT_INT_EQ(0, num_failures);
+  EXPECT_INT_EQ(0, num_mismatches);
+}
+
+/*===========================================================================*/